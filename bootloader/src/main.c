@@ -91,10 +91,29 @@ static bool LedOverridden;
 /* Private function prototypes -----------------------------------------------*/
 /* Private functions ---------------------------------------------------------*/
 
+/*
+ * The system firmware caches the results of the module integrity checks and includes the flash
+ * write generation in the cached data. The generation is passed to the system firmware via a
+ * backup register and needs to be incremented before anything is written to the internal flash
+ */
+static void Publish_Flash_Write_Generation(void)
+{
+    const uint16_t gen = SYSTEM_FLAG(Flash_Write_Generation_SysFlag);
+    HAL_Core_Write_Backup_Register(BKP_DR_FLASH_WRITE_GENERATION, gen | ((uint32_t)(uint16_t)~gen << 16));
+}
+
+static void Increment_Flash_Write_Generation(void)
+{
+    SYSTEM_FLAG(Flash_Write_Generation_SysFlag) += 1;
+    Save_SystemFlags();
+    Publish_Flash_Write_Generation();
+}
+
 void flashModulesCallback(bool isUpdating)
 {
     if(isUpdating)
     {
+        Increment_Flash_Write_Generation();
         OTA_FLASH_AVAILABLE = 1;
         if (!LedOverridden) {
             LED_SetRGBColor(FirmwareUpdateColor);
@@ -177,6 +196,8 @@ int main(void)
         Bootloader_Update_Version(BOOTLOADER_VERSION);
     }
 
+    Publish_Flash_Write_Generation();
+
     if (SYSTEM_FLAG(StartupMode_SysFlag) != 0) {
         SYSTEM_FLAG(StartupMode_SysFlag) = 0;
         Save_SystemFlags();
@@ -394,6 +415,7 @@ int main(void)
                 LED_SetRGBColor(RGB_COLOR_GREEN);
             // Restore the Factory Firmware
             // On success the device will reset)
+            Increment_Flash_Write_Generation();
             if (!FACTORY_Flash_Reset()) {
                 if (is_application_valid(ApplicationAddress, NULL)) {
                     // we have a valid image to fall back to, so just reset
@@ -472,6 +494,9 @@ int main(void)
 
     USB_DFU_MODE = 1;
 
+    // Any module in the internal flash can be rewritten in DFU mode
+    Increment_Flash_Write_Generation();
+
     HAL_DFU_USB_Init();
 
     // Main loop
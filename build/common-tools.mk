@@ -22,6 +22,7 @@ CURL = curl
 CRC = crc32
 XXD = xxd
 SERIAL_SWITCHER = $(COMMON_BUILD)/serial_switcher.py
+COMPRESS_MODULE = $(COMMON_BUILD)/compress_module.py
 
 GAWK_VERSION := $(shell gawk --version 2>/dev/null)
 ifdef GAWK_VERSION
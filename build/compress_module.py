@@ -0,0 +1,226 @@
+#!/usr/bin/env python3
+
+# Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+#
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation, either
+# version 3 of the License, or (at your option) any later version.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public
+# License along with this library; if not, see <http://www.gnu.org/licenses/>.
+#
+
+# Converts a Particle module binary into a compressed module using the small-window LZ method
+# (MODULE_COMPRESSION_METHOD_LZ). See hal/shared/lz_decompress.h for the description of the format.
+#
+# The module info header is expected to be located at the beginning of the input module.
+#
+# Bootloaders that predate the LZ method can't decompress such modules, so a dependency on the
+# bootloader version given by --bootloader-dependency is added to the module info header of the
+# compressed module. The dependency check on the device then rejects the module instead of
+# accepting an update that the bootloader would fail to apply.
+
+import argparse
+import struct
+import sys
+import zlib
+
+MODULE_INFO_FORMAT = '<LLBBHHBB'
+MODULE_INFO_SIZE = 24 # Including the dependencies
+MODULE_INFO_FLAG_COMPRESSED = 0x02
+MODULE_DEPENDENCY_FORMAT = '<BBH'
+MODULE_DEPENDENCY_OFFSETS = (16, 20)
+MODULE_FUNCTION_NONE = 0
+MODULE_FUNCTION_BOOTLOADER = 2
+COMPRESSED_MODULE_HEADER_FORMAT = '<HBBL'
+COMPRESSION_METHOD_LZ = 1
+
+MIN_WINDOW_BITS = 8
+MAX_WINDOW_BITS = 15
+DEFAULT_WINDOW_BITS = 12
+MIN_MATCH = 4
+MAX_CHAIN_LENGTH = 32
+HASH_BITS = 16
+
+def _put_length(out, n):
+    while n >= 255:
+        out.append(255)
+        n -= 255
+    out.append(n)
+
+def _put_block(out, data, lit_start, lit_end, offset, match_len):
+    lit_count = lit_end - lit_start
+    m = match_len - MIN_MATCH if match_len else 0
+    out.append((min(lit_count, 15) << 4) | min(m, 15))
+    if lit_count >= 15:
+        _put_length(out, lit_count - 15)
+    out += data[lit_start:lit_end]
+    out += struct.pack('<H', offset)
+    if match_len and m >= 15:
+        _put_length(out, m - 15)
+
+def _hash(data, pos):
+    v = data[pos] | (data[pos + 1] << 8) | (data[pos + 2] << 16) | (data[pos + 3] << 24)
+    return ((v * 2654435761) & 0xffffffff) >> (32 - HASH_BITS)
+
+def lz_compress(data, window_bits=DEFAULT_WINDOW_BITS, max_chain=MAX_CHAIN_LENGTH):
+    """Compress data using the small-window LZ format."""
+    max_offset = min(1 << window_bits, 0xffff)
+    size = len(data)
+    head = [-1] * (1 << HASH_BITS) # Last position for each hash value
+    prev = [-1] * size # Previous position with the same hash value
+    out = bytearray()
+    lit_start = 0
+    pos = 0
+    while pos + MIN_MATCH <= size:
+        h = _hash(data, pos)
+        cand = head[h]
+        best_len = 0
+        best_off = 0
+        chain = max_chain
+        limit = size - pos
+        while cand >= 0 and pos - cand <= max_offset and chain > 0:
+            if data[cand:cand + MIN_MATCH] == data[pos:pos + MIN_MATCH]:
+                n = MIN_MATCH
+                # Extend the match in chunks first
+                while n + 32 <= limit and data[cand + n:cand + n + 32] == data[pos + n:pos + n + 32]:
+                    n += 32
+                while n < limit and data[cand + n] == data[pos + n]:
+                    n += 1
+                if n > best_len:
+                    best_len = n
+                    best_off = pos - cand
+                    if n == limit:
+                        break
+            cand = prev[cand]
+            chain -= 1
+        prev[pos] = head[h]
+        head[h] = pos
+        if best_len >= MIN_MATCH:
+            _put_block(out, data, lit_start, pos, best_off, best_len)
+            # Index the positions covered by the match
+            end = pos + best_len
+            for p in range(pos + 1, min(end, size - MIN_MATCH + 1)):
+                h = _hash(data, p)
+                prev[p] = head[h]
+                head[h] = p
+            pos = end
+            lit_start = pos
+        else:
+            pos += 1
+    # The last block contains the remaining literals and terminates the stream
+    _put_block(out, data, lit_start, size, 0, 0)
+    return bytes(out)
+
+def lz_decompress(data):
+    """Reference decoder used to validate the compressed output."""
+    out = bytearray()
+    i = 0
+    while True:
+        t = data[i]
+        i += 1
+        lit = t >> 4
+        m = t & 0x0f
+        if lit == 15:
+            while True:
+                b = data[i]
+                i += 1
+                lit += b
+                if b != 255:
+                    break
+        out += data[i:i + lit]
+        i += lit
+        offset = data[i] | (data[i + 1] << 8)
+        i += 2
+        if not offset:
+            if m:
+                raise ValueError('Invalid end of stream')
+            break
+        if m == 15:
+            while True:
+                b = data[i]
+                i += 1
+                m += b
+                if b != 255:
+                    break
+        n = m + MIN_MATCH
+        start = len(out) - offset
+        if start < 0:
+            raise ValueError('Invalid match offset')
+        for k in range(n):
+            out.append(out[start + k])
+    if i != len(data):
+        raise ValueError('Unexpected data after the end of stream')
+    return bytes(out)
+
+def add_bootloader_dependency(header, version):
+    """Make the module info header depend on at least the given bootloader version."""
+    free_offset = None
+    for offset in MODULE_DEPENDENCY_OFFSETS:
+        func, index, ver = struct.unpack_from(MODULE_DEPENDENCY_FORMAT, header, offset)
+        if func == MODULE_FUNCTION_BOOTLOADER and index == 0:
+            struct.pack_into(MODULE_DEPENDENCY_FORMAT, header, offset, func, index, max(ver, version))
+            return
+        if func == MODULE_FUNCTION_NONE and free_offset is None:
+            free_offset = offset
+    if free_offset is None:
+        raise ValueError('No free dependency slot for the bootloader dependency')
+    struct.pack_into(MODULE_DEPENDENCY_FORMAT, header, free_offset, MODULE_FUNCTION_BOOTLOADER, 0, version)
+
+def compress_module(module, window_bits=DEFAULT_WINDOW_BITS, bootloader_dependency=0):
+    if len(module) < MODULE_INFO_SIZE + 2 + 4:
+        raise ValueError('Invalid module size')
+    info = list(struct.unpack_from(MODULE_INFO_FORMAT, module, 0))
+    start_addr, end_addr, mcu, flags = info[0], info[1], info[2], info[3]
+    if end_addr - start_addr + 4 != len(module):
+        raise ValueError('Module size does not match the module info header')
+    if flags & MODULE_INFO_FLAG_COMPRESSED:
+        raise ValueError('Module is already compressed')
+    if zlib.crc32(module[:-4]) != struct.unpack('>L', module[-4:])[0]:
+        raise ValueError('Invalid module CRC')
+    suffix_size = struct.unpack_from('<H', module, len(module) - 4 - 2)[0]
+    if suffix_size > len(module) - MODULE_INFO_SIZE - 4:
+        raise ValueError('Invalid module suffix size')
+    suffix = module[len(module) - 4 - suffix_size:len(module) - 4]
+    data = lz_compress(module, window_bits)
+    if lz_decompress(data) != module:
+        raise RuntimeError('Compressed data verification failed')
+    comp_header = struct.pack(COMPRESSED_MODULE_HEADER_FORMAT, struct.calcsize(COMPRESSED_MODULE_HEADER_FORMAT),
+            COMPRESSION_METHOD_LZ, window_bits, len(module))
+    body = comp_header + data + suffix
+    info[1] = start_addr + MODULE_INFO_SIZE + len(body) # module_end_address
+    info[3] = flags | MODULE_INFO_FLAG_COMPRESSED
+    header = bytearray(struct.pack(MODULE_INFO_FORMAT, *info) + module[struct.calcsize(MODULE_INFO_FORMAT):MODULE_INFO_SIZE])
+    if bootloader_dependency:
+        add_bootloader_dependency(header, bootloader_dependency)
+    output = bytes(header) + body
+    return output + struct.pack('>L', zlib.crc32(output))
+
+def main():
+    parser = argparse.ArgumentParser(description='Compress a Particle module binary using the small-window LZ method')
+    parser.add_argument('input', metavar='INPUT', type=argparse.FileType('rb'), help='Input module bin file')
+    parser.add_argument('output', metavar='OUTPUT', type=argparse.FileType('wb'), help='Output compressed module bin file')
+    parser.add_argument('--window-bits', default=DEFAULT_WINDOW_BITS, type=int,
+            choices=range(MIN_WINDOW_BITS, MAX_WINDOW_BITS + 1), help='Base two logarithm of the window size')
+    parser.add_argument('--bootloader-dependency', default=0, type=int,
+            help='Minimum bootloader version that supports the LZ method')
+    parser.add_argument('--raw', action='store_true', help='Compress the input file as is, without a module header')
+    args = parser.parse_args()
+
+    data = args.input.read()
+    if args.raw:
+        output = lz_compress(data, args.window_bits)
+    else:
+        output = compress_module(data, args.window_bits, args.bootloader_dependency)
+    args.output.write(output)
+    print('{}: {} -> {} bytes ({:.1f}%)'.format(args.output.name, len(data), len(output),
+            100.0 * len(output) / max(len(data), 1)), file=sys.stderr)
+
+if __name__ == '__main__':
+    main()
@@ -19,6 +19,24 @@ else
 CFLAGS += -DRELEASE_BUILD
 endif
 
+ifeq ("$(TRACE)","y")
+CFLAGS += -DTRACE_ENABLED=1
+endif
+
+ifeq ("$(HEAP_TRACKING)","y")
+CFLAGS += -DHEAP_TRACKING_ENABLED=1
+endif
+
+# Delta encoding builds on the compact encoding of the vitals
+ifeq ("$(VITALS_DELTA)","y")
+VITALS_COMPACT = y
+CFLAGS += -DVITALS_DELTA_ENCODING_ENABLED=1
+endif
+
+ifeq ("$(VITALS_COMPACT)","y")
+CFLAGS += -DVITALS_COMPACT_ENCODING_ENABLED=1
+endif
+
 ifdef SPARK_TEST_DRIVER
 CFLAGS += -DSPARK_TEST_DRIVER=$(SPARK_TEST_DRIVER)
 endif
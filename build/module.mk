@@ -95,6 +95,7 @@ all: prebuild $(MAKE_DEPENDENCIES) $(TARGET) postbuild
 
 elf: $(TARGET_BASE).elf
 bin: $(TARGET_BASE).bin
+compressed-bin: $(TARGET_BASE)-compressed.bin
 hex: $(TARGET_BASE).hex
 lst: $(TARGET_BASE).lst
 exe: $(TARGET_BASE)$(EXECUTABLE_EXTENSION)
@@ -178,6 +179,12 @@ size: $(TARGET_BASE).elf
 	@cp $< $@
 	$(DFUSUFFIX) -v $(subst 0x,,$(USBD_VID_PARTICLE)) -p $(subst 0x,,$(USBD_PID_DFU)) -a $@
 
+# Create a module compressed with the small-window LZ method from a bin file
+%-compressed.bin : %.bin
+	$(call echo,'Invoking: Compress Module')
+	$(VERBOSE)$(COMPRESS_MODULE) --bootloader-dependency $(LZ_COMPRESSION_BOOTLOADER_VERSION) $< $@
+	$(call echo,)
+
 # generated by running xxd -p crc_block
 CRC_LEN = 4
 CRC_BLOCK_LEN = 38
@@ -307,7 +314,7 @@ clean: clean_deps
 	$(VERBOSE)$(RMDIR) $(BUILD_PATH)
 	$(call,echo,)
 
-.PHONY: all prebuild postbuild none elf bin hex size program-dfu program-cloud program-serial
+.PHONY: all prebuild postbuild none elf bin compressed-bin hex size program-dfu program-cloud program-serial
 .SECONDARY:
 
 # Disable implicit builtin rules
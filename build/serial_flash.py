@@ -0,0 +1,206 @@
+#!/usr/bin/env python3
+
+# Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+#
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation, either
+# version 3 of the License, or (at your option) any later version.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public
+# License along with this library; if not, see <http://www.gnu.org/licenses/>.
+#
+
+# Flashes a firmware binary to a device in listening mode using the windowed serial flashing
+# protocol (see system/inc/system_serial_flash.h).
+#
+# The script can be tested without hardware by running the virtual device behind a pseudo-terminal:
+#
+#   socat PTY,link=/tmp/ttyV0,raw,echo=0 EXEC:"./device --device_id ...",pty,raw,echo=0
+#   build/serial_flash.py /tmp/ttyV0 firmware.bin
+#
+# Requires pyserial.
+
+import argparse
+import struct
+import sys
+import time
+import zlib
+
+import serial
+
+SYNC = 0x16
+
+START = 0x01
+DATA = 0x02
+END = 0x03
+ABORT = 0x04
+READY = 0x81
+ACK = 0x82
+RESULT = 0x83
+
+HEADER_FORMAT = '<BBHL'
+HEADER_SIZE = struct.calcsize(HEADER_FORMAT)
+START_FORMAT = '<LHH'
+
+FRAME_TIMEOUT = 1.0
+MAX_RETRIES = 10
+
+class Sender:
+    def __init__(self, port, verbose=False):
+        self.port = port
+        self.verbose = verbose
+        self.rx = bytearray()
+
+    def send_frame(self, type, seq=0, payload=b''):
+        h = struct.pack(HEADER_FORMAT, type, 0, len(payload), seq)
+        crc = zlib.crc32(h + payload) & 0xffffffff
+        self.port.write(bytes([SYNC]) + h + payload + struct.pack('<L', crc))
+
+    def read_frame(self, timeout):
+        # Returns a (type, seq, payload) tuple, or None if no valid frame was received in time.
+        # Anything outside of a frame, such as log output, is skipped
+        deadline = time.monotonic() + timeout
+        while True:
+            while True:
+                i = self.rx.find(bytes([SYNC]))
+                if i < 0:
+                    self.rx.clear()
+                    break
+                del self.rx[:i]
+                if len(self.rx) < 1 + HEADER_SIZE:
+                    break
+                type, _, size, seq = struct.unpack_from(HEADER_FORMAT, self.rx, 1)
+                end = 1 + HEADER_SIZE + size + 4
+                if size > 8:
+                    del self.rx[0] # Not a device frame
+                    continue
+                if len(self.rx) < end:
+                    break
+                crc, = struct.unpack_from('<L', self.rx, end - 4)
+                if zlib.crc32(bytes(self.rx[1:end - 4])) & 0xffffffff != crc:
+                    del self.rx[0]
+                    continue
+                payload = bytes(self.rx[1 + HEADER_SIZE:end - 4])
+                del self.rx[:end]
+                return type, seq, payload
+            t = deadline - time.monotonic()
+            if t <= 0:
+                return None
+            self.port.timeout = min(t, 0.05)
+            d = self.port.read(max(1, self.port.in_waiting))
+            self.rx += d
+
+    def start(self, file_size, frame_size, window):
+        for _ in range(MAX_RETRIES):
+            self.send_frame(START, 0, struct.pack(START_FORMAT, file_size, frame_size, window))
+            deadline = time.monotonic() + FRAME_TIMEOUT
+            while time.monotonic() < deadline:
+                f = self.read_frame(deadline - time.monotonic())
+                if not f:
+                    break
+                type, _, payload = f
+                if type == READY:
+                    _, frame_size, window = struct.unpack(START_FORMAT, payload)
+                    return frame_size, window
+                if type == RESULT:
+                    raise RuntimeError('Device error: {}'.format(struct.unpack('<l', payload)[0]))
+        raise RuntimeError('Device is not responding')
+
+    def send(self, data, frame_size, window):
+        frame_size, window = self.start(len(data), frame_size, window)
+        if self.verbose:
+            print('Frame size: {}, window: {}'.format(frame_size, window), file=sys.stderr)
+        count = (len(data) + frame_size - 1) // frame_size
+        base = 0 # First unacknowledged frame
+        next = 0 # Next frame to send for the first time
+        acked = set() # Frames received by the device out of order
+        retries = 0
+        while base < count:
+            # Fill the window
+            while next < count and next < base + window:
+                self.send_frame(DATA, next, data[next * frame_size:(next + 1) * frame_size])
+                next += 1
+            f = self.read_frame(FRAME_TIMEOUT)
+            if not f:
+                # Retransmit all frames in flight that haven't been acknowledged
+                retries += 1
+                if retries > MAX_RETRIES:
+                    raise RuntimeError('Device is not responding')
+                for i in range(base, next):
+                    if i not in acked:
+                        self.send_frame(DATA, i, data[i * frame_size:(i + 1) * frame_size])
+                continue
+            type, seq, payload = f
+            if type == RESULT:
+                raise RuntimeError('Device error: {}'.format(struct.unpack('<l', payload)[0]))
+            if type != ACK or seq < base:
+                continue
+            retries = 0
+            mask, = struct.unpack('<L', payload)
+            base = seq
+            acked = {seq + 1 + i for i in range(32) if mask & (1 << i)}
+            if acked:
+                # Frames preceding the ones received out of order are likely lost, resend them
+                # selectively
+                last = max(acked)
+                for i in range(base, min(last, next)):
+                    if i not in acked:
+                        self.send_frame(DATA, i, data[i * frame_size:(i + 1) * frame_size])
+            if self.verbose:
+                print('\r{}/{} frames'.format(base, count), end='', file=sys.stderr)
+        if self.verbose:
+            print(file=sys.stderr)
+        return self.finish()
+
+    def finish(self):
+        for _ in range(MAX_RETRIES):
+            self.send_frame(END)
+            # Validating the update can take a while
+            f = self.read_frame(FRAME_TIMEOUT * 5)
+            while f and f[0] != RESULT:
+                f = self.read_frame(FRAME_TIMEOUT * 5)
+            if f:
+                return struct.unpack('<l', f[2])[0]
+        raise RuntimeError('Device is not responding')
+
+    def abort(self):
+        self.send_frame(ABORT)
+
+def main():
+    parser = argparse.ArgumentParser(description='Flash a firmware binary using the windowed serial protocol')
+    parser.add_argument('port', help='serial port')
+    parser.add_argument('file', help='firmware binary')
+    parser.add_argument('--baud', type=int, default=115200, help='baud rate')
+    parser.add_argument('--frame_size', type=int, default=1024, help='maximum frame payload size')
+    parser.add_argument('--window', type=int, default=16, help='maximum number of frames in flight')
+    parser.add_argument('-v', '--verbose', action='store_true', help='print progress')
+    args = parser.parse_args()
+
+    with open(args.file, 'rb') as f:
+        data = f.read()
+    port = serial.Serial(args.port, args.baud)
+    sender = Sender(port, args.verbose)
+    start = time.monotonic()
+    try:
+        result = sender.send(data, args.frame_size, args.window)
+    except KeyboardInterrupt:
+        sender.abort()
+        raise
+    except RuntimeError as e:
+        sender.abort()
+        print('Error: {}'.format(e), file=sys.stderr)
+        sys.exit(1)
+    if result != 0:
+        print('Update failed: {}'.format(result), file=sys.stderr)
+        sys.exit(1)
+    t = time.monotonic() - start
+    print('Sent {} bytes in {:.1f}s ({:.1f} KB/s)'.format(len(data), t, len(data) / t / 1024))
+
+if __name__ == '__main__':
+    main()
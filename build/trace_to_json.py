@@ -0,0 +1,113 @@
+#!/usr/bin/env python3
+
+# Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+#
+# This library is free software; you can redistribute it and/or
+# modify it under the terms of the GNU Lesser General Public
+# License as published by the Free Software Foundation, either
+# version 3 of the License, or (at your option) any later version.
+#
+# This library is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+# Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public
+# License along with this library; if not, see <http://www.gnu.org/licenses/>.
+#
+
+# Converts trace data recorded by a device into the Chrome trace event format, which can be opened
+# in Perfetto (https://ui.perfetto.dev) or chrome://tracing.
+#
+# The input is a sequence of chunks produced by trace_format() (see services/inc/trace.h), e.g.
+# the replies to CTRL_REQUEST_GET_TRACE_DATA concatenated together, or the file saved by the
+# virtual device when it is started with --trace_file.
+
+import argparse
+import json
+import struct
+import sys
+
+FORMAT_VERSION = 1
+HEADER_FORMAT = '<BBHLL'
+EVENT_HEADER_FORMAT = '<LLBB'
+
+EVENT_BEGIN = 1
+EVENT_END = 2
+EVENT_INSTANT = 3
+
+PHASES = {
+    EVENT_BEGIN: 'B',
+    EVENT_END: 'E',
+    EVENT_INSTANT: 'i'
+}
+
+def parse_chunks(data):
+    events = {} # Events by index
+    dropped = 0
+    expected = None
+    offs = 0
+    while offs < len(data):
+        ver, _, count, first, _ = struct.unpack_from(HEADER_FORMAT, data, offs)
+        if ver != FORMAT_VERSION:
+            raise RuntimeError('Unsupported format version: {}'.format(ver))
+        offs += struct.calcsize(HEADER_FORMAT)
+        if expected is not None and first > expected:
+            dropped += first - expected
+        for i in range(count):
+            time, thread, type, name_size = struct.unpack_from(EVENT_HEADER_FORMAT, data, offs)
+            offs += struct.calcsize(EVENT_HEADER_FORMAT)
+            name = data[offs:offs + name_size].decode('utf-8', errors='replace')
+            offs += name_size
+            events[first + i] = (time, thread, type, name)
+        expected = first + count
+    return [events[i] for i in sorted(events)], dropped
+
+def to_trace_events(events, pid):
+    out = []
+    # Timestamps are 32-bit microsecond counters that wrap around every ~71 minutes
+    epoch = 0
+    prev = None
+    for time, thread, type, name in events:
+        if prev is not None and time < prev and prev - time > 0x80000000:
+            epoch += 0x100000000
+        prev = time
+        phase = PHASES.get(type)
+        if phase is None:
+            continue
+        e = {
+            'name': name,
+            'ph': phase,
+            'ts': epoch + time,
+            'pid': pid,
+            'tid': thread
+        }
+        if phase == 'i':
+            e['s'] = 't' # Thread-scoped instant event
+        out.append(e)
+    return out
+
+def main():
+    parser = argparse.ArgumentParser(description='Convert device trace data to the Chrome trace event format')
+    parser.add_argument('input', help='binary trace data')
+    parser.add_argument('output', nargs='?', help='output JSON file (default: stdout)')
+    parser.add_argument('--pid', type=int, default=1, help='process ID to assign to the events')
+    args = parser.parse_args()
+
+    with open(args.input, 'rb') as f:
+        data = f.read()
+    events, dropped = parse_chunks(data)
+    if dropped:
+        print('Warning: {} events were overwritten before they could be read'.format(dropped), file=sys.stderr)
+    trace = {
+        'traceEvents': to_trace_events(events, args.pid),
+        'displayTimeUnit': 'ms'
+    }
+    if args.output:
+        with open(args.output, 'w') as f:
+            json.dump(trace, f)
+    else:
+        json.dump(trace, sys.stdout)
+
+if __name__ == '__main__':
+    main()
@@ -181,6 +181,8 @@ private:
 	void set_debug_enabled(bool enabled = true) override {
 		debug_enabled = enabled;
 	}
+
+	system_tick_t max_receive_wait() override;
 };
 
 
@@ -257,6 +257,17 @@ struct MessageChannel : public Channel
 	 * Enable/disable debugging.
 	 */
 	virtual void set_debug_enabled(bool enabled) = 0;
+
+	/**
+	 * Get the maximum time in milliseconds the caller can wait for new data before the channel
+	 * needs to be serviced again, e.g. to retransmit an unacknowledged message.
+	 *
+	 * The default implementation returns 0, meaning the channel needs to be polled continuously.
+	 */
+	virtual system_tick_t max_receive_wait()
+	{
+		return 0;
+	}
 };
 
 class AbstractMessageChannel : public MessageChannel
@@ -25,6 +25,11 @@ namespace protocol
 
 const size_t DEFAULT_OTA_CHUNK_SIZE = 512;
 
+/**
+ * Maximum number of messages processed by a single iteration of the event loop.
+ */
+const size_t MAX_EVENT_LOOP_MESSAGES = 16;
+
 /**
  * Tie ALL the bits together.
  */
@@ -296,6 +301,18 @@ protected:
 	 */
 	ProtocolError handle_received_message(Message& message, CoAPMessageType::Enum& message_type);
 
+	/**
+	 * Processes up to `max_count` received messages. Runs the background processing if there are
+	 * no more messages to receive.
+	 */
+	ProtocolError process_messages(size_t max_count, CoAPMessageType::Enum& message_type);
+
+	/**
+	 * Waits until new data is received, the timeout expires or the channel needs to be serviced,
+	 * whichever comes first.
+	 */
+	void wait_receive(system_tick_t timeout);
+
 	/**
 	 * Sends an empty acknoweldgement for the given message.
 	 */
@@ -475,11 +492,13 @@ public:
 
 	/**
 	 * no-arg version of event loop for those callers that don't care about the message.
+	 *
+	 * Processes all pending messages, up to MAX_EVENT_LOOP_MESSAGES per call.
 	 */
 	bool event_loop()
 	{
 		CoAPMessageType::Enum message;
-		return !event_loop(message);
+		return !process_messages(MAX_EVENT_LOOP_MESSAGES, message);
 	}
 
 	/**
@@ -139,6 +139,16 @@ struct SparkDescriptor
      * @return true on success or false on failure.
      */
     bool (*append_app_info)(appender_fn appender, void* append, void* reserved);
+
+    /**
+     * Optional callback - may be null.
+     *
+     * Called when the server acknowledges a message containing the metrics serialized with
+     * `append_metrics`.
+     *
+     * @param reserved Reserved argument.
+     */
+    void (*metrics_acknowledged)(void* reserved);
 };
 
-PARTICLE_STATIC_ASSERT(SparkDescriptor_size, sizeof(SparkDescriptor)==64 || sizeof(void*)!=4);
+PARTICLE_STATIC_ASSERT(SparkDescriptor_size, sizeof(SparkDescriptor)==68 || sizeof(void*)!=4);
@@ -143,9 +143,21 @@ struct SparkCallbacks
             void* context);
 
     // size == 60
+
+    /**
+     * Wait until data is available for reading.
+     *
+     * @param timeout Maximum time to wait in milliseconds.
+     * @param handle The transport context.
+     * @return 1 if data is available, 0 if the timeout has expired, or a negative result code in
+     *         case of an error.
+     */
+    int (*wait_receive)(unsigned timeout, void* handle);
+
+    // size == 64
 };
 
-PARTICLE_STATIC_ASSERT(SparkCallbacks_size, sizeof(SparkCallbacks)==(sizeof(void*)*15));
+PARTICLE_STATIC_ASSERT(SparkCallbacks_size, sizeof(SparkCallbacks)==(sizeof(void*)*16));
 
 /**
  * Application-supplied callbacks. (Deliberately distinct from the system-supplied
@@ -97,6 +97,17 @@ void CoAPMessageStore::process(system_tick_t time, Channel& channel)
 	}
 }
 
+system_tick_t CoAPMessageStore::next_timeout(system_tick_t time) const
+{
+	system_tick_t t = std::numeric_limits<system_tick_t>::max();
+	for (const CoAPMessage* msg = head; msg; msg = msg->get_next())
+	{
+		if (time_has_passed(time, msg->get_timeout()))
+			return 0;
+		t = std::min(t, msg->get_timeout() - time);
+	}
+	return t;
+}
 
 /**
  * Registers that this message has been sent from the application.
@@ -142,7 +153,12 @@ ProtocolError CoAPMessageStore::receive(Message& msg, Channel& channel, system_t
 		message_id_t id = msg.get_id();
 		CoAPMessage* coap_msg = from_id(id);
 		if (coap_msg) {
-			g_coapRoundTripMSec = time - coap_msg->get_send_time();
+			const system_tick_t roundTrip = time - coap_msg->get_send_time();
+			g_coapRoundTripMSec = roundTrip;
+			g_coapRoundTripHistogram.record(roundTrip);
+			if (Messages::decodeType(coap_msg->get_data(), coap_msg->get_data_length()) == CoAPMessageType::EVENT) {
+				g_publishAckTime.record(roundTrip);
+			}
 		}
 		if (msgtype==CoAPType::RESET) {
 			LOG(WARN, "Received RST message; discarding session");
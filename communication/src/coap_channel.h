@@ -25,6 +25,7 @@
 #include "service_debug.h"
 
 #include "communication_diagnostic.h"
+#include <algorithm>
 #include <limits>
 
 namespace particle
@@ -234,6 +235,7 @@ public:
 			}
 			else {
 				g_retransmittedMessageCounter++;
+				g_recentRetransmittedMessageCounter.add(1, now);
 			}
 			transmit_count++;
 			return transmit_count <= MAX_RETRANSMIT+1;
@@ -450,6 +452,12 @@ public:
 	 */
 	void process(system_tick_t time, Channel& channel);
 
+	/**
+	 * Returns the number of milliseconds until a message needs to be resent or timed out, or the
+	 * maximum value of system_tick_t if there are no such messages.
+	 */
+	system_tick_t next_timeout(system_tick_t time) const;
+
 	/**
 	 * Sends the given CoAPMessage to the channel.
 	 */
@@ -641,6 +649,12 @@ public:
 		return client.has_messages();
 	}
 
+	system_tick_t max_receive_wait() override
+	{
+		const system_tick_t now = millis();
+		return std::min(channel::max_receive_wait(), std::min(client.next_timeout(now), server.next_timeout(now)));
+	}
+
 	/**
 	 * Pulls messages from the channel and stores it in a message store for
 	 * reliable receipt and retransmission.
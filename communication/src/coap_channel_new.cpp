@@ -37,6 +37,7 @@ LOG_SOURCE_CATEGORY("system.coap")
 
 #include "random.h"
 #include "scope_guard.h"
+#include "trace.h"
 #include "check.h"
 
 #define CHECK_PROTOCOL(_expr) \
@@ -867,6 +868,7 @@ int CoapChannel::handleRst(const Message& msgBuf) {
 }
 
 int CoapChannel::run() {
+    TRACE_SCOPE("coap:run");
     // TODO: ACK timeouts are handled by the old protocol implementation. As of now, the server always
     // replies with piggybacked responses so we don't need to handle separate response timeouts either
     return 0;
@@ -5,3 +5,6 @@ extern particle::SimpleUnsignedIntegerDiagnosticData g_unacknowledgedMessageCoun
 extern particle::SimpleUnsignedIntegerDiagnosticData g_trasmittedMessageCounter;
 extern particle::SimpleUnsignedIntegerDiagnosticData g_retransmittedMessageCounter;
 extern particle::SimpleUnsignedIntegerDiagnosticData g_coapRoundTripMSec;
+extern particle::HistogramDiagnosticData<> g_coapRoundTripHistogram;
+extern particle::HistogramDiagnosticData<> g_publishAckTime;
+extern particle::WindowedCounterDiagnosticData<> g_recentRetransmittedMessageCounter;
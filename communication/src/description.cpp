@@ -29,6 +29,14 @@
 #include <algorithm>
 #include "enumclass.h"
 
+/**
+ * The vitals are sent in the fixed-size binary format by default. Build with `VITALS_COMPACT=y` to
+ * use the compact format, which the cloud needs to support.
+ */
+#ifndef VITALS_COMPACT_ENCODING_ENABLED
+#define VITALS_COMPACT_ENCODING_ENABLED 0
+#endif
+
 #define CHECK_PROTOCOL(_expr) \
         do { \
             const auto _r = _expr; \
@@ -467,7 +475,11 @@ ProtocolError Description::serialize(Appender* appender, int descFlags) {
         // 16-bit Describe type
         appender->append((char)DescriptionType::DESCRIBE_METRICS);
         appender->append((char)0);
+#if VITALS_COMPACT_ENCODING_ENABLED
+        const int flags = 0x02; // Use compact binary encoding (SYSTEM_FORMAT_DIAG_FLAG_COMPACT)
+#else
         const int flags = 1; // Use binary encoding
+#endif
         const int page = 0; // Page number (unused)
         const bool ok = descriptor.append_metrics(Appender::callback, appender, flags, page, nullptr /* reserved */);
         if (!ok) {
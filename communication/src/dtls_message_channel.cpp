@@ -47,6 +47,7 @@ void mbedtls_ssl_update_out_pointers(mbedtls_ssl_context *ssl, mbedtls_ssl_trans
 #include "timer_hal.h"
 #include <stdio.h>
 #include <string.h>
+#include <limits>
 #include "dtls_session_persist.h"
 #include "coap_channel.h"
 #include "coap_channel_new.h"
@@ -595,6 +596,16 @@ AppStateDescriptor DTLSMessageChannel::cached_app_state_descriptor() const
 	return sessionPersist.app_state_descriptor();
 }
 
+system_tick_t DTLSMessageChannel::max_receive_wait()
+{
+	// A datagram may contain more than one record, in which case the remaining records are buffered
+	// by mbedTLS and the socket will not report them as readable
+	if (mbedtls_ssl_check_pending(&ssl_context)) {
+		return 0;
+	}
+	return std::numeric_limits<system_tick_t>::max();
+}
+
 
 }}
 
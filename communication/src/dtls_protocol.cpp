@@ -5,6 +5,8 @@
 #include "eckeygen.h"
 #include "mbedtls_util.h"
 
+#include <algorithm>
+
 namespace particle { namespace protocol {
 
 void DTLSProtocol::init(const char *id,
@@ -78,6 +80,16 @@ int DTLSProtocol::wait_confirmable(uint32_t timeout)
 			LOG(WARN, "error receiving acknowledgements: %d", err);
 			break;
 		}
+		if (message == CoAPMessageType::NONE)
+		{
+			const system_tick_t elapsed = millis() - start;
+			system_tick_t wait = (elapsed < 1000) ? 1000 - elapsed : 0;
+			if (channel.has_unacknowledged_requests() && elapsed < timeout)
+			{
+				wait = std::max<system_tick_t>(wait, timeout - elapsed);
+			}
+			wait_receive(wait);
+		}
 	}
 	LOG(INFO, "All Confirmed messages sent: client(%s) server(%s)",
 		channel.client_messages().has_messages() ? "no" : "yes",
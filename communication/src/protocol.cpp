@@ -34,6 +34,10 @@ LOG_SOURCE_CATEGORY("comm.protocol")
 #include "coap_channel_new.h"
 #include "coap_message_decoder.h"
 #include "coap_message_encoder.h"
+#include "trace.h"
+#include "heap_tracking.h"
+
+#include <algorithm>
 
 namespace particle { namespace protocol {
 
@@ -616,7 +620,7 @@ ProtocolError Protocol::event_loop(CoAPMessageType::Enum message_type,
 {
 	system_tick_t start = callbacks.millis();
 	LOG(INFO,"waiting %d seconds for message type=%d", timeout/1000, message_type);
-	do
+	for (;;)
 	{
 		CoAPMessageType::Enum msgtype;
 		ProtocolError error = event_loop(msgtype);
@@ -626,9 +630,12 @@ ProtocolError Protocol::event_loop(CoAPMessageType::Enum message_type,
 		}
 		if (msgtype == message_type)
 			return NO_ERROR;
-		// todo - ideally need a delay here
+		const system_tick_t elapsed = callbacks.millis() - start;
+		if (elapsed >= timeout)
+			break;
+		if (msgtype == CoAPMessageType::NONE)
+			wait_receive(timeout - elapsed);
 	}
-	while ((callbacks.millis() - start) < timeout);
 	return MESSAGE_TIMEOUT;
 }
 
@@ -638,23 +645,38 @@ ProtocolError Protocol::event_loop(CoAPMessageType::Enum message_type,
  */
 ProtocolError Protocol::event_loop(CoAPMessageType::Enum& message_type)
 {
+	return process_messages(1, message_type);
+}
+
+ProtocolError Protocol::process_messages(size_t max_count, CoAPMessageType::Enum& message_type)
+{
+	HEAP_TAG_SCOPE(HEAP_TAG_PROTOCOL);
 	// Process expired completion handlers
 	const system_tick_t t = callbacks.millis();
 	ack_handlers.update(t - last_ack_handlers_update);
 	last_ack_handlers_update = t;
 
-	Message message;
 	message_type = CoAPMessageType::NONE;
-	ProtocolError error = channel.receive(message);
-	if (!error)
+	ProtocolError error = NO_ERROR;
+	for (size_t count = 0;;)
 	{
-		if (message.length())
+		Message message;
+		error = channel.receive(message);
+		if (error)
 		{
-			error = handle_received_message(message, message_type);
+			break;
 		}
-		else
+		if (!message.length())
 		{
 			error = event_loop_idle();
+			break;
+		}
+		TRACE_BEGIN("proto:msg");
+		error = handle_received_message(message, message_type);
+		TRACE_END("proto:msg");
+		if (error || ++count >= max_count)
+		{
+			break;
 		}
 	}
 
@@ -672,6 +694,20 @@ ProtocolError Protocol::event_loop(CoAPMessageType::Enum& message_type)
 	return error;
 }
 
+void Protocol::wait_receive(system_tick_t timeout)
+{
+	if (!callbacks.wait_receive)
+	{
+		return;
+	}
+	timeout = std::min(timeout, channel.max_receive_wait());
+	if (timeout > 0)
+	{
+		// Errors are reported by the subsequent receive operation
+		callbacks.wait_receive(timeout, callbacks.transport_context);
+	}
+}
+
 ProtocolError Protocol::post_description(int desc_flags, bool force)
 {
 	if (!force && descriptor.app_state_selector_info) {
@@ -776,6 +812,9 @@ ProtocolError Protocol::handle_app_state_reply(const Message& msg, bool* handled
 					SparkAppStateUpdate::COMPUTE_AND_PERSIST, 0, nullptr);
 			channel.command(Channel::LOAD_SESSION);
 		}
+		if ((desc_flags & DescriptionType::DESCRIBE_METRICS) && descriptor.metrics_acknowledged) {
+			descriptor.metrics_acknowledged(nullptr);
+		}
 	}
 	return ProtocolError::NO_ERROR;
 }
@@ -181,6 +181,15 @@ module_scheme_t module_scheme(const module_info_t* mi);
  */
 uint8_t module_info_matches_platform(const module_info_t* mi);
 
+/**
+ * Compression method.
+ */
+typedef enum module_compression_method {
+    MODULE_COMPRESSION_METHOD_DEFLATE = 0, ///< Raw Deflate.
+    MODULE_COMPRESSION_METHOD_LZ = 1 ///< Small-window LZ (see `hal/shared/lz_decompress.h`). Requires a bootloader
+                                     ///< of version `LZ_COMPRESSION_BOOTLOADER_VERSION` or newer.
+} module_compression_method;
+
 /**
  * Compressed module header.
  *
@@ -193,16 +202,14 @@ typedef struct compressed_module_header {
      */
     uint16_t size;
     /**
-     * Compression method.
-     *
-     * As of now, the only supported method is raw Deflate (0).
+     * Compression method (see `module_compression_method`).
      */
     uint8_t method;
     /**
      * Base two logarithm of the window size used when compressing this module.
      *
-     * For raw Deflate the valid range is [8, 15]. The value of 0 corresponds to the default window
-     * size of 15 bits.
+     * For both methods the valid range is [8, 15]. The value of 0 corresponds to the default window
+     * size of 15 bits for raw Deflate and 12 bits for LZ.
      */
     uint8_t window_bits;
     /**
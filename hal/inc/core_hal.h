@@ -58,6 +58,12 @@ typedef enum
 
 /* Exported constants --------------------------------------------------------*/
 
+/*
+ * The bootloader stores the current internal flash write generation in this register on every
+ * boot. The lower 16 bits contain the generation and the upper 16 bits contain its inverse
+ */
+#define BKP_DR_FLASH_WRITE_GENERATION BKP_DR_08
+
 //Following is normally defined via "CFLAGS += -DDFU_BUILD_ENABLE" in makefile
 #ifndef DFU_BUILD_ENABLE
 #define DFU_BUILD_ENABLE
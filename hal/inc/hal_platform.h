@@ -360,6 +360,11 @@
 #define HAL_PLATFORM_PACKET_BUFFER_FLOW_CONTROL_THRESHOLD (0)
 #endif // HAL_PLATFORM_PACKET_BUFFER_FLOW_CONTROL_THRESHOLD
 
+// Number of buffers in the lwIP pbuf pool that count towards its pressure threshold (0 means the entire pool)
+#ifndef HAL_PLATFORM_PBUF_POOL_PRESSURE_LIMIT
+#define HAL_PLATFORM_PBUF_POOL_PRESSURE_LIMIT (0)
+#endif // HAL_PLATFORM_PBUF_POOL_PRESSURE_LIMIT
+
 #ifndef HAL_PLATFORM_MUXER_MAY_NEED_DELAY_IN_TX
 #define HAL_PLATFORM_MUXER_MAY_NEED_DELAY_IN_TX (0)
 #endif //HAL_PLATFORM_MUXER_MAY_NEED_DELAY_IN_TX
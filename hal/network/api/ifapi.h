@@ -267,6 +267,12 @@ typedef enum if_wiznet_driver_specific {
     IF_WIZNET_DRIVER_SPECIFIC_PIN_REMAP = 1,
 } if_wiznet_driver_specific;
 
+typedef enum if_mem_pressure_t {
+    IF_MEM_PRESSURE_NONE     = 0,
+    IF_MEM_PRESSURE_HIGH     = 1,
+    IF_MEM_PRESSURE_CRITICAL = 2
+} if_mem_pressure_t;
+
 typedef struct if_wiznet_pin_remap {
     if_req_driver_specific base;
     uint16_t cs_pin;
@@ -329,6 +335,9 @@ int if_get_power_state(if_t iface, if_power_state_t* state);
 
 int if_get_profile(if_t iface, char* profile, size_t length);
 
+/* Pressure on the packet buffers shared by all interfaces */
+if_mem_pressure_t if_get_mem_pressure(void);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -40,6 +40,7 @@ LOG_SOURCE_CATEGORY("net.pppncp")
 #include "concurrent_hal.h"
 #include "platform_config.h"
 #include "memp_hook.h"
+#include "heap_tracking.h"
 
 using namespace particle::net;
 
@@ -163,6 +164,7 @@ void PppNcpNetif::setExpectedInternalState(NetifEvent ev) {
 }
 
 void PppNcpNetif::loop(void* arg) {
+    const int prevHeapTag = heap_tag_enter(HEAP_TAG_NCP, nullptr);
     PppNcpNetif* self = static_cast<PppNcpNetif*>(arg);
     unsigned int timeout = 100;
     while(!self->exit_) {
@@ -214,6 +216,7 @@ void PppNcpNetif::loop(void* arg) {
     self->downImpl();
     self->celMan_->ncpClient()->off();
 
+    heap_tag_leave(prevHeapTag, nullptr);
     os_thread_exit(nullptr);
 }
 
@@ -471,7 +474,7 @@ int PppNcpNetif::ncpDataHandlerCb(int id, const uint8_t* data, size_t size, void
 
 void PppNcpNetif::mempEventHandler(memp_t type, unsigned available, unsigned size, void* ctx) {
     PppNcpNetif* self = static_cast<PppNcpNetif*>(ctx);
-    if (available > HAL_PLATFORM_PACKET_BUFFER_FLOW_CONTROL_THRESHOLD) {
+    if (lwip_memp_get_pressure_for(type, available) != LWIP_MEMP_PRESSURE_CRITICAL) {
         self->celMan_->ncpClient()->dataChannelFlowControl(false);
     }
 }
@@ -45,6 +45,7 @@ LOG_SOURCE_CATEGORY("net.esp32ncp")
 #include "check.h"
 #include <lwip/stats.h>
 #include "memp_hook.h"
+#include "heap_tracking.h"
 #include "ncp.h"
 
 using namespace particle::net;
@@ -174,6 +175,7 @@ void Esp32NcpNetif::setExpectedInternalState(NetifEvent ev) {
 }
 
 void Esp32NcpNetif::loop(void* arg) {
+    const int prevHeapTag = heap_tag_enter(HEAP_TAG_NCP, nullptr);
     Esp32NcpNetif* self = static_cast<Esp32NcpNetif*>(arg);
     unsigned int timeout = 100;
 #if !HAL_PLATFORM_WIFI_SCAN_ONLY
@@ -223,6 +225,7 @@ void Esp32NcpNetif::loop(void* arg) {
     self->downImpl();
     self->wifiMan_->ncpClient()->off();
 
+    heap_tag_leave(prevHeapTag, nullptr);
     os_thread_exit(nullptr);
 }
 
@@ -426,9 +429,7 @@ int Esp32NcpNetif::ncpDataHandlerCb(int id, const uint8_t* data, size_t size, vo
         }
     }
 
-    int poolAvail = MEMP_STATS_GET(avail, MEMP_PBUF_POOL) - MEMP_STATS_GET(used, MEMP_PBUF_POOL);
-
-    if (!p || err == ERR_MEM || poolAvail <= HAL_PLATFORM_PACKET_BUFFER_FLOW_CONTROL_THRESHOLD) {
+    if (!p || err == ERR_MEM || lwip_memp_get_pressure(MEMP_PBUF_POOL) == LWIP_MEMP_PRESSURE_CRITICAL) {
         self->wifiMan_->ncpClient()->dataChannelFlowControl(true);
 #ifdef DEBUG_BUILD
         if (!p || err == ERR_MEM) {
@@ -502,7 +503,7 @@ void Esp32NcpNetif::netifEventHandler(netif_nsc_reason_t reason, const netif_ext
 
 void Esp32NcpNetif::mempEventHandler(memp_t type, unsigned available, unsigned size, void* ctx) {
     Esp32NcpNetif* self = static_cast<Esp32NcpNetif*>(ctx);
-    if (available > HAL_PLATFORM_PACKET_BUFFER_FLOW_CONTROL_THRESHOLD) {
+    if (lwip_memp_get_pressure_for(type, available) != LWIP_MEMP_PRESSURE_CRITICAL) {
         self->wifiMan_->ncpClient()->dataChannelFlowControl(false);
     }
 }
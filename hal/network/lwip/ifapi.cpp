@@ -35,6 +35,8 @@ extern "C" {
 #include "resolvapi.h"
 #include "basenetif.h"
 #include "check.h"
+#include "heap_tracking.h"
+#include "memp_hook.h"
 
 #include "wiznet/wiznetif_config.h"
 
@@ -333,9 +335,13 @@ void netif_ext_callback_handler(struct netif* netif, netif_nsc_reason_t reason,
 int if_init(void) {
     tcpip_init([](void* arg) {
         LOG(TRACE, "LwIP started");
+        // Called in the context of the TCP/IP thread, which never leaves the scope
+        heap_tag_enter(HEAP_TAG_NETWORK, nullptr);
         srand(HAL_RNG_GetRandomNumber());
     }, /* &sem */ nullptr);
 
+    lwip_memp_pressure_init();
+
     LwipTcpIpCoreLock lk;
 
     NETIF_DECLARE_EXT_CALLBACK(handler);
@@ -1299,6 +1305,10 @@ int if_get_power_state(if_t iface, if_power_state_t* state) {
     return bnetif->getPowerState(state);
 }
 
+if_mem_pressure_t if_get_mem_pressure(void) {
+    return (if_mem_pressure_t)lwip_memp_get_pressure(MEMP_PBUF_POOL);
+}
+
 int if_get_profile(if_t iface, char* profile, size_t length) {
     LwipTcpIpCoreLock lk;
 
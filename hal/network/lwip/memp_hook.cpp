@@ -15,12 +15,18 @@
  * License along with this library; if not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "logging.h"
+LOG_SOURCE_CATEGORY("net.memp")
+
 #include "memp_hook.h"
 #include "check.h"
 #include "system_error.h"
 #include "lwiplock.h"
 #include "lwip_util.h"
 #include "lwiphooks.h"
+#include "hal_platform.h"
+#include "spark_wiring_diagnostics.h"
+#include <lwip/stats.h>
 
 namespace {
 
@@ -33,6 +39,59 @@ struct EventHandlerList {
 
 EventHandlerList* sEventHandlerList = nullptr;
 
+const char* const POOL_NAMES[MEMP_MAX] = {
+#define LWIP_MEMPOOL(name, num, size, desc) desc,
+#include <lwip/priv/memp_std.h>
+};
+
+lwip_memp_pressure_threshold_t sThresholds[MEMP_MAX] = {};
+
+unsigned poolSize(memp_t type) {
+    return MEMP_STATS_GET(avail, type);
+}
+
+unsigned poolLimit(memp_t type) {
+    const unsigned size = poolSize(type);
+    const unsigned limit = sThresholds[type].limit;
+    return (limit && limit < size) ? limit : size;
+}
+
+lwip_memp_pressure_threshold_t defaultThreshold(memp_t type) {
+    lwip_memp_pressure_threshold_t t = {};
+    if (type == MEMP_PBUF_POOL) {
+        t.limit = HAL_PLATFORM_PBUF_POOL_PRESSURE_LIMIT;
+        t.critical = HAL_PLATFORM_PACKET_BUFFER_FLOW_CONTROL_THRESHOLD;
+    }
+    return t;
+}
+
+class MempDiagnosticData: public particle::AbstractUnsignedIntegerDiagnosticData {
+public:
+    MempDiagnosticData(uint16_t id, const char* name, memp_t type, bool maxUsed) :
+            AbstractUnsignedIntegerDiagnosticData(id, name),
+            type_(type),
+            maxUsed_(maxUsed) {
+    }
+
+    virtual int get(IntType& val) override {
+        lwip_memp_info_t info = {};
+        CHECK(lwip_memp_get_info(type_, &info));
+        val = maxUsed_ ? info.max_used : info.used;
+        return 0;
+    }
+
+private:
+    memp_t type_;
+    bool maxUsed_;
+};
+
+MempDiagnosticData g_mempDiagData[] = {
+    { DIAG_ID_NETWORK_PBUF_POOL_USED, DIAG_NAME_NETWORK_PBUF_POOL_USED, MEMP_PBUF_POOL, false },
+    { DIAG_ID_NETWORK_PBUF_POOL_MAX_USED, DIAG_NAME_NETWORK_PBUF_POOL_MAX_USED, MEMP_PBUF_POOL, true },
+    { DIAG_ID_NETWORK_TCP_SEG_USED, DIAG_NAME_NETWORK_TCP_SEG_USED, MEMP_TCP_SEG, false },
+    { DIAG_ID_NETWORK_TCP_SEG_MAX_USED, DIAG_NAME_NETWORK_TCP_SEG_MAX_USED, MEMP_TCP_SEG, true }
+};
+
 } // anonymous
 
 typedef void (*lwip_memp_event_handler_t)(memp_t type, unsigned available, unsigned size, void* ctx);
@@ -59,3 +118,77 @@ int lwip_memp_event_handler_add(lwip_memp_event_handler_t handler, memp_t type,
 
     return 0;
 }
+
+void lwip_memp_pressure_init(void) {
+    for (int i = 0; i < MEMP_MAX; ++i) {
+        const auto t = defaultThreshold((memp_t)i);
+        lwip_memp_set_pressure_threshold((memp_t)i, &t);
+    }
+}
+
+int lwip_memp_set_pressure_threshold(memp_t type, const lwip_memp_pressure_threshold_t* threshold) {
+    CHECK_TRUE(type >= 0 && type < MEMP_MAX && threshold, SYSTEM_ERROR_INVALID_ARGUMENT);
+    auto t = *threshold;
+    const unsigned size = poolSize(type);
+    if (!t.limit || t.limit > size) {
+        t.limit = size;
+    }
+    CHECK_TRUE(t.critical < t.limit, SYSTEM_ERROR_INVALID_ARGUMENT);
+    particle::net::LwipTcpIpCoreLock lk;
+    sThresholds[type] = t;
+    if (t.limit < size) {
+        LOG(TRACE, "%s: pressure limit %u of %u", POOL_NAMES[type], t.limit, size);
+    }
+    return 0;
+}
+
+int lwip_memp_get_pressure_threshold(memp_t type, lwip_memp_pressure_threshold_t* threshold) {
+    CHECK_TRUE(type >= 0 && type < MEMP_MAX && threshold, SYSTEM_ERROR_INVALID_ARGUMENT);
+    *threshold = sThresholds[type];
+    threshold->limit = poolLimit(type);
+    return 0;
+}
+
+lwip_memp_pressure_t lwip_memp_get_pressure(memp_t type) {
+    if (type < 0 || type >= MEMP_MAX) {
+        return LWIP_MEMP_PRESSURE_NONE;
+    }
+    const unsigned size = poolSize(type);
+    const unsigned used = MEMP_STATS_GET(used, type);
+    return lwip_memp_get_pressure_for(type, (used < size) ? size - used : 0);
+}
+
+lwip_memp_pressure_t lwip_memp_get_pressure_for(memp_t type, unsigned available) {
+    if (type < 0 || type >= MEMP_MAX) {
+        return LWIP_MEMP_PRESSURE_NONE;
+    }
+    // Elements beyond the limit are not available to the producers
+    const unsigned reserved = poolSize(type) - poolLimit(type);
+    const unsigned avail = (available > reserved) ? available - reserved : 0;
+    if (avail <= sThresholds[type].critical) {
+        return LWIP_MEMP_PRESSURE_CRITICAL;
+    }
+    return LWIP_MEMP_PRESSURE_NONE;
+}
+
+int lwip_memp_get_info(memp_t type, lwip_memp_info_t* info) {
+    CHECK_TRUE(type >= 0 && type < MEMP_MAX && info, SYSTEM_ERROR_INVALID_ARGUMENT);
+    info->name = POOL_NAMES[type];
+    info->size = poolSize(type);
+    info->limit = poolLimit(type);
+    info->used = MEMP_STATS_GET(used, type);
+    info->max_used = MEMP_STATS_GET(max, type);
+    info->errors = MEMP_STATS_GET(err, type);
+    return 0;
+}
+
+void lwip_memp_dump_info(void) {
+    for (int i = 0; i < MEMP_MAX; ++i) {
+        lwip_memp_info_t info = {};
+        if (lwip_memp_get_info((memp_t)i, &info) < 0) {
+            continue;
+        }
+        LOG(INFO, "%s: used %u, max %u, limit %u, size %u, errors %u", info.name, info.used, info.max_used,
+                info.limit, info.size, info.errors);
+    }
+}
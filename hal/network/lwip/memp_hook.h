@@ -27,6 +27,64 @@ typedef void (*lwip_memp_event_handler_t)(memp_t type, unsigned available, unsig
 
 int lwip_memp_event_handler_add(lwip_memp_event_handler_t handler, memp_t type, void* ctx);
 
+/**
+ * Pool pressure levels.
+ */
+typedef enum lwip_memp_pressure_t {
+    LWIP_MEMP_PRESSURE_NONE = 0, ///< Enough elements are available.
+    LWIP_MEMP_PRESSURE_CRITICAL = 1 ///< Only the reserve is left. Incoming data should not be fed to the stack.
+} lwip_memp_pressure_t;
+
+/**
+ * Pool pressure threshold.
+ *
+ * The pressure of a pool is reported as critical when no more than `critical` of its first `limit`
+ * elements are available. The remaining elements act as a reserve for the TCP/IP stack. This only
+ * affects the reported pressure, the pool itself is not resized and its elements are not reserved.
+ */
+typedef struct lwip_memp_pressure_threshold_t {
+    unsigned limit; ///< Number of elements producers may use (0 means the entire pool).
+    unsigned critical; ///< Number of available elements at which the pressure becomes critical.
+} lwip_memp_pressure_threshold_t;
+
+/**
+ * Pool usage statistics.
+ */
+typedef struct lwip_memp_info_t {
+    const char* name; ///< Pool name.
+    unsigned size; ///< Total number of elements in the pool.
+    unsigned limit; ///< Number of elements producers may use.
+    unsigned used; ///< Number of elements in use.
+    unsigned max_used; ///< Maximum number of elements that were in use at the same time.
+    unsigned errors; ///< Number of failed allocations.
+} lwip_memp_info_t;
+
+/**
+ * Applies the default pressure thresholds. Called once before the TCP/IP stack is started.
+ */
+void lwip_memp_pressure_init(void);
+
+int lwip_memp_set_pressure_threshold(memp_t type, const lwip_memp_pressure_threshold_t* threshold);
+int lwip_memp_get_pressure_threshold(memp_t type, lwip_memp_pressure_threshold_t* threshold);
+
+/**
+ * Returns the current pressure level of a pool.
+ */
+lwip_memp_pressure_t lwip_memp_get_pressure(memp_t type);
+
+/**
+ * Returns the pressure level of a pool given the number of free elements in it. Can be used in
+ * an event handler, which receives the number of free elements as an argument.
+ */
+lwip_memp_pressure_t lwip_memp_get_pressure_for(memp_t type, unsigned available);
+
+int lwip_memp_get_info(memp_t type, lwip_memp_info_t* info);
+
+/**
+ * Logs the usage statistics of all pools.
+ */
+void lwip_memp_dump_info(void);
+
 #ifdef __cplusplus
 }
 #endif // __cplusplus
@@ -25,8 +25,10 @@
 #include "service_debug.h"
 extern "C" {
 #include <netif/ppp/pppos.h>
+#include <netif/ppp/ppp_impl.h>
 }
 #include <lwip/netifapi.h>
+#include <lwip/tcpip.h>
 #include <netif/ppp/pppapi.h>
 #include <mutex>
 #include "socket_hal.h"
@@ -38,6 +40,8 @@ extern "C" {
 #include "delay_hal.h"
 #include "platform_ncp.h"
 #include "resolvapi.h"
+#include "heap_tracking.h"
+#include "memp_hook.h"
 
 LOG_SOURCE_CATEGORY("net.ppp.client");
 
@@ -70,9 +74,21 @@ const char* pppPhaseToString(uint8_t phase) {
 }
 #endif // !PPP_DEBUG
 
+#if IP_FORWARD || LWIP_IPV6_FORWARD
+// Reserve enough space in front of the received packets so that they can be forwarded to another interface
+const size_t FRAME_HEADROOM = PBUF_LINK_ENCAPSULATION_HLEN + PBUF_LINK_HLEN;
+#else
+const size_t FRAME_HEADROOM = 0;
+#endif // IP_FORWARD || LWIP_IPV6_FORWARD
+
+// Before a frame is passed to the TCP/IP thread, its address and control fields are replaced with
+// a pointer to the PCB and the protocol field is expanded to 2 bytes, as expected by ppp_input()
+const size_t FRAME_PREFIX_SIZE = FRAME_HEADROOM + sizeof(ppp_pcb*) + sizeof(uint16_t);
+
 } // anonymous
 
-Client::Client() {
+Client::Client() :
+    decoder_(this) {
   std::call_once(once_, []() {
     LOCK_TCPIP_CORE();
     netifClientDataIdx_ = netif_alloc_client_data_id();
@@ -99,6 +115,7 @@ void Client::init() {
     pcb_ = pppapi_pppos_create(&if_, &Client::outputCb, &Client::notifyStatusCb, this);
     SPARK_ASSERT(pcb_);
     if_.flags &= ~NETIF_FLAG_UP;
+    decoder_.maxFrameSize(PPP_MAXMRU + PPP_HDRLEN + HdlcDecoder::FCS_SIZE);
 
     LOCK_TCPIP_CORE();
     ipcp_ = std::make_unique<Ipcp>(pcb_);
@@ -164,6 +181,7 @@ void Client::deinit() {
       os_queue_destroy(queue_, nullptr);
       queue_ = nullptr;
     }
+    decoder_.reset();
     if (pcb_) {
       pppapi_free(pcb_);
       pcb_ = nullptr;
@@ -249,9 +267,8 @@ int Client::input(const uint8_t* data, size_t size) {
         // LOG_DUMP(TRACE, data, size);
 
         if (platform_primary_ncp_identifier() == PLATFORM_NCP_SARA_R410) {
-          auto pppos = (pppos_pcb*)pcb_->link_ctx_cb;
           const char NO_CARRIER[] = "\r\nNO CARRIER\r\n";
-          if (pppos && pppos->in_state == PDADDRESS && pcb_->phase == PPP_PHASE_NETWORK && data[0] != PPP_FLAG && size >= sizeof(NO_CARRIER) - 1 && !strncmp((const char*)data, NO_CARRIER, size)) {
+          if (decoder_.atFrameBoundary() && pcb_->phase == PPP_PHASE_NETWORK && data[0] != PPP_FLAG && size >= sizeof(NO_CARRIER) - 1 && !strncmp((const char*)data, NO_CARRIER, size)) {
             LOG(ERROR, "NO CARRIER in network PPP phase");
             pppapi_close(pcb_, 1);
             notifyEvent(EVENT_ERROR, ERROR_NO_CARRIER_IN_NETWORK_PHASE);
@@ -268,7 +285,16 @@ int Client::input(const uint8_t* data, size_t size) {
         auto linkDropBefore = lwip_stats.link.drop;
 #endif // DEBUG_BUILD
 
-        pppos_input(pcb_, (u8_t*)data, size);
+        // Decode the frames directly into pbufs instead of going through pppos_input(), which
+        // processes the data byte by byte
+        auto pppos = (pppos_pcb*)pcb_->link_ctx_cb;
+        if (!pppos || !pppos->open) {
+          decoder_.reset();
+          return 0;
+        }
+        decoder_.accm(pppos->in_accm[0] | (pppos->in_accm[1] << 8) | (pppos->in_accm[2] << 16) |
+            ((uint32_t)pppos->in_accm[3] << 24));
+        decoder_.decode(data, size);
 
 #ifdef DEBUG_BUILD
         auto linkDropAfter = lwip_stats.link.drop;
@@ -278,8 +304,7 @@ int Client::input(const uint8_t* data, size_t size) {
 #endif // DEBUG_BUILD
         // FIXME
         err_t err = ERR_OK;
-        int poolAvail = MEMP_STATS_GET(avail, MEMP_PBUF_POOL) - MEMP_STATS_GET(used, MEMP_PBUF_POOL);
-        if (poolAvail <= HAL_PLATFORM_PACKET_BUFFER_FLOW_CONTROL_THRESHOLD) {
+        if (lwip_memp_get_pressure(MEMP_PBUF_POOL) == LWIP_MEMP_PRESSURE_CRITICAL) {
           LOG_DEBUG(WARN, "Almost out of pbufs");
           return SYSTEM_ERROR_NO_MEMORY;
         }
@@ -294,6 +319,108 @@ int Client::input(const uint8_t* data, size_t size) {
   return SYSTEM_ERROR_INVALID_STATE;
 }
 
+uint8_t* Client::frameBuffer(size_t* size) {
+  auto p = pbuf_alloc(PBUF_RAW, 0, PBUF_POOL);
+  if (!p) {
+    return nullptr;
+  }
+  size_t offs = 0;
+  if (!frameHead_) {
+    frameHead_ = p;
+    offs = FRAME_PREFIX_SIZE;
+  } else if (frameTail_ != frameHead_) {
+    // The previous buffer is full and can be appended to the chain
+    pbuf_cat(frameHead_, frameTail_);
+  }
+  frameTail_ = p;
+  // Assume the buffer will be filled completely. The size of the last buffer is adjusted when the
+  // frame ends
+  p->len = p->tot_len = PBUF_POOL_BUFSIZE;
+  *size = PBUF_POOL_BUFSIZE - offs;
+  return (uint8_t*)p->payload + offs;
+}
+
+void Client::frameReceived(size_t size, size_t lastSize) {
+  frameTail_->len = frameTail_->tot_len = lastSize + ((frameTail_ == frameHead_) ? FRAME_PREFIX_SIZE : 0);
+  if (frameTail_ != frameHead_) {
+    pbuf_cat(frameHead_, frameTail_);
+  }
+  auto p = frameHead_;
+  frameHead_ = frameTail_ = nullptr;
+  // Parse the address, control and protocol fields. The first buffer is always large enough to
+  // contain all of them
+  auto d = (uint8_t*)p->payload + FRAME_PREFIX_SIZE;
+  const size_t dataSize = size - HdlcDecoder::FCS_SIZE;
+  size_t offs = 0;
+  if (offs < dataSize && d[offs] == PPP_ALLSTATIONS) {
+    ++offs;
+  }
+  if (offs < dataSize && d[offs] == PPP_UI) {
+    ++offs;
+  }
+  uint16_t protocol = 0;
+  if (offs < dataSize && (d[offs] & 0x01)) {
+    protocol = d[offs++]; // Compressed protocol field
+  } else if (offs + 1 < dataSize) {
+    protocol = (d[offs] << 8) | d[offs + 1];
+    offs += 2;
+  } else {
+    pbuf_free(p);
+    LINK_STATS_INC(link.lenerr);
+    LINK_STATS_INC(link.drop);
+    return;
+  }
+  d += offs;
+  *--d = protocol & 0xff;
+  *--d = protocol >> 8;
+  d -= sizeof(ppp_pcb*);
+  memcpy(d, &pcb_, sizeof(ppp_pcb*));
+  pbuf_remove_header(p, d - (uint8_t*)p->payload);
+  // Trim off the FCS
+  pbuf_realloc(p, p->tot_len - HdlcDecoder::FCS_SIZE);
+  if (tcpip_try_callback(&Client::frameInputCb, p) != ERR_OK) {
+    pbuf_free(p);
+    LINK_STATS_INC(link.drop);
+  }
+}
+
+void Client::frameError(HdlcFrameError error) {
+  switch (error) {
+  case HdlcFrameError::BAD_FCS:
+    LINK_STATS_INC(link.chkerr);
+    break;
+  case HdlcFrameError::TOO_SHORT:
+  case HdlcFrameError::TOO_LONG:
+    LINK_STATS_INC(link.lenerr);
+    break;
+  case HdlcFrameError::NO_MEMORY:
+    LINK_STATS_INC(link.memerr);
+    break;
+  default:
+    break;
+  }
+  LINK_STATS_INC(link.drop);
+  freeFrame();
+}
+
+void Client::freeFrame() {
+  if (frameTail_ && frameTail_ != frameHead_) {
+    pbuf_free(frameTail_);
+  }
+  if (frameHead_) {
+    pbuf_free(frameHead_);
+  }
+  frameHead_ = frameTail_ = nullptr;
+}
+
+void Client::frameInputCb(void* arg) {
+  auto p = (pbuf*)arg;
+  ppp_pcb* pcb = nullptr;
+  memcpy(&pcb, p->payload, sizeof(pcb));
+  pbuf_remove_header(p, sizeof(pcb));
+  ppp_input(pcb, p);
+}
+
 void Client::setNotifyCallback(NotifyCallback cb, void* ctx) {
   std::lock_guard<std::mutex> lk(mutex_);
   cb_ = cb;
@@ -344,10 +471,12 @@ netif* Client::getIf() {
 }
 
 void Client::loopCb(void* arg) {
+  const int prevHeapTag = heap_tag_enter(HEAP_TAG_NETWORK, nullptr);
   Client* self = static_cast<Client*>(arg);
   if (self) {
     self->loop();
   }
+  heap_tag_leave(prevHeapTag, nullptr);
   os_thread_exit(nullptr);
 }
 
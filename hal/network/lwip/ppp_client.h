@@ -32,12 +32,13 @@ extern "C" {
 #include <mutex>
 #include <atomic>
 #include "stream.h"
+#include "hdlc_decoder.h"
 
 #ifdef __cplusplus
 
 namespace particle { namespace net { namespace ppp {
 
-class Client {
+class Client: private HdlcDecoder::Handler {
 public:
   Client();
   ~Client();
@@ -158,6 +159,14 @@ private:
 
   void transition(State newState);
 
+  // HdlcDecoder::Handler
+  uint8_t* frameBuffer(size_t* size) override;
+  void frameReceived(size_t size, size_t lastSize) override;
+  void frameError(HdlcFrameError error) override;
+  void freeFrame();
+
+  static void frameInputCb(void* arg);
+
 private:
 
   struct QueueEvent {
@@ -171,6 +180,11 @@ private:
   std::unique_ptr<Ipcp> ipcp_;
 #endif // PPP_IPCP_OVERRIDE
 
+  // The frames are decoded directly into a chain of PBUF_POOL buffers
+  HdlcDecoder decoder_;
+  pbuf* frameHead_ = nullptr;
+  pbuf* frameTail_ = nullptr;
+
   std::unique_ptr<char> user_;
   std::unique_ptr<char> pass_;
 
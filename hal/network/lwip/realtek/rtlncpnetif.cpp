@@ -45,6 +45,7 @@ LOG_SOURCE_CATEGORY("net.rltkncp");
 #include "check.h"
 #include <lwip/stats.h>
 #include "memp_hook.h"
+#include "heap_tracking.h"
 #include "lwip_rltk.h"
 #include "scope_guard.h"
 
@@ -148,6 +149,7 @@ void RealtekNcpNetif::setExpectedInternalState(NetifEvent ev) {
 }
 
 void RealtekNcpNetif::loop(void* arg) {
+    const int prevHeapTag = heap_tag_enter(HEAP_TAG_NCP, nullptr);
     RealtekNcpNetif* self = static_cast<RealtekNcpNetif*>(arg);
     unsigned int timeout = 100;
     while(!self->exit_) {
@@ -190,6 +192,7 @@ void RealtekNcpNetif::loop(void* arg) {
     self->downImpl();
     self->wifiMan_->ncpClient()->off();
 
+    heap_tag_leave(prevHeapTag, nullptr);
     os_thread_exit(nullptr);
 }
 
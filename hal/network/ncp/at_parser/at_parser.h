@@ -18,6 +18,7 @@
 #pragma once
 
 #include <memory>
+#include <cstddef>
 #include "c_string.h"
 
 namespace particle {
@@ -84,6 +85,32 @@ public:
      * @see `logCategory()`
      */
     static constexpr auto DEFAULT_LOG_CATEGORY = "ncp.at";
+    /**
+     * Default size of the input buffer.
+     *
+     * @see `inputBufferSize()`
+     */
+    static constexpr size_t DEFAULT_INPUT_BUFFER_SIZE = 64;
+    /**
+     * Minimum size of the input buffer.
+     *
+     * The buffer needs to fit the longest final result code followed by CRLF.
+     *
+     * @see `inputBufferSize()`
+     */
+    static constexpr size_t MIN_INPUT_BUFFER_SIZE = 13; // "NO DIALTONE\r\n"
+    /**
+     * Default size of the command buffer.
+     *
+     * @see `commandBufferSize()`
+     */
+    static constexpr size_t DEFAULT_COMMAND_BUFFER_SIZE = 128;
+    /**
+     * Default size of the response buffer.
+     *
+     * @see `responseBufferSize()`
+     */
+    static constexpr size_t DEFAULT_RESPONSE_BUFFER_SIZE = 128;
 
     /**
      * Constructs a settings object with all parameters set to their default values.
@@ -199,6 +226,65 @@ public:
      * @see `DEFAULT_LOG_CATEGORY`
      */
     const char* logCategory() const;
+    /**
+     * Sets the size of the input buffer.
+     *
+     * This buffer holds the data received from the DCE. A larger buffer reduces the number of
+     * stream reads needed to parse long response lines and binary payloads. URC prefixes cannot
+     * be longer than this buffer.
+     *
+     * @param size Buffer size. Must not be less than `MIN_INPUT_BUFFER_SIZE`.
+     * @return This settings object.
+     *
+     * @see `DEFAULT_INPUT_BUFFER_SIZE`
+     */
+    AtParserConfig& inputBufferSize(size_t size);
+    /**
+     * Returns the size of the input buffer.
+     *
+     * @return Buffer size.
+     *
+     * @see `DEFAULT_INPUT_BUFFER_SIZE`
+     */
+    size_t inputBufferSize() const;
+    /**
+     * Sets the size of the command buffer.
+     *
+     * This buffer holds the command line characters used for the echo handling and logging.
+     *
+     * @param size Buffer size.
+     * @return This settings object.
+     *
+     * @see `DEFAULT_COMMAND_BUFFER_SIZE`
+     */
+    AtParserConfig& commandBufferSize(size_t size);
+    /**
+     * Returns the size of the command buffer.
+     *
+     * @return Buffer size.
+     *
+     * @see `DEFAULT_COMMAND_BUFFER_SIZE`
+     */
+    size_t commandBufferSize() const;
+    /**
+     * Sets the size of the response buffer.
+     *
+     * This buffer holds the response line characters used for logging.
+     *
+     * @param size Buffer size.
+     * @return This settings object.
+     *
+     * @see `DEFAULT_RESPONSE_BUFFER_SIZE`
+     */
+    AtParserConfig& responseBufferSize(size_t size);
+    /**
+     * Returns the size of the response buffer.
+     *
+     * @return Buffer size.
+     *
+     * @see `DEFAULT_RESPONSE_BUFFER_SIZE`
+     */
+    size_t responseBufferSize() const;
 
 private:
     Stream* strm_;
@@ -208,6 +294,9 @@ private:
     bool echoEnabled_;
     bool logEnabled_;
     CString logCategory_;
+    size_t inBufSize_;
+    size_t cmdBufSize_;
+    size_t respBufSize_;
 };
 
 /**
@@ -413,7 +502,10 @@ inline AtParserConfig::AtParserConfig() :
         cmdTimeout_(DEFAULT_COMMAND_TIMEOUT),
         strmTimeout_(DEFAULT_STREAM_TIMEOUT),
         echoEnabled_(DEFAULT_ECHO_ENABLED),
-        logEnabled_(DEFAULT_LOG_ENABLED) {
+        logEnabled_(DEFAULT_LOG_ENABLED),
+        inBufSize_(DEFAULT_INPUT_BUFFER_SIZE),
+        cmdBufSize_(DEFAULT_COMMAND_BUFFER_SIZE),
+        respBufSize_(DEFAULT_RESPONSE_BUFFER_SIZE) {
 }
 
 inline AtParserConfig& AtParserConfig::stream(Stream* strm) {
@@ -479,4 +571,31 @@ inline const char* AtParserConfig::logCategory() const {
     return logCategory_ ? static_cast<const char*>(logCategory_) : DEFAULT_LOG_CATEGORY;
 }
 
+inline AtParserConfig& AtParserConfig::inputBufferSize(size_t size) {
+    inBufSize_ = size;
+    return *this;
+}
+
+inline size_t AtParserConfig::inputBufferSize() const {
+    return inBufSize_;
+}
+
+inline AtParserConfig& AtParserConfig::commandBufferSize(size_t size) {
+    cmdBufSize_ = size;
+    return *this;
+}
+
+inline size_t AtParserConfig::commandBufferSize() const {
+    return cmdBufSize_;
+}
+
+inline AtParserConfig& AtParserConfig::responseBufferSize(size_t size) {
+    respBufSize_ = size;
+    return *this;
+}
+
+inline size_t AtParserConfig::responseBufferSize() const {
+    return respBufSize_;
+}
+
 } // particle
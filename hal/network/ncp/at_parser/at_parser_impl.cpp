@@ -22,6 +22,9 @@
 #include "stream.h"
 #include "logging.h"
 #include "scope_guard.h"
+#include "spark_wiring_diagnostics.h"
+#include "trace.h"
+#include "heap_tracking.h"
 #include "check.h"
 #include "debug.h"
 
@@ -46,7 +49,7 @@ struct ResultCode {
 };
 
 // Final result codes recognized by the parser
-const ResultCode RESULT_CODES[] = {
+constexpr ResultCode RESULT_CODES[] = {
     { AtResponse::OK, "OK", 2 },
     { AtResponse::ERROR, "ERROR", 5 },
     { AtResponse::BUSY, "BUSY", 4 },
@@ -57,7 +60,14 @@ const ResultCode RESULT_CODES[] = {
     { AtResponse::CMS_ERROR, "+CMS ERROR", 10 }
 };
 
-const size_t RESULT_CODE_COUNT = sizeof(RESULT_CODES) / sizeof(RESULT_CODES[0]);
+constexpr size_t RESULT_CODE_COUNT = sizeof(RESULT_CODES) / sizeof(RESULT_CODES[0]);
+
+constexpr size_t maxResultCodeSize(size_t i = 0) {
+    return (i < RESULT_CODE_COUNT) ? std::max(RESULT_CODES[i].strSize, maxResultCodeSize(i + 1)) : 0;
+}
+
+static_assert(AtParserConfig::MIN_INPUT_BUFFER_SIZE >= maxResultCodeSize() + 2 /* CRLF */,
+        "Input buffer is too small to fit a final result code");
 
 size_t appendToBuf(char* dest, size_t destSize, const char* src, size_t srcSize) {
     const size_t n = std::min(srcSize, destSize);
@@ -93,11 +103,17 @@ inline system_tick_t millis() {
     return HAL_Timer_Get_Milli_Seconds();
 }
 
+// Time in milliseconds between sending a command and receiving its final result code
+HistogramDiagnosticData<> g_cmdTime(DIAG_ID_NCP_AT_COMMAND_TIME, DIAG_NAME_NCP_AT_COMMAND_TIME);
+
 } // unnamed
 
 AtParserImpl::AtParserImpl(AtParserConfig conf) :
         cmdTerm_(cmdTermStr(conf.commandTerminator())),
         cmdTermSize_(strlen(cmdTerm_)),
+        bufSize_(conf.inputBufferSize()),
+        cmdBufSize_(conf.commandBufferSize()),
+        respBufSize_(conf.responseBufferSize()),
         conf_(std::move(conf)) {
     reset();
 }
@@ -105,6 +121,16 @@ AtParserImpl::AtParserImpl(AtParserConfig conf) :
 AtParserImpl::~AtParserImpl() {
 }
 
+int AtParserImpl::init() {
+    buf_.reset(new(std::nothrow) char[bufSize_]);
+    cmdData_.reset(new(std::nothrow) char[cmdBufSize_]);
+    respData_.reset(new(std::nothrow) char[respBufSize_]);
+    if (!buf_ || !cmdData_ || !respData_) {
+        return SYSTEM_ERROR_NO_MEMORY;
+    }
+    return 0;
+}
+
 int AtParserImpl::newCommand() {
     if (!checkStatus(StatusFlag::READY)) {
         return SYSTEM_ERROR_BUSY; // This error doesn't affect the current command
@@ -133,6 +159,8 @@ int AtParserImpl::sendCommand() {
     clearStatus(StatusFlag::WRITE_CMD);
     setStatus(StatusFlag::FLUSH_CMD);
     cmdTermOffs_ = 0;
+    cmdTime_ = millis();
+    TRACE_INSTANT("at:send");
     PARSER_CHECK(flushCommand(&cmdTimeout_));
     return 0;
 }
@@ -149,6 +177,7 @@ void AtParserImpl::resetCommand() {
     }
     clearStatus(StatusFlag::HAS_RESULT | StatusFlag::HAS_ECHO);
     setStatus(StatusFlag::READY);
+    cmdTime_ = 0;
 }
 
 int AtParserImpl::write(const char* data, size_t size) {
@@ -161,7 +190,7 @@ int AtParserImpl::write(const char* data, size_t size) {
         cmdSize_ = 0;
     }
     const int ret = write(data, &size, &cmdTimeout_);
-    cmdSize_ += appendToBuf(cmdData_ + cmdSize_, CMD_BUF_SIZE - cmdSize_, data, size);
+    cmdSize_ += appendToBuf(cmdData_.get() + cmdSize_, cmdBufSize_ - cmdSize_, data, size);
     if (ret < 0) {
         return error(ret);
     }
@@ -169,6 +198,8 @@ int AtParserImpl::write(const char* data, size_t size) {
 }
 
 int AtParserImpl::readResult(int* errorCode) {
+    TRACE_SCOPE("at:result");
+    HEAP_TAG_SCOPE(HEAP_TAG_NCP);
     if (checkStatus(StatusFlag::READY)) {
         return error(SYSTEM_ERROR_INVALID_STATE);
     }
@@ -198,7 +229,50 @@ int AtParserImpl::readLine(char* data, size_t size) {
     if (checkStatus(StatusFlag::URC_HANDLER)) {
         ret = readLine(data, size, nullptr /* timeout */);
     } else if (!checkStatus(StatusFlag::READY)) {
-        ret = readRespLine(data, size);
+        ret = beginRespLine();
+        if (ret >= 0) {
+            ret = readLine(data, size, &cmdTimeout_);
+        }
+    } else {
+        ret = SYSTEM_ERROR_INVALID_STATE;
+    }
+    if (ret < 0) {
+        error(ret);
+    }
+    return ret;
+}
+
+int AtParserImpl::readLine(AtResponseReader::LineHandler handler, void* data) {
+    int ret = 0;
+    if (!handler) {
+        ret = SYSTEM_ERROR_INVALID_ARGUMENT;
+    } else if (checkStatus(StatusFlag::URC_HANDLER)) {
+        ret = readLineChunks(handler, data, nullptr /* timeout */);
+    } else if (!checkStatus(StatusFlag::READY)) {
+        ret = beginRespLine();
+        if (ret >= 0) {
+            ret = readLineChunks(handler, data, &cmdTimeout_);
+        }
+    } else {
+        ret = SYSTEM_ERROR_INVALID_STATE;
+    }
+    if (ret < 0) {
+        error(ret);
+    }
+    return ret;
+}
+
+int AtParserImpl::readBinary(char* data, size_t size) {
+    int ret = 0;
+    if (!data && size > 0) {
+        ret = SYSTEM_ERROR_INVALID_ARGUMENT;
+    } else if (checkStatus(StatusFlag::URC_HANDLER)) {
+        ret = readBinary(data, size, nullptr /* timeout */);
+    } else if (checkStatus(StatusFlag::HAS_RESULT)) {
+        ret = SYSTEM_ERROR_END_OF_STREAM;
+    } else if (!checkStatus(StatusFlag::READY)) {
+        // The payload follows a response line that has been read already
+        ret = readBinary(data, size, &cmdTimeout_);
     } else {
         ret = SYSTEM_ERROR_INVALID_STATE;
     }
@@ -266,7 +340,7 @@ int AtParserImpl::hasNextLine(bool* hasLine) {
 
 int AtParserImpl::addUrcHandler(const char* prefix, AtParser::UrcHandler handler, void* data) {
     const size_t prefixSize = strlen(prefix);
-    if (prefixSize == 0 || prefixSize > INPUT_BUF_SIZE) {
+    if (prefixSize == 0 || prefixSize > bufSize_) {
         return SYSTEM_ERROR_INVALID_ARGUMENT;
     }
     removeUrcHandler(prefix);
@@ -275,7 +349,12 @@ int AtParserImpl::addUrcHandler(const char* prefix, AtParser::UrcHandler handler
     h.prefixSize = prefixSize;
     h.callback = handler;
     h.data = data;
-    if (!urcHandlers_.append(std::move(h))) {
+    h.key = urcKey(prefix, prefixSize);
+    // Keep the handlers sorted by key
+    const auto it = std::upper_bound(urcHandlers_.begin(), urcHandlers_.end(), h.key, [](uint16_t key, const UrcHandler& h) {
+        return key < h.key;
+    });
+    if (!urcHandlers_.insert(it - urcHandlers_.begin(), std::move(h))) {
         return SYSTEM_ERROR_NO_MEMORY;
     }
     return 0;
@@ -291,6 +370,7 @@ void AtParserImpl::removeUrcHandler(const char* prefix) {
 }
 
 int AtParserImpl::processUrc(unsigned timeout) {
+    HEAP_TAG_SCOPE(HEAP_TAG_NCP);
     if (!checkStatus(StatusFlag::READY)) {
         return SYSTEM_ERROR_BUSY;
     }
@@ -313,6 +393,7 @@ void AtParserImpl::reset() {
     bufPos_ = 0;
     cmdSize_ = 0;
     cmdTimeout_ = 0;
+    cmdTime_ = 0;
     cmdTermOffs_ = 0;
     respSize_ = 0;
     errorCode_ = 0;
@@ -321,10 +402,11 @@ void AtParserImpl::reset() {
 }
 
 bool AtParserImpl::isConfigValid(const AtParserConfig& conf) {
-    return (conf.stream() != nullptr && conf.commandTimeout() > 0 && conf.streamTimeout() > 0);
+    return (conf.stream() != nullptr && conf.commandTimeout() > 0 && conf.streamTimeout() > 0 &&
+            conf.inputBufferSize() >= AtParserConfig::MIN_INPUT_BUFFER_SIZE);
 }
 
-int AtParserImpl::readRespLine(char* data, size_t size) {
+int AtParserImpl::beginRespLine() {
     if (checkStatus(StatusFlag::HAS_RESULT)) {
         return SYSTEM_ERROR_END_OF_STREAM;
     }
@@ -332,7 +414,6 @@ int AtParserImpl::readRespLine(char* data, size_t size) {
         CHECK(waitEcho());
         setStatus(StatusFlag::HAS_ECHO);
     }
-    size_t bytesRead = 0;
     for (;;) {
         if (checkStatus(StatusFlag::LINE_BEGIN)) {
             const int ret = CHECK(parseLine(ParseFlag::PARSE_RESULT | ParseFlag::PARSE_URC, &cmdTimeout_));
@@ -341,12 +422,11 @@ int AtParserImpl::readRespLine(char* data, size_t size) {
             }
         }
         if (!checkStatus(StatusFlag::LINE_END)) {
-            bytesRead = CHECK(readLine(data, size, &cmdTimeout_));
             break;
         }
         CHECK(nextLine(&cmdTimeout_));
     }
-    return bytesRead;
+    return 0;
 }
 
 int AtParserImpl::waitEcho() {
@@ -424,7 +504,7 @@ int AtParserImpl::parseResult() {
     for (size_t i = 0; i < RESULT_CODE_COUNT; ++i) {
         const ResultCode& r2 = RESULT_CODES[i];
         const size_t n = std::min(bufPos_, r2.strSize);
-        if (memcmp(buf_, r2.str, n) == 0 && n > maxSize) {
+        if (memcmp(buf_.get(), r2.str, n) == 0 && n > maxSize) {
             r = &r2;
             maxSize = n;
         }
@@ -444,7 +524,7 @@ int AtParserImpl::parseResult() {
         if (bufPos_ < r->strSize + 2) {
             return ParseResult::READ_MORE;
         }
-        const auto codeStr = buf_ + r->strSize + 1; // First character after ':'
+        const auto codeStr = buf_.get() + r->strSize + 1; // First character after ':'
         const size_t codeStrSize = bufPos_ - r->strSize - 1;
         const size_t n = findNewline(codeStr, codeStrSize);
         if (n == codeStrSize) {
@@ -472,6 +552,11 @@ int AtParserImpl::parseResult() {
         errorCode_ = 0;
     }
     result_ = r->val;
+    if (cmdTime_) {
+        // Ignore result codes that are not a response to a command sent by the parser
+        g_cmdTime.record(millis() - cmdTime_);
+        cmdTime_ = 0;
+    }
     return ParseResult::PARSED_RESULT;
 }
 
@@ -482,13 +567,16 @@ int AtParserImpl::parseUrc(const UrcHandler** handler) {
     // Look for an URC prefix that matches the buffer contents
     const UrcHandler* h = nullptr;
     size_t maxSize = 0;
-    for (size_t i = 0; i < (size_t)urcHandlers_.size(); ++i) {
-        const UrcHandler& h2 = urcHandlers_.at(i);
-        const size_t n = std::min(bufPos_, h2.prefixSize);
-        if (memcmp(buf_, h2.prefix, n) == 0 && n > maxSize) {
-            h = &h2;
-            maxSize = n;
-        }
+    const uint16_t key = urcKey(buf_.get(), 1);
+    if (bufPos_ > 1) {
+        // Check the single-character prefixes and the prefixes starting with the same two
+        // characters as the buffer contents
+        findUrcHandler(key, key, &h, &maxSize);
+        const uint16_t key2 = urcKey(buf_.get(), bufPos_);
+        findUrcHandler(key2, key2, &h, &maxSize);
+    } else {
+        // Check all prefixes starting with the same character
+        findUrcHandler(key, key | 0xff, &h, &maxSize);
     }
     if (!h) {
         return ParseResult::NO_MATCH;
@@ -500,16 +588,29 @@ int AtParserImpl::parseUrc(const UrcHandler** handler) {
     return ParseResult::PARSED_URC;
 }
 
+void AtParserImpl::findUrcHandler(uint16_t minKey, uint16_t maxKey, const UrcHandler** handler, size_t* matchSize) const {
+    auto it = std::lower_bound(urcHandlers_.begin(), urcHandlers_.end(), minKey, [](const UrcHandler& h, uint16_t key) {
+        return h.key < key;
+    });
+    for (; it != urcHandlers_.end() && it->key <= maxKey; ++it) {
+        const size_t n = std::min(bufPos_, it->prefixSize);
+        if (memcmp(buf_.get(), it->prefix, n) == 0 && n > *matchSize) {
+            *handler = &*it;
+            *matchSize = n;
+        }
+    }
+}
+
 int AtParserImpl::parseEcho() {
     if (bufPos_ == 0) {
         return ParseResult::READ_MORE;
     }
     // Check if the command line matches the buffer contents
     size_t n = std::min(bufPos_, cmdSize_);
-    if (memcmp(buf_, cmdData_, n) != 0) {
+    if (memcmp(buf_.get(), cmdData_.get(), n) != 0) {
         return ParseResult::NO_MATCH;
     }
-    n = std::min(cmdSize_, INPUT_BUF_SIZE);
+    n = std::min(cmdSize_, bufSize_);
     if (bufPos_ < n) {
         return ParseResult::READ_MORE;
     }
@@ -519,15 +620,15 @@ int AtParserImpl::parseEcho() {
 int AtParserImpl::readLine(char* data, size_t size, unsigned* timeout) {
     size_t bytesRead = 0;
     for (;;) {
-        size_t n = findNewline(buf_, bufPos_);
+        size_t n = findNewline(buf_.get(), bufPos_);
         if (data && n > size) {
             n = size;
         }
         if (n > 0) {
             clearStatus(StatusFlag::LINE_BEGIN);
-            respSize_ += appendToBuf(respData_ + respSize_, RESP_BUF_SIZE - respSize_, buf_, n);
+            respSize_ += appendToBuf(respData_.get() + respSize_, respBufSize_ - respSize_, buf_.get(), n);
             if (data) {
-                memcpy(data, buf_, n);
+                memcpy(data, buf_.get(), n);
                 data += n;
                 size -= n;
             }
@@ -535,11 +636,11 @@ int AtParserImpl::readLine(char* data, size_t size, unsigned* timeout) {
             bufPos_ -= n;
         }
         if (bufPos_ > 0) {
-            memmove(buf_, buf_ + n, bufPos_);
+            memmove(buf_.get(), buf_.get() + n, bufPos_);
             if (isNewline(buf_[0])) {
                 setStatus(StatusFlag::LINE_END);
                 if (conf_.logEnabled()) {
-                    logRespLine(respData_, respSize_);
+                    logRespLine(respData_.get(), respSize_);
                 }
                 respSize_ = 0;
             }
@@ -550,15 +651,80 @@ int AtParserImpl::readLine(char* data, size_t size, unsigned* timeout) {
     return bytesRead;
 }
 
+int AtParserImpl::readLineChunks(AtResponseReader::LineHandler handler, void* data, unsigned* timeout) {
+    size_t bytesRead = 0;
+    for (;;) {
+        const size_t n = findNewline(buf_.get(), bufPos_);
+        if (n > 0) {
+            clearStatus(StatusFlag::LINE_BEGIN);
+            respSize_ += appendToBuf(respData_.get() + respSize_, respBufSize_ - respSize_, buf_.get(), n);
+            // Pass the data to the handler directly from the input buffer
+            CHECK(handler(buf_.get(), n, data));
+            bytesRead += n;
+            bufPos_ -= n;
+        }
+        if (bufPos_ > 0) {
+            memmove(buf_.get(), buf_.get() + n, bufPos_);
+            setStatus(StatusFlag::LINE_END);
+            if (conf_.logEnabled()) {
+                logRespLine(respData_.get(), respSize_);
+            }
+            respSize_ = 0;
+            break;
+        }
+        CHECK(readMore(timeout));
+    }
+    return bytesRead;
+}
+
+int AtParserImpl::readBinary(char* data, size_t size, unsigned* timeout) {
+    // Skip the rest of the current line
+    if (!checkStatus(StatusFlag::LINE_END)) {
+        CHECK(readLine(nullptr, 0, timeout));
+    }
+    // Skip the line terminator. Unlike nextLine(), this doesn't skip empty lines as the payload
+    // itself may start with a newline character
+    if (bufPos_ == 0) {
+        CHECK(readMore(timeout));
+    }
+    size_t n = 1;
+    if (buf_[0] == '\r') {
+        if (bufPos_ == 1) {
+            CHECK(readMore(timeout));
+        }
+        if (buf_[1] == '\n') {
+            ++n;
+        }
+    }
+    bufPos_ -= n;
+    memmove(buf_.get(), buf_.get() + n, bufPos_);
+    clearStatus(StatusFlag::LINE_BEGIN | StatusFlag::LINE_END);
+    // Copy the data that has been buffered already
+    n = std::min(bufPos_, size);
+    if (n > 0) {
+        memcpy(data, buf_.get(), n);
+        bufPos_ -= n;
+        memmove(buf_.get(), buf_.get() + n, bufPos_);
+    }
+    // Read the rest of the data directly into the destination buffer
+    while (n < size) {
+        n += CHECK(readStream(data + n, size - n, timeout));
+    }
+    if (conf_.logEnabled()) {
+        LOG_C(TRACE, conf_.logCategory(), "< [%u bytes]", (unsigned)size);
+    }
+    return size;
+}
+
 int AtParserImpl::nextLine(unsigned* timeout) {
     size_t bytesRead = 0;
     for (;;) {
-        size_t n = findNewline(buf_, bufPos_);
-        respSize_ += appendToBuf(respData_ + respSize_, RESP_BUF_SIZE - respSize_, buf_, n);
+        size_t n = findNewline(buf_.get(), bufPos_);
+        respSize_ += appendToBuf(respData_.get() + respSize_, respBufSize_ - respSize_, buf_.get(), n);
         if (n < bufPos_) {
             setStatus(StatusFlag::LINE_END);
             if (conf_.logEnabled()) {
-                logRespLine(respData_, respSize_);
+                logRespLine(respData_.get(), respSize_);
             }
             respSize_ = 0;
             do {
@@ -571,7 +737,7 @@ int AtParserImpl::nextLine(unsigned* timeout) {
             bufPos_ -= n;
         }
         if (bufPos_ > 0) {
-            memmove(buf_, buf_ + n, bufPos_);
+            memmove(buf_.get(), buf_.get() + n, bufPos_);
         } else {
             CHECK(readMore(timeout));
         }
@@ -585,11 +751,17 @@ int AtParserImpl::nextLine(unsigned* timeout) {
 }
 
 int AtParserImpl::readMore(unsigned* timeout) {
-    assert(bufPos_ < INPUT_BUF_SIZE);
+    assert(bufPos_ < bufSize_);
+    const size_t bytesRead = CHECK(readStream(buf_.get() + bufPos_, bufSize_ - bufPos_, timeout));
+    bufPos_ += bytesRead;
+    return bytesRead;
+}
+
+int AtParserImpl::readStream(char* data, size_t size, unsigned* timeout) {
     const auto strm = conf_.stream();
     size_t bytesRead = 0;
     for (;;) {
-        bytesRead = CHECK(strm->read(buf_ + bufPos_, INPUT_BUF_SIZE - bufPos_));
+        bytesRead = CHECK(strm->read(data, size));
         if (bytesRead > 0) {
             break;
         }
@@ -611,7 +783,6 @@ int AtParserImpl::readMore(unsigned* timeout) {
             *timeout -= t;
         }
     }
-    bufPos_ += bytesRead;
     return bytesRead;
 }
 
@@ -626,7 +797,7 @@ int AtParserImpl::flushCommand(unsigned* timeout) {
     if (cmdTermOffs_ == cmdTermSize_) {
         clearStatus(StatusFlag::FLUSH_CMD);
         if (conf_.logEnabled()) {
-            logCmdLine(cmdData_, cmdSize_);
+            logCmdLine(cmdData_.get(), cmdSize_);
         }
     }
     return ret;
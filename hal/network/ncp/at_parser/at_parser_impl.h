@@ -24,6 +24,8 @@
 
 #include "spark_wiring_vector.h"
 
+#include <memory>
+
 #define PARSER_CHECK(_expr) \
         ({ \
             const auto _ret = _expr; \
@@ -39,20 +41,13 @@ namespace detail {
 
 using spark::Vector;
 
-// Size of the intermediate buffer for received data
-const size_t INPUT_BUF_SIZE = 64;
-
-// Maximum number of AT command characters stored by the parser
-const size_t CMD_BUF_SIZE = 128;
-
-// Maximum number of response line characters stored by the parser
-const size_t RESP_BUF_SIZE = 128;
-
 class AtParserImpl {
 public:
     explicit AtParserImpl(AtParserConfig conf);
     ~AtParserImpl();
 
+    int init();
+
     int newCommand();
     int sendCommand();
     void resetCommand();
@@ -61,6 +56,8 @@ public:
 
     int readResult(int* errorCode);
     int readLine(char* data, size_t size);
+    int readLine(AtResponseReader::LineHandler handler, void* data);
+    int readBinary(char* data, size_t size);
     int nextLine();
     int hasNextLine(bool* hasLine);
     bool atLineEnd() const;
@@ -109,30 +106,35 @@ private:
         size_t prefixSize; // Size of the prefix string
         AtParser::UrcHandler callback; // Handler callback
         void* data; // User data
+        uint16_t key; // Lookup key (see urcKey())
     };
 
     const char* const cmdTerm_; // Command terminator string
     const size_t cmdTermSize_; // Size of the command terminator string
 
-    char buf_[INPUT_BUF_SIZE]; // Input buffer
+    std::unique_ptr<char[]> buf_; // Input buffer
+    size_t bufSize_; // Size of the input buffer
     size_t bufPos_; // Number of bytes in the input buffer
 
-    char cmdData_[CMD_BUF_SIZE]; // Command data
+    std::unique_ptr<char[]> cmdData_; // Command data
+    size_t cmdBufSize_; // Maximum number of command characters stored by the parser
     size_t cmdSize_; // Size of the command data
 
-    char respData_[RESP_BUF_SIZE]; // Response data
+    std::unique_ptr<char[]> respData_; // Response data
+    size_t respBufSize_; // Maximum number of response line characters stored by the parser
     size_t respSize_; // Size of the response data
 
     AtResponse::Result result_; // Final result code
     int errorCode_; // Error code reported via "+CME ERROR" or "+CMS ERROR"
     size_t cmdTermOffs_; // Number of characters of the command terminator written to the stream
     unsigned cmdTimeout_; // Command timeout
+    system_tick_t cmdTime_; // Time when the command was sent, or 0 if no command is in flight
     unsigned status_; // Status flags
 
-    Vector<UrcHandler> urcHandlers_; // URC handlers
+    Vector<UrcHandler> urcHandlers_; // URC handlers sorted by key
     AtParserConfig conf_; // Parser settings
 
-    int readRespLine(char* data, size_t size);
+    int beginRespLine();
     int waitEcho();
 
     int parseLine(unsigned flags, unsigned* timeout);
@@ -140,9 +142,14 @@ private:
     int parseUrc(const UrcHandler** handler);
     int parseEcho();
 
+    void findUrcHandler(uint16_t minKey, uint16_t maxKey, const UrcHandler** handler, size_t* matchSize) const;
+
     int readLine(char* data, size_t size, unsigned* timeout);
+    int readLineChunks(AtResponseReader::LineHandler handler, void* data, unsigned* timeout);
+    int readBinary(char* data, size_t size, unsigned* timeout);
     int nextLine(unsigned* timeout);
     int readMore(unsigned* timeout);
+    int readStream(char* data, size_t size, unsigned* timeout);
 
     int flushCommand(unsigned* timeout);
     int write(const char* data, size_t* size, unsigned* timeout);
@@ -155,6 +162,8 @@ private:
 
     void logCmdLine(const char* data, size_t size) const;
     void logRespLine(const char* data, size_t size) const;
+
+    static uint16_t urcKey(const char* data, size_t size);
 };
 
 inline void AtParserImpl::commandTimeout(unsigned timeout) {
@@ -189,6 +198,12 @@ inline unsigned AtParserImpl::checkStatus(unsigned flags) const {
     return (status_ & flags);
 }
 
+// URC handlers are sorted by the first two characters of their prefixes so that only the handlers
+// that can possibly match the received line need to be checked
+inline uint16_t AtParserImpl::urcKey(const char* data, size_t size) {
+    return ((uint16_t)(uint8_t)data[0] << 8) | (size > 1 ? (uint8_t)data[1] : 0);
+}
+
 } // particle::detail
 
 } // particle
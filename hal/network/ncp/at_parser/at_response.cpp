@@ -94,6 +94,28 @@ CString AtResponseReader::readLine() {
     return CString::wrap(buf);
 }
 
+int AtResponseReader::readLine(LineHandler handler, void* data) {
+    if (!parser_) {
+        return error(SYSTEM_ERROR_INVALID_STATE);
+    }
+    const int n = parser_->readLine(handler, data);
+    if (n < 0) {
+        return error(n);
+    }
+    return n;
+}
+
+int AtResponseReader::readBinary(char* data, size_t size) {
+    if (!parser_) {
+        return error(SYSTEM_ERROR_INVALID_STATE);
+    }
+    const int n = parser_->readBinary(data, size);
+    if (n < 0) {
+        return error(n);
+    }
+    return n;
+}
+
 int AtResponseReader::scanf(const char* fmt, ...) {
     va_list args;
     va_start(args, fmt);
@@ -68,6 +68,18 @@ class CString;
  */
 class AtResponseReader {
 public:
+    /**
+     * Line handler.
+     *
+     * @param data Line data. The data is only valid until the handler returns.
+     * @param size Size of the line data.
+     * @param userData User data.
+     * @return 0 on success, or a negative result code in case of an error.
+     *
+     * @see `readLine(LineHandler, void*)`
+     */
+    typedef int(*LineHandler)(const char* data, size_t size, void* userData);
+
     /**
      * Reads the current line.
      *
@@ -92,6 +104,32 @@ public:
      * @see `scanf()`
      */
     CString readLine();
+    /**
+     * Reads the current line without copying it.
+     *
+     * The handler is called one or more times with consecutive chunks of the current line as
+     * they appear in the parser's input buffer. This allows processing lines of arbitrary length,
+     * such as long URCs, without allocating a buffer for the entire line.
+     *
+     * @param handler Handler function.
+     * @param data User data.
+     * @return Number of characters read, or a negative result code in case of an error.
+     */
+    int readLine(LineHandler handler, void* data);
+    /**
+     * Reads binary data that follows the current line.
+     *
+     * This method skips the rest of the current line and the line terminator, and then reads
+     * exactly `size` bytes of raw data, which may contain newline characters. This is meant for
+     * commands that return a payload of a known size, e.g. a socket read command that reports
+     * the payload size on the preceding line. Data that is not buffered by the parser yet is read
+     * from the stream directly into the destination buffer.
+     *
+     * @param data Destination buffer.
+     * @param size Number of bytes to read.
+     * @return Number of bytes read, or a negative result code in case of an error.
+     */
+    int readBinary(char* data, size_t size);
     /**
      * Reads and parses the current line.
      *
@@ -20,6 +20,7 @@
 #include "network/ncp/cellular/cellular_network_manager.h"
 #include "network/ncp/cellular/cellular_ncp_client.h"
 #include "network/ncp/cellular/ncp.h"
+#include "network/ncp/cellular/modem_config_cache.h"
 #include "ifapi.h"
 
 #include "system_network.h" // FIXME: For network_interface_index
@@ -445,6 +446,11 @@ int cellular_command(_CALLBACKPTR_MDM cb, void* param, system_tick_t timeout_ms,
     memcpy(fmt.get(), format, n);
     fmt[n] = '\0';
 
+    if (strchr(fmt.get(), '=') && !strstr(fmt.get(), "=?")) {
+        // The application may be changing the modem settings behind our back
+        ModemConfigCache::instance()->invalidate();
+    }
+
     va_list args;
     va_start(args, format);
     auto resp = parser->command().vprintf(fmt.get(), args).timeout(timeout_ms).send();
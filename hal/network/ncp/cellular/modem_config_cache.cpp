@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "logging.h"
+LOG_SOURCE_CATEGORY("ncp.cache")
+
+#include "modem_config_cache.h"
+
+#include "system_cache.h"
+#include "platform_headers.h"
+
+#ifndef retained_system
+#define retained_system
+#endif
+
+namespace particle {
+
+using namespace services;
+
+namespace {
+
+const uint32_t REG_STATE_MAGIC = 0x52e6c0a1;
+
+struct RegistrationState {
+    uint32_t magic;
+    uint32_t ncpId;
+    uint32_t registered;
+    uint32_t check; // Inverted XOR of the other fields, detects garbage after a power loss
+};
+
+retained_system RegistrationState g_modemRegState;
+
+uint32_t regStateCheck(const RegistrationState& s) {
+    return ~(s.magic ^ s.ncpId ^ s.registered);
+}
+
+} // namespace
+
+ModemConfigCache::ModemConfigCache() :
+        fp_(),
+        loaded_(false) {
+}
+
+bool ModemConfigCache::isApplied(int ncpId, ModemConfigGroup group, uint32_t fingerprint) {
+    load();
+    return fp_.ncpId == (uint32_t)ncpId && fp_.groups[(size_t)group] == fingerprint;
+}
+
+void ModemConfigCache::setApplied(int ncpId, ModemConfigGroup group, uint32_t fingerprint) {
+    load();
+    if (fp_.ncpId != (uint32_t)ncpId) {
+        fp_ = {};
+        fp_.ncpId = ncpId;
+    } else if (fp_.groups[(size_t)group] == fingerprint) {
+        return; // Avoid unnecessary writes to flash
+    }
+    fp_.groups[(size_t)group] = fingerprint;
+    const int r = SystemCache::instance().set(SystemCacheKey::CELLULAR_NCP_CONFIG_FINGERPRINT, &fp_, sizeof(fp_));
+    if (r < 0) {
+        LOG(WARN, "Failed to store modem config fingerprint: %d", r);
+    }
+}
+
+bool ModemConfigCache::wasRegistered(int ncpId) const {
+    const auto& s = g_modemRegState;
+    return s.magic == REG_STATE_MAGIC && s.check == regStateCheck(s) && s.ncpId == (uint32_t)ncpId && s.registered;
+}
+
+void ModemConfigCache::setRegistered(int ncpId, bool registered) {
+    auto& s = g_modemRegState;
+    s.magic = REG_STATE_MAGIC;
+    s.ncpId = ncpId;
+    s.registered = registered;
+    s.check = regStateCheck(s);
+}
+
+void ModemConfigCache::modemReset() {
+    g_modemRegState = {};
+}
+
+void ModemConfigCache::invalidate() {
+    modemReset();
+    if (loaded_ && fp_.ncpId == 0) {
+        return;
+    }
+    fp_ = {};
+    loaded_ = true;
+    SystemCache::instance().del(SystemCacheKey::CELLULAR_NCP_CONFIG_FINGERPRINT);
+    LOG(TRACE, "Modem config fingerprint invalidated");
+}
+
+ModemConfigCache* ModemConfigCache::instance() {
+    static ModemConfigCache cache;
+    return &cache;
+}
+
+void ModemConfigCache::load() {
+    if (loaded_) {
+        return;
+    }
+    loaded_ = true;
+    const int r = SystemCache::instance().get(SystemCacheKey::CELLULAR_NCP_CONFIG_FINGERPRINT, &fp_, sizeof(fp_));
+    if (r != (int)sizeof(fp_)) {
+        fp_ = {};
+    }
+}
+
+} // particle
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+namespace particle {
+
+/**
+ * Fingerprint of a set of modem settings (32-bit FNV-1a hash).
+ */
+class ModemConfigFingerprint {
+public:
+    ModemConfigFingerprint() :
+            hash_(OFFSET_BASIS) {
+    }
+
+    ModemConfigFingerprint& add(const char* str) {
+        // Include the terminator so that ("ab", "c") and ("a", "bc") produce different fingerprints
+        return update(str, str ? std::strlen(str) + 1 : 0);
+    }
+
+    ModemConfigFingerprint& add(int val) {
+        return update(&val, sizeof(val));
+    }
+
+    uint32_t value() const {
+        return hash_;
+    }
+
+private:
+    static const uint32_t OFFSET_BASIS = 2166136261u;
+    static const uint32_t PRIME = 16777619u;
+
+    uint32_t hash_;
+
+    ModemConfigFingerprint& update(const void* data, size_t size) {
+        auto p = (const uint8_t*)data;
+        for (size_t i = 0; i < size; ++i) {
+            hash_ = (hash_ ^ p[i]) * PRIME;
+        }
+        return *this;
+    }
+};
+
+/**
+ * Groups of modem settings that are tracked separately.
+ */
+enum class ModemConfigGroup {
+    RADIO = 0, ///< Settings stored in the modem's NVM: RATs, scan sequence, PSM/eDRX, SIM slot.
+    PDP_CONTEXT = 1 ///< Default PDP context.
+};
+
+/**
+ * Remembers which settings have been applied to the modem and whether the modem was registered.
+ *
+ * The fingerprints of the applied settings are stored in the system cache, since the modem keeps
+ * these settings in its NVM across power cycles. The registration state is kept in retained RAM
+ * and is only meaningful as long as the modem stays powered, e.g. after a warm reset of the device
+ * or a wake-up from sleep.
+ */
+class ModemConfigCache {
+public:
+    // Returns true if the settings with the given fingerprint have been applied to the modem
+    bool isApplied(int ncpId, ModemConfigGroup group, uint32_t fingerprint);
+    void setApplied(int ncpId, ModemConfigGroup group, uint32_t fingerprint);
+
+    // Returns true if the modem was registered the last time its state was known
+    bool wasRegistered(int ncpId) const;
+    void setRegistered(int ncpId, bool registered);
+
+    // Forgets the registration state. Needs to be called when the modem is powered off or reset
+    void modemReset();
+    // Forgets everything. Needs to be called when the modem may have been reconfigured by the application
+    void invalidate();
+
+    static ModemConfigCache* instance();
+
+private:
+    static const size_t GROUP_COUNT = 2;
+
+    struct Fingerprints {
+        uint32_t ncpId;
+        uint32_t groups[GROUP_COUNT];
+    };
+
+    Fingerprints fp_;
+    bool loaded_;
+
+    ModemConfigCache();
+
+    void load();
+};
+
+} // particle
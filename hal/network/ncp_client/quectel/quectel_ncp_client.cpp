@@ -24,6 +24,7 @@ LOG_SOURCE_CATEGORY("ncp.client");
 #include "at_command.h"
 #include "at_response.h"
 #include "network/ncp/cellular/network_config_db.h"
+#include "network/ncp/cellular/modem_config_cache.h"
 
 #include "serial_stream.h"
 #include "check.h"
@@ -108,6 +109,8 @@ const auto QUECTEL_NCP_PPP_CHANNEL = 2;
 const auto QUECTEL_NCP_SIM_SELECT_PIN = 23;
 
 const unsigned REGISTRATION_CHECK_INTERVAL = 15 * 1000;
+// Polling interval used once the modem has been seen to report the registration status via URCs
+const unsigned REGISTRATION_URC_CHECK_INTERVAL = 60 * 1000;
 const unsigned REGISTRATION_TIMEOUT = 10 * 60 * 1000;
 const unsigned REGISTRATION_INTERVENTION_TIMEOUT = 15 * 1000;
 const unsigned REGISTRATION_TWILIO_HOLDOFF_TIMEOUT = 5 * 60 * 1000;
@@ -142,6 +145,9 @@ const int CGDCONT_ATTEMPTS = 5;
 
 const int COPS_MAX_RETRY_CNT = 3;
 
+// Needs to be incremented whenever the radio settings applied in initReady() and registerNet() change
+const int RADIO_CONFIG_VERSION = 1;
+
 } // anonymous
 
 QuectelNcpClient::QuectelNcpClient() {
@@ -205,6 +211,7 @@ int QuectelNcpClient::initParser(Stream* stream) {
     auto parserConf = AtParserConfig().stream(stream).commandTerminator(AtCommandTerminator::CRLF);
     parser_.destroy();
     CHECK(parser_.init(std::move(parserConf)));
+    regUrcSeen_ = false;
 
     // NOTE: These URC handlers need to take care of both the URCs and direct responses to the commands.
     // See CH28408
@@ -223,6 +230,8 @@ int QuectelNcpClient::initParser(Stream* stream) {
         if (0 >= r) {
             r = CHECK_PARSER_URC(
                 ::sscanf(atResponse, "+CREG: %u,\"%x\",\"%x\",%u", &val[0], &val[1], &val[2], &val[3]));
+            // Direct responses always include the mode, so this is an unsolicited report
+            self->regUrcSeen_ = true;
         }
         CHECK_TRUE(r >= 1, SYSTEM_ERROR_AT_RESPONSE_UNEXPECTED);
 
@@ -260,6 +269,8 @@ int QuectelNcpClient::initParser(Stream* stream) {
         if (0 >= r) {
             r = CHECK_PARSER_URC(
                 ::sscanf(atResponse, "+CGREG: %u,\"%x\",\"%x\",%u", &val[0], &val[1], &val[2], &val[3]));
+            // Direct responses always include the mode, so this is an unsolicited report
+            self->regUrcSeen_ = true;
         }
         CHECK_TRUE(r >= 1, SYSTEM_ERROR_AT_RESPONSE_UNEXPECTED);
 
@@ -305,6 +316,8 @@ int QuectelNcpClient::initParser(Stream* stream) {
         if (0 >= r) {
             r = CHECK_PARSER_URC(
                 ::sscanf(atResponse, "+CEREG: %u,\"%x\",\"%x\",%u", &val[0], &val[1], &val[2], &val[3]));
+            // Direct responses always include the mode, so this is an unsolicited report
+            self->regUrcSeen_ = true;
         }
         CHECK_TRUE(r >= 1, SYSTEM_ERROR_AT_RESPONSE_UNEXPECTED);
 
@@ -388,6 +401,8 @@ int QuectelNcpClient::off() {
     serial_->on(false);
 
     ready_ = false;
+    cfunFull_ = false;
+    ModemConfigCache::instance()->modemReset();
     ncpState(NcpState::OFF);
     return SYSTEM_ERROR_NONE;
 }
@@ -435,6 +450,7 @@ int QuectelNcpClient::disconnect() {
         return SYSTEM_ERROR_NONE;
     }
     CHECK(checkParser());
+    cfunFull_ = false;
     const int r = CHECK_PARSER(parser_.execCommand("AT+CFUN=0,0"));
     (void)r;
     // CHECK_TRUE(r == AtResponse::OK, SYSTEM_ERROR_UNKNOWN);
@@ -1098,18 +1114,38 @@ int QuectelNcpClient::getAppFirmwareVersion() {
     return ver;
 }
 
+int QuectelNcpClient::readFirmwareRevision() {
+    fwRevision_[0] = '\0';
+    auto resp = parser_.sendCommand("AT+QGMR");
+    char buf[sizeof(fwRevision_)] = {};
+    CHECK_PARSER(resp.readLine(buf, sizeof(buf)));
+    const int r = CHECK_PARSER(resp.readResult());
+    CHECK_TRUE(r == AtResponse::OK, SYSTEM_ERROR_AT_NOT_OK);
+    memcpy(fwRevision_, buf, sizeof(fwRevision_));
+    return 0;
+}
+
 int QuectelNcpClient::initReady(ModemState state) {
     // Set modem full functionality
     int r = AtResponse::OK;
+    cfunFull_ = false;
     for (int x = 0; x < QUECTEL_CFUN_MAX_ATTEMPTS; x++) {
         int r = setModuleFunctionality(CellularFunctionality::FULL, true /* check */);
         if (r == AtResponse::OK) {
+            cfunFull_ = true;
             break;
         }
         HAL_Delay_Milliseconds(1000);
     }
     CHECK_TRUE(r == AtResponse::OK, SYSTEM_ERROR_UNKNOWN);
 
+    // The modem firmware may have been updated while the device wasn't watching, so the revision
+    // is read every time the modem is initialized
+    const int revResult = readFirmwareRevision();
+    if (revResult < 0) {
+        LOG(WARN, "Failed to read modem firmware revision: %d", revResult);
+    }
+
     if (state != ModemState::MuxerAtChannel) {
         // Cold Boot only, Warm Boot will skip the following block...
 
@@ -1142,7 +1178,10 @@ int QuectelNcpClient::initReady(ModemState state) {
         // int r = CHECK_PARSER(parser_.execCommand("AT+COPS=2"));
         // CHECK_TRUE(r == AtResponse::OK, SYSTEM_ERROR_UNKNOWN);
 
-        if (isQuecCatM1Device()) {
+        // The following settings are stored in the modem's NVM and survive a power cycle
+        const bool radioConfigured = isRadioConfigApplied(radioConfigFingerprint());
+
+        if (isQuecCatM1Device() && !radioConfigured) {
             // Force eDRX mode to be disabled.
             CHECK_PARSER(parser_.execCommand("AT+CEDRXS=0"));
 
@@ -1151,7 +1190,7 @@ int QuectelNcpClient::initReady(ModemState state) {
         }
 
         // Select (U)SIM card in slot 1, EG91 has two SIM card slots
-        if (isQuecCat1Device()) {
+        if (isQuecCat1Device() && !radioConfigured) {
             CHECK_PARSER(parser_.execCommand("AT+QDSIM=0"));
         }
 
@@ -1367,7 +1406,10 @@ int QuectelNcpClient::setModuleFunctionality(CellularFunctionality cfun, bool ch
 int QuectelNcpClient::configureApn(const CellularNetworkConfig& conf) {
     // IMPORTANT: Set modem full functionality!
     // Otherwise we won't be able to query ICCID/IMSI
-    CHECK_PARSER_OK(parser_.execCommand("AT+CFUN=1,0"));
+    if (!cfunFull_) {
+        CHECK_PARSER_OK(parser_.execCommand("AT+CFUN=1,0"));
+        cfunFull_ = true;
+    }
 
     netConf_ = conf;
     if (!netConf_.isValid()) {
@@ -1388,14 +1430,21 @@ int QuectelNcpClient::configureApn(const CellularNetworkConfig& conf) {
             CHECK(checkNetConfForImsi());
         }
     }
+    const auto apn = netConf_.hasApn() ? netConf_.apn() : "";
+    const auto pdpFingerprint = ModemConfigFingerprint().add(QUECTEL_DEFAULT_CID).add(QUECTEL_DEFAULT_PDP_TYPE)
+            .add(apn).value();
+    if (ModemConfigCache::instance()->isApplied(ncpId(), ModemConfigGroup::PDP_CONTEXT, pdpFingerprint)) {
+        LOG(TRACE, "PDP context is already configured");
+        return SYSTEM_ERROR_NONE;
+    }
     // XXX: we've seen CGDCONT fail on cold boot, retrying here a few times
     for (int i = 0; i < CGDCONT_ATTEMPTS; i++) {
         // FIXME: for now IPv4 context only
         auto resp = parser_.sendCommand("AT+CGDCONT=%d,\"%s\",\"%s\"",
-                QUECTEL_DEFAULT_CID, QUECTEL_DEFAULT_PDP_TYPE,
-                netConf_.hasApn() ? netConf_.apn() : "");
+                QUECTEL_DEFAULT_CID, QUECTEL_DEFAULT_PDP_TYPE, apn);
         const int r = CHECK_PARSER(resp.readResult());
         if (r == AtResponse::OK) {
+            ModemConfigCache::instance()->setApplied(ncpId(), ModemConfigGroup::PDP_CONTEXT, pdpFingerprint);
             return SYSTEM_ERROR_NONE;
         }
         HAL_Delay_Milliseconds(200);
@@ -1406,8 +1455,11 @@ int QuectelNcpClient::configureApn(const CellularNetworkConfig& conf) {
 int QuectelNcpClient::registerNet() {
     int r = 0;
     // Set modem full functionality
-    r = CHECK_PARSER(parser_.execCommand("AT+CFUN=1,0"));
-    CHECK_TRUE(r == AtResponse::OK, SYSTEM_ERROR_UNKNOWN);
+    if (!cfunFull_) {
+        r = CHECK_PARSER(parser_.execCommand("AT+CFUN=1,0"));
+        CHECK_TRUE(r == AtResponse::OK, SYSTEM_ERROR_UNKNOWN);
+        cfunFull_ = true;
+    }
 
     resetRegistrationState();
 
@@ -1421,28 +1473,37 @@ int QuectelNcpClient::registerNet() {
     r = CHECK_PARSER(parser_.execCommand("AT+CEREG=2"));
     CHECK_TRUE(r == AtResponse::OK, SYSTEM_ERROR_UNKNOWN);
 
+    // Check the registration hint before the connection state changes
+    const bool wasRegistered = ModemConfigCache::instance()->wasRegistered(ncpId());
+
     connectionState(NcpConnectionState::CONNECTING);
 
-    // EG91NA can get stuck in an COPS? ERROR init loop, retry 2 times.
-    int copsCount = 0;
     int copsState = 2;
-    char copsResponse[64] = {};
-    do {
-        auto resp = parser_.sendCommand("AT+COPS?");
-        if (resp.hasNextLine()) {
-            CHECK_PARSER(resp.readLine(copsResponse, sizeof(copsResponse)));
-            CHECK_PARSER(::sscanf(copsResponse, "+COPS: %d", &copsState));
-        }
-        r = CHECK_PARSER(resp.readResult());
-        if (r == AtResponse::OK) {
-            break;
-        } else if (copsCount >= COPS_MAX_RETRY_CNT) {
-            // if max retries are exhausted
-            return SYSTEM_ERROR_AT_RESPONSE_UNEXPECTED;
-        }
-        ++copsCount;
-        HAL_Delay_Milliseconds(2000 * copsCount);
-    } while (copsCount < COPS_MAX_RETRY_CNT);
+    if (wasRegistered) {
+        // The modem has stayed powered since it was last registered in automatic mode
+        LOG(TRACE, "Modem was registered, skipping operator selection");
+        copsState = 0;
+    } else {
+        // EG91NA can get stuck in an COPS? ERROR init loop, retry 2 times.
+        int copsCount = 0;
+        char copsResponse[64] = {};
+        do {
+            auto resp = parser_.sendCommand("AT+COPS?");
+            if (resp.hasNextLine()) {
+                CHECK_PARSER(resp.readLine(copsResponse, sizeof(copsResponse)));
+                CHECK_PARSER(::sscanf(copsResponse, "+COPS: %d", &copsState));
+            }
+            r = CHECK_PARSER(resp.readResult());
+            if (r == AtResponse::OK) {
+                break;
+            } else if (copsCount >= COPS_MAX_RETRY_CNT) {
+                // if max retries are exhausted
+                return SYSTEM_ERROR_AT_RESPONSE_UNEXPECTED;
+            }
+            ++copsCount;
+            HAL_Delay_Milliseconds(2000 * copsCount);
+        } while (copsCount < COPS_MAX_RETRY_CNT);
+    }
 
     if (copsState != 0 && copsState != 1) {
         // Only run AT+COPS=0 if currently de-registered, to avoid PLMN reselection
@@ -1452,7 +1513,9 @@ int QuectelNcpClient::registerNet() {
         // CHECK_TRUE(r == AtResponse::OK, SYSTEM_ERROR_UNKNOWN);
     }
 
-    if (isQuecCatM1Device()) {
+    const auto radioFingerprint = radioConfigFingerprint();
+    const bool radioConfigured = isRadioConfigApplied(radioFingerprint);
+    if (isQuecCatM1Device() && !radioConfigured) {
         if (ncpId() == PLATFORM_NCP_QUECTEL_BG96 || ncpId() == PLATFORM_NCP_QUECTEL_BG95_M5) {
             // NOTE: BG96 supports 2G fallback which we disable explicitly so that a 10W power supply is not required
             // Configure RATs to be searched
@@ -1506,6 +1569,8 @@ int QuectelNcpClient::registerNet() {
             }
         }
     }
+    ModemConfigCache::instance()->setApplied(ncpId(), ModemConfigGroup::RADIO, radioFingerprint);
+
     // Check GSM, GPRS, and LTE network registration status
     CHECK_PARSER_OK(parser_.execCommand("AT+CEREG?"));
     if (isQuecCat1Device() || ncpId() == PLATFORM_NCP_QUECTEL_BG95_M5) {
@@ -1733,6 +1798,11 @@ void QuectelNcpClient::connectionState(NcpConnectionState state) {
     }
     LOG(TRACE, "NCP connection state changed: %d", (int)state);
     connState_ = state;
+    if (state == NcpConnectionState::CONNECTED) {
+        ModemConfigCache::instance()->setRegistered(ncpId(), true);
+    } else if (state == NcpConnectionState::DISCONNECTED) {
+        ModemConfigCache::instance()->setRegistered(ncpId(), false);
+    }
 
     if (connState_ == NcpConnectionState::CONNECTED) {
         inFlowControl_ = false;
@@ -1854,8 +1924,10 @@ int QuectelNcpClient::interveneRegistration() {
                 psd_.reset();
                 eps_.reset();
                 registrationInterventions_++;
+                cfunFull_ = false;
                 CHECK_PARSER_OK(parser_.execCommand(QUECTEL_CFUN_TIMEOUT, "AT+CFUN=0,0"));
                 CHECK_PARSER_OK(parser_.execCommand(QUECTEL_CFUN_TIMEOUT, "AT+CFUN=1,0"));
+                cfunFull_ = true;
                 return 0;
             }
         }
@@ -1867,8 +1939,10 @@ int QuectelNcpClient::interveneRegistration() {
                 psd_.reset();
                 eps_.reset();
                 registrationInterventions_++;
+                cfunFull_ = false;
                 CHECK_PARSER_OK(parser_.execCommand(QUECTEL_CFUN_TIMEOUT, "AT+CFUN=0,0"));
                 CHECK_PARSER_OK(parser_.execCommand(QUECTEL_CFUN_TIMEOUT, "AT+CFUN=1,0"));
+                cfunFull_ = true;
                 return 0;
             }
         }
@@ -1902,8 +1976,10 @@ int QuectelNcpClient::interveneRegistration() {
                 LOG(TRACE, "Sticky EPS denied state for %lu s, RF reset", eps_.duration() / 1000);
                 eps_.reset();
                 registrationInterventions_++;
+                cfunFull_ = false;
                 CHECK_PARSER_OK(parser_.execCommand(QUECTEL_CFUN_TIMEOUT, "AT+CFUN=0,0"));
                 CHECK_PARSER_OK(parser_.execCommand(QUECTEL_CFUN_TIMEOUT, "AT+CFUN=1,0"));
+                cfunFull_ = true;
             }
         }
     }
@@ -1911,6 +1987,36 @@ int QuectelNcpClient::interveneRegistration() {
 }
 
 
+uint32_t QuectelNcpClient::radioConfigFingerprint() const {
+    // The settings themselves are determined by the modem type, the platform and the SIM card slot.
+    // A firmware update may reset the modem's NVM, so the firmware revision is included as well
+    return ModemConfigFingerprint().add(RADIO_CONFIG_VERSION).add(ncpId()).add(PLATFORM_ID)
+            .add((int)conf_.simType()).add(fwRevision_).value();
+}
+
+bool QuectelNcpClient::isRadioConfigApplied(uint32_t fingerprint) {
+    if (!fwRevision_[0] || !ModemConfigCache::instance()->isApplied(ncpId(), ModemConfigGroup::RADIO, fingerprint)) {
+        return false;
+    }
+    // Read back one of the applied settings in case the modem has been reconfigured behind our back
+    if (isQuecCatM1Device()) {
+        auto resp = parser_.sendCommand("AT+CPSMS?");
+        int mode = -1;
+        if (resp.scanf("+CPSMS: %d", &mode) != 1 || resp.readResult() != AtResponse::OK || mode != 0) {
+            LOG(TRACE, "PSM is enabled, reapplying radio settings");
+            return false;
+        }
+    } else if (isQuecCat1Device()) {
+        auto resp = parser_.sendCommand("AT+QDSIM?");
+        int slot = -1;
+        if (resp.scanf("+QDSIM: %d", &slot) != 1 || resp.readResult() != AtResponse::OK || slot != 0) {
+            LOG(TRACE, "SIM slot has changed, reapplying radio settings");
+            return false;
+        }
+    }
+    return true;
+}
+
 int QuectelNcpClient::checkRunningImsi() {
     // Check current IMSI
     if (checkImsi_) {
@@ -1926,7 +2032,9 @@ int QuectelNcpClient::processEventsImpl() {
     checkRegistrationState();
     interveneRegistration();
     checkRunningImsi();
-    if (connState_ != NcpConnectionState::CONNECTING || millis() - regCheckTime_ < REGISTRATION_CHECK_INTERVAL) {
+    // Polling is only a fallback if the modem is known to report the registration status via URCs
+    const auto checkInterval = regUrcSeen_ ? REGISTRATION_URC_CHECK_INTERVAL : REGISTRATION_CHECK_INTERVAL;
+    if (connState_ != NcpConnectionState::CONNECTING || millis() - regCheckTime_ < checkInterval) {
         return SYSTEM_ERROR_NONE;
     }
     SCOPE_GUARD({ regCheckTime_ = millis(); });
@@ -2045,6 +2153,7 @@ int QuectelNcpClient::modemPowerOn() {
         } else if (ncpId() == PLATFORM_NCP_QUECTEL_BG96) {
             powerOffWaitMs = 7900; // BG96
         }
+        ModemConfigCache::instance()->modemReset();
         if (waitModemPowerState(1, powerOffWaitMs)) {
             LOG(TRACE, "Modem powered on");
         } else {
@@ -2064,6 +2173,7 @@ int QuectelNcpClient::modemPowerOn() {
 int QuectelNcpClient::modemPowerOff() {
     if (modemPowerState()) {
         ncpPowerState(NcpPowerState::TRANSIENT_OFF);
+        ModemConfigCache::instance()->modemReset();
 
         LOG(TRACE, "Powering modem off");
 
@@ -2138,6 +2248,7 @@ int QuectelNcpClient::modemSoftPowerOff() {
 
 int QuectelNcpClient::modemHardReset(bool powerOff) {
     LOG(TRACE, "Hard resetting the modem");
+    ModemConfigCache::instance()->modemReset();
 
     if (isQuecBG95xDevice() || ncpId() == PLATFORM_NCP_QUECTEL_BG77) {
         // BG95/BG77 reset, 2s <= reset pulse <= 3.8s
@@ -116,12 +116,16 @@ private:
     unsigned registrationInterventions_;
     volatile bool inFlowControl_ = false;
     bool checkImsi_ = false;
+    bool regUrcSeen_ = false;
+    bool cfunFull_ = false;
     unsigned int fwVersion_ = 0;
+    char fwRevision_[64] = {}; // Modem firmware revision as reported by AT+QGMR
 
     int queryAndParseAtCops(CellularSignalQuality* qual);
     int initParser(Stream* stream);
     int waitReady(bool powerOn = false);
     int getAppFirmwareVersion();
+    int readFirmwareRevision();
     int initReady(ModemState state);
     int checkRuntimeState(ModemState& state);
     int initMuxer();
@@ -144,6 +148,8 @@ private:
     void resetRegistrationState();
     void checkRegistrationState();
     int interveneRegistration();
+    uint32_t radioConfigFingerprint() const;
+    bool isRadioConfigApplied(uint32_t fingerprint);
     int checkRunningImsi();
     int processEventsImpl();
     int getIccidImpl(char* buf, size_t size);
@@ -25,6 +25,7 @@ LOG_SOURCE_CATEGORY("ncp.client");
 #include "at_command.h"
 #include "at_response.h"
 #include "network/ncp/cellular/network_config_db.h"
+#include "network/ncp/cellular/modem_config_cache.h"
 
 #include "serial_stream.h"
 #include "check.h"
@@ -423,6 +424,7 @@ int SaraNcpClient::off() {
     serial_->on(false);
 
     ready_ = false;
+    ModemConfigCache::instance()->modemReset();
     ncpState(NcpState::OFF);
     return SYSTEM_ERROR_NONE;
 }
@@ -2050,15 +2052,24 @@ int SaraNcpClient::registerNet() {
         CHECK_TRUE(r == AtResponse::OK, SYSTEM_ERROR_AT_NOT_OK);
     }
 
+    // Check the registration hint before the connection state changes
+    const bool wasRegistered = ModemConfigCache::instance()->wasRegistered(ncpId());
+
     connectionState(NcpConnectionState::CONNECTING);
     registeredTime_ = 0;
 
-    auto resp = parser_.sendCommand("AT+COPS?");
     int copsState = 2;
-    r = CHECK_PARSER(resp.scanf("+COPS: %d", &copsState));
-    CHECK_TRUE(r == 1, SYSTEM_ERROR_AT_RESPONSE_UNEXPECTED);
-    r = CHECK_PARSER(resp.readResult());
-    CHECK_TRUE(r == AtResponse::OK, SYSTEM_ERROR_AT_NOT_OK);
+    if (wasRegistered) {
+        // The modem has stayed powered since it was last registered in automatic mode
+        LOG(TRACE, "Modem was registered, skipping operator selection");
+        copsState = 0;
+    } else {
+        auto resp = parser_.sendCommand("AT+COPS?");
+        r = CHECK_PARSER(resp.scanf("+COPS: %d", &copsState));
+        CHECK_TRUE(r == 1, SYSTEM_ERROR_AT_RESPONSE_UNEXPECTED);
+        r = CHECK_PARSER(resp.readResult());
+        CHECK_TRUE(r == AtResponse::OK, SYSTEM_ERROR_AT_NOT_OK);
+    }
 
     // NOTE: up to 3 mins (FIXME: there seems to be a bug where this timeout of 3 minutes
     //       is not being respected by u-blox modems.  Setting to 5 for now.)
@@ -2307,6 +2318,11 @@ void SaraNcpClient::connectionState(NcpConnectionState state) {
     }
     LOG(TRACE, "NCP connection state changed: %d", (int)state);
     connState_ = state;
+    if (state == NcpConnectionState::CONNECTED) {
+        ModemConfigCache::instance()->setRegistered(ncpId(), true);
+    } else if (state == NcpConnectionState::DISCONNECTED) {
+        ModemConfigCache::instance()->setRegistered(ncpId(), false);
+    }
 
     if (ncpId() == PLATFORM_NCP_SARA_R510) {
         if (connState_ == NcpConnectionState::CONNECTED || connState_ == NcpConnectionState::DISCONNECTED) {
@@ -2627,6 +2643,7 @@ int SaraNcpClient::modemPowerOn() {
             }
         }
 
+        ModemConfigCache::instance()->modemReset();
         // Verify that the module was powered up by checking the VINT pin up to 1 sec
         if (waitModemPowerState(1, 1000)) {
             LOG(TRACE, "Powered on");
@@ -2669,6 +2686,7 @@ int SaraNcpClient::modemPowerOff() {
 
     if (modemPowerState()) {
         ncpPowerState(NcpPowerState::TRANSIENT_OFF);
+        ModemConfigCache::instance()->modemReset();
 
         LOG(TRACE, "Powering off using hardware control");
         // Important! We need to disable voltage translator here
@@ -2780,6 +2798,7 @@ int SaraNcpClient::modemHardReset(bool powerOff) {
     }
 
     LOG(TRACE, "Hard reset");
+    ModemConfigCache::instance()->modemReset();
     if (ncpId() == PLATFORM_NCP_SARA_U201) {
         // Low pulse for 50ms
         hal_gpio_write(UBRST, 0);
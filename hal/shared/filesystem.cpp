@@ -24,9 +24,59 @@
 #include "system_error.h"
 #include "file_util.h"
 #include "scope_guard.h"
+#include "trace.h"
+
+#if MODULE_FUNCTION != MOD_FUNC_BOOTLOADER
+#include "spark_wiring_diagnostics.h"
+#include "timer_hal.h"
+#endif /* MODULE_FUNCTION != MOD_FUNC_BOOTLOADER */
 
 using namespace particle::fs;
 
+namespace {
+
+#if MODULE_FUNCTION != MOD_FUNC_BOOTLOADER
+// Time in microseconds it takes to write data to the flash
+particle::HistogramDiagnosticData<> g_flashWriteTime(DIAG_ID_FILESYSTEM_FLASH_WRITE_TIME, DIAG_NAME_FILESYSTEM_FLASH_WRITE_TIME);
+#endif /* MODULE_FUNCTION != MOD_FUNC_BOOTLOADER */
+
+int fs_write_flash(filesystem_t* fs, uintptr_t addr, const uint8_t* data, size_t size) {
+    ++fs->stats.flash_write_count;
+#if MODULE_FUNCTION != MOD_FUNC_BOOTLOADER
+    const auto t = HAL_Timer_Get_Micro_Seconds();
+    int r = hal_exflash_write(addr, data, size);
+    g_flashWriteTime.record(HAL_Timer_Get_Micro_Seconds() - t);
+#else
+    int r = hal_exflash_write(addr, data, size);
+#endif /* MODULE_FUNCTION != MOD_FUNC_BOOTLOADER */
+    if (r) {
+        LOG_DEBUG(ERROR, "fs_prog error %d", r);
+    }
+    return r;
+}
+
+#if FILESYSTEM_WRITE_COMBINE_SIZE > 0
+
+int fs_flush_write_cache(filesystem_t* fs) {
+    auto& wc = fs->write_cache;
+    if (!wc.size) {
+        return 0;
+    }
+    // Drop the buffered data even if writing it fails, littlefs will handle the error
+    size_t size = wc.size;
+    wc.size = 0;
+    return fs_write_flash(fs, wc.addr, wc.data, size);
+}
+
+inline bool fs_write_cache_overlaps(const filesystem_t* fs, uintptr_t addr, size_t size) {
+    auto& wc = fs->write_cache;
+    return wc.size && addr < wc.addr + wc.size && wc.addr < addr + size;
+}
+
+#endif /* FILESYSTEM_WRITE_COMBINE_SIZE > 0 */
+
+} /* anonymous */
+
 #if MODULE_FUNCTION != MOD_FUNC_BOOTLOADER
 
 #include "static_recursive_mutex.h"
@@ -38,13 +88,28 @@ static StaticRecursiveMutex s_lfs_mutex;
 } /* anonymous */
 
 int filesystem_lock(filesystem_t* fs) {
-    (void)fs;
-    return !s_lfs_mutex.lock();
+    int r = !s_lfs_mutex.lock();
+#if FILESYSTEM_WRITE_COMBINE_SIZE > 0
+    if (!r && fs) {
+        ++fs->lock_count;
+    }
+#endif /* FILESYSTEM_WRITE_COMBINE_SIZE > 0 */
+    return r;
 }
 
 int filesystem_unlock(filesystem_t* fs) {
-    (void)fs;
-    return !s_lfs_mutex.unlock();
+    int r = 0;
+#if FILESYSTEM_WRITE_COMBINE_SIZE > 0
+    // Make sure everything written by the lock owner is stored in flash before other threads are
+    // allowed to access the filesystem. A flush error is reported to the lock owner
+    if (fs && fs->lock_count > 0 && --fs->lock_count == 0) {
+        r = fs_flush_write_cache(fs);
+    }
+#endif /* FILESYSTEM_WRITE_COMBINE_SIZE > 0 */
+    if (!s_lfs_mutex.unlock() && !r) {
+        r = 1;
+    }
+    return r;
 }
 
 #else
@@ -67,10 +132,23 @@ namespace {
 int fs_read(const struct lfs_config* c, lfs_block_t block,
             lfs_off_t off, void* buffer, lfs_size_t size)
 {
-    if (!((filesystem_t*)c->context)->state) {
+    TRACE_SCOPE("fs:read");
+    auto fs = (filesystem_t*)c->context;
+    if (!fs->state) {
         return SYSTEM_ERROR_INVALID_STATE;
     }
-    int r = hal_exflash_read((block + ((filesystem_t*)c->context)->first_block) * c->block_size + off, (uint8_t*)buffer, size);
+    uintptr_t addr = (block + fs->first_block) * c->block_size + off;
+#if FILESYSTEM_WRITE_COMBINE_SIZE > 0
+    if (fs_write_cache_overlaps(fs, addr, size)) {
+        int r = fs_flush_write_cache(fs);
+        if (r) {
+            return r;
+        }
+    }
+#endif /* FILESYSTEM_WRITE_COMBINE_SIZE > 0 */
+    int r = hal_exflash_read(addr, (uint8_t*)buffer, size);
+    ++fs->stats.read_count;
+    fs->stats.read_bytes += size;
     if (r) {
         LOG_DEBUG(ERROR, "fs_read error %d", r);
     }
@@ -80,22 +158,53 @@ int fs_read(const struct lfs_config* c, lfs_block_t block,
 int fs_prog(const struct lfs_config* c, lfs_block_t block,
             lfs_off_t off, const void* buffer, lfs_size_t size)
 {
-    if (!((filesystem_t*)c->context)->state) {
+    TRACE_SCOPE("fs:prog");
+    auto fs = (filesystem_t*)c->context;
+    if (!fs->state) {
         return SYSTEM_ERROR_INVALID_STATE;
     }
-    int r = hal_exflash_write((block + ((filesystem_t*)c->context)->first_block) * c->block_size + off, (const uint8_t*)buffer, size);
-    if (r) {
-        LOG_DEBUG(ERROR, "fs_prog error %d", r);
+    uintptr_t addr = (block + fs->first_block) * c->block_size + off;
+    ++fs->stats.prog_count;
+    fs->stats.prog_bytes += size;
+#if FILESYSTEM_WRITE_COMBINE_SIZE > 0
+    auto& wc = fs->write_cache;
+    if (wc.size && (addr != wc.addr + wc.size || wc.size + size > sizeof(wc.data))) {
+        // Not contiguous with the buffered data or doesn't fit
+        int r = fs_flush_write_cache(fs);
+        if (r) {
+            return r;
+        }
     }
-    return r;
+    if (size <= sizeof(wc.data)) {
+        if (!wc.size) {
+            wc.addr = addr;
+        }
+        memcpy(wc.data + wc.size, buffer, size);
+        wc.size += size;
+        return 0;
+    }
+#endif /* FILESYSTEM_WRITE_COMBINE_SIZE > 0 */
+    return fs_write_flash(fs, addr, (const uint8_t*)buffer, size);
 }
 
 int fs_erase(const struct lfs_config* c, lfs_block_t block)
 {
-    if (!((filesystem_t*)c->context)->state) {
+    TRACE_SCOPE("fs:erase");
+    auto fs = (filesystem_t*)c->context;
+    if (!fs->state) {
         return SYSTEM_ERROR_INVALID_STATE;
     }
-    int r = hal_exflash_erase_sector((block + ((filesystem_t*)c->context)->first_block) * c->block_size, 1);
+    uintptr_t addr = (block + fs->first_block) * c->block_size;
+    int r = 0;
+#if FILESYSTEM_WRITE_COMBINE_SIZE > 0
+    // Preserve the order of the flash operations
+    r = fs_flush_write_cache(fs);
+    if (r) {
+        return r;
+    }
+#endif /* FILESYSTEM_WRITE_COMBINE_SIZE > 0 */
+    r = hal_exflash_erase_sector(addr, 1);
+    ++fs->stats.erase_count;
     if (r) {
         LOG_DEBUG(ERROR, "fs_erase error %d", r);
     }
@@ -104,7 +213,12 @@ int fs_erase(const struct lfs_config* c, lfs_block_t block)
 
 int fs_sync(const struct lfs_config *c)
 {
+    TRACE_SCOPE("fs:sync");
+#if FILESYSTEM_WRITE_COMBINE_SIZE > 0
+    return fs_flush_write_cache((filesystem_t*)c->context);
+#else
     return 0;
+#endif /* FILESYSTEM_WRITE_COMBINE_SIZE > 0 */
 }
 
 #ifdef DEBUG_BUILD
@@ -332,7 +446,13 @@ int filesystem_unmount(filesystem_t* fs) {
     int ret = 0;
 
     if (fs->state) {
-        ret = lfs_unmount(&fs->instance);
+#if FILESYSTEM_WRITE_COMBINE_SIZE > 0
+        ret = fs_flush_write_cache(fs);
+#endif /* FILESYSTEM_WRITE_COMBINE_SIZE > 0 */
+        int r = lfs_unmount(&fs->instance);
+        if (!ret) {
+            ret = r;
+        }
         fs->state = false;
         // This should not be required as storage read/write/erase are gated
         // by fs->state, but just in case invalidate at least files.
@@ -428,6 +548,36 @@ int filesystem_dump_info(filesystem_t* fs) {
     return 0;
 }
 
+int filesystem_get_stats(filesystem_t* fs, filesystem_stats_t* stats) {
+    if (!fs || !stats) {
+        return SYSTEM_ERROR_INVALID_ARGUMENT;
+    }
+    FsLock lk(fs);
+    *stats = fs->stats;
+    return 0;
+}
+
+int filesystem_reset_stats(filesystem_t* fs) {
+    if (!fs) {
+        return SYSTEM_ERROR_INVALID_ARGUMENT;
+    }
+    FsLock lk(fs);
+    fs->stats = {};
+    return 0;
+}
+
+int filesystem_flush(filesystem_t* fs) {
+    if (!fs) {
+        return SYSTEM_ERROR_INVALID_ARGUMENT;
+    }
+#if FILESYSTEM_WRITE_COMBINE_SIZE > 0
+    FsLock lk(fs);
+    return fs_flush_write_cache(fs);
+#else
+    return 0;
+#endif /* FILESYSTEM_WRITE_COMBINE_SIZE > 0 */
+}
+
 int filesystem_to_system_error(int error) {
     switch (error) {
     case LFS_ERR_OK: return SYSTEM_ERROR_NONE;
@@ -25,6 +25,15 @@
 #include <lfs_util.h>
 #include <lfs.h>
 
+#if MODULE_FUNCTION == MOD_FUNC_BOOTLOADER
+#undef FILESYSTEM_WRITE_COMBINE_SIZE
+#define FILESYSTEM_WRITE_COMBINE_SIZE (0)
+#endif /* MODULE_FUNCTION == MOD_FUNC_BOOTLOADER */
+
+#ifndef FILESYSTEM_WRITE_COMBINE_SIZE
+#define FILESYSTEM_WRITE_COMBINE_SIZE (0)
+#endif /* FILESYSTEM_WRITE_COMBINE_SIZE */
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -34,6 +43,30 @@ typedef enum filesystem_instance_t {
     FILESYSTEM_INSTANCE_ASSET_STORAGE = 1
 } filesystem_instance_t;
 
+typedef struct filesystem_stats_t {
+    uint32_t read_count; // Number of block read operations
+    uint32_t prog_count; // Number of block program operations
+    uint32_t erase_count; // Number of block erase operations
+    uint32_t read_bytes; // Number of bytes read
+    uint32_t prog_bytes; // Number of bytes programmed
+    uint32_t flash_write_count; // Number of write operations issued to the flash device
+} filesystem_stats_t;
+
+#if FILESYSTEM_WRITE_COMBINE_SIZE > 0
+/*
+ * Adjacent block programs are accumulated in this buffer and written to the flash device in one
+ * operation. The buffer is flushed before any read or erase that may observe its contents, on sync,
+ * and when the outermost filesystem lock is released, so that littlefs' commit ordering and the
+ * durability of completed operations are preserved. An error that occurs when the buffer is flushed
+ * on unlock is returned by filesystem_unlock().
+ */
+typedef struct filesystem_write_cache_t {
+    uint8_t data[FILESYSTEM_WRITE_COMBINE_SIZE] __attribute__((aligned(4)));
+    uintptr_t addr; // Flash address of the first buffered byte
+    size_t size; // Number of buffered bytes
+} filesystem_write_cache_t;
+#endif /* FILESYSTEM_WRITE_COMBINE_SIZE > 0 */
+
 /* FIXME */
 typedef struct filesystem_t {
     uint16_t version;
@@ -53,6 +86,13 @@ typedef struct filesystem_t {
 
     filesystem_instance_t index;
     uintptr_t first_block;
+
+    filesystem_stats_t stats;
+
+#if FILESYSTEM_WRITE_COMBINE_SIZE > 0
+    filesystem_write_cache_t write_cache;
+    int lock_count;
+#endif /* FILESYSTEM_WRITE_COMBINE_SIZE > 0 */
 } filesystem_t;
 
 int filesystem_mount(filesystem_t* fs);
@@ -66,6 +106,10 @@ int filesystem_unlock(filesystem_t* fs);
 
 int filesystem_to_system_error(int error);
 
+int filesystem_get_stats(filesystem_t* fs, filesystem_stats_t* stats);
+int filesystem_reset_stats(filesystem_t* fs);
+int filesystem_flush(filesystem_t* fs);
+
 #ifdef __cplusplus
 } // extern "C"
 
@@ -94,8 +138,8 @@ struct FsLock {
         filesystem_lock(fs_);
     }
 
-    void unlock() {
-        filesystem_unlock(fs_);
+    int unlock() {
+        return filesystem_unlock(fs_);
     }
 
     // TODO: Rename this method to avoid confusion with filesystem_get_instance()
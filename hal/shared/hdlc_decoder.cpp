@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hdlc_decoder.h"
+
+#include "endian_util.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace particle {
+
+namespace {
+
+// Slicing-by-4 lookup tables for the 16-bit FCS. The first table is the one from RFC 1662
+struct FcsTables {
+    uint16_t t[4][256];
+};
+
+constexpr FcsTables makeFcsTables() {
+    FcsTables tbl = {};
+    for (unsigned i = 0; i < 256; ++i) {
+        unsigned v = i;
+        for (unsigned j = 0; j < 8; ++j) {
+            v = (v & 1) ? (v >> 1) ^ 0x8408 : (v >> 1);
+        }
+        tbl.t[0][i] = v;
+    }
+    for (unsigned k = 1; k < 4; ++k) {
+        for (unsigned i = 0; i < 256; ++i) {
+            const unsigned v = tbl.t[k - 1][i];
+            tbl.t[k][i] = (v >> 8) ^ tbl.t[0][v & 0xff];
+        }
+    }
+    return tbl;
+}
+
+constexpr FcsTables FCS_TABLES = makeFcsTables();
+
+inline uint16_t fcsByte(uint16_t fcs, uint8_t b) {
+    return (fcs >> 8) ^ FCS_TABLES.t[0][(fcs ^ b) & 0xff];
+}
+
+// Updates the FCS with 4 bytes of data in their on-the-wire order
+inline uint16_t fcsWord(uint16_t fcs, uint32_t w) {
+    const uint32_t x = fcs ^ littleEndianToNative(w);
+    return FCS_TABLES.t[3][x & 0xff] ^ FCS_TABLES.t[2][(x >> 8) & 0xff] ^ FCS_TABLES.t[1][(x >> 16) & 0xff] ^
+            FCS_TABLES.t[0][x >> 24];
+}
+
+// Returns a non-zero value if any of the bytes in the word is zero
+inline uint32_t hasZeroByte(uint32_t w) {
+    return (w - 0x01010101u) & ~w & 0x80808080u;
+}
+
+// Returns true if the word may contain a byte that needs special handling. If `ctrl` is true, any
+// control character is reported, and the caller checks it against the map byte by byte
+inline bool hasSpecialByte(uint32_t w, bool ctrl) {
+    uint32_t r = hasZeroByte(w ^ 0x7e7e7e7eu) | hasZeroByte(w ^ 0x7d7d7d7du);
+    if (ctrl) {
+        r |= (w - 0x20202020u) & ~w & 0x80808080u; // Any byte less than 0x20
+    }
+    return r;
+}
+
+} // namespace
+
+const uint8_t HdlcDecoder::FLAG;
+const uint8_t HdlcDecoder::ESCAPE;
+const uint8_t HdlcDecoder::TRANS;
+const size_t HdlcDecoder::FCS_SIZE;
+const uint16_t HdlcDecoder::INIT_FCS;
+const uint16_t HdlcDecoder::GOOD_FCS;
+
+HdlcDecoder::HdlcDecoder(Handler* handler) :
+        handler_(handler),
+        buf_(nullptr),
+        bufSize_(0),
+        bufOffs_(0),
+        frameSize_(0),
+        maxFrameSize_(0),
+        accm_(0xffffffff),
+        fcs_(INIT_FCS),
+        state_(State::HUNT),
+        escaped_(false) {
+}
+
+void HdlcDecoder::decode(const uint8_t* data, size_t size) {
+    auto p = data;
+    const auto end = data + size;
+    while (p < end) {
+        if (state_ == State::HUNT) {
+            const auto flag = (const uint8_t*)std::memchr(p, FLAG, end - p);
+            if (!flag) {
+                break;
+            }
+            p = flag + 1;
+            startFrame();
+            continue;
+        }
+        if (!escaped_) {
+            p += copyRun(p, end - p);
+            if (p == end) {
+                break;
+            }
+        }
+        // The next byte either needs special handling or doesn't fit in the current buffer
+        const uint8_t c = *p++;
+        if (c == FLAG) {
+            if (escaped_) {
+                // An escaped flag sequence aborts the frame (RFC 1662, 4.2)
+                dropFrame(HdlcFrameError::ABORTED);
+            } else {
+                endFrame();
+            }
+            startFrame();
+        } else if (c == ESCAPE) {
+            escaped_ = true;
+        } else if (c < 0x20 && (accm_ & (1u << c))) {
+            // Control characters from the map may have been inserted by the DCE and are discarded
+        } else if (escaped_) {
+            escaped_ = false;
+            put(c ^ TRANS);
+        } else {
+            put(c);
+        }
+    }
+}
+
+void HdlcDecoder::reset() {
+    dropFrame(HdlcFrameError::ABORTED);
+}
+
+uint16_t HdlcDecoder::fcs(uint16_t fcs, const uint8_t* data, size_t size) {
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4) {
+        uint32_t w;
+        std::memcpy(&w, data + i, 4);
+        fcs = fcsWord(fcs, w);
+    }
+    for (; i < size; ++i) {
+        fcs = fcsByte(fcs, data[i]);
+    }
+    return fcs;
+}
+
+size_t HdlcDecoder::copyRun(const uint8_t* data, size_t size) {
+    size_t n = std::min(size, bufSize_ - bufOffs_);
+    if (maxFrameSize_) {
+        n = std::min(n, maxFrameSize_ - frameSize_);
+    }
+    const auto dest = buf_ + bufOffs_;
+    const bool ctrl = accm_ != 0;
+    auto fcs = fcs_;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        uint32_t w;
+        std::memcpy(&w, data + i, 4);
+        if (hasSpecialByte(w, ctrl)) {
+            break;
+        }
+        std::memcpy(dest + i, &w, 4);
+        fcs = fcsWord(fcs, w);
+    }
+    for (; i < n; ++i) {
+        const uint8_t c = data[i];
+        if (isSpecial(c)) {
+            break;
+        }
+        dest[i] = c;
+        fcs = fcsByte(fcs, c);
+    }
+    fcs_ = fcs;
+    bufOffs_ += i;
+    frameSize_ += i;
+    return i;
+}
+
+void HdlcDecoder::put(uint8_t c) {
+    if (maxFrameSize_ && frameSize_ >= maxFrameSize_) {
+        dropFrame(HdlcFrameError::TOO_LONG);
+        return;
+    }
+    if (bufOffs_ == bufSize_) {
+        size_t size = 0;
+        const auto buf = handler_->frameBuffer(&size);
+        if (!buf || !size) {
+            dropFrame(HdlcFrameError::NO_MEMORY);
+            return;
+        }
+        buf_ = buf;
+        bufSize_ = size;
+        bufOffs_ = 0;
+    }
+    buf_[bufOffs_++] = c;
+    ++frameSize_;
+    fcs_ = fcsByte(fcs_, c);
+}
+
+void HdlcDecoder::startFrame() {
+    buf_ = nullptr;
+    bufSize_ = 0;
+    bufOffs_ = 0;
+    frameSize_ = 0;
+    fcs_ = INIT_FCS;
+    escaped_ = false;
+    state_ = State::FRAME;
+}
+
+void HdlcDecoder::endFrame() {
+    if (!frameSize_) {
+        return; // Consecutive flag sequences
+    }
+    if (frameSize_ <= FCS_SIZE) {
+        dropFrame(HdlcFrameError::TOO_SHORT);
+    } else if (fcs_ != GOOD_FCS) {
+        dropFrame(HdlcFrameError::BAD_FCS);
+    } else {
+        handler_->frameReceived(frameSize_, bufOffs_);
+    }
+}
+
+void HdlcDecoder::dropFrame(HdlcFrameError error) {
+    // The handler only needs to know about the frames it has provided the buffers for
+    if (frameSize_) {
+        handler_->frameError(error);
+    }
+    startFrame();
+    state_ = State::HUNT;
+}
+
+bool HdlcDecoder::isSpecial(uint8_t c) const {
+    return c == FLAG || c == ESCAPE || (c < 0x20 && (accm_ & (1u << c)));
+}
+
+} // particle
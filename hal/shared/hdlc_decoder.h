@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace particle {
+
+/**
+ * Reasons for discarding a received frame.
+ */
+enum class HdlcFrameError {
+    TOO_SHORT, ///< The frame is shorter than the FCS.
+    TOO_LONG, ///< The frame exceeds the maximum frame size.
+    BAD_FCS, ///< The frame check sequence is invalid.
+    NO_MEMORY, ///< No buffer is available for the frame data.
+    ABORTED ///< The frame has been aborted by the sender or the decoder has been reset.
+};
+
+/**
+ * Decoder for the HDLC-like framing used by PPP in asynchronous mode (RFC 1662).
+ *
+ * The decoder removes the flag sequences and the control escapes, verifies the 16-bit FCS and
+ * writes the contents of the frames directly into the buffers provided by the handler. Runs of
+ * bytes that don't need unescaping are processed a word at a time.
+ */
+class HdlcDecoder {
+public:
+    static const uint8_t FLAG = 0x7e;
+    static const uint8_t ESCAPE = 0x7d;
+    static const uint8_t TRANS = 0x20;
+    static const size_t FCS_SIZE = 2;
+
+    /**
+     * Handler for the decoded frames.
+     */
+    class Handler {
+    public:
+        /**
+         * Returns a buffer for the next part of the current frame.
+         *
+         * The buffer returned previously for the same frame, if any, has been filled completely.
+         * If no buffer is available, the handler returns `nullptr` and the frame is discarded.
+         *
+         * @param[out] size Buffer size.
+         * @return Buffer.
+         */
+        virtual uint8_t* frameBuffer(size_t* size) = 0;
+        /**
+         * Called when a frame with a valid FCS has been received.
+         *
+         * @param size Total size of the frame data, including the FCS.
+         * @param lastSize Number of bytes written to the last buffer.
+         */
+        virtual void frameReceived(size_t size, size_t lastSize) = 0;
+        /**
+         * Called when the current frame is discarded. The handler releases the buffers allocated
+         * for the frame.
+         */
+        virtual void frameError(HdlcFrameError error) = 0;
+
+    protected:
+        ~Handler() = default;
+    };
+
+    explicit HdlcDecoder(Handler* handler);
+
+    /**
+     * Decodes the received data.
+     */
+    void decode(const uint8_t* data, size_t size);
+
+    /**
+     * Discards the frame that is being received, if any, and waits for the next flag sequence.
+     */
+    void reset();
+
+    /**
+     * Sets the receive async control character map. The control characters whose bits are set
+     * are discarded if they are received unescaped.
+     */
+    void accm(uint32_t accm) {
+        accm_ = accm;
+    }
+
+    uint32_t accm() const {
+        return accm_;
+    }
+
+    /**
+     * Sets the maximum size of a frame, including the FCS. 0 means no limit.
+     */
+    void maxFrameSize(size_t size) {
+        maxFrameSize_ = size;
+    }
+
+    size_t maxFrameSize() const {
+        return maxFrameSize_;
+    }
+
+    /**
+     * Returns `true` if a flag sequence has just been received and no frame data followed it.
+     */
+    bool atFrameBoundary() const {
+        return state_ == State::FRAME && !frameSize_ && !escaped_;
+    }
+
+    /**
+     * Computes the FCS of the data (RFC 1662, appendix C.2).
+     *
+     * @param fcs Initial value.
+     * @param data Data.
+     * @param size Data size.
+     * @return FCS.
+     */
+    static uint16_t fcs(uint16_t fcs, const uint8_t* data, size_t size);
+
+    static const uint16_t INIT_FCS = 0xffff;
+    static const uint16_t GOOD_FCS = 0xf0b8;
+
+private:
+    enum class State {
+        HUNT, // Waiting for a flag sequence
+        FRAME // Receiving a frame
+    };
+
+    Handler* handler_;
+    uint8_t* buf_;
+    size_t bufSize_;
+    size_t bufOffs_;
+    size_t frameSize_;
+    size_t maxFrameSize_;
+    uint32_t accm_;
+    uint16_t fcs_;
+    State state_;
+    bool escaped_;
+
+    size_t copyRun(const uint8_t* data, size_t size);
+    void put(uint8_t c);
+    void startFrame();
+    void endFrame();
+    void dropFrame(HdlcFrameError error);
+    bool isSpecial(uint8_t c) const;
+};
+
+} // particle
@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hal_platform.h"
+
+#if HAL_PLATFORM_COMPRESSED_OTA
+
+#include "lz_decompress.h"
+
+#include "system_error.h"
+
+#include <algorithm>
+#include <memory>
+#include <cstring>
+
+namespace {
+
+enum State {
+    TOKEN,
+    LITERAL_COUNT,
+    LITERALS,
+    OFFSET_LOW,
+    OFFSET_HIGH,
+    MATCH_LENGTH,
+    MATCH,
+    DONE
+};
+
+} // namespace
+
+struct lz_decompress_ctx {
+    std::unique_ptr<char[]> buf; // Window and output buffer
+    size_t buf_size;
+    size_t pos; // Write position in the buffer
+    size_t pending; // Number of decoded bytes that haven't been passed to the output callback
+    size_t total; // Total number of decoded bytes, up to the window size
+    size_t count; // Remaining number of literal or match bytes
+    size_t offset; // Match offset
+    lz_decompress_output output;
+    void* user_data;
+    int result;
+    State state;
+};
+
+namespace {
+
+// Pass pending data to the output callback
+int flushOutput(lz_decompress_ctx* ctx) {
+    while (ctx->pending > 0) {
+        const size_t start = (ctx->pos - ctx->pending) & (ctx->buf_size - 1);
+        const size_t n = std::min(ctx->pending, ctx->buf_size - start);
+        const int r = ctx->output(ctx->buf.get() + start, n, ctx->user_data);
+        if (r < 0) {
+            return r;
+        }
+        if ((size_t)r > n) {
+            return SYSTEM_ERROR_OUT_OF_RANGE;
+        }
+        ctx->pending -= r;
+        if ((size_t)r < n) {
+            break;
+        }
+    }
+    return 0;
+}
+
+void putBytes(lz_decompress_ctx* ctx, size_t n) {
+    ctx->pos = (ctx->pos + n) & (ctx->buf_size - 1);
+    ctx->pending += n;
+    ctx->total = std::min(ctx->total + n, ctx->buf_size);
+}
+
+// Decode as much data as possible without overwriting pending output. Returns the number of bytes
+// consumed or a negative result code in case of an error
+int decode(lz_decompress_ctx* ctx, const uint8_t* data, size_t size) {
+    const auto bufSize = ctx->buf_size;
+    const auto buf = ctx->buf.get();
+    size_t offs = 0;
+    while (offs < size && ctx->pending < bufSize) {
+        switch (ctx->state) {
+        case TOKEN: {
+            const unsigned t = data[offs++];
+            ctx->count = t >> 4;
+            ctx->offset = t & 0x0f; // Keep the match length until the offset is decoded
+            if (ctx->count == 0x0f) {
+                ctx->state = LITERAL_COUNT;
+            } else if (ctx->count > 0) {
+                ctx->state = LITERALS;
+            } else {
+                ctx->state = OFFSET_LOW;
+            }
+            break;
+        }
+        case LITERAL_COUNT: {
+            const unsigned b = data[offs++];
+            ctx->count += b;
+            if (b != 0xff) {
+                ctx->state = LITERALS;
+            }
+            break;
+        }
+        case LITERALS: {
+            const size_t n = std::min({ ctx->count, size - offs, bufSize - ctx->pending, bufSize - ctx->pos });
+            memcpy(buf + ctx->pos, data + offs, n);
+            offs += n;
+            putBytes(ctx, n);
+            ctx->count -= n;
+            if (!ctx->count) {
+                ctx->state = OFFSET_LOW;
+            }
+            break;
+        }
+        case OFFSET_LOW: {
+            ctx->count = ctx->offset; // Match length
+            ctx->offset = data[offs++];
+            ctx->state = OFFSET_HIGH;
+            break;
+        }
+        case OFFSET_HIGH: {
+            ctx->offset |= (size_t)data[offs++] << 8;
+            if (!ctx->offset) {
+                if (ctx->count) {
+                    return SYSTEM_ERROR_BAD_DATA;
+                }
+                ctx->state = DONE;
+                return offs;
+            }
+            if (ctx->offset > ctx->total) {
+                return SYSTEM_ERROR_BAD_DATA;
+            }
+            if (ctx->count == 0x0f) {
+                ctx->state = MATCH_LENGTH;
+            } else {
+                ctx->state = MATCH;
+            }
+            ctx->count += LZ_MIN_MATCH;
+            break;
+        }
+        case MATCH_LENGTH: {
+            const unsigned b = data[offs++];
+            ctx->count += b;
+            if (b != 0xff) {
+                ctx->state = MATCH;
+            }
+            break;
+        }
+        case MATCH: {
+            // The match may need to be copied in several steps if it wraps around the end of the buffer
+            // or if there's not enough room for it
+            do {
+                const size_t src = (ctx->pos - ctx->offset) & (bufSize - 1);
+                size_t n = std::min({ ctx->count, bufSize - ctx->pending, bufSize - ctx->pos, bufSize - src });
+                if (!n) {
+                    break;
+                }
+                if (ctx->offset >= n) {
+                    memmove(buf + ctx->pos, buf + src, n);
+                } else {
+                    // Overlapping match, e.g. a run of repeated bytes
+                    for (size_t i = 0; i < n; ++i) {
+                        buf[ctx->pos + i] = buf[src + i];
+                    }
+                }
+                putBytes(ctx, n);
+                ctx->count -= n;
+            } while (ctx->count > 0);
+            if (!ctx->count) {
+                ctx->state = TOKEN;
+            }
+            break;
+        }
+        default:
+            return SYSTEM_ERROR_INVALID_STATE;
+        }
+    }
+    return offs;
+}
+
+} // namespace
+
+int lz_decompress_create(lz_decompress_ctx** ctx, const lz_decompress_opts* opts, lz_decompress_output output,
+        void* user_data) {
+    if (!ctx || !output) {
+        return SYSTEM_ERROR_INVALID_ARGUMENT;
+    }
+    unsigned windowBits = LZ_DEFAULT_WINDOW_BITS;
+    if (opts && opts->window_bits) {
+        if (opts->window_bits < LZ_MIN_WINDOW_BITS || opts->window_bits > LZ_MAX_WINDOW_BITS) {
+            return SYSTEM_ERROR_INVALID_ARGUMENT;
+        }
+        windowBits = opts->window_bits;
+    }
+    std::unique_ptr<lz_decompress_ctx> c(new(std::nothrow) lz_decompress_ctx());
+    if (!c) {
+        return SYSTEM_ERROR_NO_MEMORY;
+    }
+    c->buf_size = 1 << windowBits;
+    c->buf.reset(new(std::nothrow) char[c->buf_size]);
+    if (!c->buf) {
+        return SYSTEM_ERROR_NO_MEMORY;
+    }
+    c->output = output;
+    c->user_data = user_data;
+    lz_decompress_reset(c.get());
+    *ctx = c.release();
+    return 0;
+}
+
+void lz_decompress_destroy(lz_decompress_ctx* ctx) {
+    delete ctx;
+}
+
+int lz_decompress_reset(lz_decompress_ctx* ctx) {
+    ctx->pos = 0;
+    ctx->pending = 0;
+    ctx->total = 0;
+    ctx->count = 0;
+    ctx->offset = 0;
+    ctx->result = LZ_DECOMPRESS_NEEDS_MORE_INPUT;
+    ctx->state = TOKEN;
+    return 0;
+}
+
+int lz_decompress_input(lz_decompress_ctx* ctx, const char* data, size_t* size, unsigned flags) {
+    if (ctx->result <= 0) { // LZ_DECOMPRESS_DONE or an error
+        return SYSTEM_ERROR_INVALID_STATE;
+    }
+    size_t offs = 0;
+    for (;;) {
+        // Flush the output when the buffer is full, all input is consumed or the stream has ended
+        if (ctx->pending > 0 && (ctx->pending == ctx->buf_size || offs == *size || ctx->state == DONE)) {
+            const int r = flushOutput(ctx);
+            if (r < 0) {
+                ctx->result = r;
+                break;
+            }
+            if (ctx->pending > 0) {
+                ctx->result = LZ_DECOMPRESS_HAS_MORE_OUTPUT;
+                break;
+            }
+        }
+        if (ctx->state == DONE) {
+            // Similarly to inflate_input(), the caller is not allowed to provide more data than necessary
+            ctx->result = (offs < *size) ? (int)SYSTEM_ERROR_BAD_DATA : (int)LZ_DECOMPRESS_DONE;
+            break;
+        }
+        if (offs == *size) {
+            ctx->result = (flags & LZ_DECOMPRESS_HAS_MORE_INPUT) ? (int)LZ_DECOMPRESS_NEEDS_MORE_INPUT :
+                    (int)SYSTEM_ERROR_BAD_DATA;
+            break;
+        }
+        const int r = decode(ctx, (const uint8_t*)data + offs, *size - offs);
+        if (r < 0) {
+            ctx->result = r;
+            break;
+        }
+        offs += r;
+    }
+    if (ctx->result >= 0) {
+        *size = offs;
+    }
+    return ctx->result;
+}
+
+#endif // HAL_PLATFORM_COMPRESSED_OTA
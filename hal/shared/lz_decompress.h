@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Decoder for the small-window LZ format used by compressed modules (MODULE_COMPRESSION_METHOD_LZ).
+ *
+ * The compressed data is a sequence of blocks of the following format:
+ *
+ *   token           Literal count in the upper 4 bits, match length minus LZ_MIN_MATCH in the lower 4 bits
+ *   [lit_ext...]    Present if the literal count is 15: bytes added to the count, terminated by a byte < 255
+ *   [literals...]   Literal bytes
+ *   offset          Match offset, 16-bit little-endian. A zero offset terminates the stream
+ *   [match_ext...]  Present if the match length field is 15, same encoding as the literal count
+ *
+ * The match offset cannot exceed the window size, so the decoder only needs a RAM buffer of
+ * (1 << window_bits) bytes, which also serves as its output buffer.
+ */
+
+#define LZ_MIN_WINDOW_BITS 8
+#define LZ_MAX_WINDOW_BITS 15
+#define LZ_DEFAULT_WINDOW_BITS 12
+
+#define LZ_MIN_MATCH 4
+
+typedef struct lz_decompress_ctx lz_decompress_ctx;
+
+typedef int (*lz_decompress_output)(const char* data, size_t size, void* user_data);
+
+typedef enum lz_decompress_result {
+    LZ_DECOMPRESS_DONE = 0,
+    LZ_DECOMPRESS_NEEDS_MORE_INPUT = 1,
+    LZ_DECOMPRESS_HAS_MORE_OUTPUT = 2
+} lz_decompress_result;
+
+typedef enum lz_decompress_flag {
+    LZ_DECOMPRESS_HAS_MORE_INPUT = 0x01
+} lz_decompress_flag;
+
+typedef struct lz_decompress_opts {
+    uint8_t window_bits;
+} lz_decompress_opts;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Create a decompressor.
+ *
+ * @param ctx Decompressor context.
+ * @param opts Options. If `NULL`, the default window size is used.
+ * @param output Output callback. The callback returns the number of bytes it has consumed, which
+ *        can be less than the size of the provided data, or a negative result code in case of an
+ *        error.
+ * @param user_data User data passed to the output callback.
+ * @return 0 on success, otherwise an error code defined by `system_error_t`.
+ */
+int lz_decompress_create(lz_decompress_ctx** ctx, const lz_decompress_opts* opts, lz_decompress_output output,
+        void* user_data);
+
+/**
+ * Destroy a decompressor.
+ */
+void lz_decompress_destroy(lz_decompress_ctx* ctx);
+
+/**
+ * Reset the decompressor state.
+ *
+ * @return 0 on success, otherwise an error code defined by `system_error_t`.
+ */
+int lz_decompress_reset(lz_decompress_ctx* ctx);
+
+/**
+ * Decompress a chunk of data.
+ *
+ * The semantics of this function match those of `inflate_input()`.
+ *
+ * @param ctx Decompressor context.
+ * @param data Compressed data.
+ * @param[in,out] size Size of the compressed data. On return, the number of bytes consumed.
+ * @param flags Flags defined by `lz_decompress_flag`.
+ * @return A value defined by `lz_decompress_result`, or a negative result code in case of an error.
+ */
+int lz_decompress_input(lz_decompress_ctx* ctx, const char* data, size_t* size, unsigned flags);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "hal_platform.h"
+
+#if HAL_PLATFORM_FILESYSTEM
+
+#include "logging.h"
+LOG_SOURCE_CATEGORY("hal.ota")
+
+#include "module_validation_cache.h"
+
+#include "system_cache.h"
+#include "platform_headers.h"
+
+#ifndef retained_system
+#define retained_system
+#endif
+
+namespace particle {
+
+using namespace services;
+
+namespace {
+
+// 32-bit FNV-1a
+const uint32_t FNV_OFFSET_BASIS = 2166136261u;
+const uint32_t FNV_PRIME = 16777619u;
+
+const uint32_t RETAINED_MAGIC = 0x7a11dc0e;
+
+struct Entry {
+    uint32_t address;
+    uint32_t size;
+    uint32_t fingerprint;
+};
+
+struct Entries {
+    uint32_t count;
+    Entry entries[ModuleValidationCache::MAX_ENTRY_COUNT];
+};
+
+struct RetainedEntries {
+    uint32_t magic;
+    Entries e;
+    uint32_t check; // Detects garbage after a power loss
+};
+
+retained_system RetainedEntries g_retained;
+
+uint32_t fnv1a(uint32_t hash, const void* data, size_t size) {
+    auto p = (const uint8_t*)data;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ p[i]) * FNV_PRIME;
+    }
+    return hash;
+}
+
+uint32_t retainedCheck(const RetainedEntries& r) {
+    return ~fnv1a(FNV_OFFSET_BASIS, &r.e, sizeof(r.e));
+}
+
+// Returns the retained entries, resetting them if they are not valid
+Entries& retainedEntries() {
+    auto& r = g_retained;
+    if (r.magic != RETAINED_MAGIC || r.e.count > ModuleValidationCache::MAX_ENTRY_COUNT || r.check != retainedCheck(r)) {
+        r = {};
+        r.magic = RETAINED_MAGIC;
+        r.check = retainedCheck(r);
+    }
+    return r.e;
+}
+
+void updateRetainedCheck() {
+    g_retained.check = retainedCheck(g_retained);
+}
+
+int findEntry(const Entries& e, uint32_t address, uint32_t size) {
+    for (size_t i = 0; i < e.count; ++i) {
+        if (e.entries[i].address == address && e.entries[i].size == size) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+} // namespace
+
+ModuleValidationCache::ModuleValidationCache() :
+        loaded_(false) {
+}
+
+bool ModuleValidationCache::isVerified(const hal_module_t& module, bool useStorage) {
+    if (!isCacheable(module)) {
+        return false;
+    }
+    if (useStorage) {
+        load();
+    }
+    const auto& e = retainedEntries();
+    const int i = findEntry(e, module.bounds.start_address, module_length(&module.info));
+    return i >= 0 && e.entries[i].fingerprint == fingerprint(module);
+}
+
+void ModuleValidationCache::setVerified(const hal_module_t& module, bool verified, bool useStorage) {
+    if (!isCacheable(module)) {
+        return;
+    }
+    if (useStorage) {
+        load();
+    }
+    auto& e = retainedEntries();
+    const uint32_t addr = module.bounds.start_address;
+    const uint32_t size = module_length(&module.info);
+    int i = findEntry(e, addr, size);
+    if (!verified) {
+        if (i < 0) {
+            return;
+        }
+        e.entries[i] = e.entries[--e.count];
+    } else {
+        const uint32_t fp = fingerprint(module);
+        if (i >= 0 && e.entries[i].fingerprint == fp) {
+            return; // Avoid unnecessary writes to flash
+        }
+        if (i < 0) {
+            if (e.count >= MAX_ENTRY_COUNT) {
+                return;
+            }
+            i = e.count++;
+        }
+        auto& entry = e.entries[i];
+        entry.address = addr;
+        entry.size = size;
+        entry.fingerprint = fp;
+    }
+    updateRetainedCheck();
+    if (useStorage) {
+        save();
+    }
+}
+
+void ModuleValidationCache::invalidate() {
+    auto& e = retainedEntries();
+    if (loaded_ && e.count == 0) {
+        return;
+    }
+    e = {};
+    updateRetainedCheck();
+    loaded_ = true;
+    SystemCache::instance().del(SystemCacheKey::MODULE_VALIDATION);
+    LOG(TRACE, "Module validation cache invalidated");
+}
+
+ModuleValidationCache* ModuleValidationCache::instance() {
+    static ModuleValidationCache cache;
+    return &cache;
+}
+
+void ModuleValidationCache::load() {
+    if (loaded_) {
+        return;
+    }
+    loaded_ = true;
+    Entries stored = {};
+    const int r = SystemCache::instance().get(SystemCacheKey::MODULE_VALIDATION, &stored, sizeof(stored));
+    if (r != (int)sizeof(stored) || stored.count > MAX_ENTRY_COUNT) {
+        return;
+    }
+    // Merge the stored entries into the retained ones. The latter may have been updated during this
+    // boot before the filesystem was available
+    auto& e = retainedEntries();
+    for (size_t i = 0; i < stored.count && e.count < MAX_ENTRY_COUNT; ++i) {
+        const auto& entry = stored.entries[i];
+        if (findEntry(e, entry.address, entry.size) < 0) {
+            e.entries[e.count++] = entry;
+        }
+    }
+    updateRetainedCheck();
+}
+
+void ModuleValidationCache::save() {
+    const int r = SystemCache::instance().set(SystemCacheKey::MODULE_VALIDATION, &retainedEntries(), sizeof(Entries));
+    if (r < 0) {
+        LOG(WARN, "Failed to store module validation cache: %d", r);
+    }
+}
+
+bool ModuleValidationCache::isCacheable(const hal_module_t& module) {
+    // Modules in the external flash, such as the one in the OTA region, can be rewritten at any time
+    if (module.bounds.location != MODULE_BOUNDS_LOC_INTERNAL_FLASH) {
+        return false;
+    }
+    // Without the flash write generation there's no way to tell if a module has been rewritten
+    // in DFU mode
+    uint16_t gen = 0;
+    return getFlashWriteGeneration(&gen) == 0;
+}
+
+uint32_t ModuleValidationCache::fingerprint(const hal_module_t& module) {
+    uint16_t gen = 0;
+    getFlashWriteGeneration(&gen);
+    uint32_t h = FNV_OFFSET_BASIS;
+    h = fnv1a(h, &gen, sizeof(gen));
+    h = fnv1a(h, &module.bounds.start_address, sizeof(module.bounds.start_address));
+    h = fnv1a(h, &module.info, sizeof(module.info));
+    h = fnv1a(h, &module.suffix, sizeof(module.suffix));
+    h = fnv1a(h, &module.crc, sizeof(module.crc));
+    return h;
+}
+
+} // particle
+
+#endif // HAL_PLATFORM_FILESYSTEM
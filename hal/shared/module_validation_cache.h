@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "ota_flash_hal.h"
+
+#include <cstdint>
+#include <cstddef>
+
+namespace particle {
+
+/**
+ * Remembers which modules in the internal flash have passed the integrity check.
+ *
+ * Verifying the CRC of a module requires reading it in full. Once a module has been verified, its
+ * address, size and a fingerprint of its info header, suffix and stored CRC are recorded in the
+ * system cache, and the CRC check is skipped on subsequent boots for as long as the module at that
+ * address has the same fingerprint.
+ *
+ * A copy of the cache is also kept in retained RAM. It can be checked before the filesystem is
+ * available, which is the case when the user application is validated early during boot, and it
+ * survives warm resets and wake-ups from sleep.
+ *
+ * The modules in the internal flash are rewritten by the bootloader, either when it applies an
+ * update or in DFU mode. The bootloader increments a flash write generation before doing so and
+ * passes it to the system firmware via a backup register. The generation is part of the
+ * fingerprint, so all modules are fully verified again after any such write, even if it was
+ * interrupted. Nothing is cached with bootloaders that don't provide the generation. Writes made
+ * via a debugger bypass the bootloader and can't be detected.
+ */
+class ModuleValidationCache {
+public:
+    // Returns true if the module has been verified and hasn't changed since then. If useStorage is
+    // false, only the copy of the cache in retained RAM is checked
+    bool isVerified(const hal_module_t& module, bool useStorage = true);
+    void setVerified(const hal_module_t& module, bool verified, bool useStorage = true);
+
+    // Forgets all verified modules
+    void invalidate();
+
+    static ModuleValidationCache* instance();
+
+    static const size_t MAX_ENTRY_COUNT = 8;
+
+private:
+    bool loaded_;
+
+    ModuleValidationCache();
+
+    void load();
+    void save();
+
+    static bool isCacheable(const hal_module_t& module);
+    static uint32_t fingerprint(const hal_module_t& module);
+};
+
+/**
+ * Get the flash write generation provided by the bootloader.
+ *
+ * This function is implemented by the platform.
+ *
+ * @return 0 on success or a negative result code if the bootloader doesn't keep track of the
+ *         writes to the internal flash.
+ */
+int getFlashWriteGeneration(uint16_t* gen);
+
+} // particle
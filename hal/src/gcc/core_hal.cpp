@@ -38,7 +38,10 @@
 #include "interrupts_hal.h"
 #include <sstream>
 #include <iomanip>
+#include <fstream>
 #include "system_error.h"
+#include "trace.h"
+#include "heap_tracking.h"
 #include "../../../system/inc/system_mode.h" // FIXME
 
 #include "eeprom_file.h"
@@ -152,6 +155,49 @@ bool removeArg(std::vector<std::string>* args, const std::string& arg) {
     return found;
 }
 
+#if TRACE_ENABLED
+
+bool appendTraceData(void* data, const uint8_t* buf, size_t size) {
+    const auto strm = static_cast<std::ofstream*>(data);
+    strm->write((const char*)buf, size);
+    return strm->good();
+}
+
+void saveTraceFile() {
+    std::ofstream strm(deviceConfig.trace_file, std::ios::binary | std::ios::trunc);
+    uint32_t pos = 0;
+    int r = 0;
+    do {
+        r = trace_format(&pos, 4096, appendTraceData, &strm, nullptr);
+    } while (r > 0);
+    if (r < 0) {
+        std::cerr << "Failed to save trace data: " << r << std::endl;
+    }
+}
+
+#endif // TRACE_ENABLED
+
+#if HEAP_TRACKING_ENABLED
+
+// Saves the allocation statistics of each subsystem as a JSON object keyed by the tag name
+void saveHeapStatsFile() {
+    std::ofstream strm(deviceConfig.heap_stats_file, std::ios::trunc);
+    strm << "{";
+    for (int tag = 0; tag < HEAP_TAG_COUNT; ++tag) {
+        heap_tag_stats s = {};
+        heap_tracking_get_stats(tag, &s, nullptr);
+        strm << (tag ? ",\n" : "\n") << "  \"" << heap_tag_name(tag) << "\": {\"used\": " << s.used_size <<
+                ", \"peak\": " << s.peak_size << ", \"allocs\": " << s.alloc_count << ", \"frees\": " <<
+                s.free_count << ", \"rate\": " << s.alloc_rate << "}";
+    }
+    strm << "\n}\n";
+    if (!strm.good()) {
+        std::cerr << "Failed to save heap statistics" << std::endl;
+    }
+}
+
+#endif // HEAP_TRACKING_ENABLED
+
 } // namespace
 
 void setLoggerLevel(LoggerOutputLevel level)
@@ -178,6 +224,16 @@ extern "C" int main(int argc, char* argv[])
     try {
         log_set_callbacks(log_message_callback, log_write_callback, log_enabled_callback, nullptr);
         if (read_device_config(argc, argv)) {
+#if TRACE_ENABLED
+                if (!deviceConfig.trace_file.empty()) {
+                    std::atexit(saveTraceFile);
+                }
+#endif
+#if HEAP_TRACKING_ENABLED
+                if (!deviceConfig.heap_stats_file.empty()) {
+                    std::atexit(saveHeapStatsFile);
+                }
+#endif
                 if (!HAL_Core_Validate_Modules(0 /* flags */, nullptr /* reserved */)) {
                     set_system_mode(SAFE_MODE);
                 }
@@ -111,6 +111,8 @@ public:
             ("describe", po::value<std::string>(&config.describe), "the filename containing the device description")
             ("protocol,p", po::value<ProtocolFactory>(&config.protocol)->default_value(PROTOCOL_NONE), "the cloud communication protocol to use")
             ("flash_file", po::value<std::string>(&config.flash_file), "the filename to use to store the contents of the external flash")
+            ("trace_file", po::value<std::string>(&config.trace_file), "the filename to save the trace data to on exit (requires TRACE=y)")
+            ("heap_stats_file", po::value<std::string>(&config.heap_stats_file), "the filename to save the heap allocation statistics to on exit (requires HEAP_TRACKING=y)")
             ;
 
         command_line_options.add(program_options).add(device_options);
@@ -376,5 +378,13 @@ void DeviceConfig::read(Configuration& config)
         this->flash_file = fs::absolute(config.flash_file);
     }
 
+    if (!config.trace_file.empty()) {
+        this->trace_file = fs::absolute(config.trace_file);
+    }
+
+    if (!config.heap_stats_file.empty()) {
+        this->heap_stats_file = fs::absolute(config.heap_stats_file);
+    }
+
     setLoggerLevel((LoggerOutputLevel)(NO_LOG_LEVEL - config.log_level));
 }
@@ -256,6 +256,8 @@ struct Configuration
     std::string server_key;
     std::string describe;
     std::string flash_file;
+    std::string trace_file;
+    std::string heap_stats_file;
     uint16_t log_level;
     ProtocolFactory protocol;
     uint16_t platform_id;
@@ -270,6 +272,8 @@ struct DeviceConfig
     std::vector<std::string> argv;
     particle::config::Describe describe;
     std::string flash_file;
+    std::string trace_file;
+    std::string heap_stats_file;
     uint8_t device_id[12];
     uint8_t device_key[1024];
     uint8_t server_key[1024];
@@ -26,3 +26,6 @@
 #define FILESYSTEM_BLOCK_COUNT  (sFLASH_FILESYSTEM_PAGE_COUNT)
 #define FILESYSTEM_FIRST_BLOCK  (sFLASH_FILESYSTEM_FIRST_PAGE)
 #define FILESYSTEM_LOOKAHEAD    (128)
+
+/* Size of the buffer used to combine adjacent block programs */
+#define FILESYSTEM_WRITE_COMBINE_SIZE (FILESYSTEM_PROG_SIZE * 4)
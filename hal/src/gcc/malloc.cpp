@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * When heap tracking is enabled, the allocation functions of the C library are interposed so that
+ * the allocations made by the virtual device are accounted the same way as on a real device.
+ */
+
+#include "heap_tracking.h"
+
+#if HEAP_TRACKING_ENABLED
+
+#include <mutex>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+
+extern "C" {
+
+void* __libc_malloc(size_t size);
+void __libc_free(void* ptr);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+
+} // extern "C"
+
+namespace {
+
+std::mutex g_mutex;
+
+inline bool isPowerOfTwo(size_t val) {
+    return val && !(val & (val - 1));
+}
+
+void* trackedAlloc(size_t alignment, size_t size) {
+    size_t offset = HEAP_TRACKING_HEADER_SIZE;
+    if (alignment > offset) {
+        if (alignment > HEAP_TRACKING_MAX_OFFSET) {
+            return nullptr;
+        }
+        offset = alignment;
+    }
+    if (size > (size_t)-1 - offset) {
+        return nullptr;
+    }
+    void* block = (alignment > HEAP_TRACKING_HEADER_SIZE) ? __libc_memalign(alignment, size + offset) :
+            __libc_malloc(size + offset);
+    if (!block) {
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(g_mutex);
+    return heap_tracking_on_alloc(block, size, offset, -1 /* tag */);
+}
+
+} // namespace
+
+extern "C" {
+
+void* malloc(size_t size) {
+    return trackedAlloc(0 /* alignment */, size);
+}
+
+void free(void* ptr) {
+    if (!ptr) {
+        return;
+    }
+    void* block = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        block = heap_tracking_on_free(ptr, nullptr /* size */, nullptr /* tag */);
+    }
+    __libc_free(block);
+}
+
+void cfree(void* ptr) {
+    free(ptr);
+}
+
+void* calloc(size_t count, size_t size) {
+    if (size && count > (size_t)-1 / size) {
+        return nullptr;
+    }
+    const auto p = malloc(count * size);
+    if (p) {
+        memset(p, 0, count * size);
+    }
+    return p;
+}
+
+void* realloc(void* ptr, size_t size) {
+    if (!ptr) {
+        return malloc(size);
+    }
+    if (!size) {
+        free(ptr);
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lock(g_mutex);
+    // A resized block keeps its tag and is accounted as a deallocation followed by an allocation
+    size_t oldSize = 0;
+    int tag = 0;
+    const auto block = heap_tracking_on_free(ptr, &oldSize, &tag);
+    const size_t offset = (char*)ptr - (char*)block;
+    void* newBlock = nullptr;
+    if (size <= (size_t)-1 - offset) {
+        newBlock = __libc_realloc(block, size + offset);
+    }
+    if (!newBlock) {
+        heap_tracking_on_alloc(block, oldSize, offset, tag);
+        return nullptr;
+    }
+    return heap_tracking_on_alloc(newBlock, size, offset, tag);
+}
+
+void* memalign(size_t alignment, size_t size) {
+    if (!isPowerOfTwo(alignment)) {
+        errno = EINVAL;
+        return nullptr;
+    }
+    return trackedAlloc(alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    return memalign(alignment, size);
+}
+
+int posix_memalign(void** ptr, size_t alignment, size_t size) {
+    if (!isPowerOfTwo(alignment) || alignment % sizeof(void*) != 0) {
+        return EINVAL;
+    }
+    const auto p = trackedAlloc(alignment, size);
+    if (!p) {
+        return ENOMEM;
+    }
+    *ptr = p;
+    return 0;
+}
+
+void* valloc(size_t size) {
+    return trackedAlloc(sysconf(_SC_PAGESIZE), size);
+}
+
+void* pvalloc(size_t size) {
+    const size_t pageSize = sysconf(_SC_PAGESIZE);
+    return trackedAlloc(pageSize, (size + pageSize - 1) & ~(pageSize - 1));
+}
+
+size_t malloc_usable_size(void* ptr) {
+    if (!ptr) {
+        return 0;
+    }
+    // The underlying block may be larger, but only the requested size is guaranteed to be usable
+    return heap_tracking_alloc_size(ptr);
+}
+
+} // extern "C"
+
+#endif // HEAP_TRACKING_ENABLED
@@ -48,6 +48,7 @@ LOG_SOURCE_CATEGORY("hal.ble");
 #include "device_code.h"
 #include "radio_common.h"
 #include "nrf_system_error.h"
+#include "heap_tracking.h"
 #include "sdk_config_system.h"
 #include "spark_wiring_vector.h"
 #include "simple_pool_allocator.h"
@@ -744,6 +745,7 @@ void BleObject::BleEventDispatcher::enqueue(const ble_evt_t* event) {
 }
 
 os_thread_return_t BleObject::BleEventDispatcher::processBleEventFromThread(void* param) {
+    const int prevHeapTag = heap_tag_enter(HEAP_TAG_BLE, nullptr);
     BleEventDispatcher* dispatcher = static_cast<BleEventDispatcher*>(param);
     while (1) {
         ble_evt_t* event;
@@ -821,6 +823,7 @@ os_thread_return_t BleObject::BleEventDispatcher::processBleEventFromThread(void
             break;
         }
     }
+    heap_tag_leave(prevHeapTag, nullptr);
     os_thread_exit(dispatcher->evtThread_);
 }
 
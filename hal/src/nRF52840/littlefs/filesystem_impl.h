@@ -29,3 +29,6 @@
 #define FILESYSTEM_BLOCK_COUNT  (sFLASH_PAGECOUNT / 2)
 #define FILESYSTEM_FIRST_BLOCK  (0)
 #define FILESYSTEM_LOOKAHEAD    (128)
+
+/* Size of the buffer used to combine adjacent block programs */
+#define FILESYSTEM_WRITE_COMBINE_SIZE (FILESYSTEM_PROG_SIZE * 2)
@@ -33,7 +33,7 @@ CPPSRC += $(call target_files,$(HAL_MODULE_PATH)/shared/,*.cpp)
 
 CPPSRC += $(call target_files,$(HAL_MODULE_PATH)/network/util/,*.cpp)
 
-CSRC += $(TARGET_HAL_PATH)/src/portable/FreeRTOS/heap_4_lock.c
+CPPSRC += $(TARGET_HAL_PATH)/src/portable/FreeRTOS/heap_tlsf_lock.cpp
 CPPSRC += $(call target_files,$(TARGET_HAL_PATH)/src/portable/FreeRTOS/bits/,*.cpp)
 
 # ASM source files included in this build.
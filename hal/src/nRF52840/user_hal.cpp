@@ -20,12 +20,31 @@
 #include "system_error.h"
 #include "ota_module.h"
 #include "flash_mal.h"
+#include "module_validation_cache.h"
 
 namespace {
 
 const uint8_t USER_PART_COMPAT_INDEX = 1;
 const uint8_t USER_PART_CURRENT_INDEX = 2;
 
+bool verifyUserModuleCrc(const module_bounds_t* bounds) {
+    hal_module_t module = {};
+    module.bounds = *bounds;
+    if (locate_module(bounds, &module.info) != SYSTEM_ERROR_NONE ||
+            FLASH_ModuleCrcSuffix(&module.crc, &module.suffix, FLASH_INTERNAL, bounds->start_address + module_length(&module.info)) != SYSTEM_ERROR_NONE) {
+        return false;
+    }
+    // This is called early during boot when the filesystem is not available yet, so only the copy
+    // of the validation cache in retained RAM is checked
+    const auto cache = particle::ModuleValidationCache::instance();
+    if (cache->isVerified(module, false /* useStorage */)) {
+        return true;
+    }
+    const bool ok = FLASH_VerifyCRC32(FLASH_INTERNAL, bounds->start_address, FLASH_ModuleLength(FLASH_INTERNAL, bounds->start_address));
+    cache->setVerified(module, ok, false /* useStorage */);
+    return ok;
+}
+
 bool validUserModuleInfoAtIndex(uint8_t function, uint8_t index, module_info_t* info) {
     const auto bounds = find_module_bounds(function, index, HAL_PLATFORM_MCU_DEFAULT);
     if (!bounds) {
@@ -36,7 +55,7 @@ bool validUserModuleInfoAtIndex(uint8_t function, uint8_t index, module_info_t*
         return false;
     }
 
-    if (!FLASH_VerifyCRC32(FLASH_INTERNAL, bounds->start_address, FLASH_ModuleLength(FLASH_INTERNAL, bounds->start_address))) {
+    if (!verifyUserModuleCrc(bounds)) {
         return false;
     }
 
@@ -45,6 +45,18 @@ extern malloc_heap_region malloc_heap_regions[HAL_PLATFORM_HEAP_REGIONS];
 
 void malloc_set_heap_regions(const malloc_heap_region* regions, size_t count);
 
+typedef struct malloc_heap_stats {
+    size_t total_size; // Total size of the heap regions
+    size_t free_size; // Total size of the free blocks
+    size_t min_free_size; // Lowest value of `free_size` since the heap was initialized
+    size_t largest_free_block; // Size of the largest block that can be allocated
+    size_t free_block_count;
+    size_t used_block_count;
+} malloc_heap_stats;
+
+// Only supported by the TLSF-based heap implementation
+void malloc_get_heap_stats(malloc_heap_stats* stats);
+
 #ifdef __cplusplus
 }
 #endif // __cplusplus
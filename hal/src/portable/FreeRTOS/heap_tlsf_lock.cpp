@@ -0,0 +1,315 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Implementation of pvPortMalloc() and vPortFree() based on the TLSF allocator (see services/inc/tlsf.h).
+ * Allocating and freeing memory takes constant time, and pvPortRealloc() resizes blocks in place
+ * whenever possible.
+ *
+ * Every heap region is managed by a separate allocator instance whose control structure is placed
+ * at the beginning of the region. The regions are tried in the order in which they are defined.
+ */
+
+#include "heap_portable.h"
+
+/* Defining MPU_WRAPPERS_INCLUDED_FROM_API_FILE prevents task.h from redefining
+all the API functions to use the MPU wrappers.  That should only be done when
+task.h is included from an application file. */
+#define MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#undef MPU_WRAPPERS_INCLUDED_FROM_API_FILE
+
+#include "tlsf.h"
+#include "debug.h"
+
+#include <new>
+#include <cstring>
+
+using particle::Tlsf;
+
+extern "C" {
+
+void* pvPortMalloc(size_t size);
+void vPortFree(void* ptr);
+void* pvPortRealloc(void* ptr, size_t size);
+size_t pvPortLargestFreeBlock();
+size_t xPortGetFreeHeapSize();
+size_t xPortGetMinimumEverFreeHeapSize();
+size_t xPortGetHeapSize();
+size_t xPortGetBlockSize(void* ptr);
+void vPortInitialiseBlocks();
+
+#if configUSE_MALLOC_FAILED_HOOK == 1
+void vApplicationMallocFailedHook(size_t size);
+#endif
+
+#if HAL_PLATFORM_HEAP_REGIONS == 1
+extern char link_heap_location, link_heap_location_end;
+#endif
+
+} // extern "C"
+
+namespace {
+
+struct HeapRegion {
+    Tlsf* heap;
+    void* start;
+    void* end;
+};
+
+HeapRegion g_regions[HAL_PLATFORM_HEAP_REGIONS] = {};
+size_t g_regionCount = 0;
+
+#ifdef MODULAR_FIRMWARE
+uint8_t g_mallocEnabled = 0;
+#else
+uint8_t g_mallocEnabled = 1;
+#endif
+
+#if HAL_PLATFORM_HEAP_REGIONS == 1
+
+// The heap is initialized on the first allocation, so its bounds can be changed until then
+void* g_heapStart = &link_heap_location;
+void* g_heapEnd = &link_heap_location_end;
+
+#endif // HAL_PLATFORM_HEAP_REGIONS == 1
+
+void addRegion(void* start, void* end) {
+    SPARK_ASSERT(g_regionCount < HAL_PLATFORM_HEAP_REGIONS);
+    const auto p = ((uintptr_t)start + alignof(Tlsf) - 1) & ~(uintptr_t)(alignof(Tlsf) - 1);
+    SPARK_ASSERT(p + sizeof(Tlsf) < (uintptr_t)end);
+    const auto heap = new((void*)p) Tlsf();
+    const int r = heap->addPool((void*)(p + sizeof(Tlsf)), (uintptr_t)end - p - sizeof(Tlsf));
+    SPARK_ASSERT(r == 0);
+    g_regions[g_regionCount++] = { heap, start, end };
+}
+
+// Must be called with the heap locked
+void initHeap() {
+#if HAL_PLATFORM_HEAP_REGIONS == 1
+    if (!g_regionCount) {
+        addRegion(g_heapStart, g_heapEnd);
+    }
+#endif
+}
+
+// Must be called with the heap locked
+Tlsf* heapForBlock(void* ptr) {
+    for (size_t i = 0; i < g_regionCount; ++i) {
+        if (ptr >= g_regions[i].start && ptr < g_regions[i].end) {
+            return g_regions[i].heap;
+        }
+    }
+    return nullptr;
+}
+
+// Must be called with the heap locked
+void* allocBlock(size_t size) {
+    for (size_t i = 0; i < g_regionCount; ++i) {
+        const auto p = g_regions[i].heap->alloc(size);
+        if (p) {
+            return p;
+        }
+    }
+    return nullptr;
+}
+
+template<typename F>
+void forEachHeap(F fn) {
+    __malloc_lock(nullptr);
+    initHeap();
+    for (size_t i = 0; i < g_regionCount; ++i) {
+        Tlsf::Stats stats = {};
+        g_regions[i].heap->getStats(&stats);
+        fn(stats);
+    }
+    __malloc_unlock(nullptr);
+}
+
+void mallocFailed(size_t size) {
+#if configUSE_MALLOC_FAILED_HOOK == 1
+    if (size > 0) {
+        vApplicationMallocFailedHook(size);
+    }
+#endif
+}
+
+} // namespace
+
+void malloc_enable(uint8_t val) {
+    g_mallocEnabled = val;
+}
+
+#if HAL_PLATFORM_HEAP_REGIONS == 1
+
+void malloc_set_heap_start(void* addr) {
+    SPARK_ASSERT(!g_regionCount);
+    g_heapStart = addr;
+}
+
+void* malloc_heap_start() {
+    return g_heapStart;
+}
+
+void malloc_set_heap_end(void* addr) {
+    SPARK_ASSERT(!g_regionCount);
+    g_heapEnd = addr;
+}
+
+void* malloc_heap_end() {
+    return g_heapEnd;
+}
+
+#else
+
+void malloc_set_heap_regions(const malloc_heap_region* regions, size_t count) {
+    if (!regions) {
+        return;
+    }
+    __malloc_lock(nullptr);
+    SPARK_ASSERT(!g_regionCount);
+    for (size_t i = 0; i < count; ++i) {
+        addRegion(regions[i].start, regions[i].end);
+    }
+    __malloc_unlock(nullptr);
+}
+
+#endif // HAL_PLATFORM_HEAP_REGIONS != 1
+
+void malloc_get_heap_stats(malloc_heap_stats* stats) {
+    memset(stats, 0, sizeof(*stats));
+    forEachHeap([stats](const Tlsf::Stats& s) {
+        stats->total_size += s.totalSize;
+        stats->free_size += s.freeSize;
+        stats->min_free_size += s.minFreeSize;
+        stats->free_block_count += s.freeBlockCount;
+        stats->used_block_count += s.usedBlockCount;
+        if (s.largestFreeBlock > stats->largest_free_block) {
+            stats->largest_free_block = s.largestFreeBlock;
+        }
+    });
+}
+
+void* pvPortMalloc(size_t size) {
+    if (!g_mallocEnabled) {
+        return nullptr;
+    }
+    __malloc_lock(nullptr);
+    initHeap();
+    const auto p = allocBlock(size);
+    traceMALLOC(p, size);
+    __malloc_unlock(nullptr);
+    if (!p) {
+        mallocFailed(size);
+    }
+    return p;
+}
+
+void vPortFree(void* ptr) {
+    if (!ptr) {
+        return;
+    }
+    __malloc_lock(nullptr);
+    const auto heap = heapForBlock(ptr);
+    SPARK_ASSERT(heap);
+    traceFREE(ptr, Tlsf::blockSize(ptr));
+    heap->free(ptr);
+    __malloc_unlock(nullptr);
+}
+
+void* pvPortRealloc(void* ptr, size_t size) {
+    if (!ptr) {
+        return pvPortMalloc(size);
+    }
+    if (!size) {
+        vPortFree(ptr);
+        return nullptr;
+    }
+    if (!g_mallocEnabled) {
+        return nullptr;
+    }
+    __malloc_lock(nullptr);
+    const auto heap = heapForBlock(ptr);
+    SPARK_ASSERT(heap);
+    auto p = heap->realloc(ptr, size);
+    if (!p) {
+        // Try the other regions
+        p = allocBlock(size);
+        if (p) {
+            memcpy(p, ptr, Tlsf::blockSize(ptr));
+            heap->free(ptr);
+        }
+    }
+    __malloc_unlock(nullptr);
+    if (!p) {
+        mallocFailed(size);
+    }
+    return p;
+}
+
+size_t pvPortLargestFreeBlock() {
+    if (!g_mallocEnabled) {
+        return 0;
+    }
+    size_t size = 0;
+    forEachHeap([&size](const Tlsf::Stats& s) {
+        if (s.largestFreeBlock > size) {
+            size = s.largestFreeBlock;
+        }
+    });
+    return size;
+}
+
+size_t xPortGetFreeHeapSize() {
+    size_t size = 0;
+    forEachHeap([&size](const Tlsf::Stats& s) {
+        size += s.freeSize;
+    });
+    return size;
+}
+
+size_t xPortGetMinimumEverFreeHeapSize() {
+    size_t size = 0;
+    forEachHeap([&size](const Tlsf::Stats& s) {
+        size += s.minFreeSize;
+    });
+    return size;
+}
+
+size_t xPortGetHeapSize() {
+#if HAL_PLATFORM_HEAP_REGIONS == 1
+    if (!g_regionCount) {
+        return (uintptr_t)g_heapEnd - (uintptr_t)g_heapStart;
+    }
+#endif
+    size_t size = 0;
+    for (size_t i = 0; i < g_regionCount; ++i) {
+        size += (uintptr_t)g_regions[i].end - (uintptr_t)g_regions[i].start;
+    }
+    return size;
+}
+
+size_t xPortGetBlockSize(void* ptr) {
+    return Tlsf::blockSize(ptr);
+}
+
+void vPortInitialiseBlocks() {
+    /* This just exists to keep the linker quiet. */
+}
@@ -72,6 +72,7 @@ extern "C" {
 #include "scope_guard.h"
 #include "rtl_system_error.h"
 #include "radio_common.h"
+#include "heap_tracking.h"
 
 #include "timer_hal.h"
 
@@ -1003,6 +1004,8 @@ void BleEventDispatcher::handleIoMessage(T_IO_MSG message) const {
 }
 
 void BleEventDispatcher::bleEventDispatchThread(void *context) {
+    // The thread exits without unwinding its stack, so the tag is reset explicitly
+    const int prevHeapTag = heap_tag_enter(HEAP_TAG_BLE, nullptr);
     BleEventDispatcher* dispatcher = (BleEventDispatcher*)context;
     while (true) {
         uint8_t event;
@@ -1023,10 +1026,12 @@ void BleEventDispatcher::bleEventDispatchThread(void *context) {
             }
         }
     }
+    heap_tag_leave(prevHeapTag, nullptr);
     os_thread_exit(nullptr);
 }
 
 void BleGap::bleCommandThread(void *context) {
+    const int prevHeapTag = heap_tag_enter(HEAP_TAG_BLE, nullptr);
     BleGap* gap = (BleGap*)context;
     uint8_t command = 0;
     while (true) {
@@ -1081,6 +1086,7 @@ void BleGap::bleCommandThread(void *context) {
     }
     // Just in case clean up the queue on exit
     while (!os_queue_take(gap->cmdQueue_, &command, 0, nullptr));
+    heap_tag_leave(prevHeapTag, nullptr);
     os_thread_exit(nullptr);
 }
 
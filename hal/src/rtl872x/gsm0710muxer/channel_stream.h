@@ -26,6 +26,7 @@
 #include "system_error.h"
 #include "concurrent_hal.h"
 #include <memory>
+#include <cstring>
 #include "spark_wiring_thread.h"
 
 namespace particle {
@@ -114,13 +115,23 @@ inline int MuxerChannelStream<MuxerT>::init(size_t rxBufSize) {
 template <typename MuxerT>
 inline int MuxerChannelStream<MuxerT>::channelDataCb(const uint8_t* data, size_t size, void* ctx) {
     auto self = (MuxerChannelStream<MuxerT>*)ctx;
-    {
-        std::lock_guard<RecursiveMutex> lock(self->mutex_);
-        auto r = self->rxBuf_->put((const char*)data, size);
-        if (r == SYSTEM_ERROR_TOO_LARGE) {
-            LOG_DEBUG(WARN, "No space in muxer channel stream rx buffer while trying to put %d bytes (%d available)",
-                    (int)size, self->rxBuf_->space());
+    // The muxer thread is the only producer, no locking is needed to write to the ring buffer.
+    // The data is copied directly into the buffer's contiguous free regions
+    size_t written = 0;
+    while (written < size) {
+        size_t n = 0;
+        auto dest = self->rxBuf_->acquireWrite(&n);
+        if (!n) {
+            break;
         }
+        n = std::min(n, size - written);
+        memcpy(dest, data + written, n);
+        self->rxBuf_->commitWrite(n);
+        written += n;
+    }
+    if (written < size) {
+        LOG_DEBUG(WARN, "No space in muxer channel stream rx buffer, dropped %d out of %d bytes",
+                (int)(size - written), (int)size);
     }
     self->suspend();
     os_semaphore_give(self->sem_, false);
@@ -132,12 +143,22 @@ inline int MuxerChannelStream<MuxerT>::read(char* data, size_t size) {
     if (!enabled_) {
         return SYSTEM_ERROR_INVALID_STATE;
     }
-    ssize_t r;
+    size_t r = 0;
     {
         std::lock_guard<RecursiveMutex> lock(mutex_);
-        size_t canRead = CHECK(rxBuf_->data());
-        size_t willRead = std::min(canRead, size);
-        r = rxBuf_->get(data, willRead);
+        while (r < size) {
+            size_t n = 0;
+            auto src = rxBuf_->peekRead(&n);
+            if (!n) {
+                break;
+            }
+            n = std::min(n, size - r);
+            if (data) {
+                memcpy(data + r, src, n);
+            }
+            rxBuf_->commitRead(n);
+            r += n;
+        }
     }
     resume();
     return r;
@@ -34,6 +34,7 @@ LOG_SOURCE_CATEGORY("hal.ota")
 #include "spark_macros.h"
 #include "bootloader.h"
 #include "ota_module.h"
+#include "module_validation_cache.h"
 #include "spark_protocol_functions.h"
 #include "hal_platform.h"
 #include "hal_event.h"
@@ -510,6 +511,8 @@ int HAL_FLASH_End(void* reserved)
         moduleCount = MAX_COMBINED_MODULE_COUNT;
     }
     CHECK(validateModules(modules, moduleCount));
+    // Make sure all modules are fully verified on the next boot after the update is applied
+    ModuleValidationCache::instance()->invalidate();
     bool restartPending = false;
     for (size_t i = 0; i < moduleCount; ++i) {
         const auto module = &modules[i];
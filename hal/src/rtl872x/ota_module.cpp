@@ -20,10 +20,12 @@
 #include <string.h>
 #include "flash_mal.h"
 #include "ota_module.h"
+#include "module_validation_cache.h"
 #include "ota_flash_hal_impl.h"
 #include "platform_radio_stack.h"
 #include "platform_ncp.h"
 #include "check.h"
+#include "core_hal.h"
 
 namespace {
 
@@ -111,10 +113,29 @@ bool fetch_module(hal_module_t* target, const module_bounds_t* bounds, bool user
     if (validate_module_dependencies(bounds, userDepsOptional, target->validity_checked & MODULE_VALIDATION_DEPENDENCIES_FULL)) {
         target->validity_result |= MODULE_VALIDATION_DEPENDENCIES | (target->validity_checked & MODULE_VALIDATION_DEPENDENCIES_FULL);
     }
-    if ((target->validity_checked & MODULE_VALIDATION_INTEGRITY) && verify_crc32(bounds, info)) {
-        target->validity_result |= MODULE_VALIDATION_INTEGRITY;
+    if (target->validity_checked & MODULE_VALIDATION_INTEGRITY) {
+        // The full CRC check is skipped if the module hasn't changed since it was last verified
+        const auto cache = particle::ModuleValidationCache::instance();
+        if (cache->isVerified(*target) || verify_crc32(bounds, info)) {
+            target->validity_result |= MODULE_VALIDATION_INTEGRITY;
+            cache->setVerified(*target, true);
+        } else {
+            cache->setVerified(*target, false);
+        }
     }
     
     return true;
 }
 
+namespace particle {
+
+int getFlashWriteGeneration(uint16_t* gen) {
+    const uint32_t val = HAL_Core_Read_Backup_Register(BKP_DR_FLASH_WRITE_GENERATION);
+    if ((uint16_t)(val >> 16) != (uint16_t)~val) {
+        return SYSTEM_ERROR_NOT_SUPPORTED;
+    }
+    *gen = val & 0xffff;
+    return 0;
+}
+
+} // particle
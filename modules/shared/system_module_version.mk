@@ -14,7 +14,11 @@ USER_PART_MODULE_VERSION ?= 6
 # Skip to next 100 every v0.x.0 release (e.g. 11 for v0.6.2 to 100 for v0.7.0-rc.1),
 # but only if the bootloader has changed since the last v0.x.0 release.
 # Bump by 1 for every updated bootloader image for a release with the same v0.x.* base.
-BOOTLOADER_VERSION ?= 2700
+BOOTLOADER_VERSION ?= 2701
+
+# The first bootloader version that can decompress modules compressed with the small-window LZ
+# method. Compressed modules produced by the compressed-bin target depend on this version
+LZ_COMPRESSION_BOOTLOADER_VERSION ?= 2701
 
 ifeq ($(PLATFORM_MCU),rtl872x)
 PREBOOTLOADER_MBR_VERSION ?= 2
@@ -11,11 +11,14 @@
 
 #include "interrupts_hal.h"
 #include "service_debug.h"
+#include "heap_portable.h"
+#include "heap_tracking.h"
 
 extern "C" {
 
 void *pvPortMalloc( size_t xWantedSize );
 void vPortFree( void *pv );
+void* pvPortRealloc( void *pv, size_t xWantedSize );
 size_t xPortGetFreeHeapSize( void );
 size_t xPortGetMinimumEverFreeHeapSize( void );
 size_t xPortGetHeapSize( void );
@@ -35,7 +38,16 @@ static void panic_if_in_isr() {
 void* _malloc_r(struct _reent *r, size_t s) {
     (void)r;
     panic_if_in_isr();
+#if HEAP_TRACKING_ENABLED
+    __malloc_lock(r);
+    void* ptr = pvPortMalloc((size_t)s + HEAP_TRACKING_HEADER_SIZE);
+    if (ptr) {
+        ptr = heap_tracking_on_alloc(ptr, s, HEAP_TRACKING_HEADER_SIZE, -1 /* tag */);
+    }
+    __malloc_unlock(r);
+#else
     void* ptr = pvPortMalloc((size_t)s);
+#endif
     return ptr;
 }
 
@@ -48,7 +60,15 @@ void _free_r(struct _reent* r, void* ptr) {
         ptr = NULL;
     }
 #endif
+#if HEAP_TRACKING_ENABLED
+    if (ptr) {
+        __malloc_lock(r);
+        vPortFree(heap_tracking_on_free(ptr, nullptr /* size */, nullptr /* tag */));
+        __malloc_unlock(r);
+    }
+#else
     vPortFree(ptr);
+#endif
 }
 
 void _cfree_r(struct _reent* r, void* ptr) {
@@ -68,19 +88,32 @@ void* _realloc_r(struct _reent* r, void *ptr, size_t newsize) {
 
     panic_if_in_isr();
 
-    if (newsize == 0) {
-        vPortFree(ptr);
-        return NULL;
+#if HEAP_TRACKING_ENABLED
+    if (!ptr) {
+        return _malloc_r(r, newsize);
     }
-
-    void *p = pvPortMalloc(newsize);
-    if (p) {
-        if (ptr != NULL) {
-            memcpy(p, ptr, newsize);
-            vPortFree(ptr);
-        }
+    if (!newsize) {
+        _free_r(r, ptr);
+        return nullptr;
     }
-    return p;
+    __malloc_lock(r);
+    // A resized block keeps its tag and is accounted as a deallocation followed by an allocation
+    size_t oldSize = 0;
+    int tag = 0;
+    void* block = heap_tracking_on_free(ptr, &oldSize, &tag);
+    void* newBlock = pvPortRealloc(block, newsize + HEAP_TRACKING_HEADER_SIZE);
+    if (newBlock) {
+        ptr = heap_tracking_on_alloc(newBlock, newsize, HEAP_TRACKING_HEADER_SIZE, tag);
+    } else {
+        heap_tracking_on_alloc(block, oldSize, HEAP_TRACKING_HEADER_SIZE, tag);
+        ptr = nullptr;
+    }
+    __malloc_unlock(r);
+    return ptr;
+#else
+    // Resizes the block in place if possible
+    return pvPortRealloc(ptr, newsize);
+#endif
 }
 
 static struct mallinfo current_mallinfo = {};
@@ -89,10 +122,17 @@ struct mallinfo _mallinfo_r(struct _reent* r) {
     panic_if_in_isr();
     __malloc_lock(r);
 
+    malloc_heap_stats stats = {};
+    malloc_get_heap_stats(&stats);
+
     current_mallinfo.arena = xPortGetHeapSize();
-    current_mallinfo.fordblks = xPortGetFreeHeapSize();
+    current_mallinfo.fordblks = stats.free_size;
     current_mallinfo.uordblks = current_mallinfo.arena - current_mallinfo.fordblks;
-    current_mallinfo.usmblks = current_mallinfo.arena - xPortGetMinimumEverFreeHeapSize();
+    current_mallinfo.usmblks = current_mallinfo.arena - stats.min_free_size;
+    // Fragmentation statistics. The heap is never returned to the system, so keepcost is used
+    // to report the size of the largest free block instead
+    current_mallinfo.ordblks = stats.free_block_count;
+    current_mallinfo.keepcost = stats.largest_free_block;
 
     __malloc_unlock(r);
 
@@ -107,7 +147,14 @@ size_t _malloc_usable_size_r(struct _reent* r, void* ptr) {
 
     panic_if_in_isr();
 
+#if HEAP_TRACKING_ENABLED
+    if (!ptr) {
+        return 0;
+    }
+    return xPortGetBlockSize((char*)ptr - HEAP_TRACKING_HEADER_SIZE) - HEAP_TRACKING_HEADER_SIZE;
+#else
     return xPortGetBlockSize(ptr);
+#endif
 }
 
 #endif // HAL_PLATFORM_FREERTOS
@@ -255,7 +255,8 @@ STATIC_ASSERT_FLAGS_OFFSET(Factory_Reset_Done_SysFlag, 17);
 STATIC_ASSERT_FLAGS_OFFSET(StartupMode_SysFlag, 18);
 STATIC_ASSERT_FLAGS_OFFSET(FeaturesEnabled_SysFlag, 19);
 STATIC_ASSERT_FLAGS_OFFSET(RCC_CSR_SysFlag, 20);
-STATIC_ASSERT_FLAGS_OFFSET(reserved, 24);
+STATIC_ASSERT_FLAGS_OFFSET(Flash_Write_Generation_SysFlag, 24);
+STATIC_ASSERT_FLAGS_OFFSET(reserved, 26);
 
 
 #ifdef	__cplusplus
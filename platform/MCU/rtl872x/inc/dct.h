@@ -249,7 +249,8 @@ STATIC_ASSERT_FLAGS_OFFSET(StartupMode_SysFlag, 18);
 STATIC_ASSERT_FLAGS_OFFSET(FeaturesEnabled_SysFlag, 19);
 STATIC_ASSERT_FLAGS_OFFSET(RCC_CSR_SysFlag, 20);
 STATIC_ASSERT_FLAGS_OFFSET(restore_backup_ram, 24);
-STATIC_ASSERT_FLAGS_OFFSET(reserved, 26);
+STATIC_ASSERT_FLAGS_OFFSET(Flash_Write_Generation_SysFlag, 26);
+STATIC_ASSERT_FLAGS_OFFSET(reserved, 28);
 
 
 #ifdef	__cplusplus
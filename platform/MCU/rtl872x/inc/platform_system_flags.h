@@ -39,7 +39,9 @@ typedef struct __attribute__((packed)) platform_system_flags {
     // bit 0: 1: restore backup ram from flash
     // bit 1: 1: session data in flash is stale
     uint16_t restore_backup_ram;
-    uint16_t reserved[3];
+    // Incremented by the bootloader every time it may write to the internal flash
+    uint16_t Flash_Write_Generation_SysFlag;
+    uint16_t reserved[2];
 } platform_system_flags_t;
 
 PARTICLE_STATIC_ASSERT(platform_system_flags_size_changed, sizeof(platform_system_flags_t) == 32);
@@ -26,7 +26,9 @@
 #include "exflash_hal.h"
 #include "hal_platform.h"
 #include "inflate.h"
+#include "lz_decompress.h"
 #include "check.h"
+#include "static_assert.h"
 #include "rtl8721d.h"
 #include "rtl_header.h"
 #include "km0_km4_ipc.h"
@@ -230,8 +232,13 @@ static int inflate_output_callback(const char* data, size_t size, void* user_dat
     return size;
 }
 
-static bool flash_decompress(flash_device_t src_dev, uintptr_t src_addr, size_t src_size, flash_device_t dest_dev,
-        uintptr_t dest_addr, size_t dest_size) {
+// Both decompressors are driven by the same loop below
+PARTICLE_STATIC_ASSERT(lz_decompress_result_matches_inflate, (int)LZ_DECOMPRESS_DONE == (int)INFLATE_DONE &&
+        (int)LZ_DECOMPRESS_NEEDS_MORE_INPUT == (int)INFLATE_NEEDS_MORE_INPUT &&
+        (int)LZ_DECOMPRESS_HAS_MORE_OUTPUT == (int)INFLATE_HAS_MORE_OUTPUT);
+
+static bool flash_decompress(const compressed_module_header* header, flash_device_t src_dev, uintptr_t src_addr,
+        size_t src_size, flash_device_t dest_dev, uintptr_t dest_addr, size_t dest_size) {
     uint8_t in_buf[COPY_BLOCK_SIZE];
     inflate_output_ctx out = {};
     out.buf_offs = 0;
@@ -239,7 +246,15 @@ static bool flash_decompress(flash_device_t src_dev, uintptr_t src_addr, size_t
     out.flash_addr = dest_addr;
     out.flash_end_addr = dest_addr + dest_size;
     inflate_ctx* infl = NULL;
-    int r = inflate_create(&infl, NULL, inflate_output_callback, &out);
+    lz_decompress_ctx* lz = NULL;
+    int r = 0;
+    if (header->method == MODULE_COMPRESSION_METHOD_LZ) {
+        lz_decompress_opts opts = {};
+        opts.window_bits = header->window_bits;
+        r = lz_decompress_create(&lz, &opts, inflate_output_callback, &out);
+    } else {
+        r = inflate_create(&infl, NULL, inflate_output_callback, &out);
+    }
     if (r != 0) {
         goto error;
     }
@@ -255,7 +270,11 @@ static bool flash_decompress(flash_device_t src_dev, uintptr_t src_addr, size_t
         size_t in_buf_offs = 0;
         do {
             size_t n = in_bytes - in_buf_offs;
-            r = inflate_input(infl, (const char*)in_buf + in_buf_offs, &n, INFLATE_HAS_MORE_INPUT);
+            if (lz) {
+                r = lz_decompress_input(lz, (const char*)in_buf + in_buf_offs, &n, LZ_DECOMPRESS_HAS_MORE_INPUT);
+            } else {
+                r = inflate_input(infl, (const char*)in_buf + in_buf_offs, &n, INFLATE_HAS_MORE_INPUT);
+            }
             if (r < 0) {
                 goto error;
             }
@@ -280,9 +299,11 @@ done:
     if (out.flash_addr != out.flash_end_addr) {
         goto error;
     }
+    lz_decompress_destroy(lz);
     inflate_destroy(infl);
     return true;
 error:
+    lz_decompress_destroy(lz);
     inflate_destroy(infl);
     return false;
 }
@@ -301,7 +322,7 @@ static bool parse_compressed_module_header(flash_device_t dev, uintptr_t addr, s
     if (header->size > sizeof(compressed_module_header) && size < (size_t)prefix_size + header->size) {
         return false;
     }
-    if (header->method != 0) { // Raw Deflate
+    if (header->method != MODULE_COMPRESSION_METHOD_DEFLATE && header->method != MODULE_COMPRESSION_METHOD_LZ) {
         return false;
     }
     return true;
@@ -408,7 +429,7 @@ int FLASH_CopyMemory(flash_device_t sourceDeviceID, uint32_t sourceAddress,
             return FLASH_ACCESS_RESULT_BADARG;
         }
         length -= suffix_size;
-        if (!flash_decompress(sourceDeviceID, sourceAddress, length, destinationDeviceID, destinationAddress, dest_size)) {
+        if (!flash_decompress(&comp_header, sourceDeviceID, sourceAddress, length, destinationDeviceID, destinationAddress, dest_size)) {
             return FLASH_ACCESS_RESULT_ERROR;
         }
 #else
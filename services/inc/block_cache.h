@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "stream.h"
+
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+namespace particle {
+
+/**
+ * Random-access view of a seekable input stream with a small LRU cache of fixed-size blocks.
+ *
+ * Reads that fall into a cached block are served from RAM. A missing block is read from the
+ * underlying stream as a whole, replacing the least recently used block.
+ */
+class BlockCache {
+public:
+    struct Stats {
+        uint32_t hits; ///< Number of block lookups served from the cache.
+        uint32_t misses; ///< Number of blocks read from the stream.
+        uint32_t evictions; ///< Number of valid blocks that have been replaced.
+    };
+
+    static const size_t MAX_BLOCK_SIZE = 4096;
+    static const size_t MAX_BLOCK_COUNT = 32;
+
+    BlockCache();
+
+    /**
+     * Initialize the cache.
+     *
+     * @param stream Underlying stream. The stream needs to support seeking in both directions.
+     * @param size Size of the data available in the stream.
+     * @param blockSize Block size. Can't exceed `MAX_BLOCK_SIZE`.
+     * @param blockCount Number of cached blocks. Can't exceed `MAX_BLOCK_COUNT`.
+     * @return 0 on success or a negative result code in case of an error.
+     */
+    int init(InputStream* stream, size_t size, size_t blockSize, size_t blockCount);
+
+    /**
+     * Read data at a given offset.
+     *
+     * @return Number of bytes read or `SYSTEM_ERROR_END_OF_STREAM` if the offset is at or past
+     *         the end of the data.
+     */
+    int read(size_t offset, char* data, size_t size);
+
+    /**
+     * Get a pointer to the cached data at a given offset without copying it.
+     *
+     * The pointer remains valid until the next call to any of the non-const methods of the cache.
+     *
+     * @param offset Offset.
+     * @param[out] data Data.
+     * @return Number of bytes available at the returned pointer, which doesn't exceed the end of
+     *         the block, or `SYSTEM_ERROR_END_OF_STREAM` if the offset is at or past the end of
+     *         the data.
+     */
+    int map(size_t offset, const char** data);
+
+    /**
+     * Discard all cached blocks.
+     */
+    void invalidate();
+
+    const Stats& stats() const {
+        return stats_;
+    }
+
+    void resetStats() {
+        stats_ = Stats();
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    size_t blockSize() const {
+        return blockSize_;
+    }
+
+    size_t blockCount() const {
+        return blockCount_;
+    }
+
+private:
+    struct Block {
+        size_t index; // Index of the cached block in the stream
+        uint32_t lastUsed; // Value of the use counter when the block was last accessed
+        bool valid;
+    };
+
+    std::unique_ptr<char[]> buf_;
+    std::unique_ptr<Block[]> blocks_;
+    InputStream* stream_;
+    Stats stats_;
+    size_t size_;
+    size_t blockSize_;
+    size_t blockCount_;
+    uint32_t useCount_;
+
+    int block(size_t index);
+};
+
+} // particle
@@ -66,6 +66,29 @@
 #define DIAG_NAME_CLOUD_RATE_LIMITED_EVENTS "pub:limit"
 #define DIAG_NAME_SYSTEM_TOTAL_RAM "sys:tram"
 #define DIAG_NAME_SYSTEM_USED_RAM "sys:uram"
+#define DIAG_NAME_CLOUD_COAP_ROUND_TRIP_HISTOGRAM "coap:rtt"
+#define DIAG_NAME_CLOUD_PUBLISH_ACK_TIME "pub:ack"
+#define DIAG_NAME_CLOUD_RECENT_RETRANSMITTED_MESSAGES "coap:retransmit:win"
+#define DIAG_NAME_NCP_AT_COMMAND_TIME "ncp:at"
+#define DIAG_NAME_FILESYSTEM_FLASH_WRITE_TIME "fs:write"
+#define DIAG_NAME_SYSTEM_LARGEST_FREE_BLOCK "mem:lfb"
+#define DIAG_NAME_SYSTEM_HEAP_FRAGMENTATION "mem:frag"
+#define DIAG_NAME_HEAP_TAG_OTHER_USED "mem:used:other"
+#define DIAG_NAME_HEAP_TAG_SYSTEM_USED "mem:used:sys"
+#define DIAG_NAME_HEAP_TAG_PROTOCOL_USED "mem:used:proto"
+#define DIAG_NAME_HEAP_TAG_LEDGER_USED "mem:used:ledger"
+#define DIAG_NAME_HEAP_TAG_BLE_USED "mem:used:ble"
+#define DIAG_NAME_HEAP_TAG_NCP_USED "mem:used:ncp"
+#define DIAG_NAME_HEAP_TAG_NETWORK_USED "mem:used:net"
+#define DIAG_NAME_HEAP_TAG_USER_USED "mem:used:app"
+#define DIAG_NAME_NETWORK_PBUF_POOL_USED "net:pbuf:used"
+#define DIAG_NAME_NETWORK_PBUF_POOL_MAX_USED "net:pbuf:max"
+#define DIAG_NAME_NETWORK_TCP_SEG_USED "net:tcpseg:used"
+#define DIAG_NAME_NETWORK_TCP_SEG_MAX_USED "net:tcpseg:max"
+#define DIAG_NAME_SYSTEM_WAKE_NETWORK_ON_TIME "wake:net:on"
+#define DIAG_NAME_SYSTEM_WAKE_NETWORK_CONNECTED_TIME "wake:net:conn"
+#define DIAG_NAME_SYSTEM_WAKE_CLOUD_CONNECTED_TIME "wake:cloud"
+#define DIAG_NAME_SYSTEM_WAKE_PUBLISH_TIME "wake:pub"
 
 #ifdef __cplusplus
 extern "C" {
@@ -119,15 +142,63 @@ typedef enum diag_id {
     DIAG_ID_ALT_NETWORK_SIGNAL_QUALITY = 47, // net:alt:sigqual
     DIAG_ID_ALT_NETWORK_SIGNAL_QUALITY_VALUE = 48, // net:alt:sigqualv
     DIAG_ID_ALT_NETWORK_ACCESS_TECNHOLOGY = 49, // net:alt:at
+    DIAG_ID_CLOUD_COAP_ROUND_TRIP_HISTOGRAM = 50, // coap:rtt
+    DIAG_ID_CLOUD_PUBLISH_ACK_TIME = 51, // pub:ack
+    DIAG_ID_CLOUD_RECENT_RETRANSMITTED_MESSAGES = 52, // coap:retransmit:win
+    DIAG_ID_NCP_AT_COMMAND_TIME = 53, // ncp:at
+    DIAG_ID_FILESYSTEM_FLASH_WRITE_TIME = 54, // fs:write
+    DIAG_ID_SYSTEM_LARGEST_FREE_BLOCK = 55, // mem:lfb
+    DIAG_ID_SYSTEM_HEAP_FRAGMENTATION = 56, // mem:frag
+    DIAG_ID_HEAP_TAG_OTHER_USED = 57, // mem:used:other
+    DIAG_ID_HEAP_TAG_SYSTEM_USED = 58, // mem:used:sys
+    DIAG_ID_HEAP_TAG_PROTOCOL_USED = 59, // mem:used:proto
+    DIAG_ID_HEAP_TAG_LEDGER_USED = 60, // mem:used:ledger
+    DIAG_ID_HEAP_TAG_BLE_USED = 61, // mem:used:ble
+    DIAG_ID_HEAP_TAG_NCP_USED = 62, // mem:used:ncp
+    DIAG_ID_HEAP_TAG_NETWORK_USED = 63, // mem:used:net
+    DIAG_ID_HEAP_TAG_USER_USED = 64, // mem:used:app
+    DIAG_ID_NETWORK_PBUF_POOL_USED = 65, // net:pbuf:used
+    DIAG_ID_NETWORK_PBUF_POOL_MAX_USED = 66, // net:pbuf:max
+    DIAG_ID_NETWORK_TCP_SEG_USED = 67, // net:tcpseg:used
+    DIAG_ID_NETWORK_TCP_SEG_MAX_USED = 68, // net:tcpseg:max
+    DIAG_ID_SYSTEM_WAKE_NETWORK_ON_TIME = 69, // wake:net:on
+    DIAG_ID_SYSTEM_WAKE_NETWORK_CONNECTED_TIME = 70, // wake:net:conn
+    DIAG_ID_SYSTEM_WAKE_CLOUD_CONNECTED_TIME = 71, // wake:cloud
+    DIAG_ID_SYSTEM_WAKE_PUBLISH_TIME = 72, // wake:pub
     DIAG_ID_USER = 32768 // Base value for application-specific source IDs
 } diag_id;
 
 // Data types
 typedef enum diag_type {
     DIAG_TYPE_INT = 1, // 32-bit signed integer
-    DIAG_TYPE_UINT = 2 // 32-bit unsigned integer
+    DIAG_TYPE_UINT = 2, // 32-bit unsigned integer
+    DIAG_TYPE_HISTOGRAM = 3, // Histogram of 32-bit unsigned samples (diag_histogram_data)
+    DIAG_TYPE_COUNTER = 4 // Event counter over a sliding time window (diag_counter_data)
 } diag_type;
 
+// Maximum number of buckets in a histogram
+#define DIAG_HISTOGRAM_MAX_BUCKET_COUNT 33
+
+// Histogram data. The buckets have logarithmic bounds: bucket 0 counts the samples equal to 0, and
+// bucket N counts the samples in the range [2^(N-1), 2^N). The last bucket also counts all samples
+// that are larger than its upper bound
+typedef struct diag_histogram_data {
+    uint32_t count; // Number of samples
+    uint32_t sum; // Sum of the samples (wraps around on overflow)
+    uint32_t min; // Minimum sample value
+    uint32_t max; // Maximum sample value
+    uint16_t bucket_count; // Number of buckets
+    uint16_t reserved; // Reserved (should be set to 0)
+    uint32_t buckets[DIAG_HISTOGRAM_MAX_BUCKET_COUNT]; // Number of samples in each bucket
+} diag_histogram_data;
+
+// Windowed counter data
+typedef struct diag_counter_data {
+    uint32_t total; // Number of events since the counter was created
+    uint32_t window_count; // Number of events within the window
+    uint32_t window; // Window duration in milliseconds
+} diag_counter_data;
+
 // Data source commands
 typedef enum diag_source_cmd {
     DIAG_SOURCE_CMD_GET = 1 // Get current data
@@ -0,0 +1,258 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "appender.h"
+#include "preprocessor.h"
+#include "module_info.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Heap tracking is disabled by default. Build with `HEAP_TRACKING=y` to enable it.
+ *
+ * When heap tracking is enabled, every allocation is prefixed with a small header that stores the
+ * size of the allocation and the tag of the subsystem that made it. The tag is determined by the
+ * innermost `HEAP_TAG_SCOPE()` active in the calling thread. When heap tracking is disabled,
+ * `HEAP_TAG_SCOPE()` expands to nothing.
+ */
+#ifndef HEAP_TRACKING_ENABLED
+#define HEAP_TRACKING_ENABLED 0
+#endif
+
+// Heap tracking is not supported in the bootloader
+#if defined(MODULE_FUNCTION) && MODULE_FUNCTION == MOD_FUNC_BOOTLOADER
+#undef HEAP_TRACKING_ENABLED
+#define HEAP_TRACKING_ENABLED 0
+#endif
+
+/**
+ * Size of the header preceding every tracked allocation. The header keeps the alignment of the
+ * blocks returned by the underlying allocator.
+ */
+#define HEAP_TRACKING_HEADER_SIZE (2 * sizeof(void*))
+
+/**
+ * Maximum offset of the memory returned to the caller from the beginning of the block. Allocations
+ * with a larger alignment requirement cannot be tracked.
+ */
+#define HEAP_TRACKING_MAX_OFFSET 0xffff
+
+/**
+ * Maximum number of threads that can be in a tagged scope at the same time.
+ */
+#ifndef HEAP_TRACKING_MAX_THREADS
+#define HEAP_TRACKING_MAX_THREADS 16
+#endif
+
+/**
+ * Duration of the window over which the allocation rate is measured, in milliseconds.
+ */
+#define HEAP_TRACKING_RATE_WINDOW 1000
+
+/**
+ * Version of the binary format of the heap tracking statistics.
+ */
+#define HEAP_TRACKING_FORMAT_VERSION 1
+
+/**
+ * Subsystem tags.
+ */
+typedef enum heap_tag {
+    HEAP_TAG_OTHER = 0, ///< Allocations made outside of any tagged scope.
+    HEAP_TAG_SYSTEM = 1, ///< System thread.
+    HEAP_TAG_PROTOCOL = 2, ///< Cloud protocol.
+    HEAP_TAG_LEDGER = 3, ///< Ledger synchronization.
+    HEAP_TAG_BLE = 4, ///< BLE stack.
+    HEAP_TAG_NCP = 5, ///< Network co-processor and AT commands.
+    HEAP_TAG_NETWORK = 6, ///< TCP/IP stack.
+    HEAP_TAG_USER = 7, ///< User application.
+    HEAP_TAG_COUNT = 8 ///< Number of tags.
+} heap_tag;
+
+/**
+ * Allocation statistics of a subsystem.
+ */
+typedef struct heap_tag_stats {
+    uint32_t used_size; ///< Number of bytes currently allocated.
+    uint32_t peak_size; ///< Maximum value of `used_size` since startup.
+    uint32_t alloc_count; ///< Total number of allocations.
+    uint32_t free_count; ///< Total number of deallocations.
+    uint32_t alloc_rate; ///< Number of allocations made during the last complete rate window.
+} heap_tag_stats;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Set the tag for the allocations made by the calling thread.
+ *
+ * @param tag Tag as defined by the `heap_tag` enum.
+ * @param reserved This argument should be set to NULL.
+ * @return Previously set tag, which should be passed to `heap_tag_leave()`, or a negative result
+ *         code in case of an error.
+ */
+int heap_tag_enter(int tag, void* reserved);
+
+/**
+ * Restore the tag that was set before the matching call to `heap_tag_enter()`.
+ *
+ * @param prev_tag Value returned by `heap_tag_enter()`. Negative values are ignored.
+ * @param reserved This argument should be set to NULL.
+ */
+void heap_tag_leave(int prev_tag, void* reserved);
+
+/**
+ * Get the tag set for the calling thread.
+ *
+ * @param reserved This argument should be set to NULL.
+ * @return Tag as defined by the `heap_tag` enum.
+ */
+int heap_tag_current(void* reserved);
+
+/**
+ * Get the allocation statistics of a subsystem.
+ *
+ * @param tag Tag as defined by the `heap_tag` enum.
+ * @param stats Statistics.
+ * @param reserved This argument should be set to NULL.
+ * @return 0 on success or a negative result code in case of an error.
+ */
+int heap_tracking_get_stats(int tag, heap_tag_stats* stats, void* reserved);
+
+/**
+ * Serialize the allocation statistics of all subsystems in the binary format.
+ *
+ * The output starts with the following header (all fields are little-endian):
+ *
+ * Field         | Size | Description
+ * --------------|------|------------
+ * version       | 1    | Format version (`HEAP_TRACKING_FORMAT_VERSION`)
+ * count         | 1    | Number of tags that follow
+ * reserved      | 2    | Reserved, set to 0
+ * window        | 4    | Duration of the rate window in milliseconds
+ *
+ * Each tag is encoded as follows:
+ *
+ * Field         | Size | Description
+ * --------------|------|------------
+ * tag           | 1    | Tag as defined by the `heap_tag` enum
+ * reserved      | 3    | Reserved, set to 0
+ * used_size     | 4    | See `heap_tag_stats`
+ * peak_size     | 4    | See `heap_tag_stats`
+ * alloc_count   | 4    | See `heap_tag_stats`
+ * free_count    | 4    | See `heap_tag_stats`
+ * alloc_rate    | 4    | See `heap_tag_stats`
+ *
+ * @param max_size Maximum size of the output in bytes.
+ * @param append Appender callback.
+ * @param append_data Appender data.
+ * @param reserved This argument should be set to NULL.
+ * @return 0 on success or a negative result code in case of an error.
+ */
+int heap_tracking_format(size_t max_size, appender_fn append, void* append_data, void* reserved);
+
+/**
+ * Get the name of a tag.
+ *
+ * @param tag Tag as defined by the `heap_tag` enum.
+ * @return Tag name or NULL if the tag is invalid.
+ */
+const char* heap_tag_name(int tag);
+
+/**
+ * Initialize the header of a newly allocated block and account for the allocation.
+ *
+ * This function is called by the allocator and must not be called concurrently with
+ * `heap_tracking_on_free()`.
+ *
+ * @param block Block of at least `size + offset` bytes.
+ * @param size Requested size.
+ * @param offset Offset of the memory returned to the caller from the beginning of the block. Must
+ *        be at least `HEAP_TRACKING_HEADER_SIZE` and not greater than `HEAP_TRACKING_MAX_OFFSET`.
+ * @param tag Tag to assign to the allocation, or a negative value to use the tag of the calling
+ *        thread.
+ * @return Pointer to the memory that should be returned to the caller.
+ */
+void* heap_tracking_on_alloc(void* block, size_t size, size_t offset, int tag);
+
+/**
+ * Account for the deallocation of a block.
+ *
+ * This function is called by the allocator and must not be called concurrently with
+ * `heap_tracking_on_alloc()`.
+ *
+ * @param ptr Pointer returned by `heap_tracking_on_alloc()`.
+ * @param[out] size If not NULL, set to the requested size of the allocation.
+ * @param[out] tag If not NULL, set to the tag of the allocation.
+ * @return Pointer to the block that should be freed.
+ */
+void* heap_tracking_on_free(void* ptr, size_t* size, int* tag);
+
+/**
+ * Get the requested size of an allocation.
+ *
+ * @param ptr Pointer returned by `heap_tracking_on_alloc()`.
+ * @return Size in bytes.
+ */
+size_t heap_tracking_alloc_size(const void* ptr);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#if HEAP_TRACKING_ENABLED
+
+#ifdef __cplusplus
+
+/**
+ * Tag the allocations made by the calling thread for the rest of the enclosing scope.
+ */
+#define HEAP_TAG_SCOPE(_tag) \
+        const ::particle::HeapTagScope PP_CAT(_heap_tag_scope_, __LINE__)(_tag)
+
+namespace particle {
+
+class HeapTagScope {
+public:
+    explicit HeapTagScope(int tag) :
+            prevTag_(heap_tag_enter(tag, nullptr)) {
+    }
+
+    ~HeapTagScope() {
+        heap_tag_leave(prevTag_, nullptr);
+    }
+
+    HeapTagScope(const HeapTagScope&) = delete;
+    HeapTagScope& operator=(const HeapTagScope&) = delete;
+
+private:
+    int prevTag_;
+};
+
+} // namespace particle
+
+#endif // defined(__cplusplus)
+
+#else // !HEAP_TRACKING_ENABLED
+
+#define HEAP_TAG_SCOPE(_tag)
+
+#endif // !HEAP_TRACKING_ENABLED
@@ -19,6 +19,7 @@
 #define SERVICES_RINGBUFFER_H
 
 #include <cstddef>
+#include <atomic>
 #include <sys/types.h>
 #include "system_error.h"
 #include "check.h"
@@ -71,9 +72,33 @@ public:
     T* consume(size_t size);
     ssize_t consumeCommit(size_t size, size_t cancel = 0);
 
+    /*
+     * Zero-copy single-producer/single-consumer API.
+     *
+     * The producer calls acquireWrite() to get a contiguous writable region, fills it in place and
+     * publishes the data with commitWrite(). The consumer calls peekRead() to get a contiguous readable
+     * region and releases it with commitRead(). Each region ends either at the end of the buffer or
+     * at the position of the other side, so the data may need to be accessed in two steps when it
+     * wraps around.
+     *
+     * Lock-free guarantees: one producer and one consumer may use these methods concurrently, e.g. from
+     * an ISR and a thread, without additional locking. The producer only modifies head_ and the consumer
+     * only modifies tail_. acquireWrite() always leaves one element unused, so the buffer never becomes
+     * full through this API and full_ is never shared between the two sides. The producer must not mix
+     * these methods with put() or acquire()/acquireCommit() on the same buffer; the consumer side may
+     * use get() and consume()/consumeCommit() interchangeably with peekRead()/commitRead().
+     */
+    T* acquireWrite(size_t* size);
+    ssize_t commitWrite(size_t size);
+
+    T* peekRead(size_t* size) const;
+    ssize_t commitRead(size_t size);
+
 private:
     size_t curData() const;
     size_t curSpace() const;
+    size_t writableRegion() const;
+    size_t readableRegion() const;
     void updateCurSize();
 
 public:
@@ -350,11 +375,95 @@ inline ssize_t RingBuffer<T>::consumeCommit(size_t size, size_t cancel) {
     return (size);
 }
 
+template <typename T>
+inline T* RingBuffer<T>::acquireWrite(size_t* size) {
+    if (headPending_ != 0) {
+        // A DMA transfer is in progress
+        *size = 0;
+        return nullptr;
+    }
+    updateCurSize();
+    const size_t n = writableRegion();
+    *size = n;
+    return n ? buffer_ + head_ : nullptr;
+}
+
+template <typename T>
+inline ssize_t RingBuffer<T>::commitWrite(size_t size) {
+    if (size == 0) {
+        return 0;
+    }
+    CHECK_TRUE(headPending_ == 0, SYSTEM_ERROR_INVALID_STATE);
+    CHECK_TRUE(writableRegion() >= size, SYSTEM_ERROR_TOO_LARGE);
+    // Make sure the data is written to the buffer before it's published to the consumer
+    std::atomic_thread_fence(std::memory_order_release);
+    head_ = wrap(head_ + size, curSize_);
+    return size;
+}
+
+template <typename T>
+inline T* RingBuffer<T>::peekRead(size_t* size) const {
+    if (tailPending_ != 0) {
+        // A DMA transfer is in progress
+        *size = 0;
+        return nullptr;
+    }
+    const size_t n = readableRegion();
+    // Make sure the data is not read from the buffer before head_ is loaded
+    std::atomic_thread_fence(std::memory_order_acquire);
+    *size = n;
+    return n ? buffer_ + tail_ : nullptr;
+}
+
+template <typename T>
+inline ssize_t RingBuffer<T>::commitRead(size_t size) {
+    if (size == 0) {
+        return 0;
+    }
+    CHECK_TRUE(tailPending_ == 0, SYSTEM_ERROR_INVALID_STATE);
+    CHECK_TRUE(readableRegion() >= size, SYSTEM_ERROR_TOO_LARGE);
+    // Make sure the data is read from the buffer before the region is released to the producer
+    std::atomic_thread_fence(std::memory_order_release);
+    tail_ = wrap(tail_ + size, curSize_);
+    if (full_) {
+        // Can only be set by a producer that doesn't use acquireWrite()
+        full_ = false;
+    }
+    return size;
+}
+
 template <typename T>
 inline size_t RingBuffer<T>::curSpace() const {
     return curSize_ - curData();
 }
 
+// Size of the contiguous region that can be written by acquireWrite()/commitWrite()
+template <typename T>
+inline size_t RingBuffer<T>::writableRegion() const {
+    const size_t head = head_;
+    const size_t tail = tail_;
+    if (head >= tail && !full_) {
+        // Keep one element free if the region would end right behind the tail
+        return curSize_ - head - (tail == 0 ? 1 : 0);
+    } else if (head < tail) {
+        return tail - head - 1;
+    }
+    return 0;
+}
+
+// Size of the contiguous region that can be read by peekRead()/commitRead()
+template <typename T>
+inline size_t RingBuffer<T>::readableRegion() const {
+    const size_t head = head_;
+    const size_t tail = tail_;
+    if (head > tail) {
+        return head - tail;
+    } else if (head < tail || full_) {
+        return curSize_ - tail;
+    }
+    return 0;
+}
+
 template <typename T>
 inline size_t RingBuffer<T>::curData() const {
     // Tail is only modified by the consumer/reader, we don't care about it
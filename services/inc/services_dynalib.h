@@ -96,6 +96,14 @@ DYNALIB_FN(48, services, devicetree_tree_lock, int(void*))
 DYNALIB_FN(49, services, devicetree_tree_get, int(void*, uint32_t, void*))
 DYNALIB_FN(50, services, devicetree_string_dictionary_lookup, const char*(uint32_t, void*))
 DYNALIB_FN(51, services, devicetree_hash_string, uint32_t(const char*, size_t))
+DYNALIB_FN(52, services, trace_event, void(int, const char*, void*))
+DYNALIB_FN(53, services, trace_format, int(uint32_t*, size_t, appender_fn, void*, void*))
+DYNALIB_FN(54, services, heap_tag_enter, int(int, void*))
+DYNALIB_FN(55, services, heap_tag_leave, void(int, void*))
+DYNALIB_FN(56, services, heap_tag_current, int(void*))
+DYNALIB_FN(57, services, heap_tracking_get_stats, int(int, heap_tag_stats*, void*))
+DYNALIB_FN(58, services, heap_tracking_format, int(size_t, appender_fn, void*, void*))
+DYNALIB_FN(59, services, heap_tag_name, const char*(int))
 
 DYNALIB_END(services)
 
@@ -28,6 +28,8 @@ enum class SystemCacheKey : uint16_t {
     WIZNET_CONFIG_DATA = 0x0003,
     CELLULAR_NCP_OPERATION_MODE = 0x0004,
     CELLULAR_DEVICE_INFO = 0x0005,
+    CELLULAR_NCP_CONFIG_FINGERPRINT = 0x0006,
+    MODULE_VALIDATION = 0x0007,
     ASSET_MANAGER_CONSUMER_STATE = 0x0010,
 };
 
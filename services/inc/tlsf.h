@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace particle {
+
+/**
+ * Two-level segregated fit (TLSF) memory allocator.
+ *
+ * Free blocks are kept in an array of lists indexed by a first-level class (a power of two) and
+ * a second-level class (a linear subdivision of the power of two). A pair of bitmaps tracks which
+ * lists are non-empty, so finding a suitable free block and returning a block to the free lists
+ * both take constant time regardless of the number of blocks in the heap. Adjacent free blocks
+ * are merged immediately.
+ *
+ * Every block is preceded by a header of `BLOCK_OVERHEAD` bytes and the returned pointers are
+ * aligned to `ALIGNMENT` bytes.
+ *
+ * This class is not thread-safe.
+ */
+class Tlsf {
+public:
+    struct Stats {
+        size_t totalSize; // Total size of the pools
+        size_t freeSize; // Total size of the free blocks, including their headers
+        size_t minFreeSize; // Lowest value of `freeSize` since the first pool was added
+        size_t largestFreeBlock; // Size of the largest block that can be allocated
+        size_t freeBlockCount;
+        size_t usedBlockCount;
+    };
+
+    static constexpr size_t ALIGNMENT = 2 * sizeof(void*);
+    static constexpr size_t BLOCK_OVERHEAD = 2 * sizeof(void*);
+    static constexpr size_t MIN_BLOCK_SIZE = 2 * sizeof(void*);
+
+    // Size of the pool space that is not available for allocation
+    static constexpr size_t POOL_OVERHEAD = 2 * BLOCK_OVERHEAD;
+
+    // Blocks of up to 8MB are supported on 32-bit targets and up to 2GB on 64-bit hosts
+    static constexpr size_t MAX_BLOCK_SIZE = ((size_t)1 << ((sizeof(void*) == 8) ? 31 : 23)) - ALIGNMENT;
+
+    Tlsf();
+
+    /**
+     * Add a memory region to the heap.
+     *
+     * The region must not overlap with any other pool. Pools are never merged even if they are
+     * adjacent. A region that is larger than `MAX_BLOCK_SIZE + POOL_OVERHEAD` is truncated.
+     *
+     * @return 0 on success or a negative result code in case of an error.
+     */
+    int addPool(void* mem, size_t size);
+
+    /**
+     * Allocate a block.
+     *
+     * @return Pointer to the allocated memory or `nullptr` if the request cannot be satisfied or
+     *         `size` is 0.
+     */
+    void* alloc(size_t size);
+
+    /**
+     * Free a block. Passing `nullptr` is a no-op.
+     */
+    void free(void* ptr);
+
+    /**
+     * Resize a block.
+     *
+     * The block is grown or shrunk in place whenever possible. Growing in place requires the
+     * block that physically follows the resized block to be free and large enough.
+     *
+     * @return Pointer to the resized block or `nullptr` in case of an error, in which case the
+     *         original block is left unchanged. If `size` is 0, the block is freed and `nullptr`
+     *         is returned.
+     */
+    void* realloc(void* ptr, size_t size);
+
+    /**
+     * Get the usable size of an allocated block.
+     */
+    static size_t blockSize(const void* ptr);
+
+    /**
+     * Get the size of the largest block that can be allocated.
+     */
+    size_t largestFreeBlock() const;
+
+    void getStats(Stats* stats) const;
+
+    /**
+     * Check the consistency of the free lists.
+     *
+     * @return 0 if the free lists are consistent or a negative result code otherwise.
+     */
+    int check() const;
+
+private:
+    struct Block;
+
+    static constexpr unsigned SL_INDEX_COUNT_LOG2 = 4;
+    static constexpr unsigned SL_INDEX_COUNT = 1 << SL_INDEX_COUNT_LOG2;
+    static constexpr unsigned ALIGNMENT_LOG2 = (sizeof(void*) == 8) ? 4 : 3;
+    static constexpr unsigned FL_INDEX_SHIFT = SL_INDEX_COUNT_LOG2 + ALIGNMENT_LOG2;
+    static constexpr unsigned FL_INDEX_MAX = (sizeof(void*) == 8) ? 31 : 23;
+    static constexpr unsigned FL_INDEX_COUNT = FL_INDEX_MAX - FL_INDEX_SHIFT + 1;
+    static constexpr size_t SMALL_BLOCK_SIZE = (size_t)1 << FL_INDEX_SHIFT;
+
+    Block* blocks_[FL_INDEX_COUNT][SL_INDEX_COUNT]; // Free lists
+    uint32_t slBitmaps_[FL_INDEX_COUNT];
+    uint32_t flBitmap_;
+    size_t totalSize_;
+    size_t freeSize_;
+    size_t minFreeSize_;
+    size_t freeBlockCount_;
+    size_t usedBlockCount_;
+
+    void insertFreeBlock(Block* b);
+    void removeFreeBlock(Block* b);
+    Block* findFreeBlock(size_t size);
+    void releaseBlock(Block* b);
+    void trimBlock(Block* b, size_t size);
+
+    static void mapping(size_t size, unsigned* fl, unsigned* sl);
+    static size_t adjustSize(size_t size);
+};
+
+} // namespace particle
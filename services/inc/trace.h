@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "appender.h"
+#include "preprocessor.h"
+#include "module_info.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * Tracing is disabled by default. Build with `TRACE=y` to enable it.
+ *
+ * When tracing is disabled, the `TRACE_*()` macros expand to nothing and their arguments are not
+ * evaluated.
+ */
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 0
+#endif
+
+// Tracing is not supported in the bootloader
+#if defined(MODULE_FUNCTION) && MODULE_FUNCTION == MOD_FUNC_BOOTLOADER
+#undef TRACE_ENABLED
+#define TRACE_ENABLED 0
+#endif
+
+/**
+ * Maximum number of events stored in the trace buffer. Older events are overwritten.
+ */
+#ifndef TRACE_BUFFER_SIZE
+#define TRACE_BUFFER_SIZE 512
+#endif
+
+/**
+ * Version of the binary trace format.
+ */
+#define TRACE_FORMAT_VERSION 1
+
+/**
+ * Event types.
+ */
+typedef enum trace_event_type {
+    TRACE_EVENT_BEGIN = 1, ///< Beginning of a duration.
+    TRACE_EVENT_END = 2, ///< End of a duration.
+    TRACE_EVENT_INSTANT = 3 ///< Instant event.
+} trace_event_type;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Record a trace event.
+ *
+ * This function can be called from any thread or an ISR.
+ *
+ * @param type Event type as defined by the `trace_event_type` enum.
+ * @param name Event name. Must be a string literal or otherwise have static storage duration.
+ * @param reserved This argument should be set to NULL.
+ */
+void trace_event(int type, const char* name, void* reserved);
+
+/**
+ * Serialize the recorded events in the binary trace format.
+ *
+ * The output starts with the following header (all fields are little-endian):
+ *
+ * Field         | Size | Description
+ * --------------|------|------------
+ * version       | 1    | Format version (`TRACE_FORMAT_VERSION`)
+ * reserved      | 1    | Reserved, set to 0
+ * count         | 2    | Number of events that follow
+ * first         | 4    | Index of the first event
+ * next          | 4    | Index of the event following the last one
+ *
+ * Each event is encoded as follows:
+ *
+ * Field         | Size | Description
+ * --------------|------|------------
+ * time          | 4    | Timestamp in microseconds
+ * thread        | 4    | Thread ID
+ * type          | 1    | Event type as defined by the `trace_event_type` enum
+ * name_size     | 1    | Size of the event name
+ * name          | N    | Event name
+ *
+ * If `first` is greater than the requested position, some of the events have been overwritten
+ * before they could be read.
+ *
+ * @param pos[in,out] Index of the first event to serialize. On return, set to the index of the
+ *        event following the last serialized one.
+ * @param max_size Maximum size of the output in bytes.
+ * @param append Appender callback.
+ * @param append_data Appender data.
+ * @param reserved This argument should be set to NULL.
+ * @return Number of serialized events, or a negative result code in case of an error.
+ */
+int trace_format(uint32_t* pos, size_t max_size, appender_fn append, void* append_data, void* reserved);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#if TRACE_ENABLED
+
+#define TRACE_BEGIN(_name) \
+        trace_event(TRACE_EVENT_BEGIN, _name, NULL)
+
+#define TRACE_END(_name) \
+        trace_event(TRACE_EVENT_END, _name, NULL)
+
+#define TRACE_INSTANT(_name) \
+        trace_event(TRACE_EVENT_INSTANT, _name, NULL)
+
+#ifdef __cplusplus
+
+/**
+ * Record a duration that spans the rest of the enclosing scope.
+ */
+#define TRACE_SCOPE(_name) \
+        const ::particle::TraceScope PP_CAT(_trace_scope_, __LINE__)(_name)
+
+namespace particle {
+
+class TraceScope {
+public:
+    explicit TraceScope(const char* name) :
+            name_(name) {
+        TRACE_BEGIN(name_);
+    }
+
+    ~TraceScope() {
+        TRACE_END(name_);
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name_;
+};
+
+} // namespace particle
+
+#endif // defined(__cplusplus)
+
+#else // !TRACE_ENABLED
+
+#define TRACE_BEGIN(_name)
+#define TRACE_END(_name)
+#define TRACE_INSTANT(_name)
+#define TRACE_SCOPE(_name)
+
+#endif // !TRACE_ENABLED
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "block_cache.h"
+
+#include "system_error.h"
+#include "check.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+
+namespace particle {
+
+BlockCache::BlockCache() :
+        stream_(nullptr),
+        stats_(),
+        size_(0),
+        blockSize_(0),
+        blockCount_(0),
+        useCount_(0) {
+}
+
+int BlockCache::init(InputStream* stream, size_t size, size_t blockSize, size_t blockCount) {
+    CHECK_TRUE(stream && blockSize > 0 && blockCount > 0, SYSTEM_ERROR_INVALID_ARGUMENT);
+    CHECK_TRUE(blockSize <= MAX_BLOCK_SIZE && blockCount <= MAX_BLOCK_COUNT, SYSTEM_ERROR_INVALID_ARGUMENT);
+    // Make sure the buffer size doesn't overflow if the above limits are ever raised
+    CHECK_TRUE(blockCount <= SIZE_MAX / blockSize, SYSTEM_ERROR_INVALID_ARGUMENT);
+    std::unique_ptr<char[]> buf(new(std::nothrow) char[blockSize * blockCount]);
+    std::unique_ptr<Block[]> blocks(new(std::nothrow) Block[blockCount]);
+    CHECK_TRUE(buf && blocks, SYSTEM_ERROR_NO_MEMORY);
+    buf_ = std::move(buf);
+    blocks_ = std::move(blocks);
+    stream_ = stream;
+    size_ = size;
+    blockSize_ = blockSize;
+    blockCount_ = blockCount;
+    invalidate();
+    resetStats();
+    return 0;
+}
+
+int BlockCache::read(size_t offset, char* data, size_t size) {
+    CHECK_TRUE(stream_, SYSTEM_ERROR_INVALID_STATE);
+    if (offset >= size_) {
+        return SYSTEM_ERROR_END_OF_STREAM;
+    }
+    size = std::min(size, size_ - offset);
+    size_t n = 0;
+    while (n < size) {
+        const char* d = nullptr;
+        const size_t avail = CHECK(map(offset + n, &d));
+        const size_t chunk = std::min(avail, size - n);
+        std::memcpy(data + n, d, chunk);
+        n += chunk;
+    }
+    return n;
+}
+
+int BlockCache::map(size_t offset, const char** data) {
+    CHECK_TRUE(stream_, SYSTEM_ERROR_INVALID_STATE);
+    if (offset >= size_) {
+        return SYSTEM_ERROR_END_OF_STREAM;
+    }
+    const size_t index = offset / blockSize_;
+    const size_t slot = CHECK(block(index));
+    const size_t offsInBlock = offset - index * blockSize_;
+    const size_t blockEnd = std::min(size_ - index * blockSize_, blockSize_);
+    *data = buf_.get() + slot * blockSize_ + offsInBlock;
+    return blockEnd - offsInBlock;
+}
+
+void BlockCache::invalidate() {
+    for (size_t i = 0; i < blockCount_; ++i) {
+        blocks_[i] = Block();
+    }
+    useCount_ = 0;
+}
+
+int BlockCache::block(size_t index) {
+    // The number of blocks is expected to be small, so a linear search is good enough
+    size_t slot = 0;
+    for (size_t i = 0; i < blockCount_; ++i) {
+        const auto& b = blocks_[i];
+        if (b.valid && b.index == index) {
+            blocks_[i].lastUsed = ++useCount_;
+            ++stats_.hits;
+            return i;
+        }
+        const auto& s = blocks_[slot];
+        if (s.valid && (!b.valid || (int32_t)(b.lastUsed - s.lastUsed) < 0)) {
+            slot = i;
+        }
+    }
+    auto& b = blocks_[slot];
+    if (b.valid) {
+        b.valid = false;
+        ++stats_.evictions;
+    }
+    const size_t offset = index * blockSize_;
+    const size_t size = std::min(size_ - offset, blockSize_);
+    char* data = buf_.get() + slot * blockSize_;
+    CHECK(stream_->seek(offset));
+    size_t n = 0;
+    while (n < size) {
+        const int r = stream_->read(data + n, size - n);
+        if (r == SYSTEM_ERROR_END_OF_STREAM) {
+            return SYSTEM_ERROR_NOT_ENOUGH_DATA;
+        }
+        CHECK(r);
+        CHECK_TRUE(r > 0, SYSTEM_ERROR_NOT_ENOUGH_DATA);
+        n += r;
+    }
+    b.index = index;
+    b.lastUsed = ++useCount_;
+    b.valid = true;
+    ++stats_.misses;
+    return slot;
+}
+
+} // particle
@@ -0,0 +1,346 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "heap_tracking.h"
+
+#include "system_error.h"
+
+#if HEAP_TRACKING_ENABLED
+
+#include "timer_hal.h"
+#include "interrupts_hal.h"
+#include "concurrent_hal.h"
+#include "hal_platform.h"
+
+#include "endian_util.h"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+
+namespace particle {
+
+namespace {
+
+const size_t HEADER_SIZE = 8;
+const size_t TAG_ENTRY_SIZE = 24;
+
+const char* const TAG_NAMES[HEAP_TAG_COUNT] = {
+    "other",
+    "sys",
+    "proto",
+    "ledger",
+    "ble",
+    "ncp",
+    "net",
+    "app"
+};
+
+// Stored immediately before the memory returned to the caller
+struct BlockHeader {
+    size_t size;
+    uint16_t tag;
+    uint16_t offset; // Offset of the memory returned to the caller from the beginning of the block
+};
+
+static_assert(sizeof(BlockHeader) == HEAP_TRACKING_HEADER_SIZE, "Invalid size of the block header");
+
+// Counters are only updated by the allocator, which serializes the calls to the tracking hooks
+struct TagStats {
+    size_t usedSize;
+    size_t peakSize;
+    uint32_t allocCount;
+    uint32_t freeCount;
+    uint32_t windowCount; // Number of allocations in the current rate window
+    uint32_t lastWindowCount; // Number of allocations in the previous rate window
+};
+
+TagStats g_stats[HEAP_TAG_COUNT] = {};
+uint64_t g_windowStart = 0;
+
+#if PLATFORM_THREADING
+
+struct ThreadTag {
+    std::atomic<os_thread_t> thread;
+    int tag; // Only accessed by the owning thread
+    unsigned depth; // Number of nested scopes
+};
+
+ThreadTag g_threadTags[HEAP_TRACKING_MAX_THREADS] = {};
+
+os_thread_t currentThread() {
+    if (hal_interrupt_is_isr()) {
+        return nullptr;
+    }
+    return os_thread_current(nullptr);
+}
+
+ThreadTag* findThreadTag(os_thread_t thread) {
+    for (auto& t: g_threadTags) {
+        if (t.thread.load(std::memory_order_relaxed) == thread) {
+            return &t;
+        }
+    }
+    return nullptr;
+}
+
+ThreadTag* claimThreadTag(os_thread_t thread) {
+    for (auto& t: g_threadTags) {
+        os_thread_t expected = nullptr;
+        if (t.thread.compare_exchange_strong(expected, thread, std::memory_order_relaxed)) {
+            t.tag = HEAP_TAG_OTHER;
+            t.depth = 0;
+            return &t;
+        }
+    }
+    return nullptr;
+}
+
+#else
+
+int g_tag = HEAP_TAG_OTHER;
+
+#endif // !PLATFORM_THREADING
+
+inline bool isValidTag(int tag) {
+    return tag >= 0 && tag < HEAP_TAG_COUNT;
+}
+
+void updateRateWindow(uint64_t now) {
+    const uint64_t elapsed = now - g_windowStart;
+    if (elapsed < HEAP_TRACKING_RATE_WINDOW) {
+        return;
+    }
+    const bool adjacent = elapsed < 2 * HEAP_TRACKING_RATE_WINDOW;
+    for (auto& s: g_stats) {
+        s.lastWindowCount = adjacent ? s.windowCount : 0;
+        s.windowCount = 0;
+    }
+    g_windowStart = now;
+}
+
+// Returns the number of allocations in the last complete window without updating the counters
+uint32_t allocRate(const TagStats& s, uint64_t now) {
+    const uint64_t elapsed = now - g_windowStart;
+    if (elapsed < HEAP_TRACKING_RATE_WINDOW) {
+        return s.lastWindowCount;
+    }
+    if (elapsed < 2 * HEAP_TRACKING_RATE_WINDOW) {
+        return s.windowCount;
+    }
+    return 0;
+}
+
+inline uint32_t clampSize(size_t size) {
+    return std::min<size_t>(size, std::numeric_limits<uint32_t>::max());
+}
+
+bool appendUint32(appender_fn append, void* data, uint32_t val) {
+    val = nativeToLittleEndian(val);
+    return append(data, (const uint8_t*)&val, sizeof(val));
+}
+
+} // namespace
+
+} // namespace particle
+
+using namespace particle;
+
+int heap_tag_enter(int tag, void* reserved) {
+    if (!isValidTag(tag)) {
+        return SYSTEM_ERROR_INVALID_ARGUMENT;
+    }
+#if PLATFORM_THREADING
+    const auto thread = currentThread();
+    if (!thread) {
+        return SYSTEM_ERROR_INVALID_STATE;
+    }
+    auto t = findThreadTag(thread);
+    if (!t) {
+        t = claimThreadTag(thread);
+        if (!t) {
+            return SYSTEM_ERROR_LIMIT_EXCEEDED;
+        }
+    }
+    const int prev = t->tag;
+    t->tag = tag;
+    ++t->depth;
+    return prev;
+#else
+    const int prev = g_tag;
+    g_tag = tag;
+    return prev;
+#endif
+}
+
+void heap_tag_leave(int prevTag, void* reserved) {
+    if (!isValidTag(prevTag)) {
+        return;
+    }
+#if PLATFORM_THREADING
+    const auto thread = currentThread();
+    if (!thread) {
+        return;
+    }
+    const auto t = findThreadTag(thread);
+    if (!t) {
+        return;
+    }
+    t->tag = prevTag;
+    if (--t->depth == 0) {
+        // Release the slot for other threads
+        t->thread.store(nullptr, std::memory_order_relaxed);
+    }
+#else
+    g_tag = prevTag;
+#endif
+}
+
+int heap_tag_current(void* reserved) {
+#if PLATFORM_THREADING
+    const auto thread = currentThread();
+    if (thread) {
+        const auto t = findThreadTag(thread);
+        if (t) {
+            return t->tag;
+        }
+    }
+    return HEAP_TAG_OTHER;
+#else
+    return g_tag;
+#endif
+}
+
+int heap_tracking_get_stats(int tag, heap_tag_stats* stats, void* reserved) {
+    if (!isValidTag(tag) || !stats) {
+        return SYSTEM_ERROR_INVALID_ARGUMENT;
+    }
+    const auto& s = g_stats[tag];
+    stats->used_size = clampSize(s.usedSize);
+    stats->peak_size = clampSize(s.peakSize);
+    stats->alloc_count = s.allocCount;
+    stats->free_count = s.freeCount;
+    stats->alloc_rate = allocRate(s, hal_timer_millis(nullptr));
+    return 0;
+}
+
+int heap_tracking_format(size_t maxSize, appender_fn append, void* appendData, void* reserved) {
+    if (!append) {
+        return SYSTEM_ERROR_INVALID_ARGUMENT;
+    }
+    if (maxSize < HEADER_SIZE + HEAP_TAG_COUNT * TAG_ENTRY_SIZE) {
+        return SYSTEM_ERROR_TOO_LARGE;
+    }
+    const uint8_t h[] = { HEAP_TRACKING_FORMAT_VERSION, HEAP_TAG_COUNT, 0 /* reserved */, 0 /* reserved */ };
+    if (!append(appendData, h, sizeof(h)) || !appendUint32(append, appendData, HEAP_TRACKING_RATE_WINDOW)) {
+        return SYSTEM_ERROR_TOO_LARGE;
+    }
+    for (int tag = 0; tag < HEAP_TAG_COUNT; ++tag) {
+        heap_tag_stats s = {};
+        heap_tracking_get_stats(tag, &s, nullptr);
+        const uint8_t d[] = { (uint8_t)tag, 0 /* reserved */, 0 /* reserved */, 0 /* reserved */ };
+        if (!append(appendData, d, sizeof(d)) || !appendUint32(append, appendData, s.used_size) ||
+                !appendUint32(append, appendData, s.peak_size) || !appendUint32(append, appendData, s.alloc_count) ||
+                !appendUint32(append, appendData, s.free_count) || !appendUint32(append, appendData, s.alloc_rate)) {
+            return SYSTEM_ERROR_TOO_LARGE;
+        }
+    }
+    return 0;
+}
+
+const char* heap_tag_name(int tag) {
+    if (!isValidTag(tag)) {
+        return nullptr;
+    }
+    return TAG_NAMES[tag];
+}
+
+void* heap_tracking_on_alloc(void* block, size_t size, size_t offset, int tag) {
+    if (!isValidTag(tag)) {
+        tag = heap_tag_current(nullptr);
+    }
+    const auto h = (BlockHeader*)((char*)block + offset) - 1;
+    h->size = size;
+    h->tag = tag;
+    h->offset = offset;
+    updateRateWindow(hal_timer_millis(nullptr));
+    auto& s = g_stats[tag];
+    s.usedSize += size;
+    if (s.usedSize > s.peakSize) {
+        s.peakSize = s.usedSize;
+    }
+    ++s.allocCount;
+    ++s.windowCount;
+    return h + 1;
+}
+
+void* heap_tracking_on_free(void* ptr, size_t* size, int* tag) {
+    const auto h = static_cast<BlockHeader*>(ptr) - 1;
+    auto& s = g_stats[h->tag];
+    s.usedSize -= h->size;
+    ++s.freeCount;
+    if (size) {
+        *size = h->size;
+    }
+    if (tag) {
+        *tag = h->tag;
+    }
+    return (char*)ptr - h->offset;
+}
+
+size_t heap_tracking_alloc_size(const void* ptr) {
+    return ((const BlockHeader*)ptr - 1)->size;
+}
+
+#else // !HEAP_TRACKING_ENABLED
+
+int heap_tag_enter(int tag, void* reserved) {
+    return SYSTEM_ERROR_NOT_SUPPORTED;
+}
+
+void heap_tag_leave(int prevTag, void* reserved) {
+}
+
+int heap_tag_current(void* reserved) {
+    return HEAP_TAG_OTHER;
+}
+
+int heap_tracking_get_stats(int tag, heap_tag_stats* stats, void* reserved) {
+    return SYSTEM_ERROR_NOT_SUPPORTED;
+}
+
+int heap_tracking_format(size_t maxSize, appender_fn append, void* appendData, void* reserved) {
+    return SYSTEM_ERROR_NOT_SUPPORTED;
+}
+
+const char* heap_tag_name(int tag) {
+    return nullptr;
+}
+
+void* heap_tracking_on_alloc(void* block, size_t size, size_t offset, int tag) {
+    return block;
+}
+
+void* heap_tracking_on_free(void* ptr, size_t* size, int* tag) {
+    return ptr;
+}
+
+size_t heap_tracking_alloc_size(const void* ptr) {
+    return 0;
+}
+
+#endif // !HEAP_TRACKING_ENABLED
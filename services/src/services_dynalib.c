@@ -30,5 +30,7 @@
 #include "system_error.h"
 #include "led_service.h"
 #include "diagnostics.h"
+#include "trace.h"
+#include "heap_tracking.h"
 #include "printf_export.h"
 #include "services_dynalib.h"
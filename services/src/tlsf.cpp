@@ -0,0 +1,405 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tlsf.h"
+
+#include "system_error.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace particle {
+
+namespace {
+
+const size_t FREE_FLAG = 0x01;
+const size_t PREV_FREE_FLAG = 0x02;
+const size_t FLAG_MASK = FREE_FLAG | PREV_FREE_FLAG;
+
+// Index of the least significant bit set
+inline unsigned lowBit(uint32_t val) {
+    return __builtin_ctz(val);
+}
+
+// Index of the most significant bit set
+inline unsigned highBit(uint32_t val) {
+    return 31 - __builtin_clz(val);
+}
+
+inline unsigned sizeHighBit(size_t val) {
+    return sizeof(unsigned long long) * 8 - 1 - __builtin_clzll(val);
+}
+
+inline uintptr_t alignUp(uintptr_t val, size_t align) {
+    return (val + align - 1) & ~(uintptr_t)(align - 1);
+}
+
+inline size_t alignDown(size_t val, size_t align) {
+    return val & ~(align - 1);
+}
+
+} // namespace
+
+// The block header occupies the first two words, the free list links are stored in the block's
+// payload and are only valid while the block is free
+struct Tlsf::Block {
+    Block* prevPhys; // Physically preceding block. Only valid if the PREV_FREE flag is set
+    size_t sizeAndFlags;
+    Block* nextFree;
+    Block* prevFree;
+
+    size_t size() const {
+        return sizeAndFlags & ~FLAG_MASK;
+    }
+
+    void setSize(size_t size) {
+        sizeAndFlags = size | (sizeAndFlags & FLAG_MASK);
+    }
+
+    bool isFree() const {
+        return sizeAndFlags & FREE_FLAG;
+    }
+
+    bool isPrevFree() const {
+        return sizeAndFlags & PREV_FREE_FLAG;
+    }
+
+    char* payload() {
+        return reinterpret_cast<char*>(this) + BLOCK_OVERHEAD;
+    }
+
+    Block* next() {
+        return reinterpret_cast<Block*>(payload() + size());
+    }
+
+    // Marks the block as free and links it to the following block
+    void markFree() {
+        sizeAndFlags |= FREE_FLAG;
+        auto n = next();
+        n->prevPhys = this;
+        n->sizeAndFlags |= PREV_FREE_FLAG;
+    }
+
+    void markUsed() {
+        sizeAndFlags &= ~FREE_FLAG;
+        next()->sizeAndFlags &= ~PREV_FREE_FLAG;
+    }
+
+    static Block* fromPayload(const void* ptr) {
+        return reinterpret_cast<Block*>(const_cast<char*>(static_cast<const char*>(ptr)) - BLOCK_OVERHEAD);
+    }
+};
+
+Tlsf::Tlsf() :
+        blocks_(),
+        slBitmaps_(),
+        flBitmap_(0),
+        totalSize_(0),
+        freeSize_(0),
+        minFreeSize_(0),
+        freeBlockCount_(0),
+        usedBlockCount_(0) {
+    static_assert(offsetof(Block, nextFree) == BLOCK_OVERHEAD, "Unexpected size of the block header");
+    static_assert(sizeof(Block) - BLOCK_OVERHEAD == MIN_BLOCK_SIZE, "Unexpected minimum block size");
+    static_assert(ALIGNMENT == (1u << ALIGNMENT_LOG2), "Invalid alignment");
+    static_assert(SMALL_BLOCK_SIZE / SL_INDEX_COUNT == ALIGNMENT, "Invalid size of the small blocks");
+    static_assert(FL_INDEX_COUNT <= 32, "Invalid number of the first-level lists");
+    // The most significant bit of the block size must map to a valid first-level index
+    static_assert(MAX_BLOCK_SIZE < ((size_t)1 << FL_INDEX_MAX), "Invalid maximum block size");
+}
+
+int Tlsf::addPool(void* mem, size_t size) {
+    const auto start = alignUp((uintptr_t)mem, ALIGNMENT);
+    if (!mem || start - (uintptr_t)mem >= size) {
+        return SYSTEM_ERROR_INVALID_ARGUMENT;
+    }
+    size = alignDown(size - (start - (uintptr_t)mem), ALIGNMENT);
+    if (size < POOL_OVERHEAD + MIN_BLOCK_SIZE) {
+        return SYSTEM_ERROR_INVALID_ARGUMENT;
+    }
+    const auto blockSize = std::min(size - POOL_OVERHEAD, MAX_BLOCK_SIZE);
+    // The pool is terminated with a zero-sized block that is permanently marked as used, so that
+    // the blocks never need to check whether they're adjacent to the end of the pool
+    auto b = reinterpret_cast<Block*>(start);
+    b->prevPhys = nullptr;
+    b->sizeAndFlags = blockSize;
+    auto last = b->next();
+    last->prevPhys = nullptr;
+    last->sizeAndFlags = 0;
+    b->markFree();
+    insertFreeBlock(b);
+    const size_t poolSize = blockSize + POOL_OVERHEAD;
+    totalSize_ += poolSize;
+    freeSize_ += blockSize + BLOCK_OVERHEAD;
+    minFreeSize_ += blockSize + BLOCK_OVERHEAD;
+    return 0;
+}
+
+void* Tlsf::alloc(size_t size) {
+    if (!size || size > MAX_BLOCK_SIZE) {
+        return nullptr;
+    }
+    size = adjustSize(size);
+    const auto b = findFreeBlock(size);
+    if (!b) {
+        return nullptr;
+    }
+    removeFreeBlock(b);
+    b->markUsed();
+    freeSize_ -= b->size() + BLOCK_OVERHEAD;
+    ++usedBlockCount_;
+    trimBlock(b, size);
+    if (freeSize_ < minFreeSize_) {
+        minFreeSize_ = freeSize_;
+    }
+    return b->payload();
+}
+
+void Tlsf::free(void* ptr) {
+    if (!ptr) {
+        return;
+    }
+    const auto b = Block::fromPayload(ptr);
+    if (b->isFree()) {
+        return; // Double free
+    }
+    --usedBlockCount_;
+    releaseBlock(b);
+}
+
+void* Tlsf::realloc(void* ptr, size_t size) {
+    if (!ptr) {
+        return alloc(size);
+    }
+    if (!size) {
+        free(ptr);
+        return nullptr;
+    }
+    if (size > MAX_BLOCK_SIZE) {
+        return nullptr;
+    }
+    size = adjustSize(size);
+    const auto b = Block::fromPayload(ptr);
+    const size_t curSize = b->size();
+    if (size > curSize) {
+        const auto n = b->next();
+        if (!n->isFree() || curSize + n->size() + BLOCK_OVERHEAD < size) {
+            // Can't grow in place
+            const auto p = alloc(size);
+            if (!p) {
+                return nullptr;
+            }
+            std::memcpy(p, ptr, curSize);
+            free(ptr);
+            return p;
+        }
+        // Absorb the following block
+        removeFreeBlock(n);
+        freeSize_ -= n->size() + BLOCK_OVERHEAD;
+        b->setSize(curSize + n->size() + BLOCK_OVERHEAD);
+        b->markUsed();
+    }
+    trimBlock(b, size);
+    if (freeSize_ < minFreeSize_) {
+        minFreeSize_ = freeSize_;
+    }
+    return ptr;
+}
+
+size_t Tlsf::blockSize(const void* ptr) {
+    if (!ptr) {
+        return 0;
+    }
+    return Block::fromPayload(ptr)->size();
+}
+
+size_t Tlsf::largestFreeBlock() const {
+    if (!flBitmap_) {
+        return 0;
+    }
+    // The largest block is in the highest non-empty list, but the list is not sorted by size
+    const unsigned fl = highBit(flBitmap_);
+    const unsigned sl = highBit(slBitmaps_[fl]);
+    size_t size = 0;
+    for (auto b = blocks_[fl][sl]; b; b = b->nextFree) {
+        size = std::max(size, b->size());
+    }
+    return size;
+}
+
+void Tlsf::getStats(Stats* stats) const {
+    stats->totalSize = totalSize_;
+    stats->freeSize = freeSize_;
+    stats->minFreeSize = minFreeSize_;
+    stats->largestFreeBlock = largestFreeBlock();
+    stats->freeBlockCount = freeBlockCount_;
+    stats->usedBlockCount = usedBlockCount_;
+}
+
+int Tlsf::check() const {
+    size_t freeSize = 0;
+    size_t freeCount = 0;
+    for (unsigned fl = 0; fl < FL_INDEX_COUNT; ++fl) {
+        const bool flSet = flBitmap_ & (1u << fl);
+        if (flSet != (slBitmaps_[fl] != 0)) {
+            return SYSTEM_ERROR_BAD_DATA;
+        }
+        for (unsigned sl = 0; sl < SL_INDEX_COUNT; ++sl) {
+            const bool slSet = slBitmaps_[fl] & (1u << sl);
+            if (slSet != (blocks_[fl][sl] != nullptr)) {
+                return SYSTEM_ERROR_BAD_DATA;
+            }
+            Block* prev = nullptr;
+            for (auto b = blocks_[fl][sl]; b; prev = b, b = b->nextFree) {
+                if (b->prevFree != prev || !b->isFree() || b->isPrevFree() || b->size() < MIN_BLOCK_SIZE) {
+                    return SYSTEM_ERROR_BAD_DATA;
+                }
+                // Adjacent free blocks must have been merged
+                const auto n = b->next();
+                if (n->isFree() || !n->isPrevFree() || n->prevPhys != b) {
+                    return SYSTEM_ERROR_BAD_DATA;
+                }
+                unsigned f = 0, s = 0;
+                mapping(b->size(), &f, &s);
+                if (f != fl || s != sl) {
+                    return SYSTEM_ERROR_BAD_DATA;
+                }
+                freeSize += b->size() + BLOCK_OVERHEAD;
+                ++freeCount;
+            }
+        }
+    }
+    if (freeSize != freeSize_ || freeCount != freeBlockCount_) {
+        return SYSTEM_ERROR_BAD_DATA;
+    }
+    return 0;
+}
+
+void Tlsf::insertFreeBlock(Block* b) {
+    unsigned fl = 0, sl = 0;
+    mapping(b->size(), &fl, &sl);
+    const auto head = blocks_[fl][sl];
+    b->nextFree = head;
+    b->prevFree = nullptr;
+    if (head) {
+        head->prevFree = b;
+    }
+    blocks_[fl][sl] = b;
+    flBitmap_ |= 1u << fl;
+    slBitmaps_[fl] |= 1u << sl;
+    ++freeBlockCount_;
+}
+
+void Tlsf::removeFreeBlock(Block* b) {
+    unsigned fl = 0, sl = 0;
+    mapping(b->size(), &fl, &sl);
+    if (b->nextFree) {
+        b->nextFree->prevFree = b->prevFree;
+    }
+    if (b->prevFree) {
+        b->prevFree->nextFree = b->nextFree;
+    } else {
+        blocks_[fl][sl] = b->nextFree;
+        if (!b->nextFree) {
+            slBitmaps_[fl] &= ~(1u << sl);
+            if (!slBitmaps_[fl]) {
+                flBitmap_ &= ~(1u << fl);
+            }
+        }
+    }
+    --freeBlockCount_;
+}
+
+Tlsf::Block* Tlsf::findFreeBlock(size_t size) {
+    const size_t minSize = size;
+    // Round the size up to the next list boundary so that any block in the found list is large
+    // enough. This trades some internal fragmentation for not having to search the list
+    if (size >= SMALL_BLOCK_SIZE) {
+        size += ((size_t)1 << (sizeHighBit(size) - SL_INDEX_COUNT_LOG2)) - 1;
+    }
+    unsigned fl = 0, sl = 0;
+    mapping(size, &fl, &sl);
+    if (fl < FL_INDEX_COUNT) {
+        uint32_t slMap = slBitmaps_[fl] & (~0u << sl);
+        if (!slMap) {
+            const uint32_t flMap = flBitmap_ & (~0u << (fl + 1));
+            if (flMap) {
+                fl = lowBit(flMap);
+                slMap = slBitmaps_[fl];
+            }
+        }
+        if (slMap) {
+            return blocks_[fl][lowBit(slMap)];
+        }
+    }
+    // When the heap is nearly exhausted, the only suitable block may be in the list that also
+    // contains smaller blocks. Searching that list is not bounded in time but it allows the
+    // largest free block to always be allocated
+    mapping(minSize, &fl, &sl);
+    for (auto b = blocks_[fl][sl]; b; b = b->nextFree) {
+        if (b->size() >= minSize) {
+            return b;
+        }
+    }
+    return nullptr;
+}
+
+void Tlsf::releaseBlock(Block* b) {
+    freeSize_ += b->size() + BLOCK_OVERHEAD;
+    if (b->isPrevFree()) {
+        const auto p = b->prevPhys;
+        removeFreeBlock(p);
+        p->setSize(p->size() + b->size() + BLOCK_OVERHEAD);
+        b = p;
+    }
+    const auto n = b->next();
+    if (n->isFree()) {
+        removeFreeBlock(n);
+        b->setSize(b->size() + n->size() + BLOCK_OVERHEAD);
+    }
+    b->markFree();
+    insertFreeBlock(b);
+}
+
+void Tlsf::trimBlock(Block* b, size_t size) {
+    if (b->size() < size + BLOCK_OVERHEAD + MIN_BLOCK_SIZE) {
+        return;
+    }
+    const auto rem = reinterpret_cast<Block*>(b->payload() + size);
+    rem->sizeAndFlags = b->size() - size - BLOCK_OVERHEAD;
+    b->setSize(size);
+    // The remaining part may be merged with the following block if it's free
+    releaseBlock(rem);
+}
+
+void Tlsf::mapping(size_t size, unsigned* fl, unsigned* sl) {
+    if (size < SMALL_BLOCK_SIZE) {
+        // Small blocks are stored in the first list in linear increments
+        *fl = 0;
+        *sl = size / (SMALL_BLOCK_SIZE / SL_INDEX_COUNT);
+    } else {
+        const unsigned f = sizeHighBit(size);
+        *sl = (size >> (f - SL_INDEX_COUNT_LOG2)) ^ SL_INDEX_COUNT;
+        *fl = f - (FL_INDEX_SHIFT - 1);
+    }
+}
+
+size_t Tlsf::adjustSize(size_t size) {
+    return std::max<size_t>(alignUp(size, ALIGNMENT), MIN_BLOCK_SIZE);
+}
+
+} // namespace particle
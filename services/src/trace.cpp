@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "trace.h"
+
+#include "system_error.h"
+
+#if TRACE_ENABLED
+
+#include "timer_hal.h"
+#include "interrupts_hal.h"
+#include "concurrent_hal.h"
+#include "hal_platform.h"
+
+#include "endian_util.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+namespace particle {
+
+namespace {
+
+// Maximum number of events serialized by a single call to trace_format()
+const size_t MAX_FORMAT_EVENT_COUNT = 16;
+
+const size_t HEADER_SIZE = 12;
+const size_t EVENT_HEADER_SIZE = 10;
+const size_t MAX_NAME_SIZE = 255;
+
+struct Event {
+    const char* name;
+    uint32_t time;
+    uint32_t thread;
+    uint8_t type;
+};
+
+struct Record {
+    std::atomic<uint32_t> seq; // Index of the event plus one, or 0 if the record is being updated
+    Event event;
+};
+
+static_assert(TRACE_BUFFER_SIZE > 0, "Invalid size of the trace buffer");
+
+Record g_records[TRACE_BUFFER_SIZE] = {};
+std::atomic<uint32_t> g_next(0); // Index of the next event
+
+inline uint32_t currentThreadId() {
+#if PLATFORM_THREADING
+    if (!hal_interrupt_is_isr()) {
+        return (uint32_t)(uintptr_t)os_thread_current(nullptr);
+    }
+#endif
+    return 0;
+}
+
+// Returns false if the record has been overwritten or is being updated
+bool readRecord(uint32_t index, Event* event) {
+    const auto& r = g_records[index % TRACE_BUFFER_SIZE];
+    if (r.seq.load(std::memory_order_acquire) != index + 1) {
+        return false;
+    }
+    *event = r.event;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return r.seq.load(std::memory_order_relaxed) == index + 1;
+}
+
+bool appendUint32(appender_fn append, void* data, uint32_t val) {
+    val = nativeToLittleEndian(val);
+    return append(data, (const uint8_t*)&val, sizeof(val));
+}
+
+} // namespace
+
+} // namespace particle
+
+using namespace particle;
+
+void trace_event(int type, const char* name, void* reserved) {
+    const uint32_t index = g_next.fetch_add(1, std::memory_order_relaxed);
+    auto& r = g_records[index % TRACE_BUFFER_SIZE];
+    r.seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    r.event.name = name;
+    r.event.time = HAL_Timer_Get_Micro_Seconds();
+    r.event.thread = currentThreadId();
+    r.event.type = type;
+    r.seq.store(index + 1, std::memory_order_release);
+}
+
+int trace_format(uint32_t* pos, size_t maxSize, appender_fn append, void* appendData, void* reserved) {
+    if (!pos || !append || maxSize < HEADER_SIZE) {
+        return SYSTEM_ERROR_INVALID_ARGUMENT;
+    }
+    const uint32_t next = g_next.load(std::memory_order_acquire);
+    uint32_t first = *pos;
+    const uint32_t avail = std::min<uint32_t>(next, TRACE_BUFFER_SIZE);
+    if ((int32_t)(next - first) < 0 || next - first > avail) {
+        // Some of the requested events have been overwritten, or the position is invalid
+        first = next - avail;
+    }
+    // Take a snapshot of the events before serializing them
+    Event events[MAX_FORMAT_EVENT_COUNT];
+    size_t count = 0;
+    size_t size = HEADER_SIZE;
+    for (uint32_t i = first; i != next && count < MAX_FORMAT_EVENT_COUNT; ++i) {
+        auto& e = events[count];
+        if (!readRecord(i, &e)) {
+            const uint32_t seq = g_records[i % TRACE_BUFFER_SIZE].seq.load(std::memory_order_relaxed);
+            if (count == 0 && (int32_t)(seq - (i + 1)) > 0) {
+                // The event has been overwritten while we were reading the buffer
+                first = i + 1;
+                continue;
+            }
+            break; // The event is still being recorded
+        }
+        const size_t nameSize = e.name ? std::min(strlen(e.name), MAX_NAME_SIZE) : 0;
+        const size_t n = EVENT_HEADER_SIZE + nameSize;
+        if (size + n > maxSize) {
+            break;
+        }
+        size += n;
+        ++count;
+    }
+    const uint8_t h[] = { TRACE_FORMAT_VERSION, 0 /* reserved */, (uint8_t)count, (uint8_t)(count >> 8) };
+    if (!append(appendData, h, sizeof(h)) || !appendUint32(append, appendData, first) ||
+            !appendUint32(append, appendData, first + count)) {
+        return SYSTEM_ERROR_TOO_LARGE;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        const auto& e = events[i];
+        const uint8_t nameSize = e.name ? std::min(strlen(e.name), MAX_NAME_SIZE) : 0;
+        const uint8_t d[] = { e.type, nameSize };
+        if (!appendUint32(append, appendData, e.time) || !appendUint32(append, appendData, e.thread) ||
+                !append(appendData, d, sizeof(d)) || (nameSize && !append(appendData, (const uint8_t*)e.name, nameSize))) {
+            return SYSTEM_ERROR_TOO_LARGE;
+        }
+    }
+    *pos = first + count;
+    return count;
+}
+
+#else // !TRACE_ENABLED
+
+void trace_event(int type, const char* name, void* reserved) {
+}
+
+int trace_format(uint32_t* pos, size_t maxSize, appender_fn append, void* appendData, void* reserved) {
+    return SYSTEM_ERROR_NOT_SUPPORTED;
+}
+
+#endif // !TRACE_ENABLED
@@ -23,6 +23,7 @@
 #include "spark_wiring_string.h"
 #include "ota_flash_hal.h"
 #include "stream.h"
+#include "block_cache.h"
 #include "asset_manager_api.h"
 
 namespace particle {
@@ -120,6 +121,31 @@ private:
     size_t dataSize_;
 };
 
+/**
+ * Random-access view of an uncompressed asset.
+ *
+ * Asset files are not stored contiguously in the asset storage and can't be mapped into memory
+ * directly. Instead, the view keeps the most recently accessed blocks of the asset in RAM, so that
+ * nearby and repeated reads don't go to the storage.
+ */
+class AssetView {
+public:
+    static const size_t DEFAULT_BLOCK_SIZE = 512;
+    static const size_t DEFAULT_BLOCK_COUNT = 4;
+
+    int init(const Asset& asset, size_t blockSize = DEFAULT_BLOCK_SIZE, size_t blockCount = DEFAULT_BLOCK_COUNT);
+
+    int read(size_t offset, char* data, size_t size);
+    int map(size_t offset, const char** data);
+
+    size_t size() const;
+    const BlockCache& cache() const;
+
+private:
+    AssetReader reader_;
+    BlockCache cache_;
+};
+
 class AssetManager {
 public:
     static AssetManager& instance();
@@ -368,6 +368,79 @@ void asset_manager_close(asset_manager_stream* stream, void* reserved);
  * @return 0 on success or `system_error_t` error code
  */
 int asset_manager_format_storage(void* reserved);
+
+struct asset_manager_view;
+typedef struct asset_manager_view asset_manager_view;
+
+typedef struct asset_manager_view_stats {
+    uint16_t size; // Size of this structure
+    uint16_t reserved;
+    uint32_t asset_size; // Size of the asset data
+    uint32_t block_size; // Size of a cached block
+    uint32_t block_count; // Number of cached blocks
+    uint32_t hits; // Number of reads served from the cache
+    uint32_t misses; // Number of blocks read from the storage
+    uint32_t evictions; // Number of cached blocks that have been replaced
+} asset_manager_view_stats;
+
+/**
+ * Open a random-access view of an uncompressed asset.
+ *
+ * Recently accessed blocks of the asset are cached in RAM.
+ *
+ * @param view[out] View object
+ * @param asset Asset identifier (name, hash)
+ * @param block_size Size of a cached block (up to 4096 bytes), or 0 to use the default size
+ * @param block_count Number of cached blocks (up to 32), or 0 to use the default number
+ * @param reserved Reserved (NULL)
+ * @return 0 on success or `system_error_t` error code. `SYSTEM_ERROR_NOT_SUPPORTED` is returned
+ *         for compressed assets
+ */
+int asset_manager_open_view(asset_manager_view** view, const asset_manager_asset* asset, size_t block_size,
+        size_t block_count, void* reserved);
+
+/**
+ * Read asset data at a given offset.
+ *
+ * @param view View object
+ * @param offset Offset within the asset data
+ * @param data Target buffer
+ * @param size Target buffer size
+ * @param reserved Reserved (NULL)
+ * @return Number of bytes written into `data` on success or `system_error_t` error code
+ */
+int asset_manager_view_read(asset_manager_view* view, size_t offset, char* data, size_t size, void* reserved);
+
+/**
+ * Get a pointer to the cached asset data at a given offset.
+ *
+ * The pointer is valid until the next call to any of the view functions.
+ *
+ * @param view View object
+ * @param offset Offset within the asset data
+ * @param data[out] Pointer to the data
+ * @param reserved Reserved (NULL)
+ * @return Number of bytes available at `data` on success or `system_error_t` error code
+ */
+int asset_manager_view_map(asset_manager_view* view, size_t offset, const char** data, void* reserved);
+
+/**
+ * Get the cache statistics of a view.
+ *
+ * @param view View object
+ * @param stats Statistics to be populated (must be initialized by the caller at least with size)
+ * @param reserved Reserved (NULL)
+ * @return 0 on success or `system_error_t` error code
+ */
+int asset_manager_view_get_stats(asset_manager_view* view, asset_manager_view_stats* stats, void* reserved);
+
+/**
+ * Close a view and cleanup.
+ *
+ * @param view View object (will be freed)
+ * @param reserved Reserved (NULL)
+ */
+void asset_manager_close_view(asset_manager_view* view, void* reserved);
 #endif // !defined(PARTICLE_USER_MODULE) || defined(PARTICLE_USE_UNSTABLE_API)
 
 #ifdef __cplusplus
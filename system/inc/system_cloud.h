@@ -183,9 +183,17 @@ const uint32_t PUBLISH_EVENT_FLAG_WITH_ACK = 0x8;
  * This is a stop-gap solution until all synchronous APIs return futures, allowing asynchronous operation.
  */
 const uint32_t PUBLISH_EVENT_FLAG_ASYNC = EventType::ASYNC;
+/**
+ * Send the event via the persistent publish queue. The publish operation completes once the event
+ * is stored in the queue rather than when it's delivered to the cloud.
+ *
+ * @see `spark_publish_queue_set_config()`
+ */
+const uint32_t PUBLISH_EVENT_FLAG_PERSISTENT = 0x20;
 
 
 PARTICLE_STATIC_ASSERT(publish_no_ack_flag_matches, PUBLISH_EVENT_FLAG_NO_ACK==EventType::NO_ACK);
+PARTICLE_STATIC_ASSERT(publish_persistent_flag_is_distinct, (PUBLISH_EVENT_FLAG_PERSISTENT & (EventType::ALL_FLAGS | PUBLISH_EVENT_FLAG_PRIVATE)) == 0);
 
 typedef void (*EventHandler)(const char* name, const char* data);
 
@@ -362,6 +370,70 @@ int spark_get_connection_property(unsigned property, void* data, size_t* size, v
 
 int spark_set_random_seed_from_cloud_handler(void (*handler)(unsigned int), void* reserved);
 
+/**
+ * Eviction policies of the persistent publish queue.
+ */
+typedef enum spark_publish_queue_eviction_policy {
+    SPARK_PUBLISH_QUEUE_DROP_OLDEST = 0, ///< Discard the oldest events to make room for new ones.
+    SPARK_PUBLISH_QUEUE_DROP_NEWEST = 1 ///< Reject new events when the queue is full.
+} spark_publish_queue_eviction_policy;
+
+/**
+ * Configuration of the persistent publish queue.
+ */
+typedef struct spark_publish_queue_config {
+    uint16_t size; ///< Size of this structure.
+    uint8_t eviction_policy; ///< Eviction policy (see `spark_publish_queue_eviction_policy`).
+    uint8_t batch_size; ///< Maximum number of events sent per batch.
+    uint32_t max_size; ///< Maximum size of the queue on the filesystem in bytes.
+    uint32_t segment_size; ///< Maximum size of a segment file in bytes.
+    uint32_t batch_interval; ///< Minimum interval between batches in milliseconds.
+} spark_publish_queue_config;
+
+/**
+ * Statistics of the persistent publish queue.
+ */
+typedef struct spark_publish_queue_stats {
+    uint16_t size; ///< Size of this structure.
+    uint16_t segment_count; ///< Number of segment files.
+    uint32_t event_count; ///< Number of queued events.
+    uint32_t data_size; ///< Size of the queue on the filesystem in bytes.
+    uint32_t sent_count; ///< Number of events sent since boot.
+    uint32_t dropped_count; ///< Number of events discarded since boot.
+} spark_publish_queue_stats;
+
+/**
+ * Configure the persistent publish queue.
+ *
+ * Events published with `PUBLISH_EVENT_FLAG_PERSISTENT` are appended to the queue and sent in order
+ * while the device is connected to the cloud. Queued events are sent in batches: if the delivery of
+ * an event fails, that event and all the events following it in the same batch are sent again, even
+ * if some of them were delivered, so the delivery is at least once. The configuration is not
+ * persisted across resets.
+ *
+ * @param config Configuration.
+ * @param reserved This argument should be set to NULL.
+ * @return 0 on success or a negative result code in case of an error.
+ */
+int spark_publish_queue_set_config(const spark_publish_queue_config* config, void* reserved);
+
+/**
+ * Get statistics of the persistent publish queue.
+ *
+ * @param[out] stats Statistics.
+ * @param reserved This argument should be set to NULL.
+ * @return 0 on success or a negative result code in case of an error.
+ */
+int spark_publish_queue_get_stats(spark_publish_queue_stats* stats, void* reserved);
+
+/**
+ * Discard all events stored in the persistent publish queue.
+ *
+ * @param reserved This argument should be set to NULL.
+ * @return 0 on success or a negative result code in case of an error.
+ */
+int spark_publish_queue_clear(void* reserved);
+
 #define SPARK_BUF_LEN                 600
 
 //#define SPARK_SERVER_IP             "54.235.79.249"
@@ -63,6 +63,8 @@ typedef enum ctrl_request_type {
     CTRL_REQUEST_GET_MODULE_INFO = 90,
     CTRL_REQUEST_GET_ASSET_INFO = 91,
     CTRL_REQUEST_DIAGNOSTIC_INFO = 100,
+    CTRL_REQUEST_GET_TRACE_DATA = 101,
+    CTRL_REQUEST_GET_HEAP_TRACKING_DATA = 102,
     // CTRL_REQUEST_WIFI_SET_ANTENNA = 110,
     // CTRL_REQUEST_WIFI_GET_ANTENNA = 111,
     // CTRL_REQUEST_WIFI_SCAN = 112,
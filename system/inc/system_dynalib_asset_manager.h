@@ -38,6 +38,11 @@ DYNALIB_FN(9, system_asset_manager, asset_manager_seek, int(asset_manager_stream
 DYNALIB_FN(10, system_asset_manager, asset_manager_close, void(asset_manager_stream*, void*))
 // UNSTABLE
 DYNALIB_FN(11, system_asset_manager, asset_manager_format_storage, int(void*))
+DYNALIB_FN(12, system_asset_manager, asset_manager_open_view, int(asset_manager_view**, const asset_manager_asset*, size_t, size_t, void*))
+DYNALIB_FN(13, system_asset_manager, asset_manager_view_read, int(asset_manager_view*, size_t, char*, size_t, void*))
+DYNALIB_FN(14, system_asset_manager, asset_manager_view_map, int(asset_manager_view*, size_t, const char**, void*))
+DYNALIB_FN(15, system_asset_manager, asset_manager_view_get_stats, int(asset_manager_view*, asset_manager_view_stats*, void*))
+DYNALIB_FN(16, system_asset_manager, asset_manager_close_view, void(asset_manager_view*, void*))
 // /UNSTABLE
 
 DYNALIB_END(system_asset_manager)
@@ -121,12 +121,44 @@ int system_info_get_unstable(hal_system_info_t* info, uint32_t flags, void* rese
 int system_info_free_unstable(hal_system_info_t* info, void* reserved);
 #endif // !defined(PARTICLE_USER_MODULE) || defined(PARTICLE_USE_UNSTABLE_API)
 
+/**
+ * Flags supported by `system_format_diag_data()`.
+ */
+typedef enum system_format_diag_flag {
+    /**
+     * Use the binary encoding with fixed-size values.
+     *
+     * Only integer data sources are formatted in this mode.
+     */
+    SYSTEM_FORMAT_DIAG_FLAG_BINARY = 0x01,
+    /**
+     * Use the binary encoding with variable-length values.
+     *
+     * The encoded data starts with a 16-bit size of the source IDs followed by a 16-bit value size
+     * of 0. Each data source is then encoded as a 16-bit ID, an 8-bit data type (0 for an error) and
+     * a value encoded as one or more varints. Signed integers and error codes use the ZigZag
+     * encoding. A histogram is encoded as its number of samples followed, unless that number is 0,
+     * by the sum, minimum and maximum of the samples, the number of buckets and the bucket
+     * counters; trailing empty buckets are omitted. A windowed counter is encoded as its total
+     * count, the count within the window and the window duration.
+     */
+    SYSTEM_FORMAT_DIAG_FLAG_COMPACT = 0x02,
+    /**
+     * Format histograms and windowed counters as JSON objects with all their fields.
+     *
+     * By default, every data source is formatted as a scalar in the JSON encoding: a histogram is
+     * formatted as its number of samples and a windowed counter as its total count.
+     */
+    SYSTEM_FORMAT_DIAG_FLAG_JSON_DETAILED = 0x04
+} system_format_diag_flag;
+
 /**
  * Formats the diagnostic data using an appender function.
  *
  * @param id Array of data source IDs. This argument can be set to NULL to format all registered data sources.
  * @param count Number of data source IDs in the array.
- * @param flags Formatting flags.
+ * @param flags Formatting flags (see `system_format_diag_flag`). If no flags are set, the data is
+ *        formatted as JSON.
  * @param append Appender function.
  * @param append_data Opaque data passed to the appender function.
  * @param reserved Reserved argument (should be set to NULL).
@@ -134,8 +166,27 @@ int system_info_free_unstable(hal_system_info_t* info, void* reserved);
 int system_format_diag_data(const uint16_t* id, size_t count, unsigned flags, appender_fn append, void* append_data,
         void* reserved);
 
+/**
+ * Formats the vitals published to the cloud.
+ *
+ * If the system is built with delta encoding of the vitals enabled and the compact encoding is
+ * requested, the value size in the header of the encoded data is set to 0xffff and followed by an
+ * 8-bit frame type: 0 for a keyframe containing all data sources, or 1 for a delta frame containing
+ * only the sources that changed since the last acknowledged frame.
+ */
 bool system_metrics(appender_fn appender, void* append_data, uint32_t flags, uint32_t page, void* reserved);
 
+/**
+ * Notifies the system that the cloud has acknowledged the last vitals formatted with `system_metrics()`.
+ */
+void system_metrics_acknowledged(void* reserved);
+
+/**
+ * Notifies the system that a cloud session has been established. The vitals formatted with
+ * `system_metrics()` before that will not be acknowledged.
+ */
+void system_metrics_session_started(void* reserved);
+
 #ifdef __cplusplus
 }
 #endif // __cplusplus
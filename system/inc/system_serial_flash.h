@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "file_transfer.h"
+#include "spark_wiring_stream.h"
+
+#include <memory>
+#include <cstdint>
+
+/**
+ * Windowed serial flashing protocol.
+ *
+ * Unlike YModem, which waits for an acknowledgement after every packet, this protocol allows the
+ * sender to have multiple frames in flight. Frames that arrive out of order are buffered and
+ * written to flash once all preceding frames have been received, and lost frames are retransmitted
+ * selectively.
+ *
+ * As with YModem, updates are only accepted in listening mode if the application has opted in by
+ * including "Ymodem/Ymodem.h".
+ *
+ * All multi-byte fields are little-endian. Each frame has the following format:
+ *
+ * Field   | Size | Description
+ * --------|------|------------
+ * sync    | 1    | Synchronization byte (`SYNC`)
+ * type    | 1    | Frame type (`FrameType`)
+ * size    | 2    | Payload size
+ * seq     | 4    | Frame index (DATA and ACK frames), 0 otherwise
+ * payload | N    | Payload data
+ * crc     | 4    | CRC-32 of the `type`, `size`, `seq` and `payload` fields
+ *
+ * Frames with an invalid checksum are ignored, as is any data outside of a frame.
+ *
+ * The host starts a session by sending a START frame with the following payload:
+ *
+ * Field      | Size | Description
+ * -----------|------|------------
+ * file_size  | 4    | Size of the file in bytes
+ * frame_size | 2    | Requested maximum payload size of a DATA frame
+ * window     | 2    | Requested number of frames in flight
+ *
+ * The device replies with a READY frame that has the same payload layout and contains the actual
+ * frame size and window size that the host must use. The host then sends the file contents in DATA
+ * frames. Each DATA frame except the last one must contain exactly `frame_size` bytes.
+ *
+ * The device acknowledges the received data with ACK frames. The `seq` field of an ACK frame
+ * contains the index of the first frame that hasn't been received yet. The payload contains a
+ * 32-bit mask of the frames that follow it and have been received out of order (bit 0 corresponds
+ * to frame `seq + 1`).
+ *
+ * Once all frames are acknowledged, the host sends an END frame and the device validates the
+ * update. The device replies with a RESULT frame containing a 32-bit result code, which is also
+ * sent if the session fails at any point. The host can cancel the session with an ABORT frame.
+ */
+class SerialFlashReceiver {
+public:
+    static constexpr uint8_t SYNC = 0x16;
+
+    static constexpr unsigned HEADER_SIZE = 8; // Not including the sync byte
+    static constexpr unsigned TRAILER_SIZE = 4;
+
+    static constexpr unsigned MIN_FRAME_SIZE = 256;
+    static constexpr unsigned MAX_FRAME_SIZE = 4096;
+    static constexpr unsigned MAX_WINDOW_SIZE = 32;
+    static constexpr unsigned MAX_BUFFER_SIZE = 16 * 1024;
+
+    static constexpr system_tick_t TIMEOUT = 5000;
+    static constexpr system_tick_t ACK_INTERVAL = 500;
+
+    enum FrameType {
+        START = 0x01,
+        DATA = 0x02,
+        END = 0x03,
+        ABORT = 0x04,
+        READY = 0x81,
+        ACK = 0x82,
+        RESULT = 0x83
+    };
+
+    explicit SerialFlashReceiver(Stream& stream) :
+            stream_(stream),
+            frameSize_(0),
+            windowSize_(0),
+            frameCount_(0),
+            base_(0),
+            received_(0),
+            started_(false) {
+    }
+
+    /**
+     * Receive a file.
+     *
+     * The caller is expected to have consumed nothing from the stream yet, or only bytes preceding
+     * the sync byte of the START frame.
+     *
+     * @param tx File transfer descriptor.
+     * @return Size of the received file, or a negative result code in case of an error.
+     */
+    int receive(FileTransfer::Descriptor& tx);
+
+    /**
+     * Send a RESULT frame.
+     *
+     * @param result Result code.
+     */
+    void sendResult(int result);
+
+    /**
+     * Returns `true` if the firmware update has been prepared and needs to be either finished or
+     * cancelled.
+     */
+    bool updateStarted() const {
+        return started_;
+    }
+
+private:
+    struct Frame {
+        uint8_t type;
+        uint16_t size;
+        uint32_t seq;
+        uint8_t* data;
+    };
+
+    Stream& stream_;
+    std::unique_ptr<uint8_t[]> buf_; // Frame slots followed by a scratch slot
+    unsigned frameSize_;
+    unsigned windowSize_;
+    uint32_t frameCount_;
+    uint32_t base_; // Index of the first frame that hasn't been written to flash
+    uint32_t received_; // Mask of the buffered frames, bit 0 corresponds to frame `base_`
+    uint8_t startBuf_[HEADER_SIZE + 8 + TRAILER_SIZE]; // Used until the frame buffers are allocated
+    bool started_;
+
+    int start(FileTransfer::Descriptor& tx, const Frame& f);
+    int handleData(FileTransfer::Descriptor& tx, const Frame& f);
+    int allocBuffers(unsigned frameSize, unsigned windowSize);
+
+    int readFrame(Frame* f, system_tick_t timeout);
+    int readData(uint8_t* data, size_t size, system_tick_t timeout);
+    void sendFrame(uint8_t type, uint32_t seq, const uint8_t* data, size_t size);
+    void sendAck();
+
+    uint8_t* slot(unsigned index) const {
+        return buf_.get() + index * (HEADER_SIZE + frameSize_ + TRAILER_SIZE);
+    }
+
+    uint8_t* scratch() const {
+        return slot(windowSize_);
+    }
+};
+
+/**
+ * Update the firmware using the windowed serial flashing protocol.
+ *
+ * @param serialObj Stream.
+ * @param desc File transfer descriptor.
+ * @return `true` on success.
+ */
+bool Windowed_Serial_Flash_Update(Stream* serialObj, FileTransfer::Descriptor& desc, void* reserved);
@@ -28,6 +28,16 @@ void set_start_ymodem_flasher_serial_speed(uint32_t speed);
  */
 bool system_firmwareUpdate(Stream* stream, void* reserved=NULL);
 
+/**
+ * Updates firmware via the windowed serial flashing protocol from a given stream.
+ *
+ * See `SerialFlashReceiver` for the protocol description.
+ *
+ * @param stream
+ * @return true on successful update.
+ */
+bool system_serialFlashUpdate(Stream* stream, void* reserved=NULL);
+
 
 struct system_file_transfer_t {
     system_file_transfer_t()
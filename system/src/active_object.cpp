@@ -20,6 +20,8 @@
 #include "active_object.h"
 #include "system_threading.h"
 #include "spark_wiring_interrupts.h"
+#include "trace.h"
+#include "heap_tracking.h"
 #include "debug.h"
 
 using namespace particle;
@@ -81,6 +83,7 @@ bool ActiveObjectBase::process()
     Item item = nullptr;
     if (take(item) && item)
     {
+        TRACE_SCOPE("ao:process");
         Message& msg = *item;
         msg();
         result = true;
@@ -90,6 +93,7 @@ bool ActiveObjectBase::process()
 
 void ActiveObjectBase::run_active_object(void* data)
 {
+    HEAP_TAG_SCOPE(HEAP_TAG_SYSTEM);
     const auto that = static_cast<ActiveObjectBase*>(data);
     that->run();
 }
@@ -20,6 +20,7 @@
 #if HAL_PLATFORM_ASSETS
 
 #include "asset_manager.h"
+#include "asset_transfer.h"
 #include "storage_streams.h"
 #include "check.h"
 #include "ota_flash_hal_impl.h"
@@ -295,6 +296,8 @@ int AssetManager::clearUnusedAssets() {
         const fs::FsLock lock(fs);
         CHECK_FS(lfs_remove(&fs->instance, asset.name().c_str()));
     }
+    // Partially transferred assets that are no longer required only take up space
+    CHECK(AssetTransfer::clearExcept(requiredAssets()));
     return 0;
 }
 
@@ -310,13 +313,16 @@ int AssetManager::storeAsset(const hal_module_t* module) {
     CHECK_TRUE(reader.isValid(), SYSTEM_ERROR_BAD_DATA);
 
     auto info = reader.asset();
+    if (availableAssets_.contains(info)) {
+        // Only the assets that have changed need to be stored
+        LOG(INFO, "Asset %s (hash=%s) is already stored", info.name().c_str(), info.hash().toString().c_str());
+        CHECK(setConsumerState(ASSET_MANAGER_CONSUMER_STATE_WANT));
+        return 0;
+    }
     LOG(INFO, "Storing asset %s (hash=%s) size=%u original size=%u", info.name().c_str(), info.hash().toString().c_str(), reader.size(), reader.originalSize());
 
     CHECK(clearUnusedAssets());
 
-    CHECK(stream.seek(0));
-    char tmp[256];
-
     const auto fs = filesystem_get_instance(FILESYSTEM_INSTANCE_ASSET_STORAGE, nullptr);
     CHECK_TRUE(fs, SYSTEM_ERROR_FILE);
     fs::FsLock lock(fs);
@@ -325,24 +331,26 @@ int AssetManager::storeAsset(const hal_module_t* module) {
     filesystem_unmount(fs);
     availableAssets_.clear();
     CHECK(filesystem_mount(fs));
-
-    lfs_file_t file = {};
-    lfs_remove(&fs->instance, info.name().c_str());
-    CHECK_FS(lfs_file_open(&fs->instance, &file, info.name().c_str(), LFS_O_WRONLY | LFS_O_CREAT | LFS_O_APPEND));
-    SCOPE_GUARD({     
-        lfs_file_close(&fs->instance, &file);
+    // Refresh the list of available assets when done, so that the assets from the remaining modules
+    // being applied are compared against what is actually stored
+    SCOPE_GUARD({
+        parseAvailableAssets();
     });
 
-    while (stream.availForRead() > 0) {
-        int read = stream.read(tmp, sizeof(tmp));
-        if (read < 0 && read != SYSTEM_ERROR_END_OF_STREAM) {
-            return read;
-        }
-        if (read == SYSTEM_ERROR_END_OF_STREAM) {
-            break;
-        }
-        CHECK_FS(lfs_file_write(&fs->instance, &file, tmp, (size_t)read));
+    // The asset is copied chunk by chunk so that the copying can be resumed if it gets interrupted
+    AssetTransfer transfer;
+    CHECK(transfer.begin(info, reader.size()));
+    std::unique_ptr<char[]> buf(new(std::nothrow) char[transfer.chunkSize()]);
+    CHECK_TRUE(buf, SYSTEM_ERROR_NO_MEMORY);
+    for (int i = transfer.nextMissingChunk(); i >= 0; i = transfer.nextMissingChunk(i + 1)) {
+        const size_t offset = i * transfer.chunkSize();
+        const size_t size = std::min(transfer.chunkSize(), reader.size() - offset);
+        CHECK(stream.seek(offset));
+        CHECK(stream.readAll(buf.get(), size));
+        CHECK(transfer.write(offset, buf.get(), size));
     }
+    // The CRC of the module has been verified above
+    CHECK(transfer.finish());
 
     CHECK(setConsumerState(ASSET_MANAGER_CONSUMER_STATE_WANT));
     return 0;
@@ -549,6 +557,38 @@ int AssetReader::assetStream(InputStream*& stream) {
     return 0;
 }
 
+// AssetView
+int AssetView::init(const Asset& asset, size_t blockSize, size_t blockCount) {
+    CHECK(reader_.init(asset.name()));
+    CHECK(reader_.validate(false));
+    CHECK_TRUE(reader_.isValid(), SYSTEM_ERROR_NOT_FOUND);
+    CHECK_TRUE(reader_.asset() == asset, SYSTEM_ERROR_NOT_FOUND);
+    // Compressed assets can only be read sequentially
+    CHECK_FALSE(reader_.isCompressed(), SYSTEM_ERROR_NOT_SUPPORTED);
+    InputStream* stream = nullptr;
+    CHECK(reader_.assetStream(stream));
+    CHECK(stream->seek(0));
+    const size_t size = CHECK(stream->availForRead());
+    CHECK(cache_.init(stream, size, blockSize, blockCount));
+    return 0;
+}
+
+int AssetView::read(size_t offset, char* data, size_t size) {
+    return cache_.read(offset, data, size);
+}
+
+int AssetView::map(size_t offset, const char** data) {
+    return cache_.map(offset, data);
+}
+
+size_t AssetView::size() const {
+    return cache_.size();
+}
+
+const BlockCache& AssetView::cache() const {
+    return cache_;
+}
+
 } // particle
 
 #endif // HAL_PLATFORM_ASSETS
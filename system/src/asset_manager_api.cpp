@@ -175,4 +175,50 @@ void asset_manager_close(asset_manager_stream* stream, void* reserved) {
 
 int asset_manager_format_storage(void* reserved) {
     return AssetManager::instance().formatStorage(true /* remount */);
-}
\ No newline at end of file
+}
+int asset_manager_open_view(asset_manager_view** view, const asset_manager_asset* asset, size_t block_size,
+        size_t block_count, void* reserved) {
+    CHECK_TRUE(view && asset, SYSTEM_ERROR_INVALID_ARGUMENT);
+    auto a = assetFromApiAsset(asset);
+    CHECK_TRUE(a.isValid(), SYSTEM_ERROR_INVALID_ARGUMENT);
+
+    auto v = std::make_unique<AssetView>();
+    CHECK_TRUE(v, SYSTEM_ERROR_NO_MEMORY);
+    CHECK(v->init(a, block_size ? block_size : AssetView::DEFAULT_BLOCK_SIZE,
+            block_count ? block_count : AssetView::DEFAULT_BLOCK_COUNT));
+    *view = (asset_manager_view*)v.release();
+    return 0;
+}
+
+int asset_manager_view_read(asset_manager_view* view, size_t offset, char* data, size_t size, void* reserved) {
+    CHECK_TRUE(view && data, SYSTEM_ERROR_INVALID_ARGUMENT);
+    auto v = (AssetView*)view;
+    return v->read(offset, data, size);
+}
+
+int asset_manager_view_map(asset_manager_view* view, size_t offset, const char** data, void* reserved) {
+    CHECK_TRUE(view && data, SYSTEM_ERROR_INVALID_ARGUMENT);
+    auto v = (AssetView*)view;
+    return v->map(offset, data);
+}
+
+int asset_manager_view_get_stats(asset_manager_view* view, asset_manager_view_stats* stats, void* reserved) {
+    CHECK_TRUE(view && stats && stats->size >= sizeof(asset_manager_view_stats), SYSTEM_ERROR_INVALID_ARGUMENT);
+    auto v = (AssetView*)view;
+    const auto& cache = v->cache();
+    stats->asset_size = cache.size();
+    stats->block_size = cache.blockSize();
+    stats->block_count = cache.blockCount();
+    stats->hits = cache.stats().hits;
+    stats->misses = cache.stats().misses;
+    stats->evictions = cache.stats().evictions;
+    return 0;
+}
+
+void asset_manager_close_view(asset_manager_view* view, void* reserved) {
+    if (!view) {
+        return;
+    }
+    auto v = (AssetView*)view;
+    delete v;
+}
@@ -0,0 +1,372 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "logging.h"
+LOG_SOURCE_CATEGORY("system.asset")
+
+#include "hal_platform.h"
+
+#if HAL_PLATFORM_ASSETS
+
+#include "asset_transfer.h"
+#include "check.h"
+#include "scope_guard.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+namespace particle {
+
+namespace {
+
+const uint32_t STATE_MAGIC = 0x41535446; // "ASTF"
+const uint16_t STATE_VERSION = 1;
+
+// Directories are skipped when the asset storage is scanned for available assets
+const auto TRANSFER_DIR = "/.transfer";
+const auto DATA_DIR = "/.transfer/data";
+const auto STATE_DIR = "/.transfer/state";
+
+// The transfer state is checkpointed every time this many bytes are received
+const size_t CHECKPOINT_INTERVAL = 64 * 1024;
+
+// The data stored in the asset storage is read in blocks of this size
+const size_t READ_BLOCK_SIZE = 128;
+
+String dataPath(const char* name) {
+    return String(DATA_DIR) + '/' + name;
+}
+
+String statePath(const char* name) {
+    return String(STATE_DIR) + '/' + name;
+}
+
+int makeDir(lfs_t* lfs, const char* path) {
+    const int r = lfs_mkdir(lfs, path);
+    if (r < 0 && r != LFS_ERR_EXIST) {
+        return filesystem_to_system_error(r);
+    }
+    return 0;
+}
+
+} // namespace
+
+const size_t AssetTransfer::DEFAULT_CHUNK_SIZE;
+
+AssetTransfer::AssetTransfer() :
+        state_(),
+        file_(),
+        fs_(nullptr),
+        chunkCount_(0),
+        receivedChunks_(0),
+        bytesToCheckpoint_(0),
+        active_(false) {
+}
+
+AssetTransfer::~AssetTransfer() {
+    cancel(false /* discard */);
+}
+
+int AssetTransfer::begin(const Asset& asset, size_t fileSize, size_t chunkSize) {
+    CHECK_FALSE(active_, SYSTEM_ERROR_INVALID_STATE);
+    CHECK_TRUE(asset.isValid() && fileSize > 0 && chunkSize > 0, SYSTEM_ERROR_INVALID_ARGUMENT);
+    const auto& hash = asset.hash().hash();
+    CHECK_TRUE(hash.size() <= sizeof(state_.hash), SYSTEM_ERROR_INVALID_ARGUMENT);
+
+    fs_ = filesystem_get_instance(FILESYSTEM_INSTANCE_ASSET_STORAGE, nullptr);
+    CHECK_TRUE(fs_, SYSTEM_ERROR_FILE);
+    const fs::FsLock lock(fs_);
+    CHECK(filesystem_mount(fs_));
+    CHECK(makeDir(&fs_->instance, TRANSFER_DIR));
+    CHECK(makeDir(&fs_->instance, DATA_DIR));
+    CHECK(makeDir(&fs_->instance, STATE_DIR));
+
+    asset_ = asset;
+    chunkCount_ = (fileSize + chunkSize - 1) / chunkSize;
+    bitmap_.reset(new(std::nothrow) uint8_t[bitmapSize()]);
+    CHECK_TRUE(bitmap_, SYSTEM_ERROR_NO_MEMORY);
+    CHECK(partialHash_.init());
+    CHECK(tempHash_.init());
+
+    State expected = {};
+    expected.magic = STATE_MAGIC;
+    expected.version = STATE_VERSION;
+    expected.hashType = asset.hash().type();
+    expected.hashSize = hash.size();
+    memcpy(expected.hash, hash.data(), hash.size());
+    expected.fileSize = fileSize;
+    expected.chunkSize = chunkSize;
+
+    const auto name = asset.name().c_str();
+    int r = loadState(expected);
+    if (r < 0) {
+        if (r != SYSTEM_ERROR_NOT_FOUND) {
+            LOG(WARN, "Restarting transfer of asset %s: %d", name, r);
+        }
+        state_ = expected;
+        memset(bitmap_.get(), 0, bitmapSize());
+        CHECK(partialHash_.start());
+        lfs_remove(&fs_->instance, dataPath(name).c_str());
+        lfs_remove(&fs_->instance, statePath(name).c_str());
+    }
+    CHECK_FS(lfs_file_open(&fs_->instance, &file_, dataPath(name).c_str(), LFS_O_RDWR | LFS_O_CREAT));
+
+    receivedChunks_ = 0;
+    for (size_t i = 0; i < chunkCount_; ++i) {
+        if (hasChunk(i)) {
+            ++receivedChunks_;
+        }
+    }
+    bytesToCheckpoint_ = 0;
+    active_ = true;
+    if (receivedChunks_ > 0) {
+        LOG(INFO, "Resuming transfer of asset %s: %u of %u chunks received", name, (unsigned)receivedChunks_,
+                (unsigned)chunkCount_);
+    }
+    return 0;
+}
+
+int AssetTransfer::write(size_t offset, const char* data, size_t size) {
+    CHECK_TRUE(active_, SYSTEM_ERROR_INVALID_STATE);
+    CHECK_TRUE(offset < state_.fileSize && offset % state_.chunkSize == 0, SYSTEM_ERROR_INVALID_ARGUMENT);
+    CHECK_TRUE(size == std::min<size_t>(state_.chunkSize, state_.fileSize - offset), SYSTEM_ERROR_INVALID_ARGUMENT);
+    const size_t index = offset / state_.chunkSize;
+    if (hasChunk(index)) {
+        return 0; // Duplicate chunk
+    }
+    const fs::FsLock lock(fs_);
+    // Writing past the end of the file fills the gap with zeros
+    CHECK_FS(lfs_file_seek(&fs_->instance, &file_, offset, LFS_SEEK_SET));
+    const int n = CHECK_FS(lfs_file_write(&fs_->instance, &file_, data, size));
+    CHECK_TRUE((size_t)n == size, SYSTEM_ERROR_FILE);
+    bitmap_[index / 8] |= 1 << (index % 8);
+    ++receivedChunks_;
+    if (state_.partialSize == offset) {
+        CHECK(partialHash_.update(data, size));
+        state_.partialSize += size;
+    }
+    // The chunk may have filled a gap between the previously received chunks
+    CHECK(updatePartialHash());
+    bytesToCheckpoint_ += size;
+    if (bytesToCheckpoint_ >= CHECKPOINT_INTERVAL) {
+        CHECK(checkpoint());
+    }
+    return 0;
+}
+
+int AssetTransfer::finish(const char* fileHash) {
+    CHECK_TRUE(active_, SYSTEM_ERROR_INVALID_STATE);
+    CHECK_TRUE(receivedChunks_ == chunkCount_ && state_.partialSize == state_.fileSize, SYSTEM_ERROR_NOT_ENOUGH_DATA);
+    const fs::FsLock lock(fs_);
+    const auto name = asset_.name().c_str();
+    NAMED_SCOPE_GUARD(discardGuard, {
+        close(true /* discard */);
+    });
+    CHECK(tempHash_.copyFrom(partialHash_));
+    CHECK(tempHash_.finish(state_.partialHash));
+    if (fileHash && memcmp(fileHash, state_.partialHash, Sha256::HASH_SIZE) != 0) {
+        LOG(ERROR, "Integrity check of asset %s has failed", name);
+        return SYSTEM_ERROR_BAD_DATA;
+    }
+    CHECK_FS(lfs_file_sync(&fs_->instance, &file_));
+    {
+        // The SHA-256 check supersedes the CRC check
+        AssetReader reader;
+        CHECK(reader.init(dataPath(name).c_str()));
+        CHECK(reader.validate(!fileHash /* full */));
+        CHECK_TRUE(reader.isValid() && reader.asset() == asset_ && reader.size() == state_.fileSize, SYSTEM_ERROR_BAD_DATA);
+    }
+    CHECK_FS(lfs_file_close(&fs_->instance, &file_));
+    active_ = false;
+    lfs_remove(&fs_->instance, name);
+    CHECK_FS(lfs_rename(&fs_->instance, dataPath(name).c_str(), name));
+    discardGuard.dismiss();
+    lfs_remove(&fs_->instance, statePath(name).c_str());
+    return 0;
+}
+
+void AssetTransfer::cancel(bool discard) {
+    if (!active_) {
+        return;
+    }
+    const fs::FsLock lock(fs_);
+    if (!discard) {
+        const int r = checkpoint();
+        if (r < 0) {
+            LOG(ERROR, "Failed to save asset transfer state: %d", r);
+        }
+    }
+    close(discard);
+}
+
+bool AssetTransfer::hasChunk(size_t index) const {
+    return index < chunkCount_ && (bitmap_[index / 8] & (1 << (index % 8)));
+}
+
+int AssetTransfer::nextMissingChunk(size_t index) const {
+    for (; index < chunkCount_; ++index) {
+        if (!hasChunk(index)) {
+            return index;
+        }
+    }
+    return SYSTEM_ERROR_NOT_FOUND;
+}
+
+int AssetTransfer::clear(const char* name) {
+    const auto fs = filesystem_get_instance(FILESYSTEM_INSTANCE_ASSET_STORAGE, nullptr);
+    CHECK_TRUE(fs, SYSTEM_ERROR_FILE);
+    const fs::FsLock lock(fs);
+    lfs_remove(&fs->instance, statePath(name).c_str());
+    lfs_remove(&fs->instance, dataPath(name).c_str());
+    return 0;
+}
+
+int AssetTransfer::clearExcept(const Vector<Asset>& assets) {
+    const auto fs = filesystem_get_instance(FILESYSTEM_INSTANCE_ASSET_STORAGE, nullptr);
+    CHECK_TRUE(fs, SYSTEM_ERROR_FILE);
+    const fs::FsLock lock(fs);
+    Vector<String> names;
+    lfs_dir_t dir = {};
+    int r = lfs_dir_open(&fs->instance, &dir, DATA_DIR);
+    if (r == LFS_ERR_NOENT) {
+        return 0;
+    }
+    CHECK_FS(r);
+    {
+        SCOPE_GUARD({
+            lfs_dir_close(&fs->instance, &dir);
+        });
+        lfs_info info = {};
+        while (CHECK_FS(lfs_dir_read(&fs->instance, &dir, &info)) == 1) {
+            if (info.type != LFS_TYPE_REG) {
+                continue;
+            }
+            bool keep = false;
+            for (const auto& asset: assets) {
+                if (asset.name() == info.name) {
+                    keep = true;
+                    break;
+                }
+            }
+            if (!keep) {
+                CHECK_TRUE(names.append(String(info.name)), SYSTEM_ERROR_NO_MEMORY);
+            }
+        }
+    }
+    for (const auto& name: names) {
+        LOG(INFO, "Removing partially transferred asset %s", name.c_str());
+        CHECK(clear(name.c_str()));
+    }
+    return 0;
+}
+
+int AssetTransfer::loadState(const State& expected) {
+    const auto name = asset_.name().c_str();
+    lfs_file_t file = {};
+    const int r = lfs_file_open(&fs_->instance, &file, statePath(name).c_str(), LFS_O_RDONLY);
+    if (r == LFS_ERR_NOENT) {
+        return SYSTEM_ERROR_NOT_FOUND;
+    }
+    CHECK_FS(r);
+    {
+        SCOPE_GUARD({
+            lfs_file_close(&fs_->instance, &file);
+        });
+        CHECK_TRUE(CHECK_FS(lfs_file_read(&fs_->instance, &file, &state_, sizeof(state_))) == (int)sizeof(state_),
+                SYSTEM_ERROR_BAD_DATA);
+        // Everything up to the partial size describes the asset and has to match
+        CHECK_TRUE(memcmp(&state_, &expected, offsetof(State, partialSize)) == 0, SYSTEM_ERROR_BAD_DATA);
+        CHECK_TRUE(state_.partialSize <= state_.fileSize, SYSTEM_ERROR_BAD_DATA);
+        CHECK_TRUE(CHECK_FS(lfs_file_read(&fs_->instance, &file, bitmap_.get(), bitmapSize())) == (int)bitmapSize(),
+                SYSTEM_ERROR_BAD_DATA);
+    }
+    // Verify the data covered by the checkpointed hash
+    CHECK(partialHash_.start());
+    CHECK_FS(lfs_file_open(&fs_->instance, &file_, dataPath(name).c_str(), LFS_O_RDONLY));
+    const int ret = hashFile(0, state_.partialSize);
+    lfs_file_close(&fs_->instance, &file_);
+    CHECK(ret);
+    char hash[Sha256::HASH_SIZE] = {};
+    CHECK(tempHash_.copyFrom(partialHash_));
+    CHECK(tempHash_.finish(hash));
+    CHECK_TRUE(memcmp(hash, state_.partialHash, sizeof(hash)) == 0, SYSTEM_ERROR_BAD_DATA);
+    return 0;
+}
+
+int AssetTransfer::saveState() {
+    const auto path = statePath(asset_.name().c_str());
+    // Files are updated atomically in LittleFS
+    lfs_file_t file = {};
+    CHECK_FS(lfs_file_open(&fs_->instance, &file, path.c_str(), LFS_O_WRONLY | LFS_O_CREAT | LFS_O_TRUNC));
+    NAMED_SCOPE_GUARD(closeGuard, {
+        lfs_file_close(&fs_->instance, &file);
+    });
+    CHECK_FS(lfs_file_write(&fs_->instance, &file, &state_, sizeof(state_)));
+    CHECK_FS(lfs_file_write(&fs_->instance, &file, bitmap_.get(), bitmapSize()));
+    closeGuard.dismiss();
+    CHECK_FS(lfs_file_close(&fs_->instance, &file));
+    return 0;
+}
+
+int AssetTransfer::checkpoint() {
+    if (!bytesToCheckpoint_) {
+        return 0;
+    }
+    // The data needs to be stored before the state that refers to it
+    CHECK_FS(lfs_file_sync(&fs_->instance, &file_));
+    CHECK(tempHash_.copyFrom(partialHash_));
+    CHECK(tempHash_.finish(state_.partialHash));
+    CHECK(saveState());
+    bytesToCheckpoint_ = 0;
+    return 0;
+}
+
+int AssetTransfer::hashFile(size_t offset, size_t size) {
+    char buf[READ_BLOCK_SIZE];
+    CHECK_FS(lfs_file_seek(&fs_->instance, &file_, offset, LFS_SEEK_SET));
+    while (size > 0) {
+        const size_t n = std::min(size, sizeof(buf));
+        CHECK_TRUE(CHECK_FS(lfs_file_read(&fs_->instance, &file_, buf, n)) == (int)n, SYSTEM_ERROR_BAD_DATA);
+        CHECK(partialHash_.update(buf, n));
+        size -= n;
+    }
+    return 0;
+}
+
+int AssetTransfer::updatePartialHash() {
+    while (state_.partialSize < state_.fileSize && hasChunk(state_.partialSize / state_.chunkSize)) {
+        const size_t n = std::min<size_t>(state_.chunkSize, state_.fileSize - state_.partialSize);
+        CHECK(hashFile(state_.partialSize, n));
+        state_.partialSize += n;
+    }
+    return 0;
+}
+
+void AssetTransfer::close(bool discard) {
+    if (active_) {
+        lfs_file_close(&fs_->instance, &file_);
+        active_ = false;
+    }
+    if (discard) {
+        clear(asset_.name().c_str());
+    }
+}
+
+} // particle
+
+#endif // HAL_PLATFORM_ASSETS
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "hal_platform.h"
+
+#if HAL_PLATFORM_ASSETS
+
+#include "asset_manager.h"
+#include "filesystem.h"
+#include "sha256.h"
+
+#include <memory>
+
+namespace particle {
+
+/**
+ * Resumable transfer of a single asset module into the asset storage.
+ *
+ * The module is written in fixed-size chunks that can arrive in any order. The received chunks are
+ * tracked in a bitmap, and the SHA-256 of the contiguous part of the module that starts at the
+ * beginning is computed as the chunks arrive. Both are checkpointed to the asset storage together
+ * with the data, so an interrupted transfer continues from the last checkpoint. On resumption, the
+ * data covered by the checkpointed hash is read back and verified before it's trusted.
+ *
+ * The module is moved to its final location only once it's complete and valid, so a partially
+ * transferred asset is never reported as available.
+ */
+class AssetTransfer {
+public:
+    static const size_t DEFAULT_CHUNK_SIZE = 4096;
+
+    AssetTransfer();
+    ~AssetTransfer();
+
+    /**
+     * Start or resume the transfer of an asset.
+     *
+     * The previous transfer of the asset is resumed if it was started for the same hash, module
+     * size and chunk size, and the checkpointed data is intact. Otherwise, the transfer starts over.
+     *
+     * @param asset Asset.
+     * @param fileSize Size of the asset module.
+     * @param chunkSize Chunk size.
+     * @return 0 on success or a negative result code in case of an error.
+     */
+    int begin(const Asset& asset, size_t fileSize, size_t chunkSize = DEFAULT_CHUNK_SIZE);
+    /**
+     * Write a chunk of the asset module.
+     *
+     * @param offset Offset of the chunk in the module. Must be a multiple of the chunk size.
+     * @param data Chunk data.
+     * @param size Chunk size. Must be equal to the chunk size unless it's the last chunk.
+     * @return 0 on success or a negative result code in case of an error.
+     */
+    int write(size_t offset, const char* data, size_t size);
+    /**
+     * Finish the transfer and store the asset.
+     *
+     * @param fileHash Expected SHA-256 of the asset module, or `nullptr`. If the hash is not
+     *        provided, the integrity of the module is verified using its CRC.
+     * @return 0 on success or a negative result code in case of an error.
+     */
+    int finish(const char* fileHash = nullptr);
+    /**
+     * Stop the transfer.
+     *
+     * @param discard If `true`, the transferred data is discarded. Otherwise, the transfer state
+     *        is checkpointed so that it can be resumed later.
+     */
+    void cancel(bool discard = false);
+
+    bool isActive() const {
+        return active_;
+    }
+
+    size_t chunkSize() const {
+        return state_.chunkSize;
+    }
+
+    size_t chunkCount() const {
+        return chunkCount_;
+    }
+
+    size_t receivedChunkCount() const {
+        return receivedChunks_;
+    }
+
+    bool hasChunk(size_t index) const;
+
+    /**
+     * Get the index of the first chunk that hasn't been received yet.
+     *
+     * @param index Index of the chunk to start the search from.
+     * @return Chunk index or `SYSTEM_ERROR_NOT_FOUND` if all the remaining chunks have been received.
+     */
+    int nextMissingChunk(size_t index = 0) const;
+
+    /**
+     * Get the size of the contiguous part of the module that starts at the beginning and has
+     * been received.
+     */
+    size_t partialSize() const {
+        return state_.partialSize;
+    }
+
+    /**
+     * Discard the transferred data of an asset.
+     */
+    static int clear(const char* name);
+    /**
+     * Discard the transferred data of all assets except the given ones.
+     */
+    static int clearExcept(const Vector<Asset>& assets);
+
+private:
+    // Persistently stored transfer state. Followed by the chunk bitmap in the state file
+    struct State {
+        uint32_t magic;
+        uint16_t version;
+        uint8_t hashType;
+        uint8_t hashSize;
+        uint8_t hash[Sha256::HASH_SIZE]; // Hash of the asset
+        uint32_t fileSize;
+        uint32_t chunkSize;
+        uint32_t partialSize;
+        char partialHash[Sha256::HASH_SIZE];
+    };
+
+    State state_;
+    Asset asset_;
+    lfs_file_t file_;
+    filesystem_t* fs_;
+    std::unique_ptr<uint8_t[]> bitmap_;
+    Sha256 partialHash_;
+    Sha256 tempHash_;
+    size_t chunkCount_;
+    size_t receivedChunks_;
+    size_t bytesToCheckpoint_;
+    bool active_;
+
+    int loadState(const State& expected);
+    int saveState();
+    int checkpoint();
+    int hashFile(size_t offset, size_t size);
+    int updatePartialHash();
+    void close(bool discard);
+
+    size_t bitmapSize() const {
+        return (chunkCount_ + 7) / 8;
+    }
+};
+
+} // particle
+
+#endif // HAL_PLATFORM_ASSETS
@@ -24,7 +24,9 @@
 #include "common.h"
 
 #include "ota_flash_hal_impl.h"
+#include "flash_mal.h"
 
+#include "core_hal.h"
 #include "delay_hal.h"
 
 #include "protocol_defs.h" // For UpdateFlag enum
@@ -37,6 +39,7 @@
 #include "control/storage.pb.h"
 
 #include <memory>
+#include <algorithm>
 #include "system_info_encoding.h"
 
 #define PB(_name) particle_ctrl_##_name
@@ -50,6 +53,15 @@ using namespace common;
 
 namespace {
 
+#ifdef INTERNAL_FLASH_PAGE_SIZE
+const size_t FLASH_PAGE_SIZE = INTERNAL_FLASH_PAGE_SIZE;
+#else
+const size_t FLASH_PAGE_SIZE = 4096;
+#endif
+
+const size_t MIN_FIRMWARE_UPDATE_CHUNK_SIZE = 1024;
+const size_t MAX_FIRMWARE_UPDATE_CHUNK_SIZE = 4 * FLASH_PAGE_SIZE;
+
 // TODO: Move handling of compressed firmware binaries to the common system code
 struct FirmwareUpdate {
     FileTransfer::Descriptor descr; // File transfer descriptor
@@ -59,6 +71,23 @@ struct FirmwareUpdate {
 
 std::unique_ptr<FirmwareUpdate> g_update;
 
+// Returns the size of the firmware data chunks that the host should send. Larger chunks require
+// fewer request round trips, but each chunk needs to be buffered in RAM by the request channel
+size_t firmwareUpdateChunkSize() {
+    runtime_info_t info = {};
+    info.size = sizeof(info);
+    HAL_Core_Runtime_Info(&info, nullptr);
+    // Don't use more than a quarter of the largest free block
+    const size_t maxSize = std::min<size_t>(info.largest_free_block_heap / 4, MAX_FIRMWARE_UPDATE_CHUNK_SIZE);
+    // Use a power of two that is either a multiple or a divisor of the flash page size, so that
+    // chunks stay aligned to the page boundaries
+    size_t size = MIN_FIRMWARE_UPDATE_CHUNK_SIZE;
+    while (size * 2 <= maxSize) {
+        size *= 2;
+    }
+    return size;
+}
+
 void cancelFirmwareUpdate() {
     if (!g_update) {
         return;
@@ -96,7 +125,7 @@ int startFirmwareUpdateRequest(ctrl_request* req) {
         return SYSTEM_ERROR_NOT_SUPPORTED;
     }
     update->descr.store = FileTransfer::Store::FIRMWARE;
-    update->descr.chunk_size = 1024; // TODO: Determine depending on free RAM?
+    update->descr.chunk_size = firmwareUpdateChunkSize();
     update->descr.chunk_address = 0;
     update->descr.file_address = 0;
     int ret = Spark_Prepare_For_Firmware_Update(update->descr, 0, nullptr);
@@ -160,6 +189,7 @@ int firmwareUpdateDataRequest(ctrl_request* req) {
         return SYSTEM_ERROR_OUT_OF_RANGE;
     }
 
+    // The chunk data is written to flash directly from the request buffer
     g_update->descr.chunk_size = pbData.size;
     const int ret = Spark_Save_Firmware_Chunk(g_update->descr, (const uint8_t*)pbData.data, nullptr);
     if (ret != 0) {
@@ -30,10 +30,13 @@ LOG_SOURCE_CATEGORY("system.ledger");
 #include <cstring>
 #include <cassert>
 
+#include <pb_encode.h>
+
 #include "ledger.h"
 #include "ledger_manager.h"
 #include "ledger_util.h"
 
+#include "nanopb_misc.h"
 #include "file_util.h"
 #include "time_util.h"
 #include "endian_util.h"
@@ -156,20 +159,7 @@ int readFooter(lfs_t* fs, lfs_file_t* file, size_t* dataSize = nullptr, size_t*
     return n;
 }
 
-int writeFooter(lfs_t* fs, lfs_file_t* file, size_t dataSize, size_t infoSize, int version = DATA_FORMAT_VERSION) {
-    LedgerDataFooter f = {};
-    f.dataSize = nativeToLittleEndian(dataSize);
-    f.infoSize = nativeToLittleEndian(infoSize);
-    f.version = nativeToLittleEndian(version);
-    size_t n = CHECK_FS(lfs_file_write(fs, file, &f, sizeof(f)));
-    if (n != sizeof(f)) {
-        LOG(ERROR, "Unexpected number of bytes written");
-        return SYSTEM_ERROR_FILESYSTEM;
-    }
-    return n;
-}
-
-int writeLedgerInfo(lfs_t* fs, lfs_file_t* file, const char* ledgerName, const LedgerInfo& info) {
+int writeLedgerInfoAndFooter(lfs_t* fs, lfs_file_t* file, const char* ledgerName, const LedgerInfo& info, size_t dataSize) {
     // All fields must be set
     assert(info.isScopeTypeSet() && info.isScopeIdSet() && info.isSyncDirectionSet() && info.isDataSizeSet() &&
             info.isLastUpdatedSet() && info.isLastSyncedSet() && info.isUpdateCountSet() && info.isSyncPendingSet());
@@ -194,8 +184,27 @@ int writeLedgerInfo(lfs_t* fs, lfs_file_t* file, const char* ledgerName, const L
     }
     pbInfo.update_count = info.updateCount();
     pbInfo.sync_pending = info.syncPending();
-    n = CHECK(encodeProtobufToFile(file, &PB_INTERNAL(LedgerInfo_msg), &pbInfo));
-    return n;
+    // Encode the info section and the footer into a single buffer so that they are written to the
+    // file in one operation
+    char buf[PB_INTERNAL(LedgerInfo_size) + sizeof(LedgerDataFooter)];
+    pb_ostream_t stream = {};
+    if (!pb_ostream_from_buffer_ex(&stream, (pb_byte_t*)buf, PB_INTERNAL(LedgerInfo_size), nullptr) ||
+            !pb_encode(&stream, &PB_INTERNAL(LedgerInfo_msg), &pbInfo)) {
+        return SYSTEM_ERROR_ENCODING_FAILED;
+    }
+    size_t infoSize = stream.bytes_written;
+    LedgerDataFooter f = {};
+    f.dataSize = nativeToLittleEndian(dataSize);
+    f.infoSize = nativeToLittleEndian(infoSize);
+    f.version = nativeToLittleEndian(DATA_FORMAT_VERSION);
+    std::memcpy(buf + infoSize, &f, sizeof(f));
+    size_t size = infoSize + sizeof(f);
+    n = CHECK_FS(lfs_file_write(fs, file, buf, size));
+    if (n != size) {
+        LOG(ERROR, "Unexpected number of bytes written");
+        return SYSTEM_ERROR_FILESYSTEM;
+    }
+    return infoSize;
 }
 
 inline int getTempDirPath(char* buf, size_t size, const char* ledgerName) {
@@ -397,10 +406,8 @@ int Ledger::updateInfo(const LedgerInfo& info) {
     // Write the info section
     CHECK_FS(lfs_file_seek(fs.instance(), &file, -(int)(infoSize + sizeof(LedgerDataFooter)), LFS_SEEK_END));
     auto newInfo = this->info().update(info);
-    size_t newInfoSize = CHECK(writeLedgerInfo(fs.instance(), &file, name_, newInfo));
-    // Write the footer
-    if (newInfoSize != infoSize) {
-        CHECK(writeFooter(fs.instance(), &file, dataSize, newInfoSize));
+    size_t newInfoSize = CHECK(writeLedgerInfoAndFooter(fs.instance(), &file, name_, newInfo, dataSize));
+    if (newInfoSize < infoSize) {
         size_t newFileSize = CHECK_FS(lfs_file_tell(fs.instance(), &file));
         CHECK_FS(lfs_file_truncate(fs.instance(), &file, newFileSize));
     }
@@ -589,10 +596,8 @@ int Ledger::initCurrentData(lfs_t* fs) {
             LOG(ERROR, "Error while closing file: %d", r);
         }
     });
-    // Write the info section
-    size_t infoSize = CHECK(writeLedgerInfo(fs, &file, name_, info()));
-    // Write the footer
-    CHECK(writeFooter(fs, &file, 0 /* dataSize */, infoSize));
+    // Write the info section and the footer
+    CHECK(writeLedgerInfoAndFooter(fs, &file, name_, info(), 0 /* dataSize */));
     return 0;
 }
 
@@ -862,10 +867,8 @@ int LedgerWriter::close(bool discard) {
     if (src_ == LedgerWriteSource::USER && !info_.isSyncPendingSet()) {
         newInfo.syncPending(true);
     }
-    // Write the info section
-    size_t infoSize = CHECK(writeLedgerInfo(fs.instance(), &file_, ledger_->name(), newInfo));
-    // Write the footer
-    CHECK(writeFooter(fs.instance(), &file_, dataSize_, infoSize));
+    // Write the info section and the footer
+    CHECK(writeLedgerInfoAndFooter(fs.instance(), &file_, ledger_->name(), newInfo, dataSize_));
     closeFileGuard.dismiss();
     CHECK_FS(lfs_file_close(fs.instance(), &file_));
     // Flush the data. Keep the ledger instance locked so that the ledger state is updated atomically
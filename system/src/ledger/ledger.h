@@ -302,7 +302,7 @@ private:
     // Ledger::info()
     // Ledger::setLedgerInfo()
     // Ledger::loadLedgerInfo()
-    // writeLedgerInfo()
+    // writeLedgerInfoAndFooter()
     std::optional<LedgerScopeId> scopeId_;
     std::optional<int64_t> lastUpdated_;
     std::optional<int64_t> lastSynced_;
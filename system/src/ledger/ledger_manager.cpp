@@ -48,6 +48,7 @@ LOG_SOURCE_CATEGORY("system.ledger");
 #include "endian_util.h"
 #include "str_compat.h"
 #include "scope_guard.h"
+#include "heap_tracking.h"
 #include "check.h"
 
 #include "cloud/cloud.pb.h"
@@ -247,6 +248,7 @@ LedgerManager::~LedgerManager() {
 }
 
 int LedgerManager::init() {
+    HEAP_TAG_SCOPE(HEAP_TAG_LEDGER);
     std::lock_guard lock(mutex_);
     if (state_ != State::NEW) {
         return 0; // Already initialized
@@ -1483,6 +1485,7 @@ void LedgerManager::releaseLedger(const LedgerBase* ledger) {
 }
 
 int LedgerManager::connectionCallback(int error, int status, void* arg) {
+    HEAP_TAG_SCOPE(HEAP_TAG_LEDGER);
     auto self = static_cast<LedgerManager*>(arg);
     std::lock_guard lock(self->mutex_);
     int r = 0;
@@ -1509,6 +1512,7 @@ int LedgerManager::connectionCallback(int error, int status, void* arg) {
 }
 
 int LedgerManager::requestCallback(coap_message* apiMsg, const char* uri, int method, int reqId, void* arg) {
+    HEAP_TAG_SCOPE(HEAP_TAG_LEDGER);
     auto self = static_cast<LedgerManager*>(arg);
     std::lock_guard lock(self->mutex_);
     clear_system_error_message();
@@ -1532,6 +1536,7 @@ int LedgerManager::requestCallback(coap_message* apiMsg, const char* uri, int me
 }
 
 int LedgerManager::responseCallback(coap_message* apiMsg, int status, int reqId, void* arg) {
+    HEAP_TAG_SCOPE(HEAP_TAG_LEDGER);
     auto self = static_cast<LedgerManager*>(arg);
     std::lock_guard lock(self->mutex_);
     CoapMessagePtr msg(apiMsg);
@@ -1545,6 +1550,7 @@ int LedgerManager::responseCallback(coap_message* apiMsg, int status, int reqId,
 }
 
 int LedgerManager::messageBlockCallback(coap_message* msg, int reqId, void* arg) {
+    HEAP_TAG_SCOPE(HEAP_TAG_LEDGER);
     auto self = static_cast<LedgerManager*>(arg);
     std::lock_guard lock(self->mutex_);
     assert(self->msg_.get() == msg && self->reqId_ == reqId);
@@ -1565,6 +1571,7 @@ int LedgerManager::messageBlockCallback(coap_message* msg, int reqId, void* arg)
 }
 
 void LedgerManager::requestErrorCallback(int error, int /* reqId */, void* arg) {
+    HEAP_TAG_SCOPE(HEAP_TAG_LEDGER);
     auto self = static_cast<LedgerManager*>(arg);
     std::lock_guard lock(self->mutex_);
     LOG(ERROR, "Request failed: %d", error);
@@ -1573,6 +1580,7 @@ void LedgerManager::requestErrorCallback(int error, int /* reqId */, void* arg)
 }
 
 void LedgerManager::timerCallback(void* arg) {
+    HEAP_TAG_SCOPE(HEAP_TAG_LEDGER);
     auto self = static_cast<LedgerManager*>(arg);
     std::lock_guard lock(self->mutex_);
     int r = self->run();
@@ -58,6 +58,7 @@
 #include "rgbled.h"
 #include "led_service.h"
 #include "diagnostics.h"
+#include "heap_tracking.h"
 #include "check.h"
 #include "spark_wiring_interrupts.h"
 #include "spark_wiring_cellular.h"
@@ -484,6 +485,7 @@ void app_loop(bool threaded)
                 //Execute user application setup only once
                 DECLARE_SYS_HEALTH(ENTERED_Setup);
                 if (system_mode() != SAFE_MODE) {
+                    HEAP_TAG_SCOPE(HEAP_TAG_USER);
                     setup();
                 }
                 SPARK_WIRING_APPLICATION = 1;
@@ -501,7 +503,10 @@ void app_loop(bool threaded)
             //Execute user application loop
             DECLARE_SYS_HEALTH(ENTERED_Loop);
             if (system_mode()!=SAFE_MODE) {
-                loop();
+                {
+                    HEAP_TAG_SCOPE(HEAP_TAG_USER);
+                    loop();
+                }
                 DECLARE_SYS_HEALTH(RAN_Loop);
 #if !(defined(MODULAR_FIRMWARE) && MODULAR_FIRMWARE)
                 _post_loop();
@@ -647,6 +652,29 @@ private:
     func_t f_;
 };
 
+#if HEAP_TRACKING_ENABLED
+
+// Number of heap bytes currently allocated by a subsystem
+class HeapTagDiagnosticData: public AbstractUnsignedIntegerDiagnosticData {
+public:
+    HeapTagDiagnosticData(uint16_t id, const char* name, int tag) :
+            AbstractUnsignedIntegerDiagnosticData(id, name),
+            tag_(tag) {
+    }
+
+    virtual int get(IntType& val) override {
+        heap_tag_stats stats = {};
+        CHECK(heap_tracking_get_stats(tag_, &stats, nullptr));
+        val = stats.used_size;
+        return 0;
+    }
+
+private:
+    int tag_;
+};
+
+#endif // HEAP_TRACKING_ENABLED
+
 int resetSettingsToFactoryDefaultsIfNeeded() {
 #if !defined(SPARK_NO_PLATFORM) && HAL_PLATFORM_DCT
     Load_SystemFlags();
@@ -709,6 +737,38 @@ RunTimeInfoDiagnosticData g_usedRamDiagData(DIAG_ID_SYSTEM_USED_RAM, DIAG_NAME_S
     }
 );
 
+RunTimeInfoDiagnosticData g_largestFreeBlockDiagData(DIAG_ID_SYSTEM_LARGEST_FREE_BLOCK, DIAG_NAME_SYSTEM_LARGEST_FREE_BLOCK,
+    [](const runtime_info_t& info) -> RunTimeInfoDiagnosticData::IntType {
+        return info.largest_free_block_heap;
+    }
+);
+
+// Percentage of the free heap memory that can't be allocated as a single block
+RunTimeInfoDiagnosticData g_heapFragmentationDiagData(DIAG_ID_SYSTEM_HEAP_FRAGMENTATION, DIAG_NAME_SYSTEM_HEAP_FRAGMENTATION,
+    [](const runtime_info_t& info) -> RunTimeInfoDiagnosticData::IntType {
+        if (!info.freeheap || info.largest_free_block_heap >= info.freeheap) {
+            return 0;
+        }
+        return 100 - (uint64_t)info.largest_free_block_heap * 100 / info.freeheap;
+    }
+);
+
+#if HEAP_TRACKING_ENABLED
+HeapTagDiagnosticData g_heapTagDiagData[] = {
+    { DIAG_ID_HEAP_TAG_OTHER_USED, DIAG_NAME_HEAP_TAG_OTHER_USED, HEAP_TAG_OTHER },
+    { DIAG_ID_HEAP_TAG_SYSTEM_USED, DIAG_NAME_HEAP_TAG_SYSTEM_USED, HEAP_TAG_SYSTEM },
+    { DIAG_ID_HEAP_TAG_PROTOCOL_USED, DIAG_NAME_HEAP_TAG_PROTOCOL_USED, HEAP_TAG_PROTOCOL },
+    { DIAG_ID_HEAP_TAG_LEDGER_USED, DIAG_NAME_HEAP_TAG_LEDGER_USED, HEAP_TAG_LEDGER },
+    { DIAG_ID_HEAP_TAG_BLE_USED, DIAG_NAME_HEAP_TAG_BLE_USED, HEAP_TAG_BLE },
+    { DIAG_ID_HEAP_TAG_NCP_USED, DIAG_NAME_HEAP_TAG_NCP_USED, HEAP_TAG_NCP },
+    { DIAG_ID_HEAP_TAG_NETWORK_USED, DIAG_NAME_HEAP_TAG_NETWORK_USED, HEAP_TAG_NETWORK },
+    { DIAG_ID_HEAP_TAG_USER_USED, DIAG_NAME_HEAP_TAG_USER_USED, HEAP_TAG_USER }
+};
+
+static_assert(sizeof(g_heapTagDiagData) / sizeof(g_heapTagDiagData[0]) == HEAP_TAG_COUNT,
+        "Each heap tag must have a diagnostic source");
+#endif // HEAP_TRACKING_ENABLED
+
 #if HAL_PLATFORM_LWIP
 void if_init_postpone(system_event_t event, int param, void* pointer, void* context) {
     if (event == aux_power_state) {
@@ -0,0 +1,711 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#undef LOG_COMPILE_TIME_LEVEL
+#define LOG_COMPILE_TIME_LEVEL LOG_LEVEL_ALL
+
+#include "logging.h"
+
+LOG_SOURCE_CATEGORY("system.pubq")
+
+#include "publish_queue.h"
+
+#if HAL_PLATFORM_FILESYSTEM
+
+#include "timer_hal.h"
+#include "core_hal.h"
+
+#include "file_util.h"
+#include "endian_util.h"
+#include "str_compat.h"
+#include "scope_guard.h"
+#include "check.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+
+namespace particle::system {
+
+using fs::FsLock;
+
+namespace {
+
+const auto DEFAULT_DIR = "/sys/publish_queue";
+const auto HEAD_FILE_NAME = "head";
+
+const uint8_t RECORD_MAGIC = 0xa7;
+const uint32_t HEAD_MAGIC = 0x31485150; // "PQH1"
+
+// Record format:
+//
+// Field     | Size | Description
+// ----------|------|------------
+// magic     | 1    | RECORD_MAGIC
+// flags     | 1    | PUBLISH_EVENT_FLAG_* flags
+// name_size | 1    | Length of the event name
+// reserved  | 1    |
+// data_size | 2    | Length of the event data
+// reserved  | 2    |
+// ttl       | 4    | Event TTL
+// name      | N    | Event name followed by a null character
+// data      | M    | Event data followed by a null character
+// crc       | 4    | CRC-32 of all the preceding fields, serves as a commit marker
+struct __attribute__((packed)) RecordHeader {
+    uint8_t magic;
+    uint8_t flags;
+    uint8_t nameSize;
+    uint8_t reserved1;
+    uint16_t dataSize;
+    uint16_t reserved2;
+    int32_t ttl;
+};
+
+static_assert(sizeof(RecordHeader) == 12);
+
+const size_t RECORD_TRAILER_SIZE = 4;
+const size_t MAX_DATA_SIZE = 0xffff;
+
+struct __attribute__((packed)) HeadInfo {
+    uint32_t magic;
+    uint32_t segment;
+    uint32_t offset;
+    uint32_t crc;
+};
+
+inline size_t recordSize(size_t nameSize, size_t dataSize) {
+    return sizeof(RecordHeader) + nameSize + 1 + dataSize + 1 + RECORD_TRAILER_SIZE;
+}
+
+inline uint32_t computeCrc(const void* data, size_t size) {
+    return HAL_Core_Compute_CRC32((const uint8_t*)data, size);
+}
+
+inline int closeFile(lfs_t* lfs, lfs_file_t* file) { // Transforms the LittleFS error to a system error
+    CHECK_FS(lfs_file_close(lfs, file));
+    return 0;
+}
+
+inline int closeDir(lfs_t* lfs, lfs_dir_t* dir) { // ditto
+    CHECK_FS(lfs_dir_close(lfs, dir));
+    return 0;
+}
+
+// Parses a segment file name
+bool parseSegmentName(const char* name, uint32_t* id) {
+    char* end = nullptr;
+    const auto v = std::strtoul(name, &end, 10);
+    if (end == name || *end != '\0') {
+        return false;
+    }
+    *id = v;
+    return true;
+}
+
+} // namespace
+
+PublishQueue::PublishQueue(const char* dir) :
+        bufSize_(0),
+        tailFile_(),
+        dir_(),
+        head_(),
+        batchPos_(),
+        maxSize_(DEFAULT_MAX_SIZE),
+        segmentSize_(DEFAULT_SEGMENT_SIZE),
+        totalSize_(0),
+        nextSegmentId_(1),
+        eventCount_(0),
+        sentCount_(0),
+        droppedCount_(0),
+        batchAcked_(0),
+        batchDone_(0),
+        batchTime_(0),
+        batchInterval_(DEFAULT_BATCH_INTERVAL),
+        batchSize_(DEFAULT_BATCH_SIZE),
+        batchCount_(0),
+        batchGen_(0),
+        policy_(SPARK_PUBLISH_QUEUE_DROP_OLDEST),
+        tailOpen_(false),
+        inited_(false) {
+    strlcpy(dir_, dir, sizeof(dir_));
+}
+
+PublishQueue::~PublishQueue() {
+    if (tailOpen_) {
+        FsLock fs;
+        closeTail(fs.instance());
+    }
+}
+
+int PublishQueue::push(const char* name, const char* data, int ttl, uint32_t flags) {
+    const size_t nameSize = name ? std::strlen(name) : 0;
+    const size_t dataSize = data ? std::strlen(data) : 0;
+    if (!nameSize || nameSize > USER_EVENT_NAME_LENGTH || dataSize > MAX_DATA_SIZE) {
+        return SYSTEM_ERROR_INVALID_ARGUMENT;
+    }
+    const size_t size = recordSize(nameSize, dataSize);
+    if (size > maxSize_) {
+        return SYSTEM_ERROR_TOO_LARGE;
+    }
+    CHECK(init());
+    CHECK(ensureBuffer(size));
+    // Serialize the record
+    RecordHeader h = {};
+    h.magic = RECORD_MAGIC;
+    h.flags = flags;
+    h.nameSize = nameSize;
+    h.dataSize = nativeToLittleEndian<uint16_t>(dataSize);
+    h.ttl = nativeToLittleEndian<int32_t>(ttl);
+    auto p = buf_.get();
+    std::memcpy(p, &h, sizeof(h));
+    p += sizeof(h);
+    std::memcpy(p, name, nameSize + 1);
+    p += nameSize + 1;
+    if (dataSize) {
+        std::memcpy(p, data, dataSize);
+    }
+    p[dataSize] = '\0';
+    p += dataSize + 1;
+    const uint32_t crc = nativeToLittleEndian(computeCrc(buf_.get(), p - buf_.get()));
+    std::memcpy(p, &crc, sizeof(crc));
+    // Append it to the tail segment
+    FsLock fs;
+    const auto lfs = fs.instance();
+    CHECK(makeRoom(lfs, size));
+    if (segments_.isEmpty() || (segments_.last().size && segments_.last().size + size > segmentSize_)) {
+        CHECK(addSegment(lfs));
+    }
+    CHECK(openTail(lfs));
+    NAMED_SCOPE_GUARD(resetGuard, {
+        // Reload the queue state on next use. The partially written record will be discarded
+        closeTail(lfs);
+        inited_ = false;
+    });
+    CHECK_FS(lfs_file_write(lfs, &tailFile_, buf_.get(), size));
+    CHECK_FS(lfs_file_sync(lfs, &tailFile_));
+    resetGuard.dismiss();
+    auto& tail = segments_.last();
+    tail.size += size;
+    ++tail.eventCount;
+    totalSize_ += size;
+    ++eventCount_;
+    return 0;
+}
+
+int PublishQueue::process(SendFn send, void* arg) {
+    CHECK(init());
+    const auto now = HAL_Timer_Get_Milli_Seconds();
+    if (batchCount_) {
+        const uint32_t mask = ((uint64_t)1 << batchCount_) - 1;
+        if ((batchDone_ & mask) != mask) {
+            return 0; // Waiting for acknowledgements
+        }
+        CHECK(commitBatch());
+    }
+    if (!eventCount_ || now - batchTime_ < batchInterval_) {
+        return 0;
+    }
+    batchTime_ = now;
+    ++batchGen_;
+    batchAcked_ = 0;
+    batchDone_ = 0;
+    FsLock fs;
+    const auto lfs = fs.instance();
+    int segIndex = 0;
+    Pos pos = head_;
+    unsigned eventsLeft = segments_.first().eventCount;
+    lfs_file_t file = {};
+    bool fileOpen = false;
+    SCOPE_GUARD({
+        if (fileOpen) {
+            closeFile(lfs, &file);
+        }
+    });
+    while (batchCount_ < batchSize_) {
+        if (!eventsLeft) {
+            // Proceed to the next segment
+            if (++segIndex >= segments_.size()) {
+                break;
+            }
+            if (fileOpen) {
+                fileOpen = false;
+                CHECK(closeFile(lfs, &file));
+            }
+            pos.segment = segments_.at(segIndex).id;
+            pos.offset = 0;
+            eventsLeft = segments_.at(segIndex).eventCount;
+            continue;
+        }
+        if (!fileOpen) {
+            if (pos.segment == segments_.last().id && tailOpen_) {
+                // The data written to the open file is only visible to other handles once it's
+                // synchronized, which is done after every record
+                CHECK_FS(lfs_file_sync(lfs, &tailFile_));
+            }
+            char path[64] = {};
+            CHECK(formatPath(path, sizeof(path), pos.segment));
+            CHECK_FS(lfs_file_open(lfs, &file, path, LFS_O_RDONLY));
+            fileOpen = true;
+            CHECK_FS(lfs_file_seek(lfs, &file, pos.offset, LFS_SEEK_SET));
+        }
+        Event ev = {};
+        size_t size = 0;
+        int r = readRecord(lfs, &file, &ev, &size);
+        if (r < 0) {
+            // The record was valid when the queue was loaded. Reload the queue state on next use
+            LOG(ERROR, "Failed to read event: %d", r);
+            resetBatch();
+            closeTail(lfs);
+            inited_ = false;
+            return r;
+        }
+        const auto index = batchCount_++;
+        r = send(ev, ((uint32_t)batchGen_ << 8) | index, arg);
+        if (r < 0) {
+            // Try again with the next batch
+            LOG(TRACE, "Failed to send event: %d", r);
+            batchCount_ = index;
+            break;
+        }
+        pos.offset += size;
+        batchPos_[index] = pos;
+        --eventsLeft;
+    }
+    return batchCount_;
+}
+
+void PublishQueue::eventSent(uint32_t tag, int error) {
+    const unsigned index = tag & 0xff;
+    if ((uint16_t)(tag >> 8) != batchGen_ || index >= batchCount_) {
+        return; // Stale acknowledgement
+    }
+    const uint32_t bit = (uint32_t)1 << index;
+    batchDone_ |= bit;
+    if (!error) {
+        batchAcked_ |= bit;
+    }
+}
+
+void PublishQueue::cancelBatch() {
+    if (batchCount_) {
+        const int r = commitBatch();
+        if (r < 0) {
+            LOG(ERROR, "Failed to update queue state: %d", r);
+        }
+    }
+}
+
+int PublishQueue::clear() {
+    FsLock fs;
+    closeTail(fs.instance());
+    resetBatch();
+    CHECK(rmrf(dir_));
+    segments_.clear();
+    head_ = Pos();
+    totalSize_ = 0;
+    eventCount_ = 0;
+    nextSegmentId_ = 1;
+    inited_ = false;
+    return 0;
+}
+
+int PublishQueue::setConfig(const spark_publish_queue_config& conf) {
+    if (conf.segment_size < MIN_SEGMENT_SIZE || conf.max_size < conf.segment_size || !conf.batch_size ||
+            conf.batch_size > MAX_BATCH_SIZE || (conf.eviction_policy != SPARK_PUBLISH_QUEUE_DROP_OLDEST &&
+            conf.eviction_policy != SPARK_PUBLISH_QUEUE_DROP_NEWEST)) {
+        return SYSTEM_ERROR_INVALID_ARGUMENT;
+    }
+    maxSize_ = conf.max_size;
+    segmentSize_ = conf.segment_size;
+    batchSize_ = conf.batch_size;
+    batchInterval_ = conf.batch_interval;
+    policy_ = conf.eviction_policy;
+    return 0;
+}
+
+int PublishQueue::getStats(spark_publish_queue_stats* stats) {
+    CHECK(init());
+    stats->segment_count = segments_.size();
+    stats->event_count = eventCount_;
+    stats->data_size = totalSize_;
+    stats->sent_count = sentCount_;
+    stats->dropped_count = droppedCount_;
+    return 0;
+}
+
+PublishQueue* PublishQueue::instance() {
+    static PublishQueue queue(DEFAULT_DIR);
+    return &queue;
+}
+
+int PublishQueue::init() {
+    if (inited_) {
+        return 0;
+    }
+    int r = load();
+    if (r < 0) {
+        LOG(ERROR, "Failed to load publish queue: %d", r);
+        return r;
+    }
+    inited_ = true;
+    batchTime_ = HAL_Timer_Get_Milli_Seconds() - batchInterval_;
+    if (eventCount_) {
+        LOG(INFO, "Loaded %u queued event(s)", (unsigned)eventCount_);
+    }
+    return 0;
+}
+
+int PublishQueue::load() {
+    auto fsInstance = filesystem_get_instance(FILESYSTEM_INSTANCE_DEFAULT, nullptr);
+    FsLock fs(fsInstance);
+    const auto lfs = fs.instance();
+    CHECK(filesystem_mount(fsInstance));
+    CHECK(mkdirp(dir_));
+    closeTail(lfs);
+    resetBatch();
+    segments_.clear();
+    totalSize_ = 0;
+    eventCount_ = 0;
+    // Enumerate the segment files
+    lfs_dir_t dir = {};
+    CHECK_FS(lfs_dir_open(lfs, &dir, dir_));
+    NAMED_SCOPE_GUARD(closeDirGuard, {
+        closeDir(lfs, &dir);
+    });
+    lfs_info entry = {};
+    int r = 0;
+    while ((r = lfs_dir_read(lfs, &dir, &entry)) == 1) {
+        uint32_t id = 0;
+        if (entry.type != LFS_TYPE_REG || !parseSegmentName(entry.name, &id)) {
+            continue;
+        }
+        Segment seg = {};
+        seg.id = id;
+        seg.size = entry.size;
+        auto it = std::lower_bound(segments_.begin(), segments_.end(), id, [](const Segment& s, uint32_t id) {
+            return s.id < id;
+        });
+        CHECK_TRUE(segments_.insert(it, seg) != segments_.end(), SYSTEM_ERROR_NO_MEMORY);
+    }
+    CHECK_FS(r);
+    closeDirGuard.dismiss();
+    CHECK(closeDir(lfs, &dir));
+    // Read the head position
+    char path[64] = {};
+    CHECK(formatPath(path, sizeof(path), 0));
+    HeadInfo info = {};
+    lfs_file_t file = {};
+    r = lfs_file_open(lfs, &file, path, LFS_O_RDONLY);
+    if (r == 0) {
+        r = lfs_file_read(lfs, &file, &info, sizeof(info));
+        closeFile(lfs, &file);
+        if (r != (int)sizeof(info) || littleEndianToNative(info.magic) != HEAD_MAGIC ||
+                littleEndianToNative(info.crc) != computeCrc(&info, offsetof(HeadInfo, crc))) {
+            LOG(WARN, "Invalid queue state, sending from the first segment");
+            info = HeadInfo();
+        }
+    } else if (r != LFS_ERR_NOENT) {
+        CHECK_FS(r);
+    }
+    head_.segment = littleEndianToNative(info.segment);
+    head_.offset = littleEndianToNative(info.offset);
+    nextSegmentId_ = head_.segment + 1;
+    // Remove the segments that have been sent completely but not deleted before a reset
+    while (!segments_.isEmpty() && segments_.first().id < head_.segment) {
+        CHECK(formatPath(path, sizeof(path), segments_.first().id));
+        CHECK_FS(lfs_remove(lfs, path));
+        segments_.takeFirst();
+    }
+    if (segments_.isEmpty()) {
+        return 0;
+    }
+    if (segments_.first().id != head_.segment) {
+        head_.segment = segments_.first().id;
+        head_.offset = 0;
+    }
+    nextSegmentId_ = std::max(nextSegmentId_, segments_.last().id + 1);
+    // Validate the records and count the unsent events
+    for (int i = 0; i < segments_.size(); ++i) {
+        auto& seg = segments_.at(i);
+        const bool isTail = (i == segments_.size() - 1);
+        CHECK(scanSegment(lfs, &seg, (i == 0) ? head_.offset : 0, isTail));
+        totalSize_ += seg.size;
+        eventCount_ += seg.eventCount;
+    }
+    return 0;
+}
+
+int PublishQueue::scanSegment(lfs_t* lfs, Segment* seg, uint32_t offset, bool isTail) {
+    char path[64] = {};
+    CHECK(formatPath(path, sizeof(path), seg->id));
+    lfs_file_t file = {};
+    CHECK_FS(lfs_file_open(lfs, &file, path, isTail ? LFS_O_RDWR : LFS_O_RDONLY));
+    NAMED_SCOPE_GUARD(closeFileGuard, {
+        closeFile(lfs, &file);
+    });
+    seg->eventCount = 0;
+    if (offset > seg->size) {
+        offset = seg->size;
+    }
+    CHECK_FS(lfs_file_seek(lfs, &file, offset, LFS_SEEK_SET));
+    for (;;) {
+        Event ev = {};
+        size_t size = 0;
+        int r = readRecord(lfs, &file, &ev, &size);
+        if (r == SYSTEM_ERROR_END_OF_STREAM) {
+            break;
+        }
+        if (r == SYSTEM_ERROR_BAD_DATA) {
+            LOG(WARN, "Discarding invalid data in segment %u at offset %u", (unsigned)seg->id, (unsigned)offset);
+            if (isTail) {
+                // Remove the partially written record so that new records can be appended
+                CHECK_FS(lfs_file_truncate(lfs, &file, offset));
+                seg->size = offset;
+            }
+            break;
+        }
+        CHECK(r);
+        offset += size;
+        ++seg->eventCount;
+    }
+    closeFileGuard.dismiss();
+    CHECK(closeFile(lfs, &file));
+    return 0;
+}
+
+int PublishQueue::readRecord(lfs_t* lfs, lfs_file_t* file, Event* event, size_t* size) {
+    RecordHeader h = {};
+    int r = CHECK_FS(lfs_file_read(lfs, file, &h, sizeof(h)));
+    if (r == 0) {
+        return SYSTEM_ERROR_END_OF_STREAM;
+    }
+    if (r != (int)sizeof(h) || h.magic != RECORD_MAGIC || !h.nameSize || h.nameSize > USER_EVENT_NAME_LENGTH) {
+        return SYSTEM_ERROR_BAD_DATA;
+    }
+    const size_t dataSize = littleEndianToNative(h.dataSize);
+    const size_t n = recordSize(h.nameSize, dataSize);
+    CHECK(ensureBuffer(n));
+    const auto buf = buf_.get();
+    std::memcpy(buf, &h, sizeof(h));
+    r = CHECK_FS(lfs_file_read(lfs, file, buf + sizeof(h), n - sizeof(h)));
+    if (r != (int)(n - sizeof(h))) {
+        return SYSTEM_ERROR_BAD_DATA;
+    }
+    uint32_t crc = 0;
+    std::memcpy(&crc, buf + n - RECORD_TRAILER_SIZE, sizeof(crc));
+    const auto name = buf + sizeof(h);
+    const auto data = name + h.nameSize + 1;
+    if (littleEndianToNative(crc) != computeCrc(buf, n - RECORD_TRAILER_SIZE) || name[h.nameSize] != '\0' ||
+            data[dataSize] != '\0') {
+        return SYSTEM_ERROR_BAD_DATA;
+    }
+    event->name = name;
+    event->data = dataSize ? data : nullptr;
+    event->ttl = littleEndianToNative(h.ttl);
+    event->flags = h.flags;
+    *size = n;
+    return 0;
+}
+
+int PublishQueue::commitBatch() {
+    // Only the events preceding the first unacknowledged event can be removed from the queue
+    unsigned n = 0;
+    while (n < batchCount_ && (batchAcked_ & ((uint32_t)1 << n))) {
+        ++n;
+    }
+    resetBatch();
+    if (!n) {
+        return 0;
+    }
+    for (unsigned i = 0; i < n; ++i) {
+        const auto id = batchPos_[i].segment;
+        for (auto& seg: segments_) {
+            if (seg.id == id) {
+                if (seg.eventCount) {
+                    --seg.eventCount;
+                    --eventCount_;
+                }
+                break;
+            }
+        }
+    }
+    sentCount_ += n;
+    head_ = batchPos_[n - 1];
+    FsLock fs;
+    const auto lfs = fs.instance();
+    if (!eventCount_) {
+        // Start with an empty segment
+        head_.segment = nextSegmentId_;
+        head_.offset = 0;
+    } else {
+        // Skip the segments that don't have unsent events
+        for (const auto& seg: segments_) {
+            if (seg.id >= head_.segment && seg.eventCount) {
+                if (seg.id != head_.segment) {
+                    head_.segment = seg.id;
+                    head_.offset = 0;
+                }
+                break;
+            }
+        }
+    }
+    // Store the new head position before removing the sent segments
+    CHECK(writeHead(lfs));
+    while (!segments_.isEmpty() && segments_.first().id < head_.segment) {
+        CHECK(removeHeadSegment(lfs, false /* drop */));
+    }
+    return 0;
+}
+
+void PublishQueue::resetBatch() {
+    batchCount_ = 0;
+    batchAcked_ = 0;
+    batchDone_ = 0;
+    ++batchGen_;
+}
+
+int PublishQueue::writeHead(lfs_t* lfs) {
+    HeadInfo info = {};
+    info.magic = nativeToLittleEndian(HEAD_MAGIC);
+    info.segment = nativeToLittleEndian(head_.segment);
+    info.offset = nativeToLittleEndian(head_.offset);
+    info.crc = nativeToLittleEndian(computeCrc(&info, offsetof(HeadInfo, crc)));
+    char path[64] = {};
+    CHECK(formatPath(path, sizeof(path), 0));
+    // Files are updated atomically in LittleFS
+    lfs_file_t file = {};
+    CHECK_FS(lfs_file_open(lfs, &file, path, LFS_O_WRONLY | LFS_O_CREAT | LFS_O_TRUNC));
+    NAMED_SCOPE_GUARD(closeFileGuard, {
+        closeFile(lfs, &file);
+    });
+    CHECK_FS(lfs_file_write(lfs, &file, &info, sizeof(info)));
+    closeFileGuard.dismiss();
+    CHECK(closeFile(lfs, &file));
+    return 0;
+}
+
+int PublishQueue::openTail(lfs_t* lfs) {
+    if (tailOpen_) {
+        return 0;
+    }
+    char path[64] = {};
+    CHECK(formatPath(path, sizeof(path), segments_.last().id));
+    CHECK_FS(lfs_file_open(lfs, &tailFile_, path, LFS_O_WRONLY | LFS_O_CREAT | LFS_O_APPEND));
+    tailOpen_ = true;
+    return 0;
+}
+
+void PublishQueue::closeTail(lfs_t* lfs) {
+    if (tailOpen_) {
+        tailOpen_ = false;
+        int r = closeFile(lfs, &tailFile_);
+        if (r < 0) {
+            LOG(ERROR, "Failed to close segment file: %d", r);
+        }
+    }
+}
+
+int PublishQueue::addSegment(lfs_t* lfs) {
+    closeTail(lfs);
+    Segment seg = {};
+    seg.id = nextSegmentId_;
+    CHECK_TRUE(segments_.append(seg), SYSTEM_ERROR_NO_MEMORY);
+    ++nextSegmentId_;
+    if (segments_.size() == 1) {
+        head_.segment = seg.id;
+        head_.offset = 0;
+    }
+    return 0;
+}
+
+int PublishQueue::removeHeadSegment(lfs_t* lfs, bool drop) {
+    const auto seg = segments_.first();
+    if (drop) {
+        if (batchCount_) {
+            resetBatch(); // The positions of the events in the batch are no longer valid
+        }
+        droppedCount_ += seg.eventCount;
+        eventCount_ -= seg.eventCount;
+        LOG(WARN, "Publish queue is full, dropping %u event(s)", (unsigned)seg.eventCount);
+    }
+    if (segments_.size() == 1) {
+        closeTail(lfs);
+    }
+    char path[64] = {};
+    CHECK(formatPath(path, sizeof(path), seg.id));
+    int r = lfs_remove(lfs, path);
+    if (r < 0 && r != LFS_ERR_NOENT) { // The tail segment is created lazily
+        CHECK_FS(r);
+    }
+    totalSize_ -= seg.size;
+    segments_.takeFirst();
+    if (drop) {
+        head_.segment = segments_.isEmpty() ? nextSegmentId_ : segments_.first().id;
+        head_.offset = 0;
+    }
+    return 0;
+}
+
+int PublishQueue::makeRoom(lfs_t* lfs, size_t size) {
+    while (totalSize_ + size > maxSize_ && !segments_.isEmpty()) {
+        if (policy_ == SPARK_PUBLISH_QUEUE_DROP_NEWEST) {
+            ++droppedCount_;
+            return SYSTEM_ERROR_LIMIT_EXCEEDED;
+        }
+        CHECK(removeHeadSegment(lfs, true /* drop */));
+    }
+    return 0;
+}
+
+int PublishQueue::ensureBuffer(size_t size) {
+    if (size > bufSize_) {
+        std::unique_ptr<char[]> buf(new(std::nothrow) char[size]);
+        CHECK_TRUE(buf, SYSTEM_ERROR_NO_MEMORY);
+        buf_ = std::move(buf);
+        bufSize_ = size;
+    }
+    return 0;
+}
+
+int PublishQueue::formatPath(char* buf, size_t size, uint32_t segment) const {
+    // Segment 0 is never used, the name is reserved for the head file
+    const int n = segment ? snprintf(buf, size, "%s/%u", dir_, (unsigned)segment) :
+            snprintf(buf, size, "%s/%s", dir_, HEAD_FILE_NAME);
+    CHECK_TRUE(n > 0 && (size_t)n < size, SYSTEM_ERROR_PATH_TOO_LONG);
+    return 0;
+}
+
+int PublishQueue::sendToCloud(const Event& event, uint32_t tag, void* /* arg */) {
+    spark_send_event_data d = {};
+    d.size = sizeof(d);
+    d.handler_callback = [](int error, const void* /* data */, void* callbackData, void* /* reserved */) {
+        instance()->eventSent((uintptr_t)callbackData, error);
+    };
+    d.handler_data = (void*)(uintptr_t)tag;
+    // Request an acknowledgement so that the event is not removed from the queue before it's
+    // received by the cloud
+    const auto flags = (event.flags & ~PUBLISH_EVENT_FLAG_NO_ACK) | PUBLISH_EVENT_FLAG_WITH_ACK;
+    if (!spark_send_event(event.name, event.data, event.ttl, flags, &d)) {
+        return SYSTEM_ERROR_LIMIT_EXCEEDED; // Most likely rate limited
+    }
+    return 0;
+}
+
+} // namespace particle::system
+
+#endif // HAL_PLATFORM_FILESYSTEM
@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "hal_platform.h"
+
+#if HAL_PLATFORM_FILESYSTEM
+
+#include "system_cloud.h"
+#include "filesystem.h"
+
+#include "spark_wiring_vector.h"
+
+#include <memory>
+#include <cstdint>
+
+namespace particle::system {
+
+/**
+ * Persistent queue of events that are waiting to be published.
+ *
+ * The queue is stored as an append-only log split into segment files. Every record is followed by
+ * a CRC-32 of its contents that serves as the record's commit marker: a record that was only
+ * partially written before a reset fails the check and is discarded, along with everything that
+ * follows it in the segment. The position of the first unsent record is stored in a separate file
+ * that is only rewritten once per drained batch.
+ *
+ * Events are sent in batches without waiting for the acknowledgement of each individual event.
+ * Once all events in a batch have completed, the head of the queue is moved past the events that
+ * precede the first failed one. The failed event and all the events following it are sent again as
+ * part of a later batch, including those that were already delivered, so the delivery is at least
+ * once.
+ *
+ * This class is not thread-safe and is expected to be used from the system thread.
+ */
+class PublishQueue {
+public:
+    /**
+     * Event read from the queue.
+     */
+    struct Event {
+        const char* name;
+        const char* data;
+        int ttl;
+        uint32_t flags; // PUBLISH_EVENT_FLAG_*
+    };
+
+    /**
+     * Function used to send the queued events.
+     *
+     * The function must call `eventSent()` with the given `tag` once the delivery of the event is
+     * confirmed or has failed. This may happen before the function returns.
+     *
+     * @return 0 if the event is being sent or a negative result code in case of an error.
+     */
+    typedef int (*SendFn)(const Event& event, uint32_t tag, void* arg);
+
+    static constexpr size_t DEFAULT_MAX_SIZE = 32 * 1024;
+    static constexpr size_t DEFAULT_SEGMENT_SIZE = 4 * 1024;
+    static constexpr unsigned DEFAULT_BATCH_SIZE = 4; // Publisher allows up to 4 events per second
+    static constexpr unsigned DEFAULT_BATCH_INTERVAL = 1000;
+    static constexpr unsigned MAX_BATCH_SIZE = 32;
+    static constexpr size_t MIN_SEGMENT_SIZE = 1024;
+
+    explicit PublishQueue(const char* dir);
+    ~PublishQueue();
+
+    /**
+     * Append an event to the queue.
+     *
+     * @return 0 on success or a negative result code in case of an error.
+     */
+    int push(const char* name, const char* data, int ttl, uint32_t flags);
+
+    /**
+     * Send the next batch of events if the previous batch has completed.
+     *
+     * @param send Function used to send the events.
+     * @param arg Argument to pass to the function.
+     * @return Number of events sent or a negative result code in case of an error.
+     */
+    int process(SendFn send = sendToCloud, void* arg = nullptr);
+
+    /**
+     * Complete the delivery of an event.
+     *
+     * @param tag Tag passed to the send function.
+     * @param error 0 if the event was delivered or a negative result code otherwise.
+     */
+    void eventSent(uint32_t tag, int error);
+
+    /**
+     * Stop waiting for the acknowledgements of the current batch, e.g. because the cloud
+     * connection was lost.
+     *
+     * The events that haven't been acknowledged will be sent again as part of the next batch.
+     */
+    void cancelBatch();
+
+    int clear();
+
+    /**
+     * Load the state of the queue from the filesystem if it hasn't been loaded yet.
+     *
+     * @return 0 on success or a negative result code in case of an error.
+     */
+    int prepare() {
+        return init();
+    }
+
+    int setConfig(const spark_publish_queue_config& conf);
+    int getStats(spark_publish_queue_stats* stats);
+
+    /**
+     * Returns `true` if the queue is known to have no events. The queue is considered non-empty
+     * until its state is loaded.
+     */
+    bool isEmpty() const {
+        return inited_ ? !eventCount_ : false;
+    }
+
+    /**
+     * Returns `true` if there's a batch of events being sent.
+     */
+    bool isSending() const {
+        return batchCount_ > 0;
+    }
+
+    /**
+     * Send an event to the cloud. This is the default send function.
+     */
+    static int sendToCloud(const Event& event, uint32_t tag, void* arg);
+
+    static PublishQueue* instance();
+
+private:
+    struct Segment {
+        uint32_t id; // Segment number
+        uint32_t size; // Size of the segment file
+        uint32_t eventCount; // Number of unsent events in the segment
+    };
+
+    struct Pos {
+        uint32_t segment;
+        uint32_t offset;
+    };
+
+    Vector<Segment> segments_; // Sorted by segment number. The last segment is the tail
+    std::unique_ptr<char[]> buf_; // Record buffer
+    size_t bufSize_;
+    lfs_file_t tailFile_; // Tail segment, kept open to speed up appending
+    char dir_[32];
+    Pos head_; // Position of the first unsent record
+    Pos batchPos_[MAX_BATCH_SIZE]; // Positions following the records in the current batch
+    size_t maxSize_;
+    size_t segmentSize_;
+    size_t totalSize_; // Sum of the segment sizes
+    uint32_t nextSegmentId_;
+    uint32_t eventCount_; // Number of unsent events
+    uint32_t sentCount_;
+    uint32_t droppedCount_;
+    uint32_t batchAcked_; // Mask of the acknowledged events in the current batch
+    uint32_t batchDone_; // Mask of the events in the current batch whose delivery has completed
+    system_tick_t batchTime_;
+    unsigned batchInterval_;
+    unsigned batchSize_;
+    unsigned batchCount_; // Number of events in the current batch
+    uint16_t batchGen_; // Incremented every time a batch is started or cancelled
+    int policy_;
+    bool tailOpen_;
+    bool inited_;
+
+    int init();
+    int load();
+    int scanSegment(lfs_t* lfs, Segment* seg, uint32_t offset, bool isTail);
+    int readRecord(lfs_t* lfs, lfs_file_t* file, Event* event, size_t* size);
+    int commitBatch();
+    void resetBatch();
+    int writeHead(lfs_t* lfs);
+    int openTail(lfs_t* lfs);
+    void closeTail(lfs_t* lfs);
+    int addSegment(lfs_t* lfs);
+    int removeHeadSegment(lfs_t* lfs, bool drop);
+    int makeRoom(lfs_t* lfs, size_t size);
+    int ensureBuffer(size_t size);
+
+    int formatPath(char* buf, size_t size, uint32_t segment) const;
+};
+
+} // namespace particle::system
+
+#endif // HAL_PLATFORM_FILESYSTEM
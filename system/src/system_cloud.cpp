@@ -36,11 +36,13 @@
 #include "system_cloud_internal.h"
 #include "system_cloud_connection.h"
 #include "system_publish_vitals.h"
+#include "publish_queue.h"
 #include "system_task.h"
 #include "system_threading.h"
 #include "system_update.h"
 #include "system_cloud_internal.h"
 #include "system_connection_manager.h"
+#include "system_wake_latency.h"
 #include "string_convert.h"
 #include "spark_protocol_functions.h"
 #include "events.h"
@@ -194,7 +196,24 @@ bool spark_send_event(const char* name, const char* data, int ttl, uint32_t flag
         d.handler_data = r->handler_data;
     }
 
-    return spark_protocol_send_event(sp, name, data, ttl, convert(flags), &d);
+    if (flags & PUBLISH_EVENT_FLAG_PERSISTENT) {
+        flags &= ~PUBLISH_EVENT_FLAG_PERSISTENT;
+#if HAL_PLATFORM_FILESYSTEM
+        // Persistent events are always sent via the queue so that an event whose direct delivery
+        // fails is not lost. The publish operation completes once the event is stored
+        const int r = PublishQueue::instance()->push(name, data, ttl, flags);
+        if (d.handler_callback) {
+            d.handler_callback(r, nullptr, d.handler_data, nullptr);
+        }
+        return r == 0;
+#endif // HAL_PLATFORM_FILESYSTEM
+    }
+
+    if (!spark_protocol_send_event(sp, name, data, ttl, convert(flags), &d)) {
+        return false;
+    }
+    WakeLatency::instance()->stageReached(WakeLatency::PUBLISH);
+    return true;
 }
 
 bool spark_variable(const char *varKey, const void *userVar, Spark_Data_TypeDef userVarType, spark_variable_t* extra)
@@ -348,3 +367,33 @@ int spark_set_random_seed_from_cloud_handler(void (*handler)(unsigned int), void
     random_seed_from_cloud_handler = handler;
     return 0;
 }
+
+int spark_publish_queue_set_config(const spark_publish_queue_config* config, void* reserved)
+{
+#if HAL_PLATFORM_FILESYSTEM
+    SYSTEM_THREAD_CONTEXT_SYNC(spark_publish_queue_set_config(config, reserved));
+    return PublishQueue::instance()->setConfig(*config);
+#else
+    return SYSTEM_ERROR_NOT_SUPPORTED;
+#endif // HAL_PLATFORM_FILESYSTEM
+}
+
+int spark_publish_queue_get_stats(spark_publish_queue_stats* stats, void* reserved)
+{
+#if HAL_PLATFORM_FILESYSTEM
+    SYSTEM_THREAD_CONTEXT_SYNC(spark_publish_queue_get_stats(stats, reserved));
+    return PublishQueue::instance()->getStats(stats);
+#else
+    return SYSTEM_ERROR_NOT_SUPPORTED;
+#endif // HAL_PLATFORM_FILESYSTEM
+}
+
+int spark_publish_queue_clear(void* reserved)
+{
+#if HAL_PLATFORM_FILESYSTEM
+    SYSTEM_THREAD_CONTEXT_SYNC(spark_publish_queue_clear(reserved));
+    return PublishQueue::instance()->clear();
+#else
+    return SYSTEM_ERROR_NOT_SUPPORTED;
+#endif // HAL_PLATFORM_FILESYSTEM
+}
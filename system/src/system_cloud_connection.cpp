@@ -38,6 +38,9 @@ namespace {
 
 uint16_t cloud_udp_port = PORT_COAPS; // default Particle Cloud UDP port
 
+// Maximum time to block waiting for data while the handshake is in progress
+const unsigned HANDSHAKE_MAX_RECEIVE_WAIT = 100;
+
 } /* anonymous */
 
 /* FIXME: */
@@ -287,6 +290,33 @@ int Spark_Receive(unsigned char *buf, uint32_t buflen, void* reserved)
     return system_cloud_recv(buf, buflen, 0);
 }
 
+// Returns 1 if data is available for reading, 0 if the timeout has expired or -1 if an error occurred
+int Spark_Wait_Receive(unsigned timeout, void* reserved)
+{
+    if (SPARK_WLAN_RESET || SPARK_WLAN_SLEEP || spark_cloud_socket_closed() || cloud_socket_aborted)
+    {
+        //break from any blocking loop
+        LOG(TRACE, "SPARK_WLAN_RESET || SPARK_WLAN_SLEEP || spark_cloud_socket_closed() || cloud_socket_aborted");
+        return -1;
+    }
+
+    const bool handshake = SPARK_CLOUD_PROTOCOL_HANDSHAKE_IN_PROGRESS;
+    if (handshake && timeout > HANDSHAKE_MAX_RECEIVE_WAIT) {
+        // The ISR task queue needs to be serviced while the system thread is blocked in the handshake
+        timeout = HANDSHAKE_MAX_RECEIVE_WAIT;
+    }
+    int r = system_cloud_wait_recv(timeout);
+    if (r == SYSTEM_ERROR_NOT_SUPPORTED) {
+        r = 1; // Let the caller poll the socket
+    } else if (r < 0) {
+        r = -1;
+    }
+    if (r == 0 && handshake) {
+        SystemISRTaskQueue.process();
+    }
+    return r;
+}
+
 int Internet_Test(void)
 {
     int r = system_internet_test(nullptr);
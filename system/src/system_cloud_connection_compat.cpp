@@ -248,6 +248,11 @@ int system_cloud_recv(uint8_t* buf, size_t buflen, int flags)
     return SYSTEM_ERROR_UNKNOWN;
 }
 
+int system_cloud_wait_recv(unsigned timeout)
+{
+    return SYSTEM_ERROR_NOT_SUPPORTED;
+}
+
 int system_internet_test(void* reserved)
 {
 #if !HAL_PLATFORM_MAY_LEAK_SOCKETS
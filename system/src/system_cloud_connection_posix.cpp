@@ -324,6 +324,16 @@ int system_cloud_send(const uint8_t* buf, size_t buflen, int flags)
 {
     (void)flags;
     LOG_DEBUG(TRACE, "TX s_state.socket %d buflen %d", s_state.socket, buflen);
+#if HAL_PLATFORM_IFAPI
+    // Responses to outgoing messages are received into the shared packet buffers. Defer sending
+    // only when they are nearly exhausted so that the incoming data can be processed first.
+    // Deferring under moderate pressure would also hold back ACKs and handshake messages, which
+    // are what allows the server to stop retransmitting and free the buffers up
+    if (if_get_mem_pressure() == IF_MEM_PRESSURE_CRITICAL) {
+        LOG_DEBUG(WARN, "Packet buffers are exhausted, deferring send");
+        return 0;
+    }
+#endif // HAL_PLATFORM_IFAPI
     int r = sock_send(s_state.socket, buf, buflen, 0);
     if (r < 0) {
         if (errno == ENOMEM) {
@@ -361,6 +371,19 @@ int system_cloud_recv(uint8_t* buf, size_t buflen, int flags)
     return recvd;
 }
 
+int system_cloud_wait_recv(unsigned timeout)
+{
+    pollfd pfd = {};
+    pfd.fd = s_state.socket;
+    pfd.events = POLLIN;
+    const int r = sock_poll(&pfd, 1, timeout);
+    if (r < 0) {
+        LOG(ERROR, "sock_poll returned %d %d", r, errno);
+        return SYSTEM_ERROR_IO;
+    }
+    return r > 0 ? 1 : 0;
+}
+
 int system_internet_test(void* reserved)
 {
     return particle::system::ConnectionManager::instance()->testConnections();
@@ -1129,6 +1129,7 @@ void Spark_Protocol_Init(void)
         callbacks.set_time = system_set_time;
         callbacks.notify_client_messages_processed = clientMessagesProcessed;
         callbacks.server_moved = handleServerMovedRequest;
+        callbacks.wait_receive = Spark_Wait_Receive;
 
         SparkDescriptor descriptor;
         memset(&descriptor, 0, sizeof(descriptor));
@@ -1140,6 +1141,7 @@ void Spark_Protocol_Init(void)
         descriptor.append_system_info = system_module_info_pb;
         descriptor.append_app_info = system_app_info;
         descriptor.append_metrics = system_metrics;
+        descriptor.metrics_acknowledged = system_metrics_acknowledged;
         descriptor.call_event_handler = invokeEventHandler;
 #if HAL_PLATFORM_CLOUD_UDP
         descriptor.app_state_selector_info = compute_cloud_state_checksum;
@@ -1266,6 +1268,8 @@ int Spark_Handshake(bool presence_announce)
     } else if (err != 0) {
         return spark_protocol_to_system_error(err);
     }
+    // The vitals published in the previous session can no longer be acknowledged
+    system_metrics_session_started(nullptr);
     if (!session_resumed) {
         // XXX: ideally this event should be generated before we perform the handshake
         // but the current semantic of indicating after the handshake/session-resumption are done
@@ -36,6 +36,7 @@ LOG_SOURCE_CATEGORY("system.cm")
 #include "ifapi.h"
 #include "random.h"
 #include "system_threading.h"
+#include "spark_wiring_diagnostics.h"
 
 namespace particle { namespace system {
 
@@ -83,6 +84,9 @@ static int getCloudHostnameAndPort(addrinfo** info, CloudServerAddressType* type
 ConnectionManager::ConnectionManager()
     : preferredNetwork_(NETWORK_INTERFACE_ALL) {
     bestNetworks_ = ConnectionTester::getSupportedInterfaces();
+    for (const auto& i: bestNetworks_) {
+        linkQuality_.append(std::make_pair(i.first, LinkQuality()));
+    }
 }
 
 ConnectionManager* ConnectionManager::instance() {
@@ -127,15 +131,19 @@ network_handle_t ConnectionManager::selectCloudConnectionNetwork() {
     network_handle_t bestNetwork = NETWORK_INTERFACE_ALL;
 
     bool canUsePreferred = false;
+    bool bestDegraded = false;
     // If no preferred network, use the 'best' network based on criteria
     // Network is ready: ie configured + connected (see ipv4 routable hook)
     // Network has best criteria based on network tester results
+    // Network is not degraded according to the passive link quality estimate, unless all of them are
     for (auto& i: bestNetworks_) {
         if (network_ready(i.first, 0, nullptr)) {
-            if (bestNetwork == NETWORK_INTERFACE_ALL) {
+            const bool degraded = isDegraded(i.first);
+            if (bestNetwork == NETWORK_INTERFACE_ALL || (bestDegraded && !degraded)) {
                 bestNetwork = i.first;
+                bestDegraded = degraded;
             }
-            if (preferredNetwork_ != NETWORK_INTERFACE_ALL && preferredNetwork_ == i.first && isValidScore(i.second) /* score */) {
+            if (preferredNetwork_ != NETWORK_INTERFACE_ALL && preferredNetwork_ == i.first && isValidScore(i.second) /* score */ && !degraded) {
                 canUsePreferred = true;
             }
         }
@@ -207,6 +215,7 @@ int ConnectionManager::testConnections(bool background) {
         }
     }
     if (r == 0) {
+        updateLinkQuality(metrics);
         bestNetworks_.clear();
         for (auto& i: metrics) {
             bestNetworks_.append(std::make_pair(i.interface, i.resultingScore));
@@ -238,6 +247,96 @@ void ConnectionManager::handlePeriodicCheck() {
     }
 }
 
+void ConnectionManager::updateLinkQuality() {
+    const auto now = HAL_Timer_Get_Milli_Seconds();
+    if (now - lastLinkQualityUpdate_ < LINK_QUALITY_UPDATE_PERIOD_MS) {
+        return;
+    }
+    lastLinkQualityUpdate_ = now;
+
+    // Round trip times and retransmissions of the CoAP messages carried over the DTLS session are
+    // attributed to the interface the cloud socket is bound to
+    CloudTrafficStats stats = { NETWORK_INTERFACE_ALL };
+    diag_histogram_data rtt = {};
+    if (spark_cloud_flag_connected() &&
+            AbstractHistogramDiagnosticData::get(DIAG_ID_CLOUD_COAP_ROUND_TRIP_HISTOGRAM, rtt) == 0 &&
+            AbstractUnsignedIntegerDiagnosticData::get(DIAG_ID_CLOUD_TRANSMITTED_MESSAGES, stats.txCount) == 0 &&
+            AbstractUnsignedIntegerDiagnosticData::get(DIAG_ID_CLOUD_RETRANSMITTED_MESSAGES, stats.retxCount) == 0) {
+        stats.interface = getCloudConnectionNetwork();
+        stats.rttCount = rtt.count;
+        stats.rttSum = rtt.sum;
+    }
+    auto q = linkQuality(stats.interface);
+    if (q && stats.interface == cloudTraffic_.interface) {
+        const uint32_t rttCount = stats.rttCount - cloudTraffic_.rttCount;
+        if (rttCount) {
+            q->addRtt((stats.rttSum - cloudTraffic_.rttSum) / rttCount, rttCount);
+        }
+        // Every retransmission means that either the original message or its acknowledgement was lost
+        const uint32_t lost = stats.retxCount - cloudTraffic_.retxCount;
+        q->addLoss(stats.txCount - cloudTraffic_.txCount + lost, lost);
+    }
+    cloudTraffic_ = stats;
+}
+
+void ConnectionManager::updateLinkQuality(const Vector<ConnectionMetrics>& metrics) {
+    for (const auto& i: metrics) {
+        auto q = linkQuality(i.interface);
+        if (!q || !i.txPacketCount) {
+            continue; // Not tested
+        }
+        if (i.rxPacketCount) {
+            q->addRtt(i.avgPacketRoundTripTime, i.rxPacketCount);
+        }
+        q->addLoss(i.txPacketCount, i.txPacketCount - std::min(i.rxPacketCount, i.txPacketCount));
+    }
+}
+
+void ConnectionManager::handleDegradedLink() {
+    const auto current = cloudTraffic_.interface;
+    auto q = linkQuality(current);
+    if (!q || !q->isDegraded()) {
+        return;
+    }
+    const auto now = HAL_Timer_Get_Milli_Seconds();
+    if (lastDegradedLinkCheck_ && now - lastDegradedLinkCheck_ < DEGRADED_LINK_HOLD_DOWN_MS) {
+        return;
+    }
+    bool haveStandby = false;
+    for (const auto& i: linkQuality_) {
+        if (i.first != current && !i.second.isDegraded() && network_ready(i.first, 0, nullptr)) {
+            haveStandby = true;
+            break;
+        }
+    }
+    if (!haveStandby) {
+        return;
+    }
+    LOG(WARN, "%s link is degraded (srtt=%lu ms, loss=%u%%) - checking other network interfaces", netifToName(current),
+            q->srtt(), q->loss() * 100 / LinkQuality::LOSS_SCALE);
+    lastDegradedLinkCheck_ = now;
+    scheduleCloudConnectionNetworkCheck();
+    leaveDegradedLink_ = true;
+}
+
+bool ConnectionManager::isDegraded(network_interface_t interface) const {
+    const auto q = getLinkQuality(interface);
+    return q && q->isDegraded();
+}
+
+const LinkQuality* ConnectionManager::getLinkQuality(network_interface_t interface) const {
+    for (const auto& i: linkQuality_) {
+        if (i.first == interface) {
+            return &i.second;
+        }
+    }
+    return nullptr;
+}
+
+LinkQuality* ConnectionManager::linkQuality(network_interface_t interface) {
+    return const_cast<LinkQuality*>(getLinkQuality(interface));
+}
+
 bool ConnectionManager::testIsAllowed() const {
     uint8_t resetPending = 0;
     system_get_flag(SYSTEM_FLAG_RESET_PENDING, &resetPending, nullptr);
@@ -246,6 +345,11 @@ bool ConnectionManager::testIsAllowed() const {
 }
 
 int ConnectionManager::checkCloudConnectionNetwork() {
+    updateLinkQuality();
+    if (!checkScheduled_ && !backgroundTestInProgress_) {
+        handleDegradedLink();
+    }
+
     bool finishedBackgroundTest = false;
     if (backgroundTestInProgress_) {
         int r = testConnections(true /* background */);
@@ -279,6 +383,8 @@ int ConnectionManager::checkCloudConnectionNetwork() {
     }
 
     checkScheduled_ = false;
+    const bool leaveDegradedLink = leaveDegradedLink_;
+    leaveDegradedLink_ = false;
 
     unsigned countReady = 0;
     bool matchesCurrent = false;
@@ -297,7 +403,7 @@ int ConnectionManager::checkCloudConnectionNetwork() {
         return SYSTEM_ERROR_INVALID_STATE;
     }
     // Simple case, just perform a cloud ping
-    if (matchesCurrent && (countReady == 1 || getCloudConnectionNetwork() == getPreferredNetwork())) {
+    if (matchesCurrent && (countReady == 1 || (getCloudConnectionNetwork() == getPreferredNetwork() && !leaveDegradedLink))) {
         spark_protocol_command(system_cloud_protocol_instance(), ProtocolCommands::PING, 0, nullptr);
         LOG_DEBUG(TRACE, "Still using the same network interface (%s) for the cloud connection - perform a cloud ping", netifToName(getCloudConnectionNetwork()));
         return 0;
@@ -306,6 +412,7 @@ int ConnectionManager::checkCloudConnectionNetwork() {
         if (!finishedBackgroundTest) {
             // Re-test connections
             backgroundTestInProgress_ = false;
+            leaveDegradedLink_ = leaveDegradedLink;
             return testConnections(true /* background */);
         } else {
             best = selectCloudConnectionNetwork();
@@ -317,9 +424,11 @@ int ConnectionManager::checkCloudConnectionNetwork() {
             }
         }
     }
-    // If best candidate doesn't match current network interface - reconnect
+    // If best candidate doesn't match current network interface - reconnect. The session is resumed
+    // on the new interface without a full handshake. There's no point in waiting for the server to
+    // acknowledge the disconnection over a link that is known to be degraded
     LOG(TRACE, "Best network interface for cloud connection changed (to %s) - move the cloud session", netifToName(best));
-    auto options = CloudDisconnectOptions().reconnect(true);
+    auto options = CloudDisconnectOptions().reconnect(true).graceful(!isDegraded(getCloudConnectionNetwork()));
     auto systemOptions = options.toSystemOptions();
     spark_cloud_disconnect(&systemOptions, nullptr);
     return 0;
@@ -23,6 +23,7 @@
 #if HAL_PLATFORM_IFAPI
 
 #include "system_network.h"
+#include "system_link_quality.h"
 #include "spark_wiring_vector.h"
 #include <memory>
 
@@ -69,9 +70,26 @@ public:
     int scheduleCloudConnectionNetworkCheck();
     int checkCloudConnectionNetwork();
 
+    // Returns the passive link quality estimate for a network interface or nullptr if the interface is not supported
+    const LinkQuality* getLinkQuality(network_interface_t interface) const;
+
 private:
+    // Snapshot of the cloud protocol counters used to attribute new samples to the cloud interface
+    struct CloudTrafficStats {
+        network_handle_t interface;
+        uint32_t rttCount;
+        uint32_t rttSum;
+        uint32_t txCount;
+        uint32_t retxCount;
+    };
+
     void handlePeriodicCheck();
     bool testIsAllowed() const;
+    void updateLinkQuality();
+    void updateLinkQuality(const Vector<ConnectionMetrics>& metrics);
+    void handleDegradedLink();
+    bool isDegraded(network_interface_t interface) const;
+    LinkQuality* linkQuality(network_interface_t interface);
 
 private:
     network_handle_t preferredNetwork_;
@@ -82,6 +100,14 @@ private:
     std::unique_ptr<ConnectionTester> backgroundTester_;
     static constexpr system_tick_t PERIODIC_CHECK_PERIOD_MS = 5 * 60 * 1000;
     system_tick_t nextPeriodicCheck_ = 0;
+    Vector<std::pair<network_interface_t, LinkQuality>> linkQuality_;
+    CloudTrafficStats cloudTraffic_ = { NETWORK_INTERFACE_ALL };
+    static constexpr system_tick_t LINK_QUALITY_UPDATE_PERIOD_MS = 1000;
+    system_tick_t lastLinkQualityUpdate_ = 0;
+    // Minimum time between two attempts to move the cloud session off a degraded link
+    static constexpr system_tick_t DEGRADED_LINK_HOLD_DOWN_MS = 60 * 1000;
+    system_tick_t lastDegradedLinkCheck_ = 0;
+    bool leaveDegradedLink_ = false;
 };
 
 class ConnectionTester {
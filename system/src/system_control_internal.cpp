@@ -25,6 +25,9 @@
 #include "system_update.h"
 #include "spark_wiring_system.h"
 #include "appender.h"
+#include "trace.h"
+#include "heap_tracking.h"
+#include "endian_util.h"
 #include "debug.h"
 #include "delay_hal.h"
 #include "hal_platform.h"
@@ -44,6 +47,12 @@ namespace {
 
 typedef int(*ReplyFormatterCallback)(Appender*, void* data);
 
+// Maximum size of a reply to a CTRL_REQUEST_GET_TRACE_DATA request
+const size_t MAX_TRACE_DATA_REPLY_SIZE = 1024;
+
+// Maximum size of a reply to a CTRL_REQUEST_GET_HEAP_TRACKING_DATA request
+const size_t MAX_HEAP_TRACKING_DATA_REPLY_SIZE = 256;
+
 int formatReplyData(ctrl_request* req, ReplyFormatterCallback callback, void* data = nullptr,
         size_t maxSize = std::numeric_limits<size_t>::max()) {
     size_t bufSize = std::min((size_t)128, maxSize); // Initial size of the reply buffer
@@ -245,6 +254,37 @@ void SystemControl::processRequest(ctrl_request* req, ControlRequestChannel* /*
         }
         break;
     }
+    case CTRL_REQUEST_GET_TRACE_DATA: {
+        // The request contains an optional index of the first event to read
+        struct Formatter {
+            uint32_t start;
+            static int callback(Appender* appender, void* data) {
+                const auto d = static_cast<Formatter*>(data);
+                uint32_t pos = d->start; // The callback may be invoked more than once
+                const int r = trace_format(&pos, MAX_TRACE_DATA_REPLY_SIZE, Appender::callback, appender, nullptr);
+                return (r < 0) ? r : 0;
+            }
+        };
+        Formatter f = {};
+        if (req->request_size >= sizeof(uint32_t)) {
+            uint32_t pos = 0;
+            memcpy(&pos, req->request_data, sizeof(pos));
+            f.start = littleEndianToNative(pos);
+        }
+        const int ret = formatReplyData(req, Formatter::callback, &f, MAX_TRACE_DATA_REPLY_SIZE);
+        setResult(req, ret);
+        break;
+    }
+    case CTRL_REQUEST_GET_HEAP_TRACKING_DATA: {
+        struct Formatter {
+            static int callback(Appender* appender, void* data) {
+                return heap_tracking_format(MAX_HEAP_TRACKING_DATA_REPLY_SIZE, Appender::callback, appender, nullptr);
+            }
+        };
+        const int ret = formatReplyData(req, Formatter::callback, nullptr, MAX_HEAP_TRACKING_DATA_REPLY_SIZE);
+        setResult(req, ret);
+        break;
+    }
     /* config requests */
     case CTRL_REQUEST_SET_CLAIM_CODE: {
         setResult(req, control::config::handleSetClaimCodeRequest(req));
@@ -24,8 +24,11 @@
 #include "spark_wiring_json.h"
 #include "spark_wiring_diagnostics.h"
 #include "spark_macros.h"
+#include "varint.h"
+#include "system_publish_vitals.h"
 #include <cstdio>
 #include <climits>
+#include <algorithm>
 
 #include "control/common.h"
 #if HAL_PLATFORM_PROTOBUF
@@ -89,6 +92,20 @@ public:
         return writeDirect(value);
     }
 
+    bool write(uint8_t value) {
+        return writeDirect(value);
+    }
+
+    bool writeVarint(uint32_t value) {
+        char buf[maxUnsignedVarintSize<uint32_t>()];
+        const int n = encodeUnsignedVarint(buf, sizeof(buf), value);
+        return fn_(data_, (const uint8_t*)buf, n);
+    }
+
+    bool writeSignedVarint(int32_t value) {
+        // ZigZag encoding
+        return writeVarint(((uint32_t)value << 1) ^ (uint32_t)(value >> 31));
+    }
 };
 
 
@@ -127,6 +144,15 @@ private:
     bool state_;
 };
 
+// Returns the number of histogram buckets excluding the trailing empty buckets
+unsigned usedBucketCount(const diag_histogram_data& val) {
+	unsigned n = std::min<unsigned>(val.bucket_count, DIAG_HISTOGRAM_MAX_BUCKET_COUNT);
+	while (n > 0 && !val.buckets[n - 1]) {
+		--n;
+	}
+	return n;
+}
+
 template <typename T>
 class AbstractDiagnosticsFormatter {
 
@@ -167,6 +193,22 @@ protected:
 			}
 			break;
 		}
+		case DIAG_TYPE_HISTOGRAM: {
+			diag_histogram_data val = {};
+			const int ret = AbstractHistogramDiagnosticData::get(src, val);
+			if ((ret == 0 && !fmt.formatSourceHistogram(src, val)) || (ret != 0 && !fmt.formatSourceError(src, ret))) {
+				return SYSTEM_ERROR_TOO_LARGE;
+			}
+			break;
+		}
+		case DIAG_TYPE_COUNTER: {
+			diag_counter_data val = {};
+			const int ret = AbstractCounterDiagnosticData::get(src, val);
+			if ((ret == 0 && !fmt.formatSourceCounter(src, val)) || (ret != 0 && !fmt.formatSourceError(src, ret))) {
+				return SYSTEM_ERROR_TOO_LARGE;
+			}
+			break;
+		}
 		default:
 			return SYSTEM_ERROR_NOT_SUPPORTED;
 		}
@@ -214,9 +256,10 @@ public:
 class JsonDiagnosticsFormatter : public AbstractDiagnosticsFormatter<JsonDiagnosticsFormatter> {
 
 	AppendJson& json;
+	bool detailed;
 
 public:
-	JsonDiagnosticsFormatter(AppendJson& appender_) : json(appender_) {}
+	JsonDiagnosticsFormatter(AppendJson& appender_, bool detailed_ = false) : json(appender_), detailed(detailed_) {}
 
 	inline bool openDocument() {
 		json.beginObject();
@@ -249,6 +292,42 @@ public:
 		json.name(src->name).value(val);
 		return json.isOk();
 	}
+
+	bool formatSourceHistogram(const diag_source* src, const diag_histogram_data& val) {
+		if (!detailed) {
+			json.name(src->name).value(val.count);
+			return json.isOk();
+		}
+		json.name(src->name);
+		json.beginObject();
+		json.name("n").value(val.count);
+		if (val.count) {
+			json.name("sum").value(val.sum);
+			json.name("min").value(val.min);
+			json.name("max").value(val.max);
+			json.name("b").beginArray();
+			for (unsigned i = 0; i < usedBucketCount(val); ++i) {
+				json.value(val.buckets[i]);
+			}
+			json.endArray();
+		}
+		json.endObject();
+		return json.isOk();
+	}
+
+	bool formatSourceCounter(const diag_source* src, const diag_counter_data& val) {
+		if (!detailed) {
+			json.name(src->name).value(val.total);
+			return json.isOk();
+		}
+		json.name(src->name);
+		json.beginObject();
+		json.name("t").value(val.total);
+		json.name("w").value(val.window_count);
+		json.name("p").value(val.window);
+		json.endObject();
+		return json.isOk();
+	}
 };
 
 
@@ -281,7 +360,7 @@ public:
 	}
 
 	inline bool isSourceOk(const diag_source* src) {
-	    return true;
+	    return src->type == DIAG_TYPE_INT || src->type == DIAG_TYPE_UINT;
 	}
 
 	inline bool formatSourceInt(const diag_source* src, AbstractIntegerDiagnosticData::IntType val) {
@@ -292,6 +371,128 @@ public:
 		return data.write(src->id) && data.write(val);
 	}
 
+	// Sources of other types are skipped by isSourceOk()
+	inline bool formatSourceHistogram(const diag_source* src, const diag_histogram_data& val) {
+		return true;
+	}
+
+	inline bool formatSourceCounter(const diag_source* src, const diag_counter_data& val) {
+		return true;
+	}
+};
+
+class CompactDiagnosticsFormatter : public AbstractDiagnosticsFormatter<CompactDiagnosticsFormatter> {
+
+	AppendData& data;
+
+	using id = decltype(diag_source::id);
+
+	// Value type of a source that failed to provide its data. Other value types match the diag_type enum
+	static const uint8_t ERROR_VALUE_TYPE = 0;
+
+	// Value size indicating that the values have variable length and are delta-encoded
+	static const uint16_t DELTA_VALUE_SIZE = 0xffff;
+
+	// Frame types of the delta encoding
+	static const uint8_t KEYFRAME = 0;
+	static const uint8_t DELTA_FRAME = 1;
+
+	VitalsDeltaEncoder* delta;
+
+	bool writeHeader(const diag_source* src, uint8_t type) {
+		return data.write(src->id) && data.write(type);
+	}
+
+	bool unchanged(const diag_source* src, int64_t val) {
+		return delta && !delta->update(src->id, val);
+	}
+
+	bool unchangedDigest(const diag_source* src, const void* val, size_t size) {
+		if (!delta) {
+			return false;
+		}
+		// FNV-1a
+		uint32_t h = 2166136261u;
+		for (size_t i = 0; i < size; ++i) {
+			h = (h ^ ((const uint8_t*)val)[i]) * 16777619u;
+		}
+		return !delta->updateDigest(src->id, h);
+	}
+
+public:
+	CompactDiagnosticsFormatter(AppendData& appender_, VitalsDeltaEncoder* delta_ = nullptr) :
+			data(appender_),
+			delta(delta_) {
+	}
+
+	inline bool openDocument() {
+		if (delta) {
+			const uint8_t frameType = delta->beginSnapshot() ? KEYFRAME : DELTA_FRAME;
+			return data.write(uint16_t(sizeof(id))) && data.write(DELTA_VALUE_SIZE) && data.write(frameType);
+		}
+		// A value size of 0 indicates that the values have variable length
+		return data.write(uint16_t(sizeof(id))) && data.write(uint16_t(0));
+	}
+
+	inline bool closeDocument() {
+		return true;
+	}
+
+	bool formatSourceError(const diag_source* src, int error) {
+		if (unchangedDigest(src, &error, sizeof(error))) {
+			return true;
+		}
+		return writeHeader(src, ERROR_VALUE_TYPE) && data.writeSignedVarint(error);
+	}
+
+	inline bool isSourceOk(const diag_source* src) {
+	    return true;
+	}
+
+	inline bool formatSourceInt(const diag_source* src, AbstractIntegerDiagnosticData::IntType val) {
+		if (unchanged(src, val)) {
+			return true;
+		}
+		return writeHeader(src, DIAG_TYPE_INT) && data.writeSignedVarint(val);
+	}
+
+	inline bool formatSourceUnsignedInt(const diag_source* src, AbstractUnsignedIntegerDiagnosticData::IntType val) {
+		if (unchanged(src, val)) {
+			return true;
+		}
+		return writeHeader(src, DIAG_TYPE_UINT) && data.writeVarint(val);
+	}
+
+	bool formatSourceHistogram(const diag_source* src, const diag_histogram_data& val) {
+		if (unchangedDigest(src, &val, sizeof(val))) {
+			return true;
+		}
+		if (!writeHeader(src, DIAG_TYPE_HISTOGRAM) || !data.writeVarint(val.count)) {
+			return false;
+		}
+		if (!val.count) {
+			return true;
+		}
+		const unsigned bucketCount = usedBucketCount(val);
+		if (!data.writeVarint(val.sum) || !data.writeVarint(val.min) || !data.writeVarint(val.max) ||
+				!data.writeVarint(bucketCount)) {
+			return false;
+		}
+		for (unsigned i = 0; i < bucketCount; ++i) {
+			if (!data.writeVarint(val.buckets[i])) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool formatSourceCounter(const diag_source* src, const diag_counter_data& val) {
+		if (unchangedDigest(src, &val, sizeof(val))) {
+			return true;
+		}
+		return writeHeader(src, DIAG_TYPE_COUNTER) && data.writeVarint(val.total) &&
+				data.writeVarint(val.window_count) && data.writeVarint(val.window);
+	}
 };
 
 #if HAL_PLATFORM_PROTOBUF
@@ -316,6 +517,43 @@ private:
 
 #endif // HAL_PLATFORM_PROTOBUF
 
+#if VITALS_DELTA_ENCODING_ENABLED
+
+// Changes of the vitals that are below these thresholds are only published in keyframes
+const struct {
+	uint16_t id;
+	uint32_t threshold;
+} VITALS_DELTA_THRESHOLDS[] = {
+	{ DIAG_ID_SYSTEM_FREE_MEMORY, 1024 }, // Bytes
+	{ DIAG_ID_SYSTEM_USED_RAM, 1024 }, // Bytes
+	{ DIAG_ID_SYSTEM_UPTIME, VitalsDeltaEncoder::KEYFRAME_ONLY }, // Can be derived from the publish time
+	{ DIAG_ID_SYSTEM_BATTERY_CHARGE, 256 }, // 1% (Q8.8)
+	{ DIAG_ID_NETWORK_SIGNAL_STRENGTH, 5 * 256 }, // 5% (Q8.8)
+	{ DIAG_ID_NETWORK_SIGNAL_QUALITY, 5 * 256 }, // 5% (Q8.8)
+	{ DIAG_ID_NETWORK_SIGNAL_STRENGTH_VALUE, 3 * 256 }, // 3 units (Q8.8)
+	{ DIAG_ID_NETWORK_SIGNAL_QUALITY_VALUE, 3 * 256 }, // 3 units (Q8.8)
+	{ DIAG_ID_ALT_NETWORK_SIGNAL_STRENGTH, 5 * 256 },
+	{ DIAG_ID_ALT_NETWORK_SIGNAL_QUALITY, 5 * 256 },
+	{ DIAG_ID_ALT_NETWORK_SIGNAL_STRENGTH_VALUE, 3 * 256 },
+	{ DIAG_ID_ALT_NETWORK_SIGNAL_QUALITY_VALUE, 3 * 256 },
+	{ DIAG_ID_CLOUD_COAP_ROUND_TRIP, 100 } // Milliseconds
+};
+
+VitalsDeltaEncoder g_vitalsDeltaEncoder;
+bool g_vitalsDeltaThresholdsSet = false;
+
+VitalsDeltaEncoder& vitalsDeltaEncoder() {
+	if (!g_vitalsDeltaThresholdsSet) {
+		for (const auto& t: VITALS_DELTA_THRESHOLDS) {
+			g_vitalsDeltaEncoder.threshold(t.id, t.threshold);
+		}
+		g_vitalsDeltaThresholdsSet = true;
+	}
+	return g_vitalsDeltaEncoder;
+}
+
+#endif // VITALS_DELTA_ENCODING_ENABLED
+
 } // anonymous
 
 bool module_info_to_json(AppendJson& json, const hal_module_t* module, uint32_t flags)
@@ -424,23 +662,47 @@ bool append_system_version_info(Appender* appender)
 
 int system_format_diag_data(const uint16_t* id, size_t count, unsigned flags, appender_fn append, void* append_data,
         void* reserved) {
-	if (flags & 1) {
+	if (flags & SYSTEM_FORMAT_DIAG_FLAG_COMPACT) {
+		AppendData data(append, append_data);
+		CompactDiagnosticsFormatter fmt(data);
+	    return fmt.format(id, count, flags);
+	}
+	else if (flags & SYSTEM_FORMAT_DIAG_FLAG_BINARY) {
 		AppendData data(append, append_data);
 		BinaryDiagnosticsFormatter fmt(data);
 	    return fmt.format(id, count, flags);
 	}
 	else {
 	    AppendJson json(append, append_data);
-	    JsonDiagnosticsFormatter fmt(json);
+	    JsonDiagnosticsFormatter fmt(json, flags & SYSTEM_FORMAT_DIAG_FLAG_JSON_DETAILED);
 	    return fmt.format(id, count, flags);
 	}
 }
 
 bool system_metrics(appender_fn appender, void* append_data, uint32_t flags, uint32_t page, void* reserved) {
+#if VITALS_DELTA_ENCODING_ENABLED
+	if (flags & SYSTEM_FORMAT_DIAG_FLAG_COMPACT) {
+		AppendData data(appender, append_data);
+		CompactDiagnosticsFormatter fmt(data, &vitalsDeltaEncoder());
+		return fmt.format(nullptr, 0, flags) == 0;
+	}
+#endif // VITALS_DELTA_ENCODING_ENABLED
     const int ret = system_format_diag_data(nullptr, 0, flags, appender, append_data, nullptr);
     return ret == 0;
 }
 
+void system_metrics_acknowledged(void* reserved) {
+#if VITALS_DELTA_ENCODING_ENABLED
+	vitalsDeltaEncoder().acknowledge();
+#endif // VITALS_DELTA_ENCODING_ENABLED
+}
+
+void system_metrics_session_started(void* reserved) {
+#if VITALS_DELTA_ENCODING_ENABLED
+	vitalsDeltaEncoder().reset();
+#endif // VITALS_DELTA_ENCODING_ENABLED
+}
+
 bool system_app_info(appender_fn appender, void* append_data, void* reserved) {
 	AppendJson json(appender, append_data);
 	json.name("f").beginArray();
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "system_link_quality.h"
+
+#include <algorithm>
+
+namespace particle { namespace system {
+
+namespace {
+
+// Gains of the RTT estimator (RFC 6298): alpha = 1/8, beta = 1/4
+const unsigned SRTT_SHIFT = 3;
+const unsigned RTTVAR_SHIFT = 2;
+
+// A batch of packets moves the loss average by at most this fraction of the difference
+const unsigned MAX_LOSS_GAIN_SHIFT = 1;
+
+} // namespace
+
+const uint32_t LinkQuality::INVALID_SCORE;
+const unsigned LinkQuality::LOSS_SCALE;
+const unsigned LinkQuality::DEGRADED_LOSS;
+const unsigned LinkQuality::RECOVERED_LOSS;
+const uint32_t LinkQuality::DEGRADED_RTT_MS;
+const uint32_t LinkQuality::RECOVERED_RTT_MS;
+const unsigned LinkQuality::MIN_DEGRADED_PACKETS;
+
+LinkQuality::LinkQuality() {
+    reset();
+}
+
+void LinkQuality::addRtt(uint32_t rtt, unsigned count) {
+    if (!count) {
+        return;
+    }
+    rtt = std::max<uint32_t>(rtt, 1); // 0 is reserved for "no samples"
+    if (!srtt_) {
+        srtt_ = rtt;
+        rttVar_ = rtt / 2;
+    } else {
+        // An average of several samples is weighted as if the samples were added one by one, which
+        // is close enough for the small number of samples collected between two updates
+        const int64_t n = std::min(count, 1u << SRTT_SHIFT);
+        const int64_t err = (int64_t)rtt - srtt_;
+        const int64_t absErr = (err < 0) ? -err : err;
+        const int64_t nv = std::min(count, 1u << RTTVAR_SHIFT);
+        rttVar_ = (int64_t)rttVar_ + ((absErr - (int64_t)rttVar_) * nv >> RTTVAR_SHIFT);
+        srtt_ = std::max<int64_t>((int64_t)srtt_ + (err * n >> SRTT_SHIFT), 1);
+    }
+    packetCount_ = std::min(packetCount_ + count, MIN_DEGRADED_PACKETS);
+    updateState();
+}
+
+void LinkQuality::addLoss(unsigned sent, unsigned lost) {
+    if (!sent) {
+        return;
+    }
+    lost = std::min(lost, sent);
+    const int64_t ratio = (uint64_t)lost * LOSS_SCALE / sent;
+    const int64_t n = std::min(sent, 1u << (SRTT_SHIFT - MAX_LOSS_GAIN_SHIFT));
+    loss_ = (int64_t)loss_ + ((ratio - (int64_t)loss_) * n >> SRTT_SHIFT);
+    packetCount_ = std::min(packetCount_ + sent, MIN_DEGRADED_PACKETS);
+    updateState();
+}
+
+void LinkQuality::reset() {
+    srtt_ = 0;
+    rttVar_ = 0;
+    loss_ = 0;
+    packetCount_ = 0;
+    degraded_ = false;
+}
+
+uint32_t LinkQuality::score() const {
+    if (!srtt_) {
+        return INVALID_SCORE;
+    }
+    // Use the retransmission timeout as the base score, then penalize for the lost packets
+    const uint64_t rto = (uint64_t)srtt_ + 4 * (uint64_t)rttVar_;
+    const uint64_t score = rto * (LOSS_SCALE + 4 * loss_) / LOSS_SCALE;
+    return std::min<uint64_t>(score, INVALID_SCORE - 1);
+}
+
+void LinkQuality::updateState() {
+    if (!degraded_) {
+        degraded_ = packetCount_ >= MIN_DEGRADED_PACKETS && (loss_ >= DEGRADED_LOSS || srtt_ >= DEGRADED_RTT_MS);
+    } else {
+        degraded_ = !(loss_ < RECOVERED_LOSS && srtt_ < RECOVERED_RTT_MS);
+    }
+}
+
+} } // particle::system
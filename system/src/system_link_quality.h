@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+namespace particle { namespace system {
+
+/**
+ * Passive estimate of the quality of a network link.
+ *
+ * The round trip time is smoothed as described in RFC 6298 and the loss rate is an exponentially
+ * weighted moving average of the fraction of packets that had to be retransmitted. The estimator
+ * doesn't generate any traffic on its own: it is fed with the timings of the packets that are
+ * sent over the link anyway.
+ */
+class LinkQuality {
+public:
+    static const uint32_t INVALID_SCORE = 0xffffffff;
+    // Loss rate is expressed in units of 1/LOSS_SCALE
+    static const unsigned LOSS_SCALE = 1024;
+
+    // The link is considered degraded when its loss rate or smoothed RTT exceeds these values, and
+    // recovered when both drop below the lower values
+    static const unsigned DEGRADED_LOSS = LOSS_SCALE * 3 / 10;
+    static const unsigned RECOVERED_LOSS = LOSS_SCALE / 10;
+    static const uint32_t DEGRADED_RTT_MS = 5000;
+    static const uint32_t RECOVERED_RTT_MS = 2500;
+    // Minimum number of packets that need to be accounted for before the link can be considered degraded
+    static const unsigned MIN_DEGRADED_PACKETS = 3;
+
+    LinkQuality();
+
+    /**
+     * Adds a round trip time sample.
+     *
+     * @param rtt Round trip time in milliseconds.
+     * @param count Number of packets the sample is an average of.
+     */
+    void addRtt(uint32_t rtt, unsigned count = 1);
+
+    /**
+     * Adds a loss sample.
+     *
+     * @param sent Number of packets sent, including retransmissions.
+     * @param lost Number of packets that were lost.
+     */
+    void addLoss(unsigned sent, unsigned lost);
+
+    /**
+     * Forgets all samples.
+     */
+    void reset();
+
+    bool hasRtt() const {
+        return srtt_ != 0;
+    }
+
+    uint32_t srtt() const {
+        return srtt_;
+    }
+
+    uint32_t rttVar() const {
+        return rttVar_;
+    }
+
+    // Returns the loss rate in units of 1/LOSS_SCALE
+    unsigned loss() const {
+        return loss_;
+    }
+
+    /**
+     * Returns `true` if the link is degraded. The state changes with hysteresis so that a link
+     * that is on the edge doesn't flap between the two states.
+     */
+    bool isDegraded() const {
+        return degraded_;
+    }
+
+    /**
+     * Returns a score that can be compared with the scores of `ConnectionTester`. Lower is better.
+     */
+    uint32_t score() const;
+
+private:
+    uint32_t srtt_;
+    uint32_t rttVar_;
+    unsigned loss_;
+    unsigned packetCount_;
+    bool degraded_;
+
+    void updateState();
+};
+
+} } // particle::system
@@ -52,6 +52,7 @@ LOG_SOURCE_CATEGORY("system.nm")
 #include "control/network.h"
 #include <unistd.h>
 #include "system_connection_manager.h"
+#include "system_wake_latency.h"
 #include "spark_wiring_cloud.h"
 
 #define CHECKV(_expr) \
@@ -442,6 +443,7 @@ void NetworkManager::transition(State state) {
             NetworkDiagnostics::instance()->status(NetworkDiagnostics::CONNECTED);
             if (state_ != State::IP_CONFIGURED) {
                 system_notify_event(network_status, network_status_connected);
+                WakeLatency::instance()->stageReached(WakeLatency::NETWORK_CONNECTED);
             }
             break;
         }
@@ -683,6 +685,9 @@ void NetworkManager::handleIfPowerState(if_t iface, const struct if_event* ev) {
 
 // FIXME: this currently works somewhat properly only if there is just 1 network interface.
 void NetworkManager::handleIfPhyState(if_t iface, const struct if_event* ev) {
+    if (ev->ev_phy_state->state == IF_PHY_STATE_ON) {
+        WakeLatency::instance()->stageReached(WakeLatency::NETWORK_ON);
+    }
     if (networkStatus_ == NetworkStatus::NETWORK_STATUS_POWERING_ON && ev->ev_phy_state->state == IF_PHY_STATE_ON) {
         system_notify_event(network_status, network_status_on);
     } else if (networkStatus_ == NetworkStatus::NETWORK_STATUS_POWERING_OFF && ev->ev_phy_state->state == IF_PHY_STATE_OFF) {
@@ -1,6 +1,7 @@
 
 #include "system_publish_vitals.h"
 
+#include <algorithm>
 #include <limits>
 
 #include "logging.h"
@@ -152,5 +153,163 @@ template class VitalsPublisher<particle::mock_type::Timer>;
 
 #endif // UNIT_TEST
 
+VitalsDeltaEncoder::VitalsDeltaEncoder()
+    : _keyframeInterval(DEFAULT_KEYFRAME_INTERVAL),
+      _snapshotCount(0),
+      _outstanding(0),
+      _keyframe(false),
+      _keyframeAcked(false)
+{
+}
+
+int VitalsDeltaEncoder::threshold(uint16_t id, uint32_t threshold)
+{
+    const auto src = source(id, true /* create */);
+    if (!src)
+    {
+        return SYSTEM_ERROR_NO_MEMORY;
+    }
+    src->threshold = threshold;
+    return SYSTEM_ERROR_NONE;
+}
+
+uint32_t VitalsDeltaEncoder::threshold(uint16_t id) const
+{
+    const auto src = source(id);
+    return src ? src->threshold : 0;
+}
+
+void VitalsDeltaEncoder::keyframeInterval(unsigned interval)
+{
+    _keyframeInterval = std::max(interval, 1u);
+}
+
+unsigned VitalsDeltaEncoder::keyframeInterval(void) const
+{
+    return _keyframeInterval;
+}
+
+bool VitalsDeltaEncoder::beginSnapshot(void)
+{
+    // Discard the previous snapshot if it hasn't been acknowledged. A delta can't be built while
+    // it's outstanding, since its acknowledgement can't be told apart from that of the new snapshot
+    for (auto& src: _sources)
+    {
+        src.sentType = ValueType::NONE;
+    }
+    _keyframe = (!_keyframeAcked || _outstanding > 0 || _snapshotCount + 1 >= _keyframeInterval);
+    if (_keyframe)
+    {
+        _snapshotCount = 0;
+    }
+    else
+    {
+        ++_snapshotCount;
+    }
+    ++_outstanding;
+    return _keyframe;
+}
+
+bool VitalsDeltaEncoder::update(uint16_t id, int64_t value)
+{
+    return update(id, value, ValueType::NUMBER);
+}
+
+bool VitalsDeltaEncoder::updateDigest(uint16_t id, uint32_t digest)
+{
+    return update(id, digest, ValueType::DIGEST);
+}
+
+bool VitalsDeltaEncoder::update(uint16_t id, int64_t value, ValueType type)
+{
+    const auto src = source(id, true /* create */);
+    if (!src)
+    {
+        return true; // Publish the value if it can't be tracked
+    }
+    bool changed = _keyframe || src->ackedType != type;
+    if (!changed && src->threshold != KEYFRAME_ONLY)
+    {
+        if (type == ValueType::DIGEST)
+        {
+            changed = (value != src->ackedValue);
+        }
+        else
+        {
+            const uint64_t diff = (value > src->ackedValue) ? (uint64_t)value - src->ackedValue
+                                                              : (uint64_t)src->ackedValue - value;
+            changed = (diff > src->threshold);
+        }
+    }
+    if (changed)
+    {
+        src->sentValue = value;
+        src->sentType = type;
+    }
+    return changed;
+}
+
+void VitalsDeltaEncoder::acknowledge(void)
+{
+    if (!_outstanding || --_outstanding > 0)
+    {
+        return; // Unexpected or stale acknowledgement
+    }
+    for (auto& src: _sources)
+    {
+        if (src.sentType != ValueType::NONE)
+        {
+            src.ackedValue = src.sentValue;
+            src.ackedType = src.sentType;
+            src.sentType = ValueType::NONE;
+        }
+    }
+    if (_keyframe)
+    {
+        _keyframeAcked = true;
+    }
+}
+
+void VitalsDeltaEncoder::reset(void)
+{
+    for (auto& src: _sources)
+    {
+        src.ackedType = ValueType::NONE;
+        src.sentType = ValueType::NONE;
+    }
+    _snapshotCount = 0;
+    _keyframe = false;
+    _keyframeAcked = false;
+    _outstanding = 0;
+}
+
+VitalsDeltaEncoder::Source* VitalsDeltaEncoder::source(uint16_t id, bool create)
+{
+    const auto it = std::lower_bound(_sources.begin(), _sources.end(), id, [](const Source& src, uint16_t id) {
+        return src.id < id;
+    });
+    if (it != _sources.end() && it->id == id)
+    {
+        return &*it;
+    }
+    if (!create)
+    {
+        return nullptr;
+    }
+    Source src = {};
+    src.id = id;
+    const int index = it - _sources.begin();
+    if (!_sources.insert(index, src))
+    {
+        return nullptr;
+    }
+    return &_sources[index];
+}
+
+const VitalsDeltaEncoder::Source* VitalsDeltaEncoder::source(uint16_t id) const
+{
+    return const_cast<VitalsDeltaEncoder*>(this)->source(id, false /* create */);
+}
+
 }
 }// namespace particle { namespace system {
\ No newline at end of file
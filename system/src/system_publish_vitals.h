@@ -3,10 +3,20 @@
 
 #include <cstdarg>
 #include <cstddef>
+#include <cstdint>
 #include <functional>
 
 #include "spark_protocol_functions.h"
 #include "system_tick_hal.h"
+#include "spark_wiring_vector.h"
+
+/**
+ * Delta encoding of the vitals is disabled by default. Build with `VITALS_DELTA=y` to enable it;
+ * this also enables the compact encoding of the vitals (`VITALS_COMPACT=y`).
+ */
+#ifndef VITALS_DELTA_ENCODING_ENABLED
+#define VITALS_DELTA_ENCODING_ENABLED 0
+#endif
 
 namespace particle
 {
@@ -94,6 +104,138 @@ private:
     void publishFromTimer(void);
 };
 
+/**
+ * @class VitalsDeltaEncoder system_publish_vitals.h
+ * @brief Select the vitals that need to be published
+ *
+ * Tracks the last value of each data source acknowledged by the cloud. A delta snapshot only
+ * includes the sources whose values changed by more than the source's threshold since then. Every
+ * `keyframeInterval()` snapshots, and whenever no keyframe has been acknowledged yet, a keyframe
+ * including all sources is produced instead.
+ *
+ * Acknowledgements don't identify the snapshot they refer to. If a snapshot is started while
+ * another one is still awaiting acknowledgement, it is produced as a keyframe, and the acknowledged
+ * values are only updated once all outstanding snapshots have been acknowledged. The changes of a
+ * snapshot that is discarded this way are therefore published again.
+ */
+class VitalsDeltaEncoder
+{
+public:
+    static const unsigned DEFAULT_KEYFRAME_INTERVAL = 12;
+
+    /**
+     * @brief Threshold value for sources whose changes are only published in keyframes
+     */
+    static const uint32_t KEYFRAME_ONLY = 0xffffffff;
+
+    VitalsDeltaEncoder();
+
+    /**
+     * @brief Set the change threshold of a data source
+     *
+     * @param[in] id Data source ID
+     * @param[in] threshold Maximum absolute change of the value that is not published. The default
+     *            threshold is 0, which means that any change is published
+     * @returns \p system_error_t result code
+     */
+    int threshold(uint16_t id, uint32_t threshold);
+
+    /**
+     * @brief Fetch the change threshold of a data source
+     */
+    uint32_t threshold(uint16_t id) const;
+
+    /**
+     * @brief Set the number of snapshots between keyframes
+     */
+    void keyframeInterval(unsigned interval);
+
+    /**
+     * @brief Fetch the number of snapshots between keyframes
+     */
+    unsigned keyframeInterval(void) const;
+
+    /**
+     * @brief Start a new snapshot
+     *
+     * @returns `true` if the snapshot is a keyframe
+     */
+    bool beginSnapshot(void);
+
+    /**
+     * @brief Check whether the value of a numeric data source needs to be published
+     *
+     * @param[in] id Data source ID
+     * @param[in] value Current value
+     * @returns `true` if the value needs to be included in the current snapshot
+     */
+    bool update(uint16_t id, int64_t value);
+
+    /**
+     * @brief Check whether the value of a non-numeric data source needs to be published
+     *
+     * Thresholds don't apply to such sources and any change of the value is published.
+     *
+     * @param[in] id Data source ID
+     * @param[in] digest Hash of the current value
+     * @returns `true` if the value needs to be included in the current snapshot
+     */
+    bool updateDigest(uint16_t id, uint32_t digest);
+
+    /**
+     * @brief Process an acknowledgement of a snapshot by the cloud
+     *
+     * The values of the current snapshot become acknowledged when there are no older snapshots
+     * awaiting acknowledgement.
+     */
+    void acknowledge(void);
+
+    /**
+     * @brief Forget the acknowledged values and the snapshots awaiting acknowledgement
+     *
+     * The next snapshot will be a keyframe. Needs to be called when a new cloud session is
+     * established, since the acknowledgements of earlier snapshots will never arrive.
+     */
+    void reset(void);
+
+    /**
+     * @brief Check whether the current snapshot is a keyframe
+     */
+    bool isKeyframe(void) const
+    {
+        return _keyframe;
+    }
+
+private:
+    enum ValueType
+    {
+        NONE,
+        NUMBER,
+        DIGEST
+    };
+
+    struct Source
+    {
+        int64_t ackedValue;
+        int64_t sentValue;
+        uint32_t threshold;
+        uint16_t id;
+        uint8_t ackedType; // ValueType
+        uint8_t sentType; // ValueType
+    };
+
+    spark::Vector<Source> _sources; // Sorted by ID
+    unsigned _keyframeInterval;
+    unsigned _snapshotCount; // Number of snapshots since the last keyframe
+    unsigned _outstanding; // Number of snapshots awaiting acknowledgement
+    bool _keyframe;
+    bool _keyframeAcked;
+
+    bool update(uint16_t id, int64_t value, ValueType type);
+    Source* source(uint16_t id, bool create);
+    const Source* source(uint16_t id) const;
+};
+
 } // namespace system
 } // namespace particle
 
@@ -0,0 +1,320 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "system_serial_flash.h"
+
+#include "system_update.h"
+#include "timer_hal.h"
+#include "delay_hal.h"
+#include "core_hal.h"
+
+#include "endian_util.h"
+#include "system_error.h"
+#include "check.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+namespace {
+
+using namespace particle;
+
+const size_t START_PAYLOAD_SIZE = 8;
+
+// Maximum time to wait for the remaining bytes of a frame once its sync byte has been received
+const system_tick_t FRAME_TIMEOUT = 1000;
+
+uint32_t readUint32(const uint8_t* data) {
+    uint32_t v = 0;
+    memcpy(&v, data, sizeof(v));
+    return littleEndianToNative(v);
+}
+
+uint16_t readUint16(const uint8_t* data) {
+    uint16_t v = 0;
+    memcpy(&v, data, sizeof(v));
+    return littleEndianToNative(v);
+}
+
+void writeUint32(uint8_t* data, uint32_t val) {
+    val = nativeToLittleEndian(val);
+    memcpy(data, &val, sizeof(val));
+}
+
+void writeUint16(uint8_t* data, uint16_t val) {
+    val = nativeToLittleEndian(val);
+    memcpy(data, &val, sizeof(val));
+}
+
+} // namespace
+
+int SerialFlashReceiver::receive(FileTransfer::Descriptor& tx) {
+    Frame f = {};
+    // Wait for the START frame
+    for (;;) {
+        const int r = CHECK(readFrame(&f, TIMEOUT));
+        if (r > 0 && f.type == START) {
+            break;
+        }
+    }
+    CHECK(start(tx, f));
+    system_tick_t lastActivity = HAL_Timer_Get_Milli_Seconds();
+    for (;;) {
+        int r = readFrame(&f, ACK_INTERVAL);
+        const auto now = HAL_Timer_Get_Milli_Seconds();
+        if (r == SYSTEM_ERROR_TIMEOUT) {
+            if (now - lastActivity >= TIMEOUT) {
+                return r;
+            }
+            // The last acknowledgement could have been lost
+            sendAck();
+            continue;
+        }
+        if (r <= 0) {
+            continue; // Invalid frame
+        }
+        lastActivity = now;
+        switch (f.type) {
+        case START: {
+            // The READY frame could have been lost
+            uint8_t d[START_PAYLOAD_SIZE] = {};
+            writeUint32(d, tx.file_length);
+            writeUint16(d + 4, frameSize_);
+            writeUint16(d + 6, windowSize_);
+            sendFrame(READY, 0, d, sizeof(d));
+            break;
+        }
+        case DATA: {
+            CHECK(handleData(tx, f));
+            if (!stream_.available()) {
+                sendAck();
+            }
+            break;
+        }
+        case END: {
+            if (base_ == frameCount_) {
+                return tx.file_length;
+            }
+            sendAck();
+            break;
+        }
+        case ABORT: {
+            return SYSTEM_ERROR_ABORTED;
+        }
+        default:
+            break;
+        }
+    }
+}
+
+int SerialFlashReceiver::start(FileTransfer::Descriptor& tx, const Frame& f) {
+    if (f.size < START_PAYLOAD_SIZE) {
+        return SYSTEM_ERROR_PROTOCOL;
+    }
+    const size_t fileSize = readUint32(f.data);
+    unsigned frameSize = std::clamp<unsigned>(readUint16(f.data + 4), MIN_FRAME_SIZE, MAX_FRAME_SIZE);
+    unsigned windowSize = std::clamp<unsigned>(readUint16(f.data + 6), 1, MAX_WINDOW_SIZE);
+    if (!fileSize) {
+        return SYSTEM_ERROR_INVALID_ARGUMENT;
+    }
+    // Use fewer frames in flight if the buffers would be too large, and reduce the window and frame
+    // size further if there's not enough RAM
+    const unsigned slotSize = HEADER_SIZE + frameSize + TRAILER_SIZE;
+    windowSize = std::max<unsigned>(std::min<unsigned>(windowSize, MAX_BUFFER_SIZE / slotSize - 1), 1);
+    int r = 0;
+    while ((r = allocBuffers(frameSize, windowSize)) < 0) {
+        if (windowSize > 1) {
+            windowSize /= 2;
+        } else if (frameSize / 2 >= MIN_FRAME_SIZE) {
+            frameSize /= 2;
+        } else {
+            return r;
+        }
+    }
+    tx.file_length = fileSize;
+    tx.chunk_size = frameSize;
+    r = Spark_Prepare_For_Firmware_Update(tx, 0, nullptr);
+    if (r != 0) {
+        return (r < 0) ? r : SYSTEM_ERROR_OTA;
+    }
+    started_ = true;
+    tx.chunk_address = tx.file_address;
+    frameCount_ = (fileSize + frameSize - 1) / frameSize;
+    base_ = 0;
+    received_ = 0;
+    uint8_t d[START_PAYLOAD_SIZE] = {};
+    writeUint32(d, fileSize);
+    writeUint16(d + 4, frameSize);
+    writeUint16(d + 6, windowSize);
+    sendFrame(READY, 0, d, sizeof(d));
+    return 0;
+}
+
+int SerialFlashReceiver::handleData(FileTransfer::Descriptor& tx, const Frame& f) {
+    if (f.seq < base_ || f.seq >= frameCount_ || f.seq - base_ >= windowSize_ || f.data != slot(f.seq % windowSize_) + HEADER_SIZE) {
+        return 0; // Duplicate or unexpected frame
+    }
+    const size_t offs = f.seq * frameSize_;
+    const size_t size = std::min<size_t>(tx.file_length - offs, frameSize_);
+    if (f.size != size) {
+        return 0;
+    }
+    received_ |= (uint32_t)1 << (f.seq - base_);
+    // Write all contiguous frames to flash
+    while (received_ & 1) {
+        tx.chunk_address = tx.file_address + base_ * frameSize_;
+        tx.chunk_size = std::min<size_t>(tx.file_length - base_ * frameSize_, frameSize_);
+        const int r = Spark_Save_Firmware_Chunk(tx, slot(base_ % windowSize_) + HEADER_SIZE, nullptr);
+        if (r != 0) {
+            return (r < 0) ? r : SYSTEM_ERROR_FLASH_IO;
+        }
+        ++base_;
+        received_ >>= 1;
+    }
+    return 0;
+}
+
+int SerialFlashReceiver::allocBuffers(unsigned frameSize, unsigned windowSize) {
+    buf_.reset();
+    frameSize_ = frameSize;
+    windowSize_ = windowSize;
+    const size_t size = (HEADER_SIZE + frameSize + TRAILER_SIZE) * (windowSize + 1 /* Scratch slot */);
+    buf_.reset(new(std::nothrow) uint8_t[size]);
+    if (!buf_) {
+        frameSize_ = 0;
+        windowSize_ = 0;
+        return SYSTEM_ERROR_NO_MEMORY;
+    }
+    return 0;
+}
+
+int SerialFlashReceiver::readFrame(Frame* f, system_tick_t timeout) {
+    // Skip everything up to the sync byte
+    const auto start = HAL_Timer_Get_Milli_Seconds();
+    for (;;) {
+        const int c = stream_.read();
+        if (c == SYNC) {
+            break;
+        }
+        if (c < 0) {
+            if (HAL_Timer_Get_Milli_Seconds() - start >= timeout) {
+                return SYSTEM_ERROR_TIMEOUT;
+            }
+            HAL_Delay_Milliseconds(1);
+        }
+    }
+    uint8_t h[HEADER_SIZE];
+    if (readData(h, sizeof(h), FRAME_TIMEOUT) < 0) {
+        return 0;
+    }
+    const uint8_t type = h[0];
+    const uint16_t size = readUint16(h + 2);
+    const uint32_t seq = readUint32(h + 4);
+    // Data frames are received directly into their slots so that they can be written to flash
+    // without copying them
+    uint8_t* dest = nullptr;
+    if (buf_ && size <= frameSize_) {
+        dest = scratch();
+        if (type == DATA && seq >= base_ && seq - base_ < windowSize_ && !(received_ & ((uint32_t)1 << (seq - base_)))) {
+            dest = slot(seq % windowSize_);
+        }
+    } else if (!buf_ && size <= START_PAYLOAD_SIZE) {
+        // The frame buffers are allocated once the START frame has been received
+        dest = startBuf_;
+    }
+    if (!dest) {
+        return 0; // Frame is too large, the remaining bytes will be skipped while looking for a sync byte
+    }
+    memcpy(dest, h, HEADER_SIZE);
+    if (readData(dest + HEADER_SIZE, size + TRAILER_SIZE, FRAME_TIMEOUT) < 0) {
+        return 0;
+    }
+    const uint32_t crc = readUint32(dest + HEADER_SIZE + size);
+    if (HAL_Core_Compute_CRC32(dest, HEADER_SIZE + size) != crc) {
+        return 0;
+    }
+    f->type = type;
+    f->size = size;
+    f->seq = seq;
+    f->data = dest + HEADER_SIZE;
+    return 1;
+}
+
+int SerialFlashReceiver::readData(uint8_t* data, size_t size, system_tick_t timeout) {
+    auto start = HAL_Timer_Get_Milli_Seconds();
+    size_t offs = 0;
+    while (offs < size) {
+        const int avail = stream_.available();
+        if (avail > 0) {
+            const size_t n = std::min<size_t>(avail, size - offs);
+            offs += stream_.readBytes((char*)data + offs, n);
+            start = HAL_Timer_Get_Milli_Seconds();
+        } else {
+            if (HAL_Timer_Get_Milli_Seconds() - start >= timeout) {
+                return SYSTEM_ERROR_TIMEOUT;
+            }
+            HAL_Delay_Milliseconds(1);
+        }
+    }
+    return 0;
+}
+
+void SerialFlashReceiver::sendFrame(uint8_t type, uint32_t seq, const uint8_t* data, size_t size) {
+    uint8_t d[1 + HEADER_SIZE + START_PAYLOAD_SIZE + TRAILER_SIZE];
+    size = std::min(size, START_PAYLOAD_SIZE);
+    d[0] = SYNC;
+    d[1] = type;
+    d[2] = 0; // Reserved
+    writeUint16(d + 3, size);
+    writeUint32(d + 5, seq);
+    memcpy(d + 1 + HEADER_SIZE, data, size);
+    writeUint32(d + 1 + HEADER_SIZE + size, HAL_Core_Compute_CRC32(d + 1, HEADER_SIZE + size));
+    stream_.write(d, 1 + HEADER_SIZE + size + TRAILER_SIZE);
+    stream_.flush();
+}
+
+void SerialFlashReceiver::sendAck() {
+    uint8_t d[4] = {};
+    writeUint32(d, received_ >> 1);
+    sendFrame(ACK, base_, d, sizeof(d));
+}
+
+void SerialFlashReceiver::sendResult(int result) {
+    uint8_t d[4] = {};
+    writeUint32(d, result);
+    sendFrame(RESULT, 0, d, sizeof(d));
+}
+
+bool Windowed_Serial_Flash_Update(Stream* serialObj, FileTransfer::Descriptor& file, void* reserved) {
+    std::unique_ptr<SerialFlashReceiver> receiver(new(std::nothrow) SerialFlashReceiver(*serialObj));
+    if (!receiver) {
+        return false;
+    }
+    int r = receiver->receive(file);
+    if (r > 0) {
+        r = Spark_Finish_Firmware_Update(file, 1 /* Success */, nullptr);
+    } else if (receiver->updateStarted()) {
+        Spark_Finish_Firmware_Update(file, 0 /* Cancel */, nullptr);
+    }
+    receiver->sendResult(r);
+    if (r < 0) {
+        return false;
+    }
+    HAL_Delay_Milliseconds(1000);
+    return true;
+}
@@ -37,6 +37,7 @@
 #include "spark_wiring_thread.h"
 #include "spark_wiring_wifi_credentials.h"
 #include "system_ymodem.h"
+#include "system_serial_flash.h"
 #include "mbedtls_util.h"
 #include "ota_flash_hal.h"
 #include "system_threading.h"
@@ -183,6 +184,11 @@ bool SystemSetupConsole<Config>::handle_peek(char c)
         system_firmwareUpdate(&serial);
         return true;
     }
+    if (SerialFlashReceiver::SYNC == c)
+    {
+        system_serialFlashUpdate(&serial);
+        return true;
+    }
     return false;
 }
 
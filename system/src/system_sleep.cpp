@@ -40,6 +40,9 @@ LOG_SOURCE_CATEGORY("system.sleep");
 #endif // HAL_PLATFORM_CELLULAR
 #include "check.h"
 #include "system_network_manager.h"
+#include "system_wake_latency.h"
+#include "publish_queue.h"
+#include "timer_hal.h"
 
 using namespace particle;
 using namespace particle::system;
@@ -91,14 +94,29 @@ network_status_t system_sleep_network_suspend(network_interface_index index) {
     return status;
 }
 
-int system_sleep_network_resume(network_interface_index index, network_status_t status) {
-    if (status.on && network_is_off(index, nullptr)) {
+// Powering up an interface is asynchronous, so all interfaces are requested to power up before any
+// of them is reconnected
+void system_sleep_network_power_up(network_interface_index index, network_status_t status) {
+    if (status.suspended && status.on && network_is_off(index, nullptr)) {
         network_on(index, 0, 0, nullptr);
     }
-    if (status.connected) {
+}
+
+void system_sleep_network_reconnect(network_interface_index index, network_status_t status) {
+    if (status.suspended && status.connected) {
         network_connect(index, 0, 0, nullptr);
     }
-    return SYSTEM_ERROR_NONE;
+}
+
+unsigned system_sleep_network_wake_stages(network_status_t status) {
+    unsigned stages = 0;
+    if (status.suspended && (status.on || status.connected)) {
+        stages |= WakeLatency::stageMask(WakeLatency::NETWORK_ON);
+    }
+    if (status.suspended && status.connected) {
+        stages |= WakeLatency::stageMask(WakeLatency::NETWORK_CONNECTED);
+    }
+    return stages;
 }
 #endif // PLATFORM_ID != PLATFORM_GCC
 
@@ -114,6 +132,8 @@ int system_sleep_ext_impl(const hal_sleep_config_t* config, hal_wakeup_source_ba
     // Cancel the firmware update
     system::FirmwareUpdate::instance()->finishUpdate(FirmwareUpdateFlag::CANCEL);
 
+    WakeLatency::instance()->cancel();
+
     SystemSleepConfigurationHelper configHelper(config);
 
     bool reconnectCloud = false;
@@ -196,15 +216,34 @@ int system_sleep_ext_impl(const hal_sleep_config_t* config, hal_wakeup_source_ba
     int ret = hal_sleep_enter(config, reason, nullptr);
 
     system_power_management_wakeup();
+    const auto wakeTime = HAL_Timer_Get_Milli_Seconds();
 
     led_set_update_enabled(1, nullptr); // Enable background LED updates
     LED_On(PARTICLE_LED_RGB); // Turn RGB on in case that RGB is controlled by user application before entering sleep mode.
 
+    unsigned wakeStages = 0;
+#if HAL_PLATFORM_CELLULAR
+    wakeStages |= system_sleep_network_wake_stages(cellularStatus);
+#endif
+#if HAL_PLATFORM_WIFI
+    wakeStages |= system_sleep_network_wake_stages(wifiStatus);
+#endif
+#if HAL_PLATFORM_ETHERNET
+    wakeStages |= system_sleep_network_wake_stages(ethernetStatus);
+#endif
+    if (reconnectCloud) {
+        wakeStages |= WakeLatency::stageMask(WakeLatency::CLOUD_CONNECTED);
+    }
+    if (reconnectCloud || sendCloudPing) {
+        wakeStages |= WakeLatency::stageMask(WakeLatency::PUBLISH);
+    }
+    WakeLatency::instance()->wokeUp(wakeTime, wakeStages);
+
     // Network resume
     // FIXME: if_get_list() can be potentially used, instead of using pre-processor.
 #if HAL_PLATFORM_CELLULAR
     if (cellularStatus.suspended) {
-        system_sleep_network_resume(NETWORK_INTERFACE_CELLULAR, cellularStatus);
+        system_sleep_network_power_up(NETWORK_INTERFACE_CELLULAR, cellularStatus);
     } else {
         cellular_resume(nullptr);
         cellular_urcs(true, nullptr);
@@ -212,21 +251,36 @@ int system_sleep_ext_impl(const hal_sleep_config_t* config, hal_wakeup_source_ba
 #endif // HAL_PLATFORM_CELLULAR
 
 #if HAL_PLATFORM_WIFI
-    if (wifiStatus.suspended) {
-        system_sleep_network_resume(NETWORK_INTERFACE_WIFI_STA, wifiStatus);
-    }
+    system_sleep_network_power_up(NETWORK_INTERFACE_WIFI_STA, wifiStatus);
 #endif // HAL_PLATFORM_WIFI
 
 #if HAL_PLATFORM_ETHERNET
-    if (ethernetStatus.suspended) {
-        system_sleep_network_resume(NETWORK_INTERFACE_ETHERNET, ethernetStatus);
-    }
+    system_sleep_network_power_up(NETWORK_INTERFACE_ETHERNET, ethernetStatus);
 #endif // HAL_PLATFORM_ETHERNET
 
+#if HAL_PLATFORM_CELLULAR
+    system_sleep_network_reconnect(NETWORK_INTERFACE_CELLULAR, cellularStatus);
+#endif
+#if HAL_PLATFORM_WIFI
+    system_sleep_network_reconnect(NETWORK_INTERFACE_WIFI_STA, wifiStatus);
+#endif
+#if HAL_PLATFORM_ETHERNET
+    system_sleep_network_reconnect(NETWORK_INTERFACE_ETHERNET, ethernetStatus);
+#endif
+
     if (reconnectCloud) {
-        // Resume cloud connection.
+        // Resume cloud connection. The connection attempt starts as soon as the network is ready
         spark_cloud_flag_connect();
 
+#if HAL_PLATFORM_FILESYSTEM
+        // Load the queued events from the filesystem while the network interfaces are powering up,
+        // so that they can be sent right after the cloud connection is established
+        const int r = PublishQueue::instance()->prepare();
+        if (r < 0) {
+            LOG(ERROR, "Failed to prepare publish queue: %d", r);
+        }
+#endif // HAL_PLATFORM_FILESYSTEM
+
         // if single-threaded, managed mode then reconnect to the cloud (for up to 60 seconds)
         auto mode = system_mode();
         if (system_thread_get_state(nullptr)==spark::feature::DISABLED && (mode==AUTOMATIC || mode==SEMI_AUTOMATIC) && spark_cloud_flag_auto_connect()) {
@@ -48,6 +48,8 @@
 #include "system_power.h"
 #include "simple_pool_allocator.h"
 #include "system_ble_prov.h"
+#include "publish_queue.h"
+#include "system_wake_latency.h"
 
 #include "spark_wiring_network.h"
 #include "spark_wiring_constants.h"
@@ -383,6 +385,7 @@ void handle_cloud_connection(bool force_events)
                     protocol::experimental::CoapChannel::instance()->open();
                     CloudDiagnostics::instance()->status(CloudDiagnostics::CONNECTED);
                     system_notify_event(cloud_status, cloud_status_connected);
+                    WakeLatency::instance()->stageReached(WakeLatency::CLOUD_CONNECTED);
                     if (system_mode() == SAFE_MODE) {
 /* FIXME: there should be macro that checks for NetworkManager availability */
                         // Connected to the cloud while in safe mode
@@ -437,6 +440,19 @@ void handle_cloud_connection(bool force_events)
         {
             Spark_Process_Events();
         }
+#if HAL_PLATFORM_FILESYSTEM
+        if (SPARK_CLOUD_CONNECTED)
+        {
+            // Drain the persistent publish queue
+            const auto queue = PublishQueue::instance();
+            if (!queue->isEmpty() || queue->isSending()) {
+                const int r = queue->process();
+                if (r < 0) {
+                    LOG(ERROR, "Failed to send queued events: %d", r);
+                }
+            }
+        }
+#endif // HAL_PLATFORM_FILESYSTEM
     }
 }
 
@@ -690,6 +706,11 @@ void cloud_disconnect(unsigned flags, cloud_disconnect_reason cloudReason, netwo
                 spark_protocol_command(spark_protocol_instance(), ProtocolCommands::TERMINATE, 0, nullptr);
             }
         }
+#if HAL_PLATFORM_FILESYSTEM
+        if (PublishQueue::instance()->isSending()) {
+            PublishQueue::instance()->cancelBatch();
+        }
+#endif // HAL_PLATFORM_FILESYSTEM
         if (opts.clearSession()) {
             clearSessionData();
         }
@@ -26,6 +26,7 @@
 #include "system_cloud_internal.h"
 #include "system_network.h"
 #include "system_ymodem.h"
+#include "system_serial_flash.h"
 #include "system_task.h"
 #include "firmware_update.h"
 #include "module_info.h"
@@ -221,6 +222,25 @@ bool system_firmwareUpdate(Stream* stream, void* reserved)
     return system_fileTransfer(&tx);
 }
 
+bool system_serialFlashUpdate(Stream* stream, void* reserved)
+{
+    // Updates over the serial console require the same opt-in as YMODEM transfers
+    if (!Ymodem_Serial_Flash_Update_Handler)
+    {
+        stream->println("Firmware update using this terminal is not supported!");
+        stream->println("Add #include \"Ymodem/Ymodem.h\" to your sketch and try again.");
+        return false;
+    }
+    FileTransfer::Descriptor desc;
+    desc.store = FileTransfer::Store::FIRMWARE;
+    const bool status = Windowed_Serial_Flash_Update(stream, desc, NULL);
+    if (status)
+    {
+        stream->println("Restarting system to apply firmware update...");
+    }
+    return status;
+}
+
 bool system_fileTransfer(system_file_transfer_t* tx, void* reserved)
 {
     bool status = false;
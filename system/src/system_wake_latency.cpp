@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "logging.h"
+LOG_SOURCE_CATEGORY("system.sleep");
+
+#include "system_wake_latency.h"
+
+#include "spark_wiring_diagnostics.h"
+#include "timer_hal.h"
+
+namespace particle { namespace system {
+
+namespace {
+
+HistogramDiagnosticData<> g_wakeNetworkOnTime(DIAG_ID_SYSTEM_WAKE_NETWORK_ON_TIME, DIAG_NAME_SYSTEM_WAKE_NETWORK_ON_TIME);
+HistogramDiagnosticData<> g_wakeNetworkConnectedTime(DIAG_ID_SYSTEM_WAKE_NETWORK_CONNECTED_TIME, DIAG_NAME_SYSTEM_WAKE_NETWORK_CONNECTED_TIME);
+HistogramDiagnosticData<> g_wakeCloudConnectedTime(DIAG_ID_SYSTEM_WAKE_CLOUD_CONNECTED_TIME, DIAG_NAME_SYSTEM_WAKE_CLOUD_CONNECTED_TIME);
+HistogramDiagnosticData<> g_wakePublishTime(DIAG_ID_SYSTEM_WAKE_PUBLISH_TIME, DIAG_NAME_SYSTEM_WAKE_PUBLISH_TIME);
+
+HistogramDiagnosticData<>* const g_stageDiag[WakeLatency::STAGE_COUNT] = {
+    &g_wakeNetworkOnTime,
+    &g_wakeNetworkConnectedTime,
+    &g_wakeCloudConnectedTime,
+    &g_wakePublishTime
+};
+
+const char* const g_stageNames[WakeLatency::STAGE_COUNT] = {
+    "network on",
+    "network connected",
+    "cloud connected",
+    "publish"
+};
+
+} // namespace
+
+WakeLatency::WakeLatency() :
+        pending_(0),
+        wakeTime_(0) {
+}
+
+void WakeLatency::wokeUp(system_tick_t time, unsigned stages) {
+    wakeTime_ = time;
+    pending_.store(stages, std::memory_order_release);
+}
+
+void WakeLatency::stageReached(Stage stage) {
+    const unsigned mask = stageMask(stage);
+    if (!(pending_.fetch_and(~mask, std::memory_order_acq_rel) & mask)) {
+        return;
+    }
+    const system_tick_t t = HAL_Timer_Get_Milli_Seconds() - wakeTime_;
+    g_stageDiag[stage]->record(t);
+    LOG(TRACE, "Wake-up to %s: %u ms", g_stageNames[stage], (unsigned)t);
+}
+
+WakeLatency* WakeLatency::instance() {
+    static WakeLatency w;
+    return &w;
+}
+
+} } // namespace particle::system
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "system_tick_hal.h"
+
+#include <atomic>
+#include <cstdint>
+
+namespace particle { namespace system {
+
+/**
+ * Measures how long it takes for the device to get back online after waking up from sleep.
+ *
+ * The time elapsed since the wake-up is recorded for each stage of the reconnection as a
+ * histogram diagnostic source. Only the stages that the sleep code has started when resuming
+ * are measured, and each of them is only measured once per wake-up.
+ */
+class WakeLatency {
+public:
+    enum Stage {
+        NETWORK_ON = 0, ///< A network interface has been powered on.
+        NETWORK_CONNECTED = 1, ///< The network connection has been established.
+        CLOUD_CONNECTED = 2, ///< The cloud connection has been established.
+        PUBLISH = 3, ///< The first event has been sent to the cloud.
+        STAGE_COUNT = 4
+    };
+
+    /**
+     * Start measuring the latency of the given stages.
+     *
+     * @param time Time of the wake-up.
+     * @param stages Mask of the stages to measure.
+     */
+    void wokeUp(system_tick_t time, unsigned stages);
+
+    /**
+     * Record the latency of a stage if it's being measured.
+     */
+    void stageReached(Stage stage);
+
+    /**
+     * Stop measuring, e.g. because the device is going to sleep.
+     */
+    void cancel() {
+        pending_.store(0, std::memory_order_relaxed);
+    }
+
+    static unsigned stageMask(Stage stage) {
+        return 1u << stage;
+    }
+
+    static WakeLatency* instance();
+
+private:
+    std::atomic<unsigned> pending_;
+    system_tick_t wakeTime_;
+
+    WakeLatency();
+};
+
+} } // namespace particle::system
@@ -206,8 +206,11 @@ particle::UsbControlRequestChannel::UsbControlRequestChannel(ControlRequestHandl
         ControlRequestChannel(handler),
         activeReqs_(nullptr),
         curReq_(nullptr),
+        cachedReqData_(nullptr),
+        cachedReqDataSize_(0),
         activeReqCount_(0),
-        lastReqId_(USB_REQUEST_INVALID_ID) {
+        lastReqId_(USB_REQUEST_INVALID_ID),
+        cachedReqDataUsed_(false) {
     // Set HAL callbacks
     ATOMIC_BLOCK() {
         HAL_USB_Set_Vendor_Request_Callback(halVendorRequestCallback, this);
@@ -220,6 +223,7 @@ particle::UsbControlRequestChannel::~UsbControlRequestChannel() {
         HAL_USB_Set_Vendor_Request_Callback(nullptr, nullptr);
         HAL_USB_Set_Vendor_Request_State_Callback(nullptr, nullptr);
     }
+    t_free(cachedReqData_);
 }
 
 int particle::UsbControlRequestChannel::allocReplyData(ctrl_request* ctrlReq, size_t size) {
@@ -246,18 +250,32 @@ void particle::UsbControlRequestChannel::freeRequestData(ctrl_request* ctrlReq)
         req->flags &= ~RequestFlag::POOLED_REQ_DATA;
     } else {
         // Free a dynamically allocated buffer
-        t_free(req->request_data);
+        freeRequestBuffer(req->request_data, &req->flags);
     }
     req->request_data = nullptr;
     req->request_size = 0;
 }
 
+void particle::UsbControlRequestChannel::freeCachedRequestData() {
+    if (!cachedReqDataUsed_) {
+        t_free(cachedReqData_);
+        cachedReqData_ = nullptr;
+        cachedReqDataSize_ = 0;
+    }
+}
+
 void particle::UsbControlRequestChannel::setResult(ctrl_request* ctrlReq, int result, ctrl_completion_handler_fn handler,
         void* data) {
     auto req = static_cast<Request*>(ctrlReq);
     if (req->request_data) {
         freeRequestData(req);
     }
+    // The cached buffer is only needed while a firmware update is in progress. If the host goes
+    // away in the middle of an update, the device is reset by the update timeout
+    if (req->type == CTRL_REQUEST_FINISH_FIRMWARE_UPDATE || req->type == CTRL_REQUEST_CANCEL_FIRMWARE_UPDATE ||
+            (req->type == CTRL_REQUEST_FIRMWARE_UPDATE_DATA && result < 0)) {
+        freeCachedRequestData();
+    }
     req->handler = handler;
     req->handlerData = data;
     ATOMIC_BLOCK() {
@@ -582,6 +600,40 @@ void particle::UsbControlRequestChannel::finishActiveRequest(Request* req) {
     }
 }
 
+char* particle::UsbControlRequestChannel::allocRequestBuffer(size_t size, uint16_t type, uint8_t* flags) {
+    // Firmware update chunks come one after another. Keep the buffer of the last chunk so that it
+    // can be reused instead of allocating a new buffer on the heap for each chunk
+    if (type == CTRL_REQUEST_FIRMWARE_UPDATE_DATA && size <= USB_REQUEST_MAX_CACHED_BUFFER_SIZE && !cachedReqDataUsed_) {
+        if (cachedReqDataSize_ < size) {
+            freeCachedRequestData();
+            cachedReqData_ = (char*)t_malloc(size);
+            if (!cachedReqData_) {
+                return nullptr;
+            }
+            cachedReqDataSize_ = size;
+        }
+        cachedReqDataUsed_ = true;
+        *flags |= RequestFlag::CACHED_REQ_DATA;
+        return cachedReqData_;
+    }
+    auto data = (char*)t_malloc(size);
+    if (!data && cachedReqData_ && !cachedReqDataUsed_) {
+        // Release the cached buffer and try again
+        freeCachedRequestData();
+        data = (char*)t_malloc(size);
+    }
+    return data;
+}
+
+void particle::UsbControlRequestChannel::freeRequestBuffer(char* data, uint8_t* flags) {
+    if (*flags & RequestFlag::CACHED_REQ_DATA) {
+        cachedReqDataUsed_ = false;
+        *flags &= ~RequestFlag::CACHED_REQ_DATA;
+    } else {
+        t_free(data);
+    }
+}
+
 void particle::UsbControlRequestChannel::finishRequest(Request* req) {
     if (req->request_data) {
         freeRequestData(req);
@@ -607,7 +659,8 @@ void particle::UsbControlRequestChannel::invokeRequestHandler(ISRTaskQueue::Task
 void particle::UsbControlRequestChannel::allocRequestData(ISRTaskQueue::Task* isrTask) {
     const auto task = static_cast<RequestTask*>(isrTask);
     auto req = task->req;
-    req->request_data = (char*)t_malloc(req->request_size); // FIXME: volatile?
+    const auto channel = static_cast<UsbControlRequestChannel*>(req->channel);
+    req->request_data = channel->allocRequestBuffer(req->request_size, req->type, &req->flags); // FIXME: volatile?
     ATOMIC_BLOCK() {
         if (req->state == RequestState::ALLOC_PENDING) {
             if (req->request_data) {
@@ -619,7 +672,7 @@ void particle::UsbControlRequestChannel::allocRequestData(ISRTaskQueue::Task* is
         }
     }
     if (req) { // Request has been cancelled
-        t_free(req->request_data);
+        channel->freeRequestBuffer(req->request_data, &req->flags);
         systemPoolDelete(req);
     }
 }
@@ -36,6 +36,10 @@ const size_t USB_REQUEST_MAX_PAYLOAD_SIZE = 65535;
 // Maximum size of a request buffer that can be allocated from the memory pool
 const size_t USB_REQUEST_MAX_POOLED_BUFFER_SIZE = 64;
 
+// Maximum size of a heap-allocated firmware update request buffer that can be kept for reuse by
+// subsequent requests
+const size_t USB_REQUEST_MAX_CACHED_BUFFER_SIZE = 16 * 1024 + 256;
+
 // Invalid request ID
 const uint16_t USB_REQUEST_INVALID_ID = 0;
 
@@ -62,7 +66,8 @@ private:
 
     // Request flags
     enum RequestFlag {
-        POOLED_REQ_DATA = 0x01 // Request buffer is allocated from the pool
+        POOLED_REQ_DATA = 0x01, // Request buffer is allocated from the pool
+        CACHED_REQ_DATA = 0x02 // Request buffer is the cached buffer
     };
 
     struct Request;
@@ -88,8 +93,11 @@ private:
 
     Request* activeReqs_; // List of active requests
     Request* curReq_; // A request currently being processed by the USB subsystem
+    char* cachedReqData_; // Request buffer kept for reuse
+    size_t cachedReqDataSize_; // Size of the cached request buffer
     uint16_t activeReqCount_; // Number of active requests
     uint16_t lastReqId_; // Last request ID
+    bool cachedReqDataUsed_; // Whether the cached request buffer is in use
 
     bool processServiceRequest(HAL_USB_SetupRequest* halReq);
     bool processInitRequest(HAL_USB_SetupRequest* halReq);
@@ -102,6 +110,10 @@ private:
     void finishActiveRequest(Request* req);
     void finishRequest(Request* req);
 
+    char* allocRequestBuffer(size_t size, uint16_t type, uint8_t* flags);
+    void freeRequestBuffer(char* data, uint8_t* flags);
+    void freeCachedRequestData();
+
     static void invokeRequestHandler(ISRTaskQueue::Task* isrTask);
     static void allocRequestData(ISRTaskQueue::Task* isrTask);
     static void finishRequest(ISRTaskQueue::Task* isrTask);
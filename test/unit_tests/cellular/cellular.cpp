@@ -24,6 +24,7 @@
 #include "appender.h"
 #include "ncp/cellular/network_config_db.h"
 #include "ncp/cellular/cellular_network_manager.h"
+#include "ncp/cellular/modem_config_cache.h"
 
 #undef WARN
 #undef INFO
@@ -146,4 +147,24 @@ TEST_CASE("cellular_printable") {
         // printf("%s", output);
         REQUIRE(strncmp(output, "700,800,900,2100,2600", sizeof(output)) == 0);
     }
-}
\ No newline at end of file
+}
+
+TEST_CASE("ModemConfigFingerprint") {
+    SECTION("same settings produce the same fingerprint") {
+        const auto fp1 = ModemConfigFingerprint().add(1).add("IP").add("spark.telefonica.com").value();
+        const auto fp2 = ModemConfigFingerprint().add(1).add("IP").add("spark.telefonica.com").value();
+        REQUIRE(fp1 == fp2);
+    }
+
+    SECTION("any change of the settings changes the fingerprint") {
+        const auto fp = ModemConfigFingerprint().add(1).add("IP").add("spark.telefonica.com").value();
+        REQUIRE(ModemConfigFingerprint().add(2).add("IP").add("spark.telefonica.com").value() != fp);
+        REQUIRE(ModemConfigFingerprint().add(1).add("IPV6").add("spark.telefonica.com").value() != fp);
+        REQUIRE(ModemConfigFingerprint().add(1).add("IP").add("").value() != fp);
+    }
+
+    SECTION("string boundaries are part of the fingerprint") {
+        REQUIRE(ModemConfigFingerprint().add("ab").add("c").value() != ModemConfigFingerprint().add("a").add("bc").value());
+        REQUIRE(ModemConfigFingerprint().add("").value() != ModemConfigFingerprint().value());
+    }
+}
@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ncp/cellular/modem_config_cache.h"
+#include "system_cache.h"
+#include "system_error.h"
+
+#include "catch2/catch.hpp"
+
+using namespace particle;
+using namespace particle::services;
+
+namespace {
+
+const int NCP_ID = 0x1a;
+const int OTHER_NCP_ID = 0x1b;
+
+bool hasStoredFingerprints() {
+    char buf[32] = {};
+    return SystemCache::instance().get(SystemCacheKey::CELLULAR_NCP_CONFIG_FINGERPRINT, buf, sizeof(buf)) > 0;
+}
+
+} // namespace
+
+TEST_CASE("ModemConfigCache") {
+    const auto cache = ModemConfigCache::instance();
+    cache->invalidate();
+
+    SECTION("no settings are applied initially") {
+        CHECK(!cache->isApplied(NCP_ID, ModemConfigGroup::RADIO, 0x1234));
+        CHECK(!cache->isApplied(NCP_ID, ModemConfigGroup::PDP_CONTEXT, 0x1234));
+        CHECK(!cache->wasRegistered(NCP_ID));
+    }
+
+    SECTION("remembers the applied settings per group") {
+        cache->setApplied(NCP_ID, ModemConfigGroup::RADIO, 0x1234);
+        CHECK(cache->isApplied(NCP_ID, ModemConfigGroup::RADIO, 0x1234));
+        CHECK(!cache->isApplied(NCP_ID, ModemConfigGroup::RADIO, 0x1235));
+        CHECK(!cache->isApplied(NCP_ID, ModemConfigGroup::PDP_CONTEXT, 0x1234));
+        cache->setApplied(NCP_ID, ModemConfigGroup::PDP_CONTEXT, 0x5678);
+        CHECK(cache->isApplied(NCP_ID, ModemConfigGroup::RADIO, 0x1234));
+        CHECK(cache->isApplied(NCP_ID, ModemConfigGroup::PDP_CONTEXT, 0x5678));
+        CHECK(hasStoredFingerprints());
+    }
+
+    SECTION("forgets the applied settings when the modem changes") {
+        cache->setApplied(NCP_ID, ModemConfigGroup::RADIO, 0x1234);
+        cache->setApplied(NCP_ID, ModemConfigGroup::PDP_CONTEXT, 0x5678);
+        CHECK(!cache->isApplied(OTHER_NCP_ID, ModemConfigGroup::RADIO, 0x1234));
+        cache->setApplied(OTHER_NCP_ID, ModemConfigGroup::RADIO, 0x1234);
+        CHECK(cache->isApplied(OTHER_NCP_ID, ModemConfigGroup::RADIO, 0x1234));
+        CHECK(!cache->isApplied(OTHER_NCP_ID, ModemConfigGroup::PDP_CONTEXT, 0x5678));
+        CHECK(!cache->isApplied(NCP_ID, ModemConfigGroup::RADIO, 0x1234));
+    }
+
+    SECTION("remembers the registration state") {
+        cache->setRegistered(NCP_ID, true);
+        CHECK(cache->wasRegistered(NCP_ID));
+        CHECK(!cache->wasRegistered(OTHER_NCP_ID));
+        cache->setRegistered(NCP_ID, false);
+        CHECK(!cache->wasRegistered(NCP_ID));
+    }
+
+    SECTION("modemReset() forgets the registration state but not the applied settings") {
+        cache->setApplied(NCP_ID, ModemConfigGroup::RADIO, 0x1234);
+        cache->setRegistered(NCP_ID, true);
+        cache->modemReset();
+        CHECK(!cache->wasRegistered(NCP_ID));
+        CHECK(cache->isApplied(NCP_ID, ModemConfigGroup::RADIO, 0x1234));
+        CHECK(hasStoredFingerprints());
+    }
+
+    SECTION("invalidate() forgets everything") {
+        cache->setApplied(NCP_ID, ModemConfigGroup::RADIO, 0x1234);
+        cache->setRegistered(NCP_ID, true);
+        cache->invalidate();
+        CHECK(!cache->wasRegistered(NCP_ID));
+        CHECK(!cache->isApplied(NCP_ID, ModemConfigGroup::RADIO, 0x1234));
+        CHECK(!hasStoredFingerprints());
+    }
+}
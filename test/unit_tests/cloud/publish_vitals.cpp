@@ -16,6 +16,9 @@
  */
 
 #include <limits>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "active_object.h"
 #include "protocol_selector.h"
@@ -382,3 +385,248 @@ TEST_CASE("Publishing vitals", "[VitalsPublisher::publish]")
         }
     }
 }
+
+namespace
+{
+
+size_t varintSize(uint64_t val)
+{
+    size_t n = 1;
+    while (val >= 0x80)
+    {
+        val >>= 7;
+        ++n;
+    }
+    return n;
+}
+
+// Size of a data source encoded with the compact diagnostics encoding
+size_t encodedSourceSize(int64_t val)
+{
+    const uint64_t zigzag = ((uint64_t)val << 1) ^ (uint64_t)(val >> 63);
+    return 2 /* ID */ + 1 /* Type */ + varintSize(zigzag);
+}
+
+} // namespace
+
+TEST_CASE("Delta encoding of vitals", "[VitalsDeltaEncoder]")
+{
+    using particle::system::VitalsDeltaEncoder;
+
+    SECTION("Selecting the data sources")
+    {
+        GIVEN("A VitalsDeltaEncoder")
+        {
+            VitalsDeltaEncoder enc;
+            REQUIRE(enc.threshold(2, 100) == SYSTEM_ERROR_NONE);
+
+            THEN("The first snapshot is a keyframe containing all sources")
+            {
+                CHECK(enc.beginSnapshot());
+                CHECK(enc.isKeyframe());
+                CHECK(enc.update(1, 10));
+                CHECK(enc.update(2, 1000));
+            }
+
+            WHEN("A keyframe is acknowledged")
+            {
+                enc.beginSnapshot();
+                enc.update(1, 10);
+                enc.update(2, 1000);
+                enc.updateDigest(3, 0x1234);
+                enc.acknowledge();
+
+                THEN("The next snapshot is a delta frame")
+                {
+                    CHECK_FALSE(enc.beginSnapshot());
+                    CHECK_FALSE(enc.isKeyframe());
+                }
+
+                THEN("Unchanged sources are not included")
+                {
+                    enc.beginSnapshot();
+                    CHECK_FALSE(enc.update(1, 10));
+                    CHECK_FALSE(enc.updateDigest(3, 0x1234));
+                }
+
+                THEN("Any change of a source without a threshold is included")
+                {
+                    enc.beginSnapshot();
+                    CHECK(enc.update(1, 11));
+                    CHECK(enc.updateDigest(3, 0x4321));
+                }
+
+                THEN("Changes within the threshold are not included")
+                {
+                    enc.beginSnapshot();
+                    CHECK_FALSE(enc.update(2, 1100));
+                    CHECK_FALSE(enc.update(2, 900));
+                    CHECK(enc.update(2, 1101));
+                    CHECK(enc.update(2, 899));
+                }
+
+                THEN("Changes are compared with the last acknowledged value")
+                {
+                    enc.beginSnapshot();
+                    CHECK(enc.update(2, 1101));
+                    enc.acknowledge();
+                    enc.beginSnapshot();
+                    CHECK_FALSE(enc.update(2, 1150));
+                    CHECK(enc.update(2, 1000));
+                }
+
+                THEN("A snapshot started while another one is outstanding is a keyframe")
+                {
+                    CHECK_FALSE(enc.beginSnapshot());
+                    CHECK(enc.update(1, 20));
+                    CHECK(enc.beginSnapshot());
+                    CHECK(enc.update(1, 20));
+                    CHECK(enc.update(2, 1000));
+                }
+
+                THEN("Acknowledgements are applied once all outstanding snapshots are acknowledged")
+                {
+                    enc.beginSnapshot();
+                    CHECK(enc.update(1, 20));
+                    enc.beginSnapshot();
+                    CHECK(enc.update(1, 30));
+                    enc.acknowledge(); // Acknowledges the first snapshot
+                    CHECK(enc.beginSnapshot());
+                    CHECK(enc.update(1, 30));
+                    enc.acknowledge(); // Acknowledges the second snapshot
+                    enc.acknowledge(); // Acknowledges the third snapshot
+                    CHECK_FALSE(enc.beginSnapshot());
+                    CHECK_FALSE(enc.update(1, 30));
+                }
+
+                THEN("reset() discards the outstanding snapshots")
+                {
+                    enc.beginSnapshot();
+                    enc.update(1, 20);
+                    enc.reset();
+                    CHECK(enc.beginSnapshot());
+                    enc.update(1, 20);
+                    enc.acknowledge();
+                    CHECK_FALSE(enc.beginSnapshot());
+                    CHECK_FALSE(enc.update(1, 20));
+                }
+
+                THEN("Sources with the KEYFRAME_ONLY threshold are only included in keyframes")
+                {
+                    REQUIRE(enc.threshold(1, VitalsDeltaEncoder::KEYFRAME_ONLY) == SYSTEM_ERROR_NONE);
+                    enc.beginSnapshot();
+                    CHECK_FALSE(enc.update(1, 1000000));
+                }
+
+                THEN("A source that appears for the first time is included")
+                {
+                    enc.beginSnapshot();
+                    CHECK(enc.update(4, 0));
+                }
+
+                THEN("A keyframe is produced after reset()")
+                {
+                    enc.reset();
+                    CHECK(enc.beginSnapshot());
+                    CHECK(enc.update(1, 10));
+                }
+            }
+
+            WHEN("A keyframe is not acknowledged")
+            {
+                enc.beginSnapshot();
+                enc.update(1, 10);
+
+                THEN("The next snapshot is a keyframe again")
+                {
+                    CHECK(enc.beginSnapshot());
+                }
+            }
+        }
+    }
+
+    SECTION("Keyframe interval")
+    {
+        GIVEN("A VitalsDeltaEncoder with a keyframe interval of 4")
+        {
+            VitalsDeltaEncoder enc;
+            enc.keyframeInterval(4);
+            CHECK(enc.keyframeInterval() == 4);
+
+            THEN("Every 4th snapshot is a keyframe")
+            {
+                std::string frames;
+                for (int i = 0; i < 9; ++i)
+                {
+                    frames += enc.beginSnapshot() ? 'K' : 'D';
+                    enc.update(1, 10);
+                    enc.acknowledge();
+                }
+                CHECK(frames == "KDDDKDDDK");
+            }
+        }
+    }
+
+    SECTION("Byte savings")
+    {
+        GIVEN("Typical vitals of a cellular device published 48 times")
+        {
+            VitalsDeltaEncoder enc;
+            enc.threshold(2, 1024); // Free memory
+            enc.threshold(6, VitalsDeltaEncoder::KEYFRAME_ONLY); // Uptime
+            enc.threshold(3, 256); // Battery charge
+            enc.threshold(33, 5 * 256); // Signal strength
+            enc.threshold(37, 3 * 256); // Signal strength value
+            enc.threshold(26, 1024); // Used RAM
+
+            size_t fullSize = 0;
+            size_t deltaSize = 0;
+            for (int i = 0; i < 48; ++i)
+            {
+                std::vector<std::pair<uint16_t, int64_t>> sources = {
+                    { 1, 140 }, // Reset reason
+                    { 2, 60000 + (i * 37) % 600 - 300 }, // Free memory
+                    { 3, 25600 - i * 40 }, // Battery charge
+                    { 6, 600 * i }, // Uptime
+                    { 7, 2 }, // Battery state
+                    { 8, 4 }, // Network status
+                    { 12, i / 20 }, // Network disconnects
+                    { 17, 4 }, // Network flags
+                    { 18, 310 }, // Country code
+                    { 10, 2 }, // Cloud status
+                    { 14, i / 20 }, // Cloud disconnects
+                    { 21, i / 10 }, // Retransmitted messages
+                    { 23, 3 * i }, // Transmitted messages
+                    { 25, 180000 }, // Total RAM
+                    { 26, 120000 + (i * 53) % 700 - 350 }, // Used RAM
+                    { 33, 15000 + (i * 71) % 800 - 400 }, // Signal strength
+                    { 37, -24000 + (i * 29) % 500 - 250 }, // Signal strength value
+                    { 36, 7 }, // Access technology
+                    { 40, 310 }, // MCC
+                    { 41, 410 }, // MNC
+                    { 42, 12345 }, // LAC
+                    { 43, 1234567 } // Cell ID
+                };
+                fullSize += 4; // Header
+                deltaSize += 5; // Header and frame type
+                enc.beginSnapshot();
+                for (const auto& src: sources)
+                {
+                    const size_t size = encodedSourceSize(src.second);
+                    fullSize += size;
+                    if (enc.update(src.first, src.second))
+                    {
+                        deltaSize += size;
+                    }
+                }
+                enc.acknowledge();
+            }
+
+            THEN("The delta encoding uses less than a third of the bytes")
+            {
+                INFO("Full: " << fullSize << " bytes, delta: " << deltaSize << " bytes");
+                CHECK(deltaSize * 3 < fullSize);
+            }
+        }
+    }
+}
@@ -21,6 +21,10 @@
 
 #include <catch2/catch.hpp>
 #include "fakeit.hpp"
+
+#include <algorithm>
+#include <limits>
+
 using namespace fakeit;
 
 using namespace particle;
@@ -239,3 +243,120 @@ SCENARIO("Events are non-confirmable over an unreliable channel with the NO_ACK
 {
 	verify_event_type_with_flags(EventType::NO_ACK, CoAPType::NON);
 }
+
+SCENARIO("event loop processes all pending messages in one iteration")
+{
+	ProtocolBuilder builder;
+	builder.callbacks.millis = &fake_millis;
+	Mock<MessageChannel> channel;
+	AbstractProtocol p(channel.get());
+	builder.build(p);
+
+	uint8_t event_buf[50];
+	const size_t msglen = Messages::event(event_buf, 0x1234, "e", "", 0, 60, EventType::PUBLIC, false);
+
+	size_t pending = 0;
+	auto receive_event = [&](Message& msg) {
+		if (pending > 0) {
+			--pending;
+			msg.set_buffer(event_buf, sizeof(event_buf));
+			msg.set_length(msglen);
+			msg.decode_id();
+		}
+		return NO_ERROR;
+	};
+	When(Method(channel,receive)).AlwaysDo(receive_event);
+
+	GIVEN("a few pending messages")
+	{
+		pending = 3;
+		REQUIRE(p.event_loop());
+		THEN("all of them are processed")
+		{
+			REQUIRE(pending == 0);
+			Verify(Method(channel,receive)).Exactly(4);
+		}
+	}
+
+	GIVEN("more pending messages than can be processed in one iteration")
+	{
+		pending = MAX_EVENT_LOOP_MESSAGES + 1;
+		REQUIRE(p.event_loop());
+		THEN("the number of processed messages is limited")
+		{
+			REQUIRE(pending == 1);
+			Verify(Method(channel,receive)).Exactly(MAX_EVENT_LOOP_MESSAGES);
+		}
+	}
+
+	GIVEN("a caller that needs to know the type of the processed message")
+	{
+		pending = 2;
+		CoAPMessageType::Enum type = CoAPMessageType::NONE;
+		REQUIRE(p.event_loop(type) == NO_ERROR);
+		THEN("only one message is processed")
+		{
+			REQUIRE(type == CoAPMessageType::EVENT);
+			REQUIRE(pending == 1);
+			Verify(Method(channel,receive)).Exactly(1);
+		}
+	}
+}
+
+namespace {
+
+system_tick_t g_millis = 0;
+unsigned g_wait_count = 0;
+unsigned g_max_wait = 0;
+
+uint32_t advancing_millis()
+{
+	return g_millis += 10;
+}
+
+int wait_receive(unsigned timeout, void* handle)
+{
+	++g_wait_count;
+	g_max_wait = std::max(g_max_wait, timeout);
+	g_millis += timeout;
+	return 0;
+}
+
+} // namespace
+
+SCENARIO("event loop waits for incoming data instead of polling the channel")
+{
+	ProtocolBuilder builder;
+	builder.callbacks.millis = &advancing_millis;
+	builder.callbacks.wait_receive = &wait_receive;
+	Mock<MessageChannel> channel;
+	AbstractProtocol p(channel.get());
+	builder.build(p);
+	When(Method(channel,receive)).AlwaysReturn(NO_ERROR);
+
+	g_millis = 0;
+	g_wait_count = 0;
+	g_max_wait = 0;
+
+	GIVEN("a channel without pending retransmissions")
+	{
+		When(Method(channel,max_receive_wait)).AlwaysReturn(std::numeric_limits<system_tick_t>::max());
+		REQUIRE(p.event_loop(CoAPMessageType::HELLO, 1000) == MESSAGE_TIMEOUT);
+		THEN("the wait is bounded by the timeout")
+		{
+			REQUIRE(g_wait_count == 1);
+			REQUIRE(g_max_wait <= 1000);
+		}
+	}
+
+	GIVEN("a channel that needs to retransmit a message soon")
+	{
+		When(Method(channel,max_receive_wait)).AlwaysReturn(100);
+		REQUIRE(p.event_loop(CoAPMessageType::HELLO, 1000) == MESSAGE_TIMEOUT);
+		THEN("the wait is bounded by the retransmission timeout")
+		{
+			REQUIRE(g_wait_count > 1);
+			REQUIRE(g_max_wait == 100);
+		}
+	}
+}
@@ -0,0 +1,374 @@
+#include "lz_decompress.h"
+#include "inflate.h"
+#include "system_error.h"
+
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/filtering_streambuf.hpp>
+#include <boost/iostreams/copy.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+namespace {
+
+const unsigned HASH_BITS = 16;
+
+class LzDecompress {
+public:
+    typedef std::function<int(const char*, size_t)> OutputFn;
+
+    explicit LzDecompress(unsigned windowBits = 0) :
+            ctx_(nullptr) {
+        lz_decompress_opts opts = {};
+        opts.window_bits = windowBits;
+        const int r = lz_decompress_create(&ctx_, &opts, outputCallback, this);
+        REQUIRE(r == 0);
+    }
+
+    ~LzDecompress() {
+        lz_decompress_destroy(ctx_);
+    }
+
+    int input(const char* data, size_t* size, bool hasMoreInput = false) {
+        return lz_decompress_input(ctx_, data, size, hasMoreInput ? LZ_DECOMPRESS_HAS_MORE_INPUT : 0);
+    }
+
+    int input(const std::string& data, bool hasMoreInput = false) {
+        size_t size = data.size();
+        return input(data.data(), &size, hasMoreInput);
+    }
+
+    void reset() {
+        lz_decompress_reset(ctx_);
+        output_ = std::string();
+    }
+
+    void outputFn(OutputFn fn) {
+        outputFn_ = std::move(fn);
+    }
+
+    const std::string& output() const {
+        return output_;
+    }
+
+private:
+    OutputFn outputFn_;
+    std::string output_;
+    lz_decompress_ctx* ctx_;
+
+    static int outputCallback(const char* data, size_t size, void* userData) {
+        auto self = (LzDecompress*)userData;
+        if (self->outputFn_) {
+            const int r = self->outputFn_(data, size);
+            if (r > 0) {
+                self->output_.append(data, r);
+            }
+            return r;
+        }
+        self->output_.append(data, size);
+        return size;
+    }
+};
+
+// Simplified version of the encoder in build/compress_module.py
+class LzEncoder {
+public:
+    LzEncoder& literals(const std::string& data) {
+        literals_ += data;
+        return *this;
+    }
+
+    LzEncoder& match(size_t offset, size_t length) {
+        REQUIRE(offset > 0);
+        REQUIRE(length >= LZ_MIN_MATCH);
+        putBlock(offset, length);
+        return *this;
+    }
+
+    std::string end() {
+        putBlock(0, 0);
+        return std::move(out_);
+    }
+
+private:
+    std::string out_;
+    std::string literals_;
+
+    void putBlock(size_t offset, size_t matchLen) {
+        const size_t litCount = literals_.size();
+        const size_t m = matchLen ? matchLen - LZ_MIN_MATCH : 0;
+        out_ += (char)((std::min<size_t>(litCount, 15) << 4) | std::min<size_t>(m, 15));
+        if (litCount >= 15) {
+            putLength(litCount - 15);
+        }
+        out_ += literals_;
+        literals_.clear();
+        out_ += (char)(offset & 0xff);
+        out_ += (char)((offset >> 8) & 0xff);
+        if (matchLen && m >= 15) {
+            putLength(m - 15);
+        }
+    }
+
+    void putLength(size_t n) {
+        for (; n >= 255; n -= 255) {
+            out_ += (char)255;
+        }
+        out_ += (char)n;
+    }
+};
+
+uint32_t hash4(const std::string& data, size_t pos) {
+    uint32_t v = 0;
+    std::memcpy(&v, data.data() + pos, 4);
+    return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+std::string compress(const std::string& data, unsigned windowBits = LZ_DEFAULT_WINDOW_BITS) {
+    const size_t maxOffset = std::min<size_t>(1 << windowBits, 0xffff);
+    std::vector<ssize_t> head(1 << HASH_BITS, -1);
+    LzEncoder enc;
+    size_t litStart = 0;
+    size_t pos = 0;
+    while (pos + LZ_MIN_MATCH <= data.size()) {
+        const auto h = hash4(data, pos);
+        const auto cand = head[h];
+        head[h] = pos;
+        size_t len = 0;
+        if (cand >= 0 && pos - cand <= maxOffset) {
+            while (pos + len < data.size() && data[cand + len] == data[pos + len]) {
+                ++len;
+            }
+        }
+        if (len >= LZ_MIN_MATCH) {
+            enc.literals(data.substr(litStart, pos - litStart)).match(pos - cand, len);
+            pos += len;
+            litStart = pos;
+        } else {
+            ++pos;
+        }
+    }
+    enc.literals(data.substr(litStart));
+    return enc.end();
+}
+
+std::string deflate(const std::string& data) {
+    using namespace boost::iostreams;
+    zlib_params params;
+    params.noheader = true; // Raw Deflate
+    filtering_istreambuf in;
+    in.push(zlib_compressor(params));
+    std::istringstream src(data);
+    in.push(src);
+    std::ostringstream dest;
+    copy(in, dest);
+    return dest.str();
+}
+
+std::string genText(size_t size, unsigned seed = 1) {
+    static const char* const words[] = { "particle", "device", "module", "flash", "system", "firmware",
+            "bootloader", "update", "cloud", "network", "0x0000", "0xffff", "\0\0\0\0", "\xff\xff\xff\xff" };
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<size_t> wordDist(0, sizeof(words) / sizeof(words[0]) - 1);
+    std::uniform_int_distribution<int> byteDist(0, 255);
+    std::string s;
+    while (s.size() < size) {
+        if (byteDist(gen) < 32) {
+            s += (char)byteDist(gen); // Occasional noise
+        } else {
+            const char* w = words[wordDist(gen)];
+            s.append(w, std::max<size_t>(std::strlen(w), 4));
+        }
+    }
+    s.resize(size);
+    return s;
+}
+
+std::string genRandom(size_t size, unsigned seed = 1) {
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> dist(0, 255);
+    std::string s(size, '\0');
+    for (auto& c: s) {
+        c = (char)dist(gen);
+    }
+    return s;
+}
+
+} // namespace
+
+TEST_CASE("lz_decompress_create()") {
+    lz_decompress_ctx* ctx = nullptr;
+    auto cb = [](const char*, size_t size, void*) {
+        return (int)size;
+    };
+    SECTION("accepts window sizes in the valid range") {
+        for (unsigned bits = LZ_MIN_WINDOW_BITS; bits <= LZ_MAX_WINDOW_BITS; ++bits) {
+            lz_decompress_opts opts = {};
+            opts.window_bits = bits;
+            REQUIRE(lz_decompress_create(&ctx, &opts, cb, nullptr) == 0);
+            lz_decompress_destroy(ctx);
+        }
+        REQUIRE(lz_decompress_create(&ctx, nullptr, cb, nullptr) == 0);
+        lz_decompress_destroy(ctx);
+    }
+    SECTION("rejects window sizes outside of the valid range") {
+        lz_decompress_opts opts = {};
+        opts.window_bits = LZ_MIN_WINDOW_BITS - 1;
+        REQUIRE(lz_decompress_create(&ctx, &opts, cb, nullptr) == SYSTEM_ERROR_INVALID_ARGUMENT);
+        opts.window_bits = LZ_MAX_WINDOW_BITS + 1;
+        REQUIRE(lz_decompress_create(&ctx, &opts, cb, nullptr) == SYSTEM_ERROR_INVALID_ARGUMENT);
+    }
+}
+
+TEST_CASE("lz_decompress_input()") {
+    SECTION("decodes an empty stream") {
+        LzDecompress lz;
+        REQUIRE(lz.input(LzEncoder().end()) == LZ_DECOMPRESS_DONE);
+        REQUIRE(lz.output().empty());
+    }
+    SECTION("decodes literals and overlapping matches") {
+        LzDecompress lz;
+        auto data = LzEncoder().literals("ab").match(2, 10).literals("xyz").match(5, 300).end();
+        REQUIRE(lz.input(data) == LZ_DECOMPRESS_DONE);
+        std::string expected = "abababababab";
+        expected += "xyz";
+        for (size_t i = 0; i < 300; ++i) {
+            expected += expected[expected.size() - 5];
+        }
+        REQUIRE(lz.output() == expected);
+    }
+    SECTION("decodes long literal runs") {
+        LzDecompress lz;
+        auto text = genRandom(1000);
+        REQUIRE(lz.input(LzEncoder().literals(text).end()) == LZ_DECOMPRESS_DONE);
+        REQUIRE(lz.output() == text);
+    }
+    SECTION("round-trips data for all window sizes") {
+        auto text = genText(100000);
+        for (unsigned bits = LZ_MIN_WINDOW_BITS; bits <= LZ_MAX_WINDOW_BITS; ++bits) {
+            auto data = compress(text, bits);
+            REQUIRE(data.size() < text.size());
+            LzDecompress lz(bits);
+            REQUIRE(lz.input(data) == LZ_DECOMPRESS_DONE);
+            REQUIRE(lz.output() == text);
+        }
+    }
+    SECTION("round-trips data provided in chunks") {
+        auto text = genText(50000, 2);
+        auto data = compress(text);
+        for (size_t chunkSize: { 1, 2, 3, 7, 64, 1000 }) {
+            LzDecompress lz;
+            int r = 0;
+            for (size_t offs = 0; offs < data.size();) {
+                size_t n = std::min(chunkSize, data.size() - offs);
+                const bool more = offs + n < data.size();
+                r = lz.input(data.data() + offs, &n, more);
+                REQUIRE(r >= 0);
+                offs += n;
+            }
+            REQUIRE(r == LZ_DECOMPRESS_DONE);
+            REQUIRE(lz.output() == text);
+        }
+    }
+    SECTION("supports partial consumption of the output") {
+        auto text = genText(20000, 3);
+        auto data = compress(text, LZ_MIN_WINDOW_BITS);
+        LzDecompress lz(LZ_MIN_WINDOW_BITS);
+        lz.outputFn([](const char*, size_t size) {
+            return (int)std::min<size_t>(size, 3);
+        });
+        size_t offs = 0;
+        int r = 0;
+        do {
+            size_t n = data.size() - offs;
+            r = lz.input(data.data() + offs, &n);
+            REQUIRE(r >= 0);
+            offs += n;
+        } while (r == LZ_DECOMPRESS_HAS_MORE_OUTPUT);
+        REQUIRE(r == LZ_DECOMPRESS_DONE);
+        REQUIRE(offs == data.size());
+        REQUIRE(lz.output() == text);
+    }
+    SECTION("propagates errors of the output callback") {
+        LzDecompress lz;
+        lz.outputFn([](const char*, size_t) {
+            return SYSTEM_ERROR_IO;
+        });
+        REQUIRE(lz.input(LzEncoder().literals("abcd").end()) == SYSTEM_ERROR_IO);
+    }
+    SECTION("fails if a match refers to data before the start of the stream") {
+        LzDecompress lz;
+        REQUIRE(lz.input(LzEncoder().literals("abc").match(4, 4).end()) == SYSTEM_ERROR_BAD_DATA);
+    }
+    SECTION("fails if a match offset exceeds the window size") {
+        auto text = genRandom(300);
+        LzDecompress lz(LZ_MIN_WINDOW_BITS);
+        REQUIRE(lz.input(LzEncoder().literals(text).match(257, 4).end()) == SYSTEM_ERROR_BAD_DATA);
+    }
+    SECTION("fails if there's data after the end of the stream") {
+        LzDecompress lz;
+        REQUIRE(lz.input(LzEncoder().literals("abcd").end() + "x") == SYSTEM_ERROR_BAD_DATA);
+    }
+    SECTION("fails if the stream is truncated") {
+        auto data = compress(genText(1000));
+        data.resize(data.size() - 1);
+        LzDecompress lz;
+        REQUIRE(lz.input(data) == SYSTEM_ERROR_BAD_DATA);
+        LzDecompress lz2;
+        REQUIRE(lz2.input(data, true /* hasMoreInput */) == LZ_DECOMPRESS_NEEDS_MORE_INPUT);
+    }
+    SECTION("can be reused after a reset") {
+        LzDecompress lz;
+        REQUIRE(lz.input(LzEncoder().literals("abcd").end()) == LZ_DECOMPRESS_DONE);
+        lz.reset();
+        REQUIRE(lz.input(LzEncoder().literals("efgh").match(4, 4).end()) == LZ_DECOMPRESS_DONE);
+        REQUIRE(lz.output() == "efghefgh");
+    }
+}
+
+TEST_CASE("lz_decompress benchmark", "[.][benchmark]") {
+    using namespace std::chrono;
+    const size_t repeatCount = 20;
+    const auto text = genText(256 * 1024, 4);
+    const auto deflated = deflate(text);
+
+    auto decodeInflate = [&]() {
+        inflate_ctx* ctx = nullptr;
+        REQUIRE(inflate_create(&ctx, nullptr, [](const char*, size_t size, void*) { return (int)size; }, nullptr) == 0);
+        size_t n = deflated.size();
+        REQUIRE(inflate_input(ctx, deflated.data(), &n, 0) == INFLATE_DONE);
+        inflate_destroy(ctx);
+    };
+    auto measure = [&](const std::function<void()>& fn) {
+        const auto t1 = steady_clock::now();
+        for (size_t i = 0; i < repeatCount; ++i) {
+            fn();
+        }
+        return duration_cast<microseconds>(steady_clock::now() - t1).count() / (double)repeatCount;
+    };
+
+    WARN("inflate: compressed " << deflated.size() << " of " << text.size() << " bytes, window 32768 bytes, "
+            << measure(decodeInflate) << " us");
+    for (unsigned bits: { 10, 12, 15 }) {
+        const auto data = compress(text, bits);
+        auto decodeLz = [&]() {
+            lz_decompress_ctx* ctx = nullptr;
+            lz_decompress_opts opts = {};
+            opts.window_bits = bits;
+            REQUIRE(lz_decompress_create(&ctx, &opts, [](const char*, size_t size, void*) { return (int)size; }, nullptr) == 0);
+            size_t n = data.size();
+            REQUIRE(lz_decompress_input(ctx, data.data(), &n, 0) == LZ_DECOMPRESS_DONE);
+            lz_decompress_destroy(ctx);
+        };
+        WARN("lz: compressed " << data.size() << " of " << text.size() << " bytes, window " << (1 << bits)
+                << " bytes, " << measure(decodeLz) << " us");
+    }
+}
@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "module_validation_cache.h"
+#include "system_cache.h"
+#include "system_error.h"
+
+#include <catch2/catch.hpp>
+
+using namespace particle;
+using namespace particle::services;
+
+namespace {
+
+int g_flashWriteGen = -1; // Negative if the generation is not available
+
+} // namespace
+
+extern "C" uint32_t module_length(const module_info_t* mi) {
+    return (uintptr_t)mi->module_end_address - (uintptr_t)mi->module_start_address;
+}
+
+int particle::getFlashWriteGeneration(uint16_t* gen) {
+    if (g_flashWriteGen < 0) {
+        return SYSTEM_ERROR_NOT_SUPPORTED;
+    }
+    *gen = g_flashWriteGen;
+    return 0;
+}
+
+namespace {
+
+hal_module_t makeModule(uint32_t address, uint32_t size, uint32_t crc = 0x12345678,
+        module_bounds_location_t location = MODULE_BOUNDS_LOC_INTERNAL_FLASH) {
+    hal_module_t m = {};
+    m.bounds.start_address = address;
+    m.bounds.end_address = address + size;
+    m.bounds.location = location;
+    m.info.module_start_address = (const void*)(uintptr_t)address;
+    m.info.module_end_address = (const void*)(uintptr_t)(address + size);
+    m.crc.crc32 = crc;
+    return m;
+}
+
+bool hasStoredEntries() {
+    char buf[256] = {};
+    return SystemCache::instance().get(SystemCacheKey::MODULE_VALIDATION, buf, sizeof(buf)) > 0;
+}
+
+} // namespace
+
+TEST_CASE("ModuleValidationCache") {
+    g_flashWriteGen = 1;
+    const auto cache = ModuleValidationCache::instance();
+    cache->invalidate();
+
+    SECTION("reports a miss for an unknown module") {
+        CHECK(!cache->isVerified(makeModule(0x30000, 0x1000)));
+        CHECK(!hasStoredEntries());
+    }
+
+    SECTION("reports a hit for a verified module") {
+        const auto m = makeModule(0x30000, 0x1000);
+        cache->setVerified(m, true);
+        CHECK(cache->isVerified(m));
+        CHECK(cache->isVerified(m, false /* useStorage */));
+        CHECK(hasStoredEntries());
+    }
+
+    SECTION("reports a miss if the module has changed") {
+        cache->setVerified(makeModule(0x30000, 0x1000, 0x1111), true);
+        CHECK(!cache->isVerified(makeModule(0x30000, 0x1000, 0x2222)));
+        CHECK(!cache->isVerified(makeModule(0x30000, 0x2000, 0x1111)));
+        CHECK(!cache->isVerified(makeModule(0x40000, 0x1000, 0x1111)));
+        // The entry is replaced when the changed module is verified
+        cache->setVerified(makeModule(0x30000, 0x1000, 0x2222), true);
+        CHECK(cache->isVerified(makeModule(0x30000, 0x1000, 0x2222)));
+        CHECK(!cache->isVerified(makeModule(0x30000, 0x1000, 0x1111)));
+    }
+
+    SECTION("forgets a module that failed verification") {
+        const auto m1 = makeModule(0x30000, 0x1000);
+        const auto m2 = makeModule(0x40000, 0x1000);
+        cache->setVerified(m1, true);
+        cache->setVerified(m2, true);
+        cache->setVerified(m1, false);
+        CHECK(!cache->isVerified(m1));
+        CHECK(cache->isVerified(m2));
+    }
+
+    SECTION("doesn't cache modules outside of the internal flash") {
+        const auto m = makeModule(0x30000, 0x1000, 0x1234, MODULE_BOUNDS_LOC_EXTERNAL_FLASH);
+        cache->setVerified(m, true);
+        CHECK(!cache->isVerified(m));
+        CHECK(!hasStoredEntries());
+    }
+
+    SECTION("reports a miss after the bootloader has written to the flash") {
+        const auto m = makeModule(0x30000, 0x1000);
+        cache->setVerified(m, true);
+        g_flashWriteGen = 2;
+        CHECK(!cache->isVerified(m));
+        CHECK(!cache->isVerified(m, false /* useStorage */));
+        cache->setVerified(m, true);
+        CHECK(cache->isVerified(m));
+        g_flashWriteGen = 1;
+        CHECK(!cache->isVerified(m));
+    }
+
+    SECTION("doesn't cache modules if the bootloader doesn't provide the flash write generation") {
+        const auto m = makeModule(0x30000, 0x1000);
+        cache->setVerified(m, true);
+        g_flashWriteGen = -1;
+        CHECK(!cache->isVerified(m));
+        cache->setVerified(makeModule(0x40000, 0x1000), true);
+        g_flashWriteGen = 1;
+        CHECK(cache->isVerified(m));
+        CHECK(!cache->isVerified(makeModule(0x40000, 0x1000)));
+    }
+
+    SECTION("invalidate() forgets all modules") {
+        const auto m1 = makeModule(0x30000, 0x1000);
+        const auto m2 = makeModule(0x40000, 0x1000);
+        cache->setVerified(m1, true);
+        cache->setVerified(m2, true, false /* useStorage */);
+        cache->invalidate();
+        CHECK(!cache->isVerified(m1));
+        CHECK(!cache->isVerified(m2, false /* useStorage */));
+        CHECK(!hasStoredEntries());
+    }
+
+    SECTION("doesn't access the storage if useStorage is false") {
+        const auto m = makeModule(0x30000, 0x1000);
+        cache->setVerified(m, true, false /* useStorage */);
+        CHECK(cache->isVerified(m, false /* useStorage */));
+        CHECK(!hasStoredEntries());
+        // The entry is stored with the next update that uses the storage
+        cache->setVerified(makeModule(0x40000, 0x1000), true);
+        CHECK(hasStoredEntries());
+        CHECK(cache->isVerified(m));
+    }
+
+    SECTION("ignores new modules when the table is full") {
+        for (size_t i = 0; i < ModuleValidationCache::MAX_ENTRY_COUNT; ++i) {
+            cache->setVerified(makeModule(0x10000 * (i + 1), 0x1000), true);
+        }
+        const auto extra = makeModule(0x10000 * (ModuleValidationCache::MAX_ENTRY_COUNT + 1), 0x1000);
+        cache->setVerified(extra, true);
+        CHECK(!cache->isVerified(extra));
+        for (size_t i = 0; i < ModuleValidationCache::MAX_ENTRY_COUNT; ++i) {
+            CHECK(cache->isVerified(makeModule(0x10000 * (i + 1), 0x1000)));
+        }
+        // Existing entries can still be updated
+        cache->setVerified(makeModule(0x10000, 0x1000, 0x4321), true);
+        CHECK(cache->isVerified(makeModule(0x10000, 0x1000, 0x4321)));
+        // Removing an entry makes room for a new one
+        cache->setVerified(makeModule(0x20000, 0x1000), false);
+        cache->setVerified(extra, true);
+        CHECK(cache->isVerified(extra));
+    }
+}
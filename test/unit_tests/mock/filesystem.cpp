@@ -18,6 +18,7 @@
 #include "filesystem.h"
 
 #include <boost/algorithm/string/split.hpp>
+#include <boost/algorithm/string/join.hpp>
 
 #include <algorithm>
 #include <vector>
@@ -87,6 +88,24 @@ Filesystem::Filesystem(MockRepository* mocks) :
     mocks_->OnCallFunc(lfs_remove).Do([this](lfs_t* lfs, const char* path) {
         return this->remove(lfs, path);
     });
+    mocks_->OnCallFunc(lfs_rename).Do([this](lfs_t* lfs, const char* oldPath, const char* newPath) {
+        return this->rename(lfs, oldPath, newPath);
+    });
+    mocks_->OnCallFunc(lfs_stat).Do([this](lfs_t* lfs, const char* path, lfs_info* info) {
+        return this->stat(lfs, path, info);
+    });
+    mocks_->OnCallFunc(lfs_mkdir).Do([this](lfs_t* lfs, const char* path) {
+        return this->mkdir(lfs, path);
+    });
+    mocks_->OnCallFunc(lfs_dir_open).Do([this](lfs_t* lfs, lfs_dir_t* dir, const char* path) {
+        return this->openDir(lfs, dir, path);
+    });
+    mocks_->OnCallFunc(lfs_dir_close).Do([this](lfs_t* lfs, lfs_dir_t* dir) {
+        return this->closeDir(lfs, dir);
+    });
+    mocks_->OnCallFunc(lfs_dir_read).Do([this](lfs_t* lfs, lfs_dir_t* dir, lfs_info* info) {
+        return this->readDir(lfs, dir, info);
+    });
 }
 
 Filesystem::~Filesystem() noexcept(false) {
@@ -151,6 +170,7 @@ void Filesystem::remove(const std::string& path) {
 void Filesystem::clear() {
     root_.entries.clear();
     fdMap_.clear();
+    dirMap_.clear();
     lastFd_ = 0;
 }
 
@@ -204,6 +224,19 @@ Filesystem::Entry* Filesystem::createEntry(const std::string& path, EntryType ty
     return &r.first->second;
 }
 
+bool Filesystem::hasParentDir(const std::string& path) {
+    auto parts = splitPath(path);
+    if (parts.empty()) {
+        return false;
+    }
+    if (parts.size() == 1) {
+        return true;
+    }
+    parts.pop_back();
+    const auto e = findEntry(boost::algorithm::join(parts, "/"));
+    return e && e->type == EntryType::DIR;
+}
+
 void Filesystem::removeEntry(Entry* entry) {
     if (entry->type == EntryType::FILE) {
         if (!entry->fds.empty()) {
@@ -452,6 +485,159 @@ int Filesystem::remove(lfs_t* lfs, const char* path) {
     }
 }
 
+int Filesystem::rename(lfs_t* lfs, const char* oldPath, const char* newPath) {
+    try {
+        if (!lfs || lfs != &filesystem_get_instance(FILESYSTEM_INSTANCE_DEFAULT, nullptr)->instance || !oldPath || !newPath) {
+            throw std::runtime_error("lfs_rename() has been called with invalid arguments");
+        }
+        const auto e = findEntry(oldPath);
+        if (!e) {
+            return LFS_ERR_NOENT;
+        }
+        if (e->type == EntryType::DIR && !e->entries.empty()) {
+            // Not supported by this mock
+            throw std::runtime_error("lfs_rename() has been called for a non-empty directory");
+        }
+        if (!e->fds.empty()) {
+            throw std::runtime_error("Detected an attempt to rename an open file");
+        }
+        if (!hasParentDir(newPath)) {
+            return LFS_ERR_NOENT;
+        }
+        auto dest = findEntry(newPath);
+        if (dest == e) {
+            return 0;
+        }
+        if (dest) {
+            if (dest->type != e->type) {
+                return (dest->type == EntryType::DIR) ? LFS_ERR_ISDIR : LFS_ERR_NOTDIR;
+            }
+            if (dest->type == EntryType::DIR && !dest->entries.empty()) {
+                return LFS_ERR_NOTEMPTY;
+            }
+            removeEntry(dest);
+        }
+        const auto type = e->type;
+        const auto data = e->data;
+        removeEntry(e);
+        createEntry(newPath, type)->data = data;
+        return 0;
+    } catch (const FileError& e) {
+        return e.code();
+    }
+}
+
+int Filesystem::stat(lfs_t* lfs, const char* path, lfs_info* info) {
+    try {
+        if (!lfs || lfs != &filesystem_get_instance(FILESYSTEM_INSTANCE_DEFAULT, nullptr)->instance || !path || !info) {
+            throw std::runtime_error("lfs_stat() has been called with invalid arguments");
+        }
+        const auto e = findEntry(path);
+        if (!e) {
+            return LFS_ERR_NOENT;
+        }
+        *info = {};
+        info->type = (e->type == EntryType::DIR) ? LFS_TYPE_DIR : LFS_TYPE_REG;
+        info->size = e->data.size();
+        strncpy(info->name, e->name.c_str(), LFS_NAME_MAX);
+        return 0;
+    } catch (const FileError& e) {
+        return e.code();
+    }
+}
+
+int Filesystem::mkdir(lfs_t* lfs, const char* path) {
+    try {
+        if (!lfs || lfs != &filesystem_get_instance(FILESYSTEM_INSTANCE_DEFAULT, nullptr)->instance || !path) {
+            throw std::runtime_error("lfs_mkdir() has been called with invalid arguments");
+        }
+        if (findEntry(path)) {
+            return LFS_ERR_EXIST;
+        }
+        if (!hasParentDir(path)) {
+            return LFS_ERR_NOENT;
+        }
+        createEntry(path, EntryType::DIR);
+        return 0;
+    } catch (const FileError& e) {
+        return e.code();
+    }
+}
+
+int Filesystem::openDir(lfs_t* lfs, lfs_dir_t* dir, const char* path) {
+    try {
+        if (!lfs || lfs != &filesystem_get_instance(FILESYSTEM_INSTANCE_DEFAULT, nullptr)->instance || !dir || !path) {
+            throw std::runtime_error("lfs_dir_open() has been called with invalid arguments");
+        }
+        auto e = findEntry(path);
+        if (!e) {
+            if (splitPath(path).empty()) {
+                e = &root_;
+            } else {
+                return LFS_ERR_NOENT;
+            }
+        } else if (e->type != EntryType::DIR) {
+            return LFS_ERR_NOTDIR;
+        }
+        dir->fd = ++lastFd_;
+        dir->pos = 0;
+        dirMap_.insert(std::make_pair(dir->fd, e));
+        return 0;
+    } catch (const FileError& e) {
+        return e.code();
+    }
+}
+
+int Filesystem::closeDir(lfs_t* lfs, lfs_dir_t* dir) {
+    try {
+        if (!lfs || lfs != &filesystem_get_instance(FILESYSTEM_INSTANCE_DEFAULT, nullptr)->instance || !dir) {
+            throw std::runtime_error("lfs_dir_close() has been called with invalid arguments");
+        }
+        const auto it = dirMap_.find(dir->fd);
+        if (it == dirMap_.end()) {
+            throw std::runtime_error("lfs_dir_close() has been called for an already closed directory");
+        }
+        dirMap_.erase(it);
+        dir->fd = 0;
+        return 0;
+    } catch (const FileError& e) {
+        return e.code();
+    }
+}
+
+int Filesystem::readDir(lfs_t* lfs, lfs_dir_t* dir, lfs_info* info) {
+    try {
+        if (!lfs || lfs != &filesystem_get_instance(FILESYSTEM_INSTANCE_DEFAULT, nullptr)->instance || !dir || !info) {
+            throw std::runtime_error("lfs_dir_read() has been called with invalid arguments");
+        }
+        const auto it = dirMap_.find(dir->fd);
+        if (it == dirMap_.end()) {
+            throw std::runtime_error("lfs_dir_read() has been called for a closed directory");
+        }
+        const auto e = it->second;
+        *info = {};
+        // Like LittleFS, report the "." and ".." entries first
+        if (dir->pos < 2) {
+            info->type = LFS_TYPE_DIR;
+            strcpy(info->name, dir->pos ? ".." : ".");
+            ++dir->pos;
+            return 1;
+        }
+        if (dir->pos - 2 >= e->entries.size()) {
+            return 0;
+        }
+        auto entry = e->entries.begin();
+        std::advance(entry, dir->pos - 2);
+        info->type = (entry->second.type == EntryType::DIR) ? LFS_TYPE_DIR : LFS_TYPE_REG;
+        info->size = entry->second.data.size();
+        strncpy(info->name, entry->first.c_str(), LFS_NAME_MAX);
+        ++dir->pos;
+        return 1;
+    } catch (const FileError& e) {
+        return e.code();
+    }
+}
+
 } // namespace test
 
 } // namespace particle
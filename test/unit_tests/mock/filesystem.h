@@ -76,6 +76,7 @@ private:
 
     Entry root_;
     std::unordered_map<int, Entry*> fdMap_;
+    std::unordered_map<int, Entry*> dirMap_;
     MockRepository* mocks_;
     int lastFd_;
     bool checkOpenFiles_;
@@ -94,10 +95,18 @@ private:
     int truncate(lfs_t* lfs, lfs_file_t* file, lfs_off_t size);
     int sync(lfs_t* lfs, lfs_file_t* file);
     int remove(lfs_t* lfs, const char* path);
+    int rename(lfs_t* lfs, const char* oldPath, const char* newPath);
+    int stat(lfs_t* lfs, const char* path, lfs_info* info);
+    int mkdir(lfs_t* lfs, const char* path);
+    int openDir(lfs_t* lfs, lfs_dir_t* dir, const char* path);
+    int closeDir(lfs_t* lfs, lfs_dir_t* dir);
+    int readDir(lfs_t* lfs, lfs_dir_t* dir, lfs_info* info);
+
+    bool hasParentDir(const std::string& path);
 };
 
 inline bool Filesystem::hasOpenFiles() const {
-    return !fdMap_.empty();
+    return !fdMap_.empty() || !dirMap_.empty();
 }
 
 inline void Filesystem::autoCheckOpenFiles(bool enabled) {
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "at_parser.h"
+#include "at_response.h"
+#include "timer_hal.h"
+
+#include "test_stream.h"
+
+#include <catch2/catch.hpp>
+
+#include <string>
+
+using namespace particle;
+
+namespace {
+
+AtParserConfig parserConfig(test::DceStream* strm) {
+    AtParserConfig conf;
+    conf.stream(strm);
+    conf.echoEnabled(false);
+    conf.logEnabled(false);
+    return conf;
+}
+
+int appendChunk(const char* data, size_t size, void* userData) {
+    const auto chunks = (std::vector<std::string>*)userData;
+    chunks->push_back(std::string(data, size));
+    return 0;
+}
+
+struct UrcCounter {
+    std::string prefix;
+    std::string line;
+    int count = 0;
+};
+
+int urcHandler(AtResponseReader* reader, const char* prefix, void* data) {
+    const auto c = (UrcCounter*)data;
+    c->prefix = prefix;
+    c->line = (const char*)reader->readLine();
+    ++c->count;
+    return 0;
+}
+
+} // namespace
+
+TEST_CASE("AtParser") {
+    test::DceStream strm;
+
+    SECTION("buffer sizes can be configured") {
+        const std::string prefix = "+" + std::string(100, 'A');
+        AtParser parser;
+        REQUIRE(parser.init(parserConfig(&strm)) == 0);
+        CHECK(parser.addUrcHandler(prefix.c_str(), urcHandler, nullptr) == SYSTEM_ERROR_INVALID_ARGUMENT);
+        AtParser parser2;
+        REQUIRE(parser2.init(parserConfig(&strm).inputBufferSize(256)) == 0);
+        CHECK(parser2.addUrcHandler(prefix.c_str(), urcHandler, nullptr) == 0);
+        CHECK(parser2.config().inputBufferSize() == 256);
+        CHECK(parser2.config().commandBufferSize() == AtParserConfig::DEFAULT_COMMAND_BUFFER_SIZE);
+        CHECK(parser2.config().responseBufferSize() == AtParserConfig::DEFAULT_RESPONSE_BUFFER_SIZE);
+        AtParser parser3;
+        CHECK(parser3.init(parserConfig(&strm).inputBufferSize(AtParserConfig::MIN_INPUT_BUFFER_SIZE - 1)) == SYSTEM_ERROR_INVALID_ARGUMENT);
+        CHECK(parser3.init(parserConfig(&strm).inputBufferSize(AtParserConfig::MIN_INPUT_BUFFER_SIZE)) == 0);
+    }
+
+    SECTION("a line longer than the input buffer can be read in chunks") {
+        const std::string line = "+COPS: " + std::string(300, 'x');
+        strm.addResponse(line + "\r\nOK\r\n");
+        AtParser parser;
+        REQUIRE(parser.init(parserConfig(&strm).inputBufferSize(32)) == 0);
+        auto resp = parser.sendCommand("AT+COPS=?");
+        std::vector<std::string> chunks;
+        CHECK(resp.readLine(appendChunk, &chunks) == (int)line.size());
+        CHECK(chunks.size() > 1);
+        std::string s;
+        for (const auto& c: chunks) {
+            CHECK(c.size() <= 32);
+            s += c;
+        }
+        CHECK(s == line);
+        CHECK(resp.readResult() == AtResponse::OK);
+    }
+
+    SECTION("binary data following a response line can be read") {
+        std::string payload = "\r\n1234\r\nOK\r\n";
+        payload += std::string(200, '\0');
+        payload += "\n+CREG: 1\r\n";
+        strm.addResponse("+QIRD: " + std::to_string(payload.size()) + "\r\n" + payload + "\r\nOK\r\n");
+        AtParser parser;
+        REQUIRE(parser.init(parserConfig(&strm)) == 0);
+        UrcCounter c;
+        REQUIRE(parser.addUrcHandler("+CREG", urcHandler, &c) == 0);
+        auto resp = parser.sendCommand("AT+QIRD=0,1500");
+        int size = 0;
+        REQUIRE(resp.scanf("+QIRD: %d", &size) == 1);
+        REQUIRE(size == (int)payload.size());
+        std::string data(size, ' ');
+        CHECK(resp.readBinary(&data[0], data.size()) == size);
+        CHECK(data == payload);
+        CHECK(resp.readResult() == AtResponse::OK);
+        CHECK(c.count == 0);
+    }
+
+    SECTION("URCs are dispatched to the handler with the longest matching prefix") {
+        UrcCounter c1, c2, c3, c4;
+        AtParser parser;
+        REQUIRE(parser.init(parserConfig(&strm)) == 0);
+        REQUIRE(parser.addUrcHandler("+C", urcHandler, &c1) == 0);
+        REQUIRE(parser.addUrcHandler("+CEREG", urcHandler, &c2) == 0);
+        REQUIRE(parser.addUrcHandler("+CREG", urcHandler, &c3) == 0);
+        REQUIRE(parser.addUrcHandler("R", urcHandler, &c4) == 0);
+        strm.addInput("+CEREG: 5\r\n");
+        CHECK(parser.processUrc() == 1);
+        CHECK(c2.count == 1);
+        CHECK(c2.prefix == "+CEREG");
+        CHECK(c2.line == "+CEREG: 5");
+        strm.addInput("+CGREG: 1\r\n");
+        CHECK(parser.processUrc() == 1);
+        CHECK(c1.count == 1);
+        strm.addInput("RING\r\n");
+        CHECK(parser.processUrc() == 1);
+        CHECK(c4.count == 1);
+        parser.removeUrcHandler("+CEREG");
+        strm.addInput("+CEREG: 1\r\n");
+        CHECK(parser.processUrc() == 1);
+        CHECK(c2.count == 1);
+        CHECK(c1.count == 2);
+        CHECK(c3.count == 0);
+    }
+
+    SECTION("URCs received while reading a response are dispatched") {
+        UrcCounter c;
+        strm.addResponse("+CREG: 2,1\r\n+CGMR: 1.0\r\nOK\r\n");
+        AtParser parser;
+        REQUIRE(parser.init(parserConfig(&strm)) == 0);
+        REQUIRE(parser.addUrcHandler("+CREG", urcHandler, &c) == 0);
+        auto resp = parser.sendCommand("AT+CGMR");
+        CHECK((const char*)resp.readLine() == std::string("+CGMR: 1.0"));
+        CHECK(resp.readResult() == AtResponse::OK);
+        CHECK(c.count == 1);
+        CHECK(c.line == "+CREG: 2,1");
+    }
+}
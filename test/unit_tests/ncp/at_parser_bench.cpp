@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Replays modem transcripts through the AT parser and reports the parsing time and the number of
+ * stream reads for different input buffer sizes. The benchmark is not run by default:
+ *
+ *   ./ncp "[benchmark]"
+ *
+ * Transcript format:
+ *   > AT+CMD        Command line sent by the DTE
+ *   < +CMD: 1       Line sent by the DCE, terminated with CRLF
+ *   <= 0d0a3132     Raw bytes sent by the DCE in hex
+ *   # ...           Comment
+ */
+
+#include "at_parser.h"
+#include "at_response.h"
+
+#include "test_stream.h"
+
+#include "c_string.h"
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace particle;
+
+namespace {
+
+// Catch2 overrides the CHECK() macro defined in check.h
+#define CHECK_RESULT(_expr) \
+        do { \
+            const int _r = _expr; \
+            if (_r < 0) { \
+                return _r; \
+            } \
+        } while (false)
+
+const unsigned REPEAT_COUNT = 200;
+
+const size_t INPUT_BUFFER_SIZES[] = { 64, 128, 256, 512, 1024 };
+
+const char* const URC_PREFIXES[] = { "+CREG", "+CGREG", "+CEREG", "+QIURC", "+QIOPEN", "+QIND", "+QUSIM", "RDY" };
+
+struct Step {
+    std::string cmd;
+    std::string resp;
+};
+
+struct LineInfo {
+    char head[16];
+    size_t size;
+};
+
+std::vector<Step> loadTranscript(const std::string& file) {
+    std::ifstream in(file);
+    REQUIRE(in.good());
+    std::vector<Step> steps;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        if (line.compare(0, 2, "> ") == 0) {
+            steps.push_back({ line.substr(2), std::string() });
+            continue;
+        }
+        REQUIRE(!steps.empty());
+        auto& resp = steps.back().resp;
+        if (line.compare(0, 3, "<= ") == 0) {
+            for (size_t i = 3; i + 1 < line.size(); i += 2) {
+                resp += (char)std::strtoul(line.substr(i, 2).c_str(), nullptr, 16);
+            }
+        } else if (line.compare(0, 1, "<") == 0) {
+            resp += line.substr(std::min<size_t>(2, line.size())) + "\r\n";
+        } else {
+            FAIL("Invalid transcript line: " << line);
+        }
+    }
+    return steps;
+}
+
+int lineChunk(const char* data, size_t size, void* userData) {
+    const auto info = (LineInfo*)userData;
+    if (info->size < sizeof(info->head)) {
+        const size_t n = std::min(size, sizeof(info->head) - info->size);
+        std::memcpy(info->head + info->size, data, n);
+    }
+    info->size += size;
+    return 0;
+}
+
+int urcHandler(AtResponseReader* reader, const char* prefix, void* data) {
+    LineInfo info = {};
+    return reader->readLine(lineChunk, &info);
+}
+
+int replay(AtParser* parser, test::DceStream* strm, const std::vector<Step>& steps, bool zeroCopy) {
+    for (const auto& step: steps) {
+        strm->addResponse(step.resp);
+    }
+    std::vector<char> payload;
+    for (const auto& step: steps) {
+        auto resp = parser->sendCommand("%s", step.cmd.c_str());
+        while (resp.hasNextLine()) {
+            LineInfo info = {};
+            if (zeroCopy) {
+                CHECK_RESULT(resp.readLine(lineChunk, &info));
+            } else {
+                const CString s = resp.readLine();
+                CHECK_RESULT(resp.error());
+                lineChunk(s, std::strlen(s), &info);
+            }
+            // Socket read responses are followed by the payload data
+            if (info.size > 7 && std::memcmp(info.head, "+QIRD: ", 7) == 0) {
+                info.head[std::min(info.size, sizeof(info.head) - 1)] = '\0';
+                payload.resize(std::atoi(info.head + 7));
+                CHECK_RESULT(resp.readBinary(payload.data(), payload.size()));
+            }
+        }
+        if (resp.readResult() != AtResponse::OK) {
+            return SYSTEM_ERROR_UNKNOWN;
+        }
+    }
+    return 0;
+}
+
+} // namespace
+
+TEST_CASE("AtParser transcript replay", "[.][benchmark]") {
+    const auto steps = loadTranscript(FIXTURES_DIRECTORY "/at_transcript_bg96.txt");
+    size_t respBytes = 0;
+    for (const auto& step: steps) {
+        respBytes += step.resp.size();
+    }
+    printf("\n%u replays of %u commands, %u bytes of response data per replay\n", REPEAT_COUNT,
+            (unsigned)steps.size(), (unsigned)respBytes);
+    printf("%-12s%-12s%-16s%-16s\n", "buf size", "mode", "us/replay", "reads/replay");
+    for (const size_t bufSize: INPUT_BUFFER_SIZES) {
+        for (const bool zeroCopy: { false, true }) {
+            test::DceStream strm;
+            AtParser parser;
+            REQUIRE(parser.init(AtParserConfig().stream(&strm).echoEnabled(false).logEnabled(false)
+                    .inputBufferSize(bufSize)) == 0);
+            for (const auto prefix: URC_PREFIXES) {
+                REQUIRE(parser.addUrcHandler(prefix, urcHandler, nullptr) == 0);
+            }
+            strm.resetReadCount();
+            const auto t1 = std::chrono::steady_clock::now();
+            for (unsigned i = 0; i < REPEAT_COUNT; ++i) {
+                REQUIRE(replay(&parser, &strm, steps, zeroCopy) == 0);
+            }
+            const auto t2 = std::chrono::steady_clock::now();
+            const double us = std::chrono::duration<double, std::micro>(t2 - t1).count() / REPEAT_COUNT;
+            printf("%-12u%-12s%-16.1f%-16.1f\n", (unsigned)bufSize, zeroCopy ? "zero-copy" : "copy", us,
+                    (double)strm.readCount() / REPEAT_COUNT);
+        }
+    }
+}
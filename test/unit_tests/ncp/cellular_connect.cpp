@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "at_parser.h"
+#include "at_response.h"
+
+#include "modem_simulator.h"
+
+#include <catch2/catch.hpp>
+
+#include <string>
+
+using namespace particle;
+
+namespace {
+
+AtParserConfig parserConfig(Stream* strm) {
+    AtParserConfig conf;
+    conf.stream(strm);
+    conf.echoEnabled(false);
+    conf.logEnabled(false);
+    return conf;
+}
+
+struct RegState {
+    int stat = -1;
+    int count = 0;
+};
+
+int regUrcHandler(AtResponseReader* reader, const char* prefix, void* data) {
+    const auto state = (RegState*)data;
+    int stat = -1;
+    // "+CEREG: <stat>[,...]"
+    const int r = reader->scanf("%*[^:]: %d", &stat);
+    if (r == 1) {
+        state->stat = stat;
+        ++state->count;
+    }
+    return 0;
+}
+
+} // namespace
+
+TEST_CASE("cmux") {
+    SECTION("frames can be encoded and decoded") {
+        const std::string data(200, 'x');
+        std::string buf = "garbage" + test::cmux::encodeFrame(2, test::cmux::UIH, true, false, data) +
+                test::cmux::encodeFrame(0, test::cmux::SABM, true, true);
+        test::cmux::Frame f;
+        REQUIRE(test::cmux::decodeFrame(&buf, &f));
+        CHECK(f.dlci == 2);
+        CHECK(f.type == test::cmux::UIH);
+        CHECK(f.cr);
+        CHECK(!f.pf);
+        CHECK(f.data == data);
+        REQUIRE(test::cmux::decodeFrame(&buf, &f));
+        CHECK(f.dlci == 0);
+        CHECK(f.type == test::cmux::SABM);
+        CHECK(f.pf);
+        CHECK(f.data.empty());
+        CHECK(!test::cmux::decodeFrame(&buf, &f));
+    }
+
+    SECTION("frames with an invalid FCS are discarded") {
+        std::string buf = test::cmux::encodeFrame(1, test::cmux::UIH, true, false, "AT\r");
+        buf[buf.size() - 2] ^= 0x01;
+        buf += test::cmux::encodeFrame(1, test::cmux::UIH, true, false, "ATI\r");
+        test::cmux::Frame f;
+        REQUIRE(test::cmux::decodeFrame(&buf, &f));
+        CHECK(f.data == "ATI\r");
+    }
+
+    SECTION("the FCS matches the reference value") {
+        // SABM on DLCI 0, as sent by the DTE
+        const uint8_t hdr[] = { 0x03, 0x3f, 0x01 };
+        CHECK(test::cmux::fcs(hdr, sizeof(hdr)) == 0x1c);
+    }
+}
+
+TEST_CASE("ModemSimulator") {
+    test::ModemSimulator sim;
+    test::ModemStream strm(&sim);
+    AtParser parser;
+    REQUIRE(parser.init(parserConfig(&strm)) == 0);
+    const auto startTime = test::SimClock::now();
+
+    SECTION("responds to basic commands") {
+        CHECK(parser.execCommand("AT") == AtResponse::OK);
+        auto resp = parser.sendCommand("AT+CGMM");
+        CHECK((const char*)resp.readLine() == std::string("BG96"));
+        CHECK(resp.readResult() == AtResponse::OK);
+        CHECK(sim.commands() == std::vector<std::string>({ "AT", "AT+CGMM" }));
+    }
+
+    SECTION("scripted handlers override the default behaviour") {
+        sim.onCommand("AT+CGMR", [](test::ModemSimulator*, const std::string&) {
+            return test::ModemSimulator::okResponse("+CGMR: 1.0");
+        });
+        sim.onCommand("AT+COPS=", [](test::ModemSimulator*, const std::string&) {
+            return test::ModemSimulator::errorResponse();
+        });
+        auto resp = parser.sendCommand("AT+CGMR");
+        CHECK((const char*)resp.readLine() == std::string("+CGMR: 1.0"));
+        CHECK(resp.readResult() == AtResponse::OK);
+        CHECK(parser.execCommand("AT+COPS=2") == AtResponse::ERROR);
+    }
+
+    SECTION("responses are delayed in simulated time") {
+        sim.responseDelay(100).cfunDelay(2000);
+        CHECK(parser.execCommand("AT") == AtResponse::OK);
+        CHECK(test::SimClock::now() - startTime == 100);
+        CHECK(parser.execCommand(5000, "AT+CFUN=1") == AtResponse::OK);
+        CHECK(test::SimClock::now() - startTime == 2200);
+        // The command times out if the response takes longer than expected
+        CHECK(parser.execCommand(1000, "AT+CFUN=0") == SYSTEM_ERROR_TIMEOUT);
+    }
+
+    SECTION("reports the registration via URCs") {
+        RegState state;
+        REQUIRE(parser.addUrcHandler("+CEREG", regUrcHandler, &state) == 0);
+        sim.registrationDelay(10000);
+        CHECK(parser.execCommand("AT+CEREG=2") == AtResponse::OK);
+        CHECK(parser.execCommand("AT+CFUN=1") == AtResponse::OK);
+        CHECK(sim.regStatus() == test::ModemSimulator::SEARCHING);
+        CHECK(parser.processUrc(5000) == SYSTEM_ERROR_TIMEOUT);
+        CHECK(state.count == 0);
+        CHECK(parser.processUrc(30000) == 1);
+        CHECK(state.stat == test::ModemSimulator::REGISTERED_HOME);
+        CHECK(test::SimClock::now() - startTime == 10000);
+        sim.deregister();
+        CHECK(parser.processUrc() == 1);
+        CHECK(state.stat == test::ModemSimulator::SEARCHING);
+    }
+
+    SECTION("reports the registration status when queried") {
+        sim.registrationDelay(10000);
+        CHECK(parser.execCommand("AT+CFUN=1") == AtResponse::OK);
+        auto resp = parser.sendCommand("AT+CEREG?");
+        CHECK((const char*)resp.readLine() == std::string("+CEREG: 0,2"));
+        CHECK(resp.readResult() == AtResponse::OK);
+        test::SimClock::advance(10000);
+        resp = parser.sendCommand("AT+CEREG?");
+        CHECK((const char*)resp.readLine() == std::string("+CEREG: 0,1"));
+        CHECK(resp.readResult() == AtResponse::OK);
+    }
+
+    SECTION("doesn't send registration URCs if they are disabled") {
+        RegState state;
+        REQUIRE(parser.addUrcHandler("+CEREG", regUrcHandler, &state) == 0);
+        sim.registrationDelay(1000).registrationUrcs(false);
+        CHECK(parser.execCommand("AT+CEREG=2") == AtResponse::OK);
+        CHECK(parser.execCommand("AT+CFUN=1") == AtResponse::OK);
+        CHECK(parser.processUrc(5000) == SYSTEM_ERROR_TIMEOUT);
+        CHECK(sim.regStatus() == test::ModemSimulator::REGISTERED_HOME);
+        CHECK(state.count == 0);
+    }
+
+    SECTION("refuses to enter the data mode if not registered") {
+        auto resp = parser.sendCommand("ATD*99***1#");
+        CHECK(resp.readResult() == AtResponse::NO_CARRIER);
+        CHECK(!sim.dataMode());
+    }
+}
+
+TEST_CASE("ModemSimulator with CMUX") {
+    test::ModemSimulator sim;
+    test::ModemStream strm(&sim);
+    AtParser parser;
+    REQUIRE(parser.init(parserConfig(&strm)) == 0);
+
+    CHECK(parser.execCommand("AT+CMUX=0,0,,1509,,,,,") == AtResponse::OK);
+    REQUIRE(sim.muxerRunning());
+    parser.destroy();
+
+    test::MuxerClient mux(&strm);
+    REQUIRE(mux.start() == 0);
+    REQUIRE(mux.openChannel(1) == 0);
+    REQUIRE(mux.openChannel(2) == 0);
+    CHECK(sim.channelOpen(1));
+    CHECK(sim.channelOpen(2));
+    CHECK(mux.openChannel(3) == 0);
+    CHECK(mux.closeChannel(3) == 0);
+    CHECK(!sim.channelOpen(3));
+
+    AtParser atParser;
+    REQUIRE(atParser.init(parserConfig(mux.channel(1))) == 0);
+    AtParser dataParser;
+    REQUIRE(dataParser.init(parserConfig(mux.channel(2))) == 0);
+
+    SECTION("AT commands can be sent via multiple channels") {
+        CHECK(atParser.execCommand("AT") == AtResponse::OK);
+        CHECK(dataParser.execCommand("ATI") == AtResponse::OK);
+        // Responses longer than the maximum frame size are split into multiple frames
+        const std::string line(3000, 'x');
+        sim.onCommand("AT+LONG", [line](test::ModemSimulator*, const std::string&) {
+            return test::ModemSimulator::okResponse(line);
+        });
+        auto resp = atParser.sendCommand("AT+LONG");
+        char buf[3001] = {};
+        CHECK(resp.readLine(buf, sizeof(buf)) == (int)line.size());
+        CHECK(buf == line);
+        CHECK(resp.readResult() == AtResponse::OK);
+    }
+
+    SECTION("URCs are sent via the configured channel") {
+        RegState state;
+        REQUIRE(atParser.addUrcHandler("+CEREG", regUrcHandler, &state) == 0);
+        sim.registrationDelay(3000);
+        CHECK(atParser.execCommand("AT+CEREG=1") == AtResponse::OK);
+        CHECK(atParser.execCommand("AT+CFUN=1") == AtResponse::OK);
+        CHECK(atParser.processUrc(10000) == 1);
+        CHECK(state.stat == test::ModemSimulator::REGISTERED_HOME);
+    }
+
+    SECTION("a channel can be switched to the data mode") {
+        sim.registrationDelay(0);
+        CHECK(atParser.execCommand("AT+CFUN=1") == AtResponse::OK);
+        // CONNECT is an intermediate result code
+        auto resp = dataParser.sendCommand("ATD*99***1#");
+        REQUIRE(resp.hasNextLine());
+        char line[16] = {};
+        CHECK(resp.readLine(line, sizeof(line)) == 7);
+        CHECK(std::string(line) == "CONNECT");
+        resp.reset();
+        CHECK(sim.dataMode());
+        dataParser.destroy();
+        auto ch = mux.channel(2);
+        const std::string lcpReq = "\x7e\xff\x7d\x23\xc0\x21\x7e";
+        REQUIRE(ch->write(lcpReq.data(), lcpReq.size()) == (int)lcpReq.size());
+        CHECK(sim.pppData() == lcpReq);
+        sim.sendPppData("\x7e\x01\x02\x7e", 50);
+        REQUIRE(ch->waitEvent(Stream::READABLE, 1000) == Stream::READABLE);
+        char buf[16] = {};
+        CHECK(ch->read(buf, sizeof(buf)) == 4);
+        CHECK(std::string(buf) == "\x7e\x01\x02\x7e");
+        // The AT channel is still functional
+        CHECK(atParser.execCommand("AT+CSQ") == AtResponse::OK);
+    }
+
+    SECTION("the multiplexer can be stopped") {
+        REQUIRE(mux.stop() == 0);
+        CHECK(!sim.muxerRunning());
+        AtParser p;
+        REQUIRE(p.init(parserConfig(&strm)) == 0);
+        CHECK(p.execCommand("AT") == AtResponse::OK);
+    }
+}
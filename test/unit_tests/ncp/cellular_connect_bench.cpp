@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Drives the AT parser against the modem simulator and reports the AT round-trip time and the
+ * simulated time it takes to get connected. The benchmark is not run by default:
+ *
+ *   ./ncp "[benchmark]"
+ *
+ * The connect sequence follows the one used by QuectelNcpClient: the multiplexer is started
+ * first, the AT channel is used to turn on the radio and wait for the registration, and the PPP
+ * session is dialed on the data channel.
+ */
+
+#include "at_parser.h"
+#include "at_response.h"
+
+#include "modem_simulator.h"
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+using namespace particle;
+
+namespace {
+
+// Catch2 overrides the CHECK() macro defined in check.h
+#define CHECK_RESULT(_expr) \
+        do { \
+            const int _r = _expr; \
+            if (_r < 0) { \
+                return _r; \
+            } \
+        } while (false)
+
+const unsigned ROUND_TRIP_COUNT = 5000;
+
+// Same as in quectel_ncp_client.cpp
+const unsigned REGISTRATION_CHECK_INTERVAL = 15000;
+const unsigned REGISTRATION_TIMEOUT = 10 * 60 * 1000;
+const unsigned AT_CHANNEL = 1;
+const unsigned PPP_CHANNEL = 2;
+
+const unsigned REGISTRATION_DELAYS[] = { 2000, 10000, 30000, 60000 };
+
+// Typical latencies of a BG96 modem
+const unsigned RESPONSE_DELAY = 20;
+const unsigned CFUN_DELAY = 300;
+
+AtParserConfig parserConfig(Stream* strm) {
+    AtParserConfig conf;
+    conf.stream(strm);
+    conf.echoEnabled(false);
+    conf.logEnabled(false);
+    return conf;
+}
+
+int regUrcHandler(AtResponseReader* reader, const char* prefix, void* data) {
+    const auto registered = (bool*)data;
+    int n = 0;
+    int stat = 0;
+    // "+CEREG: <n>,<stat>[,...]" or "+CEREG: <stat>[,...]"
+    const int r = reader->scanf("%*[^:]: %d,%d", &n, &stat);
+    if (r == 2 && n != 1 && n != 5) {
+        *registered = (stat == 1 || stat == 5);
+    } else if (r >= 1) {
+        *registered = (n == 1 || n == 5);
+    }
+    return 0;
+}
+
+double roundTripUs(Stream* strm, unsigned count) {
+    AtParser parser;
+    REQUIRE(parser.init(parserConfig(strm)) == 0);
+    const auto t1 = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < count; ++i) {
+        REQUIRE(parser.execCommand("AT") == AtResponse::OK);
+    }
+    const auto t2 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(t2 - t1).count() / count;
+}
+
+// Returns the simulated time to connected in milliseconds, or a negative result code
+int64_t connect(test::ModemSimulator* sim, bool useUrcs, unsigned* cmdCount) {
+    test::ModemStream strm(sim);
+    const auto startTime = test::SimClock::now();
+    {
+        AtParser parser;
+        CHECK_RESULT(parser.init(parserConfig(&strm)));
+        CHECK_RESULT(parser.execCommand("AT"));
+        CHECK_RESULT(parser.execCommand("ATE0"));
+        CHECK_RESULT(parser.execCommand("AT+CMEE=2"));
+        CHECK_RESULT(parser.execCommand("AT+CMUX=0,0,,1509,,,,,"));
+    }
+    test::MuxerClient mux(&strm);
+    CHECK_RESULT(mux.start());
+    CHECK_RESULT(mux.openChannel(AT_CHANNEL));
+    CHECK_RESULT(mux.openChannel(PPP_CHANNEL));
+    AtParser parser;
+    CHECK_RESULT(parser.init(parserConfig(mux.channel(AT_CHANNEL))));
+    bool registered = false;
+    CHECK_RESULT(parser.addUrcHandler("+CEREG", regUrcHandler, &registered));
+    CHECK_RESULT(parser.execCommand("AT+CEREG=%d", useUrcs ? 2 : 0));
+    CHECK_RESULT(parser.execCommand(5000, "AT+CFUN=1"));
+    auto lastCheck = test::SimClock::now();
+    for (;;) {
+        // The client polls the registration status periodically, and URCs wake it up earlier
+        if (test::SimClock::now() - lastCheck >= REGISTRATION_CHECK_INTERVAL) {
+            CHECK_RESULT(parser.execCommand("AT+CEREG?"));
+            lastCheck = test::SimClock::now();
+        }
+        if (registered) {
+            break;
+        }
+        if (test::SimClock::now() - startTime >= REGISTRATION_TIMEOUT) {
+            return SYSTEM_ERROR_TIMEOUT;
+        }
+        const int r = parser.processUrc(lastCheck + REGISTRATION_CHECK_INTERVAL - test::SimClock::now());
+        if (r < 0 && r != SYSTEM_ERROR_TIMEOUT) {
+            return r;
+        }
+    }
+    AtParser dataParser;
+    CHECK_RESULT(dataParser.init(parserConfig(mux.channel(PPP_CHANNEL))));
+    {
+        auto resp = dataParser.sendCommand(3 * 60 * 1000, "ATD*99***1#");
+        if (!resp.hasNextLine()) {
+            return SYSTEM_ERROR_UNKNOWN;
+        }
+        char buf[16] = {};
+        CHECK_RESULT(resp.readLine(buf, sizeof(buf)));
+        if (std::strcmp(buf, "CONNECT") != 0) {
+            return SYSTEM_ERROR_UNKNOWN;
+        }
+    }
+    *cmdCount = sim->commands().size();
+    return test::SimClock::now() - startTime;
+}
+
+} // namespace
+
+TEST_CASE("AT round trip", "[.][benchmark]") {
+    printf("\n%u round trips of \"AT\" with no simulated latency\n", ROUND_TRIP_COUNT);
+    printf("%-12s%-16s\n", "transport", "us/command");
+    {
+        test::ModemSimulator sim;
+        test::ModemStream strm(&sim);
+        printf("%-12s%-16.2f\n", "raw", roundTripUs(&strm, ROUND_TRIP_COUNT));
+    }
+    {
+        test::ModemSimulator sim;
+        test::ModemStream strm(&sim);
+        AtParser parser;
+        REQUIRE(parser.init(parserConfig(&strm)) == 0);
+        REQUIRE(parser.execCommand("AT+CMUX=0,0,,1509,,,,,") == AtResponse::OK);
+        parser.destroy();
+        test::MuxerClient mux(&strm);
+        REQUIRE(mux.start() == 0);
+        REQUIRE(mux.openChannel(AT_CHANNEL) == 0);
+        printf("%-12s%-16.2f\n", "cmux", roundTripUs(mux.channel(AT_CHANNEL), ROUND_TRIP_COUNT));
+    }
+}
+
+TEST_CASE("Time to connected", "[.][benchmark]") {
+    printf("\nSimulated time to connected, %u ms response latency, %u ms AT+CFUN latency\n", RESPONSE_DELAY,
+            CFUN_DELAY);
+    printf("%-16s%-16s%-16s%-16s\n", "reg delay (ms)", "registration", "connected (ms)", "commands");
+    for (unsigned delay: REGISTRATION_DELAYS) {
+        for (bool useUrcs: { false, true }) {
+            test::ModemSimulator sim;
+            sim.registrationDelay(delay).responseDelay(RESPONSE_DELAY).cfunDelay(CFUN_DELAY);
+            unsigned cmdCount = 0;
+            const auto t = connect(&sim, useUrcs, &cmdCount);
+            REQUIRE(t >= 0);
+            printf("%-16u%-16s%-16lld%-16u\n", delay, useUrcs ? "urc" : "poll", (long long)t, cmdCount);
+        }
+    }
+}
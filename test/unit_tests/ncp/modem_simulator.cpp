@@ -0,0 +1,857 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "modem_simulator.h"
+
+#include "timer_hal.h"
+#include "system_error.h"
+
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+
+system_tick_t HAL_Timer_Get_Milli_Seconds() {
+    return test::SimClock::now();
+}
+
+namespace test {
+
+uint64_t SimClock::now_ = 0;
+
+namespace {
+
+const char* const IMSI = "310260000000000";
+const char* const ICCID = "89014103211118510720";
+const char* const IMEI = "866425030000000";
+
+bool startsWith(const std::string& str, const char* prefix) {
+    return str.compare(0, std::strlen(prefix), prefix) == 0;
+}
+
+// Returns the N-th comma-separated integer parameter of a command, or a default value
+int commandParam(const std::string& cmd, unsigned index, int defaultVal) {
+    auto pos = cmd.find('=');
+    if (pos == std::string::npos) {
+        return defaultVal;
+    }
+    ++pos;
+    for (unsigned i = 0; i < index; ++i) {
+        pos = cmd.find(',', pos);
+        if (pos == std::string::npos) {
+            return defaultVal;
+        }
+        ++pos;
+    }
+    if (pos >= cmd.size() || cmd[pos] == ',') {
+        return defaultVal;
+    }
+    return std::atoi(cmd.c_str() + pos);
+}
+
+} // namespace
+
+namespace cmux {
+
+uint8_t fcs(const uint8_t* data, size_t size) {
+    // CRC-8 with the reversed polynomial x^8 + x^2 + x + 1, as specified in TS 27.010
+    uint8_t crc = 0xff;
+    for (size_t i = 0; i < size; ++i) {
+        crc ^= data[i];
+        for (int j = 0; j < 8; ++j) {
+            crc = (crc & 0x01) ? (crc >> 1) ^ 0xe0 : (crc >> 1);
+        }
+    }
+    return 0xff - crc;
+}
+
+std::string encodeFrame(unsigned dlci, uint8_t type, bool cr, bool pf, const std::string& data) {
+    std::string f;
+    f += (char)FLAG;
+    f += (char)((dlci << 2) | (cr ? 0x02 : 0x00) | 0x01);
+    f += (char)(type | (pf ? PF : 0x00));
+    if (data.size() <= 0x7f) {
+        f += (char)((data.size() << 1) | 0x01);
+    } else {
+        f += (char)((data.size() & 0x7f) << 1);
+        f += (char)(data.size() >> 7);
+    }
+    const auto c = fcs((const uint8_t*)f.data() + 1, f.size() - 1);
+    f += data;
+    f += (char)c;
+    f += (char)FLAG;
+    return f;
+}
+
+bool decodeFrame(std::string* buf, Frame* frame) {
+    for (;;) {
+        // Skip everything up to the opening flag, and any repeated flags
+        size_t pos = 0;
+        while (pos < buf->size() && (uint8_t)(*buf)[pos] != FLAG) {
+            ++pos;
+        }
+        while (pos + 1 < buf->size() && (uint8_t)(*buf)[pos + 1] == FLAG) {
+            ++pos;
+        }
+        buf->erase(0, pos);
+        if (buf->size() < 6) {
+            return false;
+        }
+        const auto p = (const uint8_t*)buf->data();
+        size_t hdrSize = 3;
+        size_t len = p[3] >> 1;
+        if (!(p[3] & 0x01)) {
+            len |= (size_t)p[4] << 7;
+            ++hdrSize;
+        }
+        const size_t frameSize = 1 + hdrSize + len + 2;
+        if (buf->size() < frameSize) {
+            return false;
+        }
+        if (p[frameSize - 1] != FLAG || fcs(p + 1, hdrSize) != p[1 + hdrSize + len]) {
+            buf->erase(0, 1); // Invalid frame
+            continue;
+        }
+        frame->dlci = p[1] >> 2;
+        frame->cr = p[1] & 0x02;
+        frame->type = p[2] & ~PF;
+        frame->pf = p[2] & PF;
+        frame->data.assign((const char*)p + 1 + hdrSize, len);
+        // Keep the closing flag as it may also be the opening flag of the next frame
+        buf->erase(0, frameSize - 1);
+        return true;
+    }
+}
+
+} // namespace cmux
+
+ModemSimulator::ModemSimulator() :
+        regTime_(0),
+        regDelay_(0),
+        respDelay_(0),
+        cfunDelay_(0),
+        urcDlci_(1),
+        maxFrameSize_(cmux::DEFAULT_MAX_FRAME_SIZE),
+        urcModes_(),
+        dataDlci_(-1),
+        searchStatus_(SEARCHING),
+        regUrcs_(true),
+        regReported_(false),
+        radioOn_(false),
+        echo_(false),
+        muxerRunning_(false) {
+    channels_[0] = Channel{ std::string(), true };
+}
+
+ModemSimulator& ModemSimulator::registrationDelay(unsigned ms) {
+    regDelay_ = ms;
+    return *this;
+}
+
+ModemSimulator& ModemSimulator::registrationUrcs(bool enabled) {
+    regUrcs_ = enabled;
+    return *this;
+}
+
+ModemSimulator& ModemSimulator::searchStatus(RegStatus status) {
+    searchStatus_ = status;
+    return *this;
+}
+
+ModemSimulator& ModemSimulator::responseDelay(unsigned ms) {
+    respDelay_ = ms;
+    return *this;
+}
+
+ModemSimulator& ModemSimulator::cfunDelay(unsigned ms) {
+    cfunDelay_ = ms;
+    return *this;
+}
+
+ModemSimulator& ModemSimulator::echo(bool enabled) {
+    echo_ = enabled;
+    return *this;
+}
+
+ModemSimulator& ModemSimulator::urcChannel(unsigned dlci) {
+    urcDlci_ = dlci;
+    return *this;
+}
+
+ModemSimulator& ModemSimulator::maxFrameSize(size_t size) {
+    maxFrameSize_ = size;
+    return *this;
+}
+
+ModemSimulator& ModemSimulator::onCommand(std::string prefix, CommandHandler handler) {
+    handlers_.push_back(std::make_pair(std::move(prefix), std::move(handler)));
+    return *this;
+}
+
+void ModemSimulator::sendUrc(const std::string& line, unsigned delay) {
+    send(muxerRunning_ ? urcDlci_ : 0, line + "\r\n", delay);
+}
+
+void ModemSimulator::sendPppData(const std::string& data, unsigned delay) {
+    if (dataDlci_ >= 0) {
+        send(dataDlci_, data, delay);
+    }
+}
+
+void ModemSimulator::startRegistration() {
+    radioOn_ = true;
+    regTime_ = SimClock::now() + regDelay_;
+    regReported_ = false;
+}
+
+void ModemSimulator::deregister() {
+    if (!radioOn_) {
+        return;
+    }
+    startRegistration();
+    if (regUrcs_) {
+        reportRegistration();
+    }
+}
+
+ModemSimulator::RegStatus ModemSimulator::regStatus() const {
+    if (!radioOn_) {
+        return NOT_REGISTERED;
+    }
+    if (SimClock::now() >= regTime_) {
+        return REGISTERED_HOME;
+    }
+    return searchStatus_;
+}
+
+bool ModemSimulator::channelOpen(unsigned dlci) const {
+    const auto it = channels_.find(dlci);
+    return it != channels_.end() && it->second.open;
+}
+
+void ModemSimulator::input(const char* data, size_t size) {
+    update();
+    if (!muxerRunning_) {
+        auto& ch = channels_[0];
+        for (size_t i = 0; i < size; ++i) {
+            if (dataDlci_ == 0) {
+                pppData_ += data[i];
+            } else {
+                processChar(0, &ch, data[i]);
+            }
+        }
+        return;
+    }
+    muxIn_.append(data, size);
+    cmux::Frame f;
+    while (muxerRunning_ && cmux::decodeFrame(&muxIn_, &f)) {
+        processFrame(f);
+    }
+}
+
+size_t ModemSimulator::output(char* data, size_t size, bool consume) {
+    const auto now = SimClock::now();
+    size_t n = 0;
+    for (auto it = out_.begin(); it != out_.end() && it->time <= now && n < size;) {
+        const size_t chunk = std::min(size - n, it->data.size());
+        std::memcpy(data + n, it->data.data(), chunk);
+        n += chunk;
+        if (!consume) {
+            ++it;
+            continue;
+        }
+        if (chunk < it->data.size()) {
+            it->data.erase(0, chunk);
+            break;
+        }
+        it = out_.erase(it);
+    }
+    return n;
+}
+
+size_t ModemSimulator::availForRead() const {
+    const auto now = SimClock::now();
+    size_t n = 0;
+    for (const auto& o: out_) {
+        if (o.time > now) {
+            break;
+        }
+        n += o.data.size();
+    }
+    return n;
+}
+
+uint64_t ModemSimulator::nextEventTime() const {
+    uint64_t t = std::numeric_limits<uint64_t>::max();
+    if (!out_.empty()) {
+        t = out_.front().time;
+    }
+    if (radioOn_ && !regReported_) {
+        t = std::min(t, regTime_);
+    }
+    return t;
+}
+
+void ModemSimulator::update() {
+    if (radioOn_ && !regReported_ && SimClock::now() >= regTime_) {
+        regReported_ = true;
+        if (regUrcs_) {
+            reportRegistration();
+        }
+    }
+}
+
+std::string ModemSimulator::okResponse(const std::string& lines) {
+    return lines.empty() ? "OK\r\n" : lines + "\r\nOK\r\n";
+}
+
+std::string ModemSimulator::errorResponse() {
+    return "ERROR\r\n";
+}
+
+void ModemSimulator::processChar(unsigned dlci, Channel* ch, char c) {
+    if (c == '\r') {
+        const std::string cmd = std::move(ch->cmd);
+        ch->cmd.clear();
+        if (!cmd.empty()) {
+            processCommand(dlci, cmd);
+        }
+    } else if (c != '\n') {
+        ch->cmd += c;
+    }
+}
+
+void ModemSimulator::processCommand(unsigned dlci, const std::string& cmd) {
+    cmds_.push_back(cmd);
+    if (echo_) {
+        send(dlci, cmd + "\r", 0);
+    }
+    unsigned delay = respDelay_;
+    std::string resp;
+    bool handled = false;
+    for (const auto& h: handlers_) {
+        if (startsWith(cmd, h.first.c_str())) {
+            resp = h.second(this, cmd);
+            handled = true;
+            break;
+        }
+    }
+    if (!handled) {
+        if (startsWith(cmd, "AT+CFUN=")) {
+            delay += cfunDelay_;
+        }
+        resp = handleCommand(dlci, cmd);
+    }
+    send(dlci, resp, delay);
+    if (startsWith(cmd, "AT+CMUX=") && !handled && !muxerRunning_) {
+        // The response is sent before the multiplexer is started
+        const int n1 = commandParam(cmd, 3, 0);
+        if (n1 > 0) {
+            maxFrameSize_ = n1;
+        }
+        muxerRunning_ = true;
+        channels_.clear();
+        muxIn_.clear();
+    }
+}
+
+std::string ModemSimulator::handleCommand(unsigned dlci, const std::string& cmd) {
+    if (!startsWith(cmd, "AT")) {
+        return errorResponse();
+    }
+    if (cmd == "AT" || startsWith(cmd, "AT+CMUX=") || startsWith(cmd, "ATH")) {
+        return okResponse();
+    }
+    if (cmd == "ATE0" || cmd == "ATE1") {
+        echo_ = (cmd == "ATE1");
+        return okResponse();
+    }
+    if (cmd == "ATI") {
+        return okResponse("Quectel\r\nBG96\r\nRevision: BG96MAR02A07M1G");
+    }
+    if (cmd == "AT+CGMM") {
+        return okResponse("BG96");
+    }
+    if (cmd == "AT+CIMI") {
+        return okResponse(IMSI);
+    }
+    if (cmd == "AT+CCID") {
+        return okResponse(std::string("+CCID: ") + ICCID);
+    }
+    if (cmd == "AT+QCCID") {
+        return okResponse(std::string("+QCCID: ") + ICCID);
+    }
+    if (cmd == "AT+CGSN") {
+        return okResponse(IMEI);
+    }
+    if (cmd == "AT+CSQ") {
+        return okResponse("+CSQ: 20,99");
+    }
+    if (cmd == "AT+CFUN?") {
+        return okResponse(radioOn_ ? "+CFUN: 1" : "+CFUN: 0");
+    }
+    if (startsWith(cmd, "AT+CFUN=")) {
+        const int fun = commandParam(cmd, 0, -1);
+        if (fun == 1) {
+            if (!radioOn_) {
+                startRegistration();
+            }
+        } else if (fun == 0 || fun == 4) {
+            radioOn_ = false;
+        } else {
+            return errorResponse();
+        }
+        return okResponse();
+    }
+    const struct {
+        const char* name;
+        UrcMode mode;
+    } regCmds[] = { { "CREG", CREG }, { "CGREG", CGREG }, { "CEREG", CEREG } };
+    for (const auto& r: regCmds) {
+        const std::string prefix = std::string("AT+") + r.name;
+        if (cmd == prefix + "?") {
+            return okResponse(regResponse(r.mode, r.name));
+        }
+        if (startsWith(cmd, (prefix + "=").c_str())) {
+            urcModes_[r.mode] = commandParam(cmd, 0, 0);
+            return okResponse();
+        }
+    }
+    if (cmd == "AT+COPS?") {
+        return okResponse(regStatus() == REGISTERED_HOME ? "+COPS: 0,0,\"Simulated\",7" : "+COPS: 0");
+    }
+    if (startsWith(cmd, "ATD") || startsWith(cmd, "AT+CGDATA")) {
+        if (regStatus() != REGISTERED_HOME) {
+            return "NO CARRIER\r\n";
+        }
+        dataDlci_ = dlci;
+        return "CONNECT\r\n";
+    }
+    // Configuration commands that are not simulated are accepted
+    return okResponse();
+}
+
+void ModemSimulator::processFrame(const cmux::Frame& f) {
+    switch (f.type) {
+    case cmux::SABM: {
+        channels_[f.dlci] = Channel{ std::string(), true };
+        sendFrame(f.dlci, cmux::UA, true);
+        break;
+    }
+    case cmux::DISC: {
+        if (!channelOpen(f.dlci)) {
+            sendFrame(f.dlci, cmux::DM, true);
+            break;
+        }
+        sendFrame(f.dlci, cmux::UA, true);
+        if (f.dlci == 0) {
+            stopMuxer();
+        } else {
+            channels_.erase(f.dlci);
+            if (dataDlci_ == (int)f.dlci) {
+                dataDlci_ = -1;
+            }
+        }
+        break;
+    }
+    case cmux::UIH:
+    case cmux::UI: {
+        if (!channelOpen(f.dlci)) {
+            sendFrame(f.dlci, cmux::DM, true);
+            break;
+        }
+        if (f.dlci == 0) {
+            processControlMessage(f.data);
+        } else if (dataDlci_ == (int)f.dlci) {
+            pppData_ += f.data;
+        } else {
+            auto& ch = channels_[f.dlci];
+            for (char c: f.data) {
+                processChar(f.dlci, &ch, c);
+            }
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+void ModemSimulator::processControlMessage(const std::string& data) {
+    size_t pos = 0;
+    while (pos + 2 <= data.size()) {
+        const uint8_t type = data[pos];
+        const size_t len = (uint8_t)data[pos + 1] >> 1;
+        if (pos + 2 + len > data.size()) {
+            break;
+        }
+        const std::string val = data.substr(pos + 2, len);
+        pos += 2 + len;
+        if (!(type & 0x02)) {
+            continue; // Response to a command sent by the simulator
+        }
+        const uint8_t msg = type & 0xfc;
+        std::string resp;
+        if (msg == cmux::MSG_MSC || msg == cmux::MSG_TEST || msg == cmux::MSG_CLD) {
+            resp += (char)(msg | 0x01);
+            resp += (char)((val.size() << 1) | 0x01);
+            resp += val;
+        } else {
+            resp += (char)(cmux::MSG_NSC | 0x01);
+            resp += (char)0x03;
+            resp += (char)type;
+        }
+        sendFrame(0, cmux::UIH, false, resp);
+        if (msg == cmux::MSG_CLD) {
+            stopMuxer();
+            break;
+        }
+    }
+}
+
+void ModemSimulator::stopMuxer() {
+    muxerRunning_ = false;
+    channels_.clear();
+    channels_[0] = Channel{ std::string(), true };
+    dataDlci_ = -1;
+    muxIn_.clear();
+}
+
+void ModemSimulator::send(unsigned dlci, const std::string& data, unsigned delay) {
+    const auto time = SimClock::now() + delay;
+    if (!muxerRunning_) {
+        sendRaw(data, time);
+        return;
+    }
+    if (!channelOpen(dlci)) {
+        return;
+    }
+    for (size_t pos = 0; pos < data.size(); pos += maxFrameSize_) {
+        // Data sent by the responder is a command frame with the C/R bit cleared
+        sendRaw(cmux::encodeFrame(dlci, cmux::UIH, false /* cr */, false /* pf */, data.substr(pos, maxFrameSize_)),
+                time);
+    }
+}
+
+void ModemSimulator::sendRaw(const std::string& data, uint64_t time) {
+    // Keep the output ordered by time, and in the order of submission for the same time
+    auto it = out_.end();
+    while (it != out_.begin() && std::prev(it)->time > time) {
+        --it;
+    }
+    out_.insert(it, Output{ time, data });
+}
+
+void ModemSimulator::sendFrame(unsigned dlci, uint8_t type, bool pf, const std::string& data) {
+    // Responses sent by the responder have the C/R bit set
+    const bool cr = (type != cmux::UIH && type != cmux::UI);
+    sendRaw(cmux::encodeFrame(dlci, type, cr, pf, data), SimClock::now() + respDelay_);
+}
+
+void ModemSimulator::reportRegistration() {
+    const char* const names[URC_MODE_COUNT] = { "+CREG", "+CGREG", "+CEREG" };
+    const auto stat = regStatus();
+    for (int i = 0; i < URC_MODE_COUNT; ++i) {
+        const int mode = urcModes_[i];
+        if (mode <= 0) {
+            continue;
+        }
+        char line[64] = {};
+        if (mode >= 2 && stat == REGISTERED_HOME) {
+            std::snprintf(line, sizeof(line), "%s: %d,\"FFFE\",\"1A2B3C\",%d", names[i], (int)stat, i == CEREG ? 7 : 0);
+        } else {
+            std::snprintf(line, sizeof(line), "%s: %d", names[i], (int)stat);
+        }
+        sendUrc(line);
+    }
+}
+
+std::string ModemSimulator::regResponse(UrcMode mode, const char* name) const {
+    char line[64] = {};
+    std::snprintf(line, sizeof(line), "+%s: %d,%d", name, urcModes_[mode], (int)regStatus());
+    return line;
+}
+
+int ModemStream::read(char* data, size_t size) {
+    sim_->update();
+    return sim_->output(data, size, true /* consume */);
+}
+
+int ModemStream::peek(char* data, size_t size) {
+    sim_->update();
+    return sim_->output(data, size, false /* consume */);
+}
+
+int ModemStream::skip(size_t size) {
+    std::string buf(size, '\0');
+    return read(&buf[0], size);
+}
+
+int ModemStream::availForRead() {
+    sim_->update();
+    return sim_->availForRead();
+}
+
+int ModemStream::write(const char* data, size_t size) {
+    sim_->input(data, size);
+    return size;
+}
+
+int ModemStream::flush() {
+    return 0;
+}
+
+int ModemStream::availForWrite() {
+    return 4096;
+}
+
+int ModemStream::waitEvent(unsigned flags, unsigned timeout) {
+    if ((flags & READABLE) && availForRead() > 0) {
+        return READABLE;
+    }
+    if (flags & WRITABLE) {
+        return WRITABLE;
+    }
+    if (!(flags & READABLE)) {
+        return SYSTEM_ERROR_INVALID_ARGUMENT;
+    }
+    const uint64_t deadline = SimClock::now() + timeout;
+    for (;;) {
+        const auto t = sim_->nextEventTime();
+        if (t > deadline) {
+            SimClock::advanceTo(deadline);
+            return (availForRead() > 0) ? (int)READABLE : (int)SYSTEM_ERROR_TIMEOUT;
+        }
+        SimClock::advanceTo(t);
+        if (availForRead() > 0) {
+            return READABLE;
+        }
+    }
+}
+
+class MuxerClient::ChannelStream: public particle::Stream {
+public:
+    ChannelStream(MuxerClient* mux, unsigned dlci) :
+            mux_(mux),
+            dlci_(dlci) {
+    }
+
+    void received(const std::string& data) {
+        buf_ += data;
+    }
+
+    int read(char* data, size_t size) override {
+        const int n = peek(data, size);
+        buf_.erase(0, n);
+        return n;
+    }
+
+    int peek(char* data, size_t size) override {
+        if (buf_.empty()) {
+            mux_->pump();
+        }
+        const size_t n = std::min(size, buf_.size());
+        std::memcpy(data, buf_.data(), n);
+        return n;
+    }
+
+    int skip(size_t size) override {
+        const size_t n = std::min(size, buf_.size());
+        buf_.erase(0, n);
+        return n;
+    }
+
+    int availForRead() override {
+        if (buf_.empty()) {
+            mux_->pump();
+        }
+        return buf_.size();
+    }
+
+    int write(const char* data, size_t size) override {
+        const int r = mux_->sendFrame(dlci_, cmux::UIH, std::string(data, size));
+        if (r < 0) {
+            return r;
+        }
+        return size;
+    }
+
+    int flush() override {
+        return 0;
+    }
+
+    int availForWrite() override {
+        return 4096;
+    }
+
+    int waitEvent(unsigned flags, unsigned timeout) override {
+        if ((flags & READABLE) && availForRead() > 0) {
+            return READABLE;
+        }
+        if (flags & WRITABLE) {
+            return WRITABLE;
+        }
+        const uint64_t deadline = SimClock::now() + timeout;
+        for (;;) {
+            const int r = mux_->pump(deadline - SimClock::now());
+            if (r < 0) {
+                return r;
+            }
+            if (!buf_.empty()) {
+                return READABLE;
+            }
+            if (SimClock::now() >= deadline) {
+                return SYSTEM_ERROR_TIMEOUT;
+            }
+        }
+    }
+
+private:
+    MuxerClient* mux_;
+    std::string buf_;
+    unsigned dlci_;
+};
+
+MuxerClient::MuxerClient(particle::Stream* strm, size_t maxFrameSize) :
+        strm_(strm),
+        maxFrameSize_(maxFrameSize) {
+}
+
+MuxerClient::~MuxerClient() {
+}
+
+int MuxerClient::start(unsigned timeout) {
+    in_.clear();
+    lastFrame_.clear();
+    const int r = sendFrame(0, cmux::SABM);
+    if (r < 0) {
+        return r;
+    }
+    return waitFrame(0, timeout);
+}
+
+int MuxerClient::stop(unsigned timeout) {
+    const int r = sendFrame(0, cmux::DISC);
+    if (r < 0) {
+        return r;
+    }
+    channels_.clear();
+    return waitFrame(0, timeout);
+}
+
+int MuxerClient::openChannel(unsigned dlci, unsigned timeout) {
+    int r = sendFrame(dlci, cmux::SABM);
+    if (r < 0) {
+        return r;
+    }
+    r = waitFrame(dlci, timeout);
+    if (r < 0) {
+        return r;
+    }
+    channels_[dlci].reset(new ChannelStream(this, dlci));
+    return 0;
+}
+
+int MuxerClient::closeChannel(unsigned dlci, unsigned timeout) {
+    const int r = sendFrame(dlci, cmux::DISC);
+    if (r < 0) {
+        return r;
+    }
+    channels_.erase(dlci);
+    return waitFrame(dlci, timeout);
+}
+
+particle::Stream* MuxerClient::channel(unsigned dlci) {
+    const auto it = channels_.find(dlci);
+    if (it == channels_.end()) {
+        return nullptr;
+    }
+    return it->second.get();
+}
+
+int MuxerClient::pump(unsigned timeout) {
+    if (strm_->availForRead() == 0) {
+        if (!timeout) {
+            return 0;
+        }
+        const int r = strm_->waitEvent(particle::Stream::READABLE, timeout);
+        if (r == SYSTEM_ERROR_TIMEOUT) {
+            return 0;
+        }
+        if (r < 0) {
+            return r;
+        }
+    }
+    char buf[256];
+    int n = 0;
+    while ((n = strm_->read(buf, sizeof(buf))) > 0) {
+        in_.append(buf, n);
+    }
+    if (n < 0) {
+        return n;
+    }
+    int count = 0;
+    cmux::Frame f;
+    while (cmux::decodeFrame(&in_, &f)) {
+        ++count;
+        if (f.type == cmux::UIH || f.type == cmux::UI) {
+            const auto ch = channels_.find(f.dlci);
+            if (ch != channels_.end()) {
+                ch->second->received(f.data);
+            }
+        } else {
+            lastFrame_[f.dlci] = f.type;
+        }
+    }
+    return count;
+}
+
+int MuxerClient::sendFrame(unsigned dlci, uint8_t type, const std::string& data) {
+    const bool pf = (type == cmux::SABM || type == cmux::DISC);
+    size_t pos = 0;
+    do {
+        const auto f = cmux::encodeFrame(dlci, type, true /* cr */, pf, data.substr(pos, maxFrameSize_));
+        const int r = strm_->write(f.data(), f.size());
+        if (r < 0) {
+            return r;
+        }
+        pos += maxFrameSize_;
+    } while (pos < data.size());
+    return 0;
+}
+
+int MuxerClient::waitFrame(unsigned dlci, unsigned timeout) {
+    const uint64_t deadline = SimClock::now() + timeout;
+    for (;;) {
+        const auto it = lastFrame_.find(dlci);
+        if (it != lastFrame_.end()) {
+            const auto type = it->second;
+            lastFrame_.erase(it);
+            return (type == cmux::UA) ? 0 : SYSTEM_ERROR_PROTOCOL;
+        }
+        const auto now = SimClock::now();
+        if (now >= deadline) {
+            return SYSTEM_ERROR_TIMEOUT;
+        }
+        const int r = pump(deadline - now);
+        if (r < 0) {
+            return r;
+        }
+    }
+}
+
+} // namespace test
@@ -0,0 +1,297 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "stream.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <limits>
+#include <cstdint>
+
+namespace test {
+
+/*
+ * Simulated time shared by the modem simulator and the code under test. HAL_Timer_Get_Milli_Seconds()
+ * returns this time in the NCP tests.
+ */
+class SimClock {
+public:
+    static uint64_t now() {
+        return now_;
+    }
+
+    static void advance(uint64_t ms) {
+        now_ += ms;
+    }
+
+    static void advanceTo(uint64_t time) {
+        if (time > now_) {
+            now_ = time;
+        }
+    }
+
+private:
+    static uint64_t now_;
+};
+
+/*
+ * GSM 07.10 basic option framing.
+ */
+namespace cmux {
+
+const uint8_t FLAG = 0xf9;
+
+// Frame types, without the P/F bit
+const uint8_t SABM = 0x2f;
+const uint8_t UA = 0x63;
+const uint8_t DM = 0x0f;
+const uint8_t DISC = 0x43;
+const uint8_t UIH = 0xef;
+const uint8_t UI = 0x03;
+
+const uint8_t PF = 0x10;
+
+// Control channel message types, without the C/R and EA bits
+const uint8_t MSG_CLD = 0xc0;
+const uint8_t MSG_TEST = 0x20;
+const uint8_t MSG_MSC = 0xe0;
+const uint8_t MSG_NSC = 0x10;
+
+const size_t DEFAULT_MAX_FRAME_SIZE = 127;
+
+struct Frame {
+    unsigned dlci;
+    uint8_t type;
+    bool pf;
+    bool cr;
+    std::string data;
+};
+
+uint8_t fcs(const uint8_t* data, size_t size);
+
+std::string encodeFrame(unsigned dlci, uint8_t type, bool cr, bool pf, const std::string& data = std::string());
+
+// Removes the first complete frame from the buffer. Garbage and frames with an invalid FCS are
+// discarded. Returns false if the buffer doesn't contain a complete frame
+bool decodeFrame(std::string* buf, Frame* frame);
+
+} // namespace cmux
+
+/*
+ * Scriptable simulator of a cellular modem.
+ *
+ * The simulator implements a subset of the AT commands used by the NCP clients, network
+ * registration with a configurable delay, the GSM 07.10 multiplexer (DCE side) and a PPP data
+ * mode. Responses are scheduled on the simulated clock and only become readable once the clock
+ * reaches their time. Use `ModemStream` to connect the simulator to a DTE.
+ */
+class ModemSimulator {
+public:
+    // Returns the complete response, including the final result code, e.g. "OK\r\n". As in the
+    // transcripts used by the AT parser tests, the lines are not preceded by an empty line
+    typedef std::function<std::string(ModemSimulator* sim, const std::string& cmd)> CommandHandler;
+
+    enum RegStatus {
+        NOT_REGISTERED = 0,
+        REGISTERED_HOME = 1,
+        SEARCHING = 2,
+        DENIED = 3
+    };
+
+    ModemSimulator();
+
+    // Time from the radio being turned on to the network registration
+    ModemSimulator& registrationDelay(unsigned ms);
+    // Whether the modem reports the registration via the +CREG/+CGREG/+CEREG URCs if they are enabled
+    ModemSimulator& registrationUrcs(bool enabled);
+    // Status reported before the registration completes
+    ModemSimulator& searchStatus(RegStatus status);
+    // Latency of every response
+    ModemSimulator& responseDelay(unsigned ms);
+    // Additional latency of the AT+CFUN command
+    ModemSimulator& cfunDelay(unsigned ms);
+    ModemSimulator& echo(bool enabled);
+    // DLCI of the channel on which URCs are sent when the multiplexer is running
+    ModemSimulator& urcChannel(unsigned dlci);
+    ModemSimulator& maxFrameSize(size_t size);
+
+    // Overrides the handling of the commands starting with the prefix
+    ModemSimulator& onCommand(std::string prefix, CommandHandler handler);
+
+    void sendUrc(const std::string& line, unsigned delay = 0);
+    // Sends data to the DTE via the channel that is in the data mode
+    void sendPppData(const std::string& data, unsigned delay = 0);
+    // Starts the network registration immediately, as if the radio was turned on
+    void startRegistration();
+    // Drops the network registration and starts it anew
+    void deregister();
+
+    RegStatus regStatus() const;
+    bool radioOn() const {
+        return radioOn_;
+    }
+    bool muxerRunning() const {
+        return muxerRunning_;
+    }
+    bool channelOpen(unsigned dlci) const;
+    bool dataMode() const {
+        return dataDlci_ >= 0;
+    }
+
+    // Command lines received from the DTE, on all channels
+    const std::vector<std::string>& commands() const {
+        return cmds_;
+    }
+    // Data received from the DTE in the data mode
+    const std::string& pppData() const {
+        return pppData_;
+    }
+
+    void clearCommands() {
+        cmds_.clear();
+    }
+
+    // Interface used by ModemStream
+    void input(const char* data, size_t size);
+    size_t output(char* data, size_t size, bool consume = true);
+    size_t availForRead() const;
+    // Returns the time of the next scheduled event or UINT64_MAX if there are none
+    uint64_t nextEventTime() const;
+    // Processes the events that are due at the current time
+    void update();
+
+    static std::string okResponse(const std::string& lines = std::string());
+    static std::string errorResponse();
+
+private:
+    struct Output {
+        uint64_t time;
+        std::string data;
+    };
+
+    struct Channel {
+        std::string cmd;
+        bool open;
+    };
+
+    enum UrcMode {
+        CREG,
+        CGREG,
+        CEREG,
+        URC_MODE_COUNT
+    };
+
+    std::vector<std::pair<std::string, CommandHandler>> handlers_;
+    std::deque<Output> out_;
+    std::map<unsigned, Channel> channels_;
+    std::vector<std::string> cmds_;
+    std::string muxIn_;
+    std::string pppData_;
+    uint64_t regTime_;
+    unsigned regDelay_;
+    unsigned respDelay_;
+    unsigned cfunDelay_;
+    unsigned urcDlci_;
+    size_t maxFrameSize_;
+    int urcModes_[URC_MODE_COUNT];
+    int dataDlci_;
+    RegStatus searchStatus_;
+    bool regUrcs_;
+    bool regReported_;
+    bool radioOn_;
+    bool echo_;
+    bool muxerRunning_;
+
+    void processChar(unsigned dlci, Channel* ch, char c);
+    void processCommand(unsigned dlci, const std::string& cmd);
+    std::string handleCommand(unsigned dlci, const std::string& cmd);
+    void processFrame(const cmux::Frame& frame);
+    void processControlMessage(const std::string& data);
+    void stopMuxer();
+    void send(unsigned dlci, const std::string& data, unsigned delay);
+    void sendRaw(const std::string& data, uint64_t time);
+    void sendFrame(unsigned dlci, uint8_t type, bool pf, const std::string& data = std::string());
+    void reportRegistration();
+    std::string regResponse(UrcMode mode, const char* name) const;
+};
+
+/*
+ * In-memory stream connecting a DTE to the simulator. Waiting for an event advances the simulated
+ * time to the next event scheduled by the simulator, so scripted delays don't take real time.
+ */
+class ModemStream: public particle::Stream {
+public:
+    explicit ModemStream(ModemSimulator* sim) :
+            sim_(sim) {
+    }
+
+    int read(char* data, size_t size) override;
+    int peek(char* data, size_t size) override;
+    int skip(size_t size) override;
+    int availForRead() override;
+    int write(const char* data, size_t size) override;
+    int flush() override;
+    int availForWrite() override;
+    int waitEvent(unsigned flags, unsigned timeout) override;
+
+private:
+    ModemSimulator* sim_;
+};
+
+/*
+ * Minimal DTE side of the GSM 07.10 multiplexer, used to talk to the simulator over CMUX.
+ */
+class MuxerClient {
+public:
+    explicit MuxerClient(particle::Stream* strm, size_t maxFrameSize = cmux::DEFAULT_MAX_FRAME_SIZE);
+    ~MuxerClient();
+
+    // Opens the control channel. The multiplexer needs to be enabled with AT+CMUX first
+    int start(unsigned timeout = 1000);
+    int stop(unsigned timeout = 1000);
+
+    int openChannel(unsigned dlci, unsigned timeout = 1000);
+    int closeChannel(unsigned dlci, unsigned timeout = 1000);
+
+    // Stream of an open channel
+    particle::Stream* channel(unsigned dlci);
+
+    // Reads the available frames from the underlying stream. Returns the number of frames read
+    int pump(unsigned timeout = 0);
+
+private:
+    class ChannelStream;
+
+    std::map<unsigned, std::unique_ptr<ChannelStream>> channels_;
+    std::map<unsigned, uint8_t> lastFrame_; // Type of the last frame received on a channel
+    particle::Stream* strm_;
+    std::string in_;
+    size_t maxFrameSize_;
+
+    int sendFrame(unsigned dlci, uint8_t type, const std::string& data = std::string());
+    int waitFrame(unsigned dlci, unsigned timeout);
+
+    friend class ChannelStream;
+};
+
+} // namespace test
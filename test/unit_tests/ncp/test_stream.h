@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "stream.h"
+#include "system_error.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <cstring>
+
+namespace test {
+
+// Stream emulating a DCE. Every command line written to the stream is answered with the next
+// response from the response queue
+class DceStream: public particle::Stream {
+public:
+    DceStream() :
+            inPos_(0),
+            readCount_(0) {
+    }
+
+    void addInput(const std::string& data) {
+        in_.append(data);
+    }
+
+    void addResponse(std::string data) {
+        resps_.push_back(std::move(data));
+    }
+
+    int read(char* data, size_t size) override {
+        ++readCount_;
+        const size_t n = std::min(size, in_.size() - inPos_);
+        memcpy(data, in_.data() + inPos_, n);
+        inPos_ += n;
+        if (inPos_ == in_.size()) {
+            in_.clear();
+            inPos_ = 0;
+        }
+        return n;
+    }
+
+    int peek(char* data, size_t size) override {
+        const size_t n = std::min(size, in_.size() - inPos_);
+        memcpy(data, in_.data() + inPos_, n);
+        return n;
+    }
+
+    int skip(size_t size) override {
+        const size_t n = std::min(size, in_.size() - inPos_);
+        inPos_ += n;
+        return n;
+    }
+
+    int availForRead() override {
+        return in_.size() - inPos_;
+    }
+
+    int write(const char* data, size_t size) override {
+        for (size_t i = 0; i < size; ++i) {
+            const char c = data[i];
+            if (c == '\r') {
+                out_.push_back(cmd_);
+                cmd_.clear();
+                if (!resps_.empty()) {
+                    addInput(resps_.front());
+                    resps_.erase(resps_.begin());
+                }
+            } else {
+                cmd_ += c;
+            }
+        }
+        return size;
+    }
+
+    int flush() override {
+        return 0;
+    }
+
+    int availForWrite() override {
+        return 1024;
+    }
+
+    int waitEvent(unsigned flags, unsigned timeout) override {
+        if ((flags & READABLE) && availForRead() > 0) {
+            return READABLE;
+        }
+        if (flags & WRITABLE) {
+            return WRITABLE;
+        }
+        return SYSTEM_ERROR_TIMEOUT;
+    }
+
+    // Command lines received from the DTE
+    const std::vector<std::string>& commands() const {
+        return out_;
+    }
+
+    // Number of read() calls
+    size_t readCount() const {
+        return readCount_;
+    }
+
+    void resetReadCount() {
+        readCount_ = 0;
+    }
+
+private:
+    std::string in_;
+    size_t inPos_;
+    std::vector<std::string> resps_;
+    std::vector<std::string> out_;
+    std::string cmd_;
+    size_t readCount_;
+};
+
+} // namespace test
@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "block_cache.h"
+#include "system_error.h"
+
+#include "util/random.h"
+
+#include <catch2/catch.hpp>
+
+#include <string>
+#include <algorithm>
+#include <cstring>
+
+using namespace particle;
+
+namespace {
+
+// Seekable stream over a string that counts the reads
+class StringInputStream: public InputStream {
+public:
+    explicit StringInputStream(std::string data) :
+            data_(std::move(data)),
+            offs_(0),
+            readCount_(0) {
+    }
+
+    int read(char* data, size_t size) override {
+        const int r = peek(data, size);
+        if (r > 0) {
+            offs_ += r;
+            ++readCount_;
+        }
+        return r;
+    }
+
+    int peek(char* data, size_t size) override {
+        if (offs_ >= data_.size()) {
+            return SYSTEM_ERROR_END_OF_STREAM;
+        }
+        size = std::min(size, data_.size() - offs_);
+        memcpy(data, data_.data() + offs_, size);
+        return size;
+    }
+
+    int skip(size_t size) override {
+        size = std::min(size, data_.size() - offs_);
+        offs_ += size;
+        return size;
+    }
+
+    int seek(size_t offset) override {
+        if (offset > data_.size()) {
+            return SYSTEM_ERROR_NOT_ENOUGH_DATA;
+        }
+        offs_ = offset;
+        return offset;
+    }
+
+    int availForRead() override {
+        return data_.size() - offs_;
+    }
+
+    int waitEvent(unsigned flags, unsigned timeout) override {
+        return 0;
+    }
+
+    unsigned readCount() const {
+        return readCount_;
+    }
+
+private:
+    std::string data_;
+    size_t offs_;
+    unsigned readCount_;
+};
+
+std::string readAt(BlockCache& cache, size_t offset, size_t size) {
+    std::string s;
+    s.resize(size);
+    const int r = cache.read(offset, &s.front(), size);
+    REQUIRE(r >= 0);
+    s.resize(r);
+    return s;
+}
+
+} // namespace
+
+TEST_CASE("BlockCache") {
+    const auto data = test::randString(1000);
+    StringInputStream stream(data);
+    BlockCache cache;
+    REQUIRE(cache.init(&stream, data.size(), 64, 4) == 0);
+
+    SECTION("reads data at arbitrary offsets") {
+        CHECK(readAt(cache, 0, 10) == data.substr(0, 10));
+        CHECK(readAt(cache, 60, 10) == data.substr(60, 10)); // Crosses a block boundary
+        CHECK(readAt(cache, 500, 200) == data.substr(500, 200)); // Spans several blocks
+        CHECK(readAt(cache, 990, 100) == data.substr(990)); // Truncated at the end
+        CHECK(readAt(cache, 0, 1000) == data);
+    }
+
+    SECTION("fails to read past the end of the data") {
+        char c = 0;
+        CHECK(cache.read(1000, &c, 1) == SYSTEM_ERROR_END_OF_STREAM);
+        const char* p = nullptr;
+        CHECK(cache.map(1000, &p) == SYSTEM_ERROR_END_OF_STREAM);
+    }
+
+    SECTION("serves repeated reads from the cache") {
+        readAt(cache, 100, 10);
+        CHECK(cache.stats().misses == 1);
+        CHECK(cache.stats().hits == 0);
+        const auto reads = stream.readCount();
+        for (int i = 0; i < 10; ++i) {
+            CHECK(readAt(cache, 64 + i * 6, 6) == data.substr(64 + i * 6, 6));
+        }
+        CHECK(stream.readCount() == reads);
+        CHECK(cache.stats().hits == 10);
+        CHECK(cache.stats().misses == 1);
+        cache.resetStats();
+        CHECK(cache.stats().hits == 0);
+    }
+
+    SECTION("evicts the least recently used block") {
+        for (size_t i = 0; i < 4; ++i) {
+            readAt(cache, i * 64, 1);
+        }
+        readAt(cache, 0, 1); // Block 1 is now the least recently used one
+        CHECK(cache.stats().evictions == 0);
+        readAt(cache, 4 * 64, 1);
+        CHECK(cache.stats().evictions == 1);
+        cache.resetStats();
+        readAt(cache, 0, 1);
+        readAt(cache, 2 * 64, 1);
+        readAt(cache, 3 * 64, 1);
+        readAt(cache, 4 * 64, 1);
+        CHECK(cache.stats().hits == 4);
+        readAt(cache, 64, 1);
+        CHECK(cache.stats().misses == 1);
+    }
+
+    SECTION("maps the cached data without copying") {
+        const char* p = nullptr;
+        CHECK(cache.map(70, &p) == 58);
+        CHECK(std::string(p, 58) == data.substr(70, 58));
+        CHECK(cache.map(999, &p) == 1);
+        CHECK(*p == data[999]);
+        // The last block is shorter than the others
+        CHECK(cache.map(960, &p) == 40);
+    }
+
+    SECTION("invalidate() discards the cached blocks") {
+        readAt(cache, 0, 1);
+        cache.invalidate();
+        readAt(cache, 0, 1);
+        CHECK(cache.stats().misses == 2);
+        CHECK(cache.stats().hits == 0);
+    }
+
+    SECTION("rejects invalid block parameters") {
+        BlockCache c;
+        CHECK(c.init(&stream, data.size(), 0, 4) == SYSTEM_ERROR_INVALID_ARGUMENT);
+        CHECK(c.init(&stream, data.size(), 64, 0) == SYSTEM_ERROR_INVALID_ARGUMENT);
+        CHECK(c.init(&stream, data.size(), BlockCache::MAX_BLOCK_SIZE + 1, 1) == SYSTEM_ERROR_INVALID_ARGUMENT);
+        CHECK(c.init(&stream, data.size(), 64, BlockCache::MAX_BLOCK_COUNT + 1) == SYSTEM_ERROR_INVALID_ARGUMENT);
+        // The product of these values wraps around on 32-bit platforms
+        CHECK(c.init(&stream, data.size(), 0x80000000u, 2) == SYSTEM_ERROR_INVALID_ARGUMENT);
+        CHECK(c.init(&stream, data.size(), BlockCache::MAX_BLOCK_SIZE, BlockCache::MAX_BLOCK_COUNT) == 0);
+        CHECK(readAt(c, 0, 1000) == data);
+    }
+
+    SECTION("reports an error if the stream is shorter than expected") {
+        BlockCache c;
+        REQUIRE(c.init(&stream, data.size() + 100, 64, 2) == 0);
+        char buf[10] = {};
+        CHECK(c.read(data.size() + 10, buf, sizeof(buf)) < 0);
+    }
+}
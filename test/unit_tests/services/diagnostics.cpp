@@ -8,6 +8,16 @@
 
 namespace {
 
+system_tick_t g_millis = 0;
+
+} // namespace
+
+system_tick_t HAL_Timer_Get_Milli_Seconds() {
+    return g_millis;
+}
+
+namespace {
+
 using namespace particle;
 
 class EnumSourcesCallback {
@@ -666,4 +676,100 @@ TEST_CASE("Wiring API") {
         testPersistentEnumDiagnosticData<PersistentEnumDiagnosticData, NoConcurrency>(diag);
         // testPersistentEnumDiagnosticData<PersistentEnumDiagnosticData, AtomicConcurrency>(diag);
     }
+
+    SECTION("HistogramDiagnosticData") {
+        HistogramDiagnosticData<8> d(1);
+        diag.start();
+
+        SECTION("bucketIndex()") {
+            CHECK(AbstractHistogramDiagnosticData::bucketIndex(0, 8) == 0);
+            CHECK(AbstractHistogramDiagnosticData::bucketIndex(1, 8) == 1);
+            CHECK(AbstractHistogramDiagnosticData::bucketIndex(2, 8) == 2);
+            CHECK(AbstractHistogramDiagnosticData::bucketIndex(3, 8) == 2);
+            CHECK(AbstractHistogramDiagnosticData::bucketIndex(4, 8) == 3);
+            CHECK(AbstractHistogramDiagnosticData::bucketIndex(64, 8) == 7);
+            CHECK(AbstractHistogramDiagnosticData::bucketIndex(UINT32_MAX, 8) == 7);
+            CHECK(AbstractHistogramDiagnosticData::bucketIndex(UINT32_MAX, DIAG_HISTOGRAM_MAX_BUCKET_COUNT) == 32);
+        }
+
+        SECTION("get() returns an empty histogram initially") {
+            diag_histogram_data val = {};
+            CHECK(AbstractHistogramDiagnosticData::get(1, val) == 0);
+            CHECK(val.count == 0);
+            CHECK(val.sum == 0);
+            CHECK(val.min == 0);
+            CHECK(val.max == 0);
+            CHECK(val.bucket_count == 8);
+        }
+
+        SECTION("record()") {
+            d.record(0);
+            d.record(5);
+            d.record(7);
+            d.record(1000);
+            CHECK(d.count() == 4);
+            diag_histogram_data val = {};
+            CHECK(AbstractHistogramDiagnosticData::get(1, val) == 0);
+            CHECK(val.count == 4);
+            CHECK(val.sum == 1012);
+            CHECK(val.min == 0);
+            CHECK(val.max == 1000);
+            CHECK(val.buckets[0] == 1);
+            CHECK(val.buckets[3] == 2);
+            CHECK(val.buckets[7] == 1);
+        }
+
+        SECTION("reset()") {
+            d.record(10);
+            d.reset();
+            diag_histogram_data val = {};
+            CHECK(AbstractHistogramDiagnosticData::get(1, val) == 0);
+            CHECK(val.count == 0);
+            CHECK(val.buckets[4] == 0);
+        }
+    }
+
+    SECTION("WindowedCounterDiagnosticData") {
+        WindowedCounterDiagnosticData<4> d(1, nullptr, 4000 /* window */);
+        diag.start();
+
+        SECTION("counts events within the window") {
+            d.add(1, 0);
+            d.add(2, 1500);
+            d.add(3, 3999);
+            CHECK(d.windowCount(3999) == 6);
+            CHECK(d.total() == 6);
+        }
+
+        SECTION("drops events that are older than the window") {
+            d.add(1, 0);
+            d.add(2, 1500);
+            CHECK(d.windowCount(4000) == 2);
+            CHECK(d.windowCount(4999) == 2);
+            CHECK(d.windowCount(5000) == 0);
+            CHECK(d.total() == 3);
+        }
+
+        SECTION("reuses expired slots") {
+            d.add(5, 500);
+            d.add(1, 4500);
+            CHECK(d.windowCount(4500) == 1);
+        }
+
+        SECTION("get()") {
+            g_millis = 10000;
+            ++d;
+            d.add(2);
+            diag_counter_data val = {};
+            CHECK(AbstractCounterDiagnosticData::get(1, val) == 0);
+            CHECK(val.total == 3);
+            CHECK(val.window_count == 3);
+            CHECK(val.window == 4000);
+            g_millis = 20000;
+            CHECK(AbstractCounterDiagnosticData::get(1, val) == 0);
+            CHECK(val.total == 3);
+            CHECK(val.window_count == 0);
+            g_millis = 0;
+        }
+    }
 }
@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "heap_tracking.h"
+#include "timer_hal.h"
+#include "system_error.h"
+
+#include <catch2/catch.hpp>
+
+#include <string>
+#include <cstdlib>
+
+namespace {
+
+uint64_t g_millis = 0;
+
+// Allocates memory the same way the platform allocator does when heap tracking is enabled
+void* trackedMalloc(size_t size, size_t offset = HEAP_TRACKING_HEADER_SIZE) {
+    const auto block = std::malloc(size + offset);
+    REQUIRE(block);
+    return heap_tracking_on_alloc(block, size, offset, -1 /* tag */);
+}
+
+void trackedFree(void* ptr) {
+    std::free(heap_tracking_on_free(ptr, nullptr /* size */, nullptr /* tag */));
+}
+
+heap_tag_stats tagStats(int tag) {
+    heap_tag_stats s = {};
+    REQUIRE(heap_tracking_get_stats(tag, &s, nullptr) == 0);
+    return s;
+}
+
+bool appendToString(void* data, const uint8_t* buf, size_t size) {
+    static_cast<std::string*>(data)->append((const char*)buf, size);
+    return true;
+}
+
+uint32_t readUint32(const std::string& s, size_t offs) {
+    const auto p = (const uint8_t*)s.data() + offs;
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+} // namespace
+
+uint64_t hal_timer_millis(void* reserved) {
+    return g_millis;
+}
+
+TEST_CASE("heap_tag_enter()") {
+    SECTION("sets the tag of the current thread until the scope is left") {
+        CHECK(heap_tag_current(nullptr) == HEAP_TAG_OTHER);
+        {
+            HEAP_TAG_SCOPE(HEAP_TAG_SYSTEM);
+            CHECK(heap_tag_current(nullptr) == HEAP_TAG_SYSTEM);
+            {
+                HEAP_TAG_SCOPE(HEAP_TAG_PROTOCOL);
+                CHECK(heap_tag_current(nullptr) == HEAP_TAG_PROTOCOL);
+            }
+            CHECK(heap_tag_current(nullptr) == HEAP_TAG_SYSTEM);
+        }
+        CHECK(heap_tag_current(nullptr) == HEAP_TAG_OTHER);
+    }
+
+    SECTION("rejects invalid tags") {
+        CHECK(heap_tag_enter(HEAP_TAG_COUNT, nullptr) == SYSTEM_ERROR_INVALID_ARGUMENT);
+        CHECK(heap_tag_enter(-1, nullptr) == SYSTEM_ERROR_INVALID_ARGUMENT);
+        heap_tag_leave(SYSTEM_ERROR_INVALID_ARGUMENT, nullptr);
+        CHECK(heap_tag_current(nullptr) == HEAP_TAG_OTHER);
+    }
+}
+
+TEST_CASE("heap_tracking_on_alloc()") {
+    SECTION("attributes allocations to the tag of the current scope") {
+        const auto s1 = tagStats(HEAP_TAG_LEDGER);
+        const auto s2 = tagStats(HEAP_TAG_USER);
+        void* p1 = nullptr;
+        void* p2 = nullptr;
+        {
+            HEAP_TAG_SCOPE(HEAP_TAG_LEDGER);
+            p1 = trackedMalloc(100);
+            {
+                HEAP_TAG_SCOPE(HEAP_TAG_USER);
+                p2 = trackedMalloc(30);
+            }
+        }
+        CHECK(heap_tracking_alloc_size(p1) == 100);
+        CHECK(heap_tracking_alloc_size(p2) == 30);
+        auto s = tagStats(HEAP_TAG_LEDGER);
+        CHECK(s.used_size == s1.used_size + 100);
+        CHECK(s.alloc_count == s1.alloc_count + 1);
+        s = tagStats(HEAP_TAG_USER);
+        CHECK(s.used_size == s2.used_size + 30);
+        CHECK(s.alloc_count == s2.alloc_count + 1);
+        // The memory is freed from a different scope but is still accounted to the original tag
+        trackedFree(p1);
+        trackedFree(p2);
+        s = tagStats(HEAP_TAG_LEDGER);
+        CHECK(s.used_size == s1.used_size);
+        CHECK(s.free_count == s1.free_count + 1);
+        s = tagStats(HEAP_TAG_USER);
+        CHECK(s.used_size == s2.used_size);
+        CHECK(s.free_count == s2.free_count + 1);
+    }
+
+    SECTION("tracks the peak usage") {
+        HEAP_TAG_SCOPE(HEAP_TAG_BLE);
+        const auto used = tagStats(HEAP_TAG_BLE).used_size;
+        auto p1 = trackedMalloc(1000);
+        auto p2 = trackedMalloc(2000);
+        trackedFree(p1);
+        auto p3 = trackedMalloc(500);
+        auto s = tagStats(HEAP_TAG_BLE);
+        CHECK(s.used_size == used + 2500);
+        CHECK(s.peak_size >= used + 3000);
+        trackedFree(p2);
+        trackedFree(p3);
+        CHECK(tagStats(HEAP_TAG_BLE).used_size == used);
+    }
+
+    SECTION("uses an explicitly specified tag") {
+        const auto used = tagStats(HEAP_TAG_NCP).used_size;
+        const auto block = std::malloc(64 + HEAP_TRACKING_HEADER_SIZE);
+        const auto p = heap_tracking_on_alloc(block, 64, HEAP_TRACKING_HEADER_SIZE, HEAP_TAG_NCP);
+        CHECK(tagStats(HEAP_TAG_NCP).used_size == used + 64);
+        size_t size = 0;
+        int tag = -1;
+        CHECK(heap_tracking_on_free(p, &size, &tag) == block);
+        CHECK(size == 64);
+        CHECK(tag == HEAP_TAG_NCP);
+        CHECK(tagStats(HEAP_TAG_NCP).used_size == used);
+        std::free(block);
+    }
+
+    SECTION("supports blocks with a larger alignment") {
+        const size_t offset = 64;
+        const auto block = std::malloc(100 + offset);
+        const auto p = heap_tracking_on_alloc(block, 100, offset, -1 /* tag */);
+        CHECK(p == (char*)block + offset);
+        CHECK(heap_tracking_on_free(p, nullptr, nullptr) == block);
+        std::free(block);
+    }
+
+    SECTION("measures the allocation rate over a time window") {
+        HEAP_TAG_SCOPE(HEAP_TAG_NETWORK);
+        g_millis += 10 * HEAP_TRACKING_RATE_WINDOW;
+        trackedFree(trackedMalloc(1)); // Start a new window
+        CHECK(tagStats(HEAP_TAG_NETWORK).alloc_rate == 0);
+        for (int i = 0; i < 9; ++i) {
+            trackedFree(trackedMalloc(1));
+        }
+        g_millis += HEAP_TRACKING_RATE_WINDOW / 2;
+        // The current window is not complete yet
+        CHECK(tagStats(HEAP_TAG_NETWORK).alloc_rate == 0);
+        g_millis += HEAP_TRACKING_RATE_WINDOW / 2;
+        CHECK(tagStats(HEAP_TAG_NETWORK).alloc_rate == 10);
+        trackedFree(trackedMalloc(1)); // Start a new window
+        CHECK(tagStats(HEAP_TAG_NETWORK).alloc_rate == 10);
+        // The rate drops to 0 if no allocations were made during the last complete window
+        g_millis += 2 * HEAP_TRACKING_RATE_WINDOW;
+        CHECK(tagStats(HEAP_TAG_NETWORK).alloc_rate == 0);
+    }
+}
+
+TEST_CASE("heap_tracking_format()") {
+    SECTION("serializes the statistics of all tags") {
+        HEAP_TAG_SCOPE(HEAP_TAG_PROTOCOL);
+        auto p = trackedMalloc(123);
+        std::string s;
+        REQUIRE(heap_tracking_format(1024, appendToString, &s, nullptr) == 0);
+        REQUIRE(s.size() == 8 + HEAP_TAG_COUNT * 24);
+        CHECK((uint8_t)s[0] == HEAP_TRACKING_FORMAT_VERSION);
+        CHECK((uint8_t)s[1] == HEAP_TAG_COUNT);
+        CHECK(readUint32(s, 4) == HEAP_TRACKING_RATE_WINDOW);
+        for (int tag = 0; tag < HEAP_TAG_COUNT; ++tag) {
+            const size_t offs = 8 + tag * 24;
+            const auto st = tagStats(tag);
+            CHECK((uint8_t)s[offs] == tag);
+            CHECK(readUint32(s, offs + 4) == st.used_size);
+            CHECK(readUint32(s, offs + 8) == st.peak_size);
+            CHECK(readUint32(s, offs + 12) == st.alloc_count);
+            CHECK(readUint32(s, offs + 16) == st.free_count);
+            CHECK(readUint32(s, offs + 20) == st.alloc_rate);
+        }
+        CHECK(readUint32(s, 8 + HEAP_TAG_PROTOCOL * 24 + 4) >= 123);
+        trackedFree(p);
+    }
+
+    SECTION("fails if the output doesn't fit in the buffer") {
+        std::string s;
+        CHECK(heap_tracking_format(100, appendToString, &s, nullptr) == SYSTEM_ERROR_TOO_LARGE);
+        CHECK(s.empty());
+    }
+
+    SECTION("tags have names") {
+        CHECK(std::string(heap_tag_name(HEAP_TAG_USER)) == "app");
+        CHECK(heap_tag_name(HEAP_TAG_COUNT) == nullptr);
+    }
+}
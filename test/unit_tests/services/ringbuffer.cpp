@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ringbuffer.h"
+
+#include <catch2/catch.hpp>
+
+#include <cstring>
+
+using particle::services::RingBuffer;
+
+TEST_CASE("RingBuffer zero-copy API") {
+    char buf[8] = {};
+    RingBuffer<char> rb(buf, sizeof(buf));
+
+    SECTION("acquireWrite() returns the contiguous free region and keeps one element unused") {
+        size_t n = 0;
+        auto p = rb.acquireWrite(&n);
+        CHECK(p == buf);
+        CHECK(n == 7);
+        memcpy(p, "abcde", 5);
+        CHECK(rb.commitWrite(5) == 5);
+        CHECK(rb.data() == 5);
+        p = rb.peekRead(&n);
+        CHECK(p == buf);
+        CHECK(n == 5);
+        CHECK(memcmp(p, "abcde", 5) == 0);
+    }
+
+    SECTION("regions are split at the end of the buffer") {
+        size_t n = 0;
+        rb.acquireWrite(&n);
+        rb.commitWrite(5);
+        rb.peekRead(&n);
+        rb.commitRead(3);
+        auto p = rb.acquireWrite(&n);
+        CHECK(p == buf + 5);
+        CHECK(n == 3);
+        rb.commitWrite(3);
+        p = rb.acquireWrite(&n);
+        CHECK(p == buf);
+        CHECK(n == 2);
+        rb.commitWrite(2);
+        p = rb.acquireWrite(&n);
+        CHECK(p == nullptr);
+        CHECK(n == 0);
+        CHECK(!rb.full());
+        CHECK(rb.data() == 7);
+        p = rb.peekRead(&n);
+        CHECK(p == buf + 3);
+        CHECK(n == 5);
+        rb.commitRead(5);
+        p = rb.peekRead(&n);
+        CHECK(p == buf);
+        CHECK(n == 2);
+        rb.commitRead(2);
+        p = rb.peekRead(&n);
+        CHECK(p == nullptr);
+        CHECK(n == 0);
+        CHECK(rb.empty());
+    }
+
+    SECTION("peekRead() can be used with a buffer filled via put()") {
+        CHECK(rb.put("abcdefgh", 8) == 8);
+        CHECK(rb.full());
+        size_t n = 0;
+        auto p = rb.peekRead(&n);
+        CHECK(p == buf);
+        CHECK(n == 8);
+        rb.commitRead(8);
+        CHECK(rb.empty());
+    }
+
+    SECTION("commits larger than the acquired or peeked region are rejected") {
+        size_t n = 0;
+        rb.acquireWrite(&n);
+        CHECK(n == 7);
+        CHECK(rb.commitWrite(8) == SYSTEM_ERROR_TOO_LARGE);
+        CHECK(rb.empty());
+        CHECK(rb.commitWrite(4) == 4);
+        CHECK(rb.commitRead(5) == SYSTEM_ERROR_TOO_LARGE);
+        CHECK(rb.data() == 4);
+        CHECK(rb.commitRead(4) == 4);
+        CHECK(rb.empty());
+    }
+}
@@ -0,0 +1,306 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tlsf.h"
+
+#include <catch2/catch.hpp>
+
+#include <vector>
+#include <memory>
+#include <random>
+#include <cstring>
+
+using namespace particle;
+
+namespace {
+
+const size_t POOL_SIZE = 64 * 1024;
+
+class Heap {
+public:
+    explicit Heap(size_t size = POOL_SIZE) :
+            mem_(new char[size]),
+            size_(size) {
+        REQUIRE(tlsf_.addPool(mem_.get(), size_) == 0);
+        REQUIRE(tlsf_.check() == 0);
+    }
+
+    Tlsf* operator->() {
+        return &tlsf_;
+    }
+
+    Tlsf::Stats stats() const {
+        Tlsf::Stats s = {};
+        tlsf_.getStats(&s);
+        return s;
+    }
+
+    bool contains(const void* ptr, size_t size) const {
+        return (const char*)ptr >= mem_.get() && (const char*)ptr + size <= mem_.get() + size_;
+    }
+
+private:
+    Tlsf tlsf_;
+    std::unique_ptr<char[]> mem_;
+    size_t size_;
+};
+
+} // namespace
+
+TEST_CASE("Tlsf") {
+    SECTION("allocates aligned blocks within the pool") {
+        Heap h;
+        std::vector<void*> ptrs;
+        for (size_t size = 1; size < 2000; size += 37) {
+            auto p = h->alloc(size);
+            REQUIRE(p);
+            CHECK((uintptr_t)p % Tlsf::ALIGNMENT == 0);
+            CHECK(Tlsf::blockSize(p) >= size);
+            CHECK(h.contains(p, size));
+            std::memset(p, 0xaa, size);
+            ptrs.push_back(p);
+        }
+        CHECK(h->check() == 0);
+        CHECK(h.stats().usedBlockCount == ptrs.size());
+        for (auto p: ptrs) {
+            h->free(p);
+        }
+        CHECK(h->check() == 0);
+        auto s = h.stats();
+        CHECK(s.usedBlockCount == 0);
+        CHECK(s.freeBlockCount == 1);
+        CHECK(s.freeSize == s.totalSize - Tlsf::BLOCK_OVERHEAD);
+    }
+
+    SECTION("returns nullptr for zero-sized and oversized requests") {
+        Heap h;
+        CHECK(h->alloc(0) == nullptr);
+        CHECK(h->alloc(POOL_SIZE) == nullptr);
+        CHECK(h->alloc(Tlsf::MAX_BLOCK_SIZE + 1) == nullptr);
+        CHECK(h->check() == 0);
+    }
+
+    SECTION("merges adjacent free blocks") {
+        Heap h;
+        auto p1 = h->alloc(100);
+        auto p2 = h->alloc(100);
+        auto p3 = h->alloc(100);
+        auto p4 = h->alloc(100);
+        REQUIRE((p1 && p2 && p3 && p4));
+        h->free(p1);
+        h->free(p3);
+        CHECK(h.stats().freeBlockCount == 3);
+        h->free(p2);
+        CHECK(h.stats().freeBlockCount == 2);
+        CHECK(h->check() == 0);
+        h->free(p4);
+        CHECK(h.stats().freeBlockCount == 1);
+        CHECK(h->check() == 0);
+    }
+
+    SECTION("can allocate the largest free block") {
+        Heap h;
+        auto p1 = h->alloc(1000);
+        auto p2 = h->alloc(10);
+        REQUIRE((p1 && p2));
+        h->free(p1);
+        auto size = h->largestFreeBlock();
+        CHECK(size > POOL_SIZE - 2048);
+        auto p = h->alloc(size);
+        CHECK(p);
+        CHECK(h->alloc(size) == nullptr);
+        // The block preceding the small allocation can be allocated too
+        size = h->largestFreeBlock();
+        CHECK(size >= 1000);
+        CHECK(h->alloc(size) == p1);
+        CHECK(h->largestFreeBlock() == 0);
+        CHECK(h->check() == 0);
+    }
+
+    SECTION("grows a block in place if the following block is free") {
+        Heap h;
+        auto p1 = h->alloc(100);
+        REQUIRE(p1);
+        std::memset(p1, 0x5a, 100);
+        auto p2 = h->realloc(p1, 1000);
+        CHECK(p2 == p1);
+        CHECK(Tlsf::blockSize(p2) >= 1000);
+        for (size_t i = 0; i < 100; ++i) {
+            REQUIRE(((uint8_t*)p2)[i] == 0x5a);
+        }
+        CHECK(h.stats().freeBlockCount == 1);
+        CHECK(h->check() == 0);
+    }
+
+    SECTION("moves a block if it can't grow in place") {
+        Heap h;
+        auto p1 = h->alloc(100);
+        auto p2 = h->alloc(100);
+        REQUIRE((p1 && p2));
+        std::memset(p1, 0x5a, 100);
+        auto p3 = h->realloc(p1, 1000);
+        REQUIRE(p3);
+        CHECK(p3 != p1);
+        for (size_t i = 0; i < 100; ++i) {
+            REQUIRE(((uint8_t*)p3)[i] == 0x5a);
+        }
+        CHECK(h.stats().usedBlockCount == 2);
+        CHECK(h->check() == 0);
+    }
+
+    SECTION("shrinks a block in place and releases its tail") {
+        Heap h;
+        auto p1 = h->alloc(1000);
+        auto p2 = h->alloc(100);
+        REQUIRE((p1 && p2));
+        const auto freeSize = h.stats().freeSize;
+        const auto blockSize = Tlsf::blockSize(p1);
+        auto p3 = h->realloc(p1, 100);
+        CHECK(p3 == p1);
+        CHECK(Tlsf::blockSize(p3) < 1000);
+        CHECK(h.stats().freeSize == freeSize + blockSize - Tlsf::blockSize(p3));
+        CHECK(h.stats().freeBlockCount == 2);
+        // The released tail can be used to grow the block again
+        CHECK(h->realloc(p3, 1000) == p1);
+        CHECK(h.stats().freeBlockCount == 1);
+        CHECK(h->check() == 0);
+    }
+
+    SECTION("keeps the block unchanged if it can't be resized") {
+        Heap h;
+        auto p1 = h->alloc(100);
+        REQUIRE(p1);
+        CHECK(h->realloc(p1, POOL_SIZE) == nullptr);
+        CHECK(Tlsf::blockSize(p1) >= 100);
+        CHECK(h.stats().usedBlockCount == 1);
+        CHECK(h->realloc(p1, 0) == nullptr);
+        CHECK(h.stats().usedBlockCount == 0);
+        CHECK(h->check() == 0);
+    }
+
+    SECTION("tracks the minimum amount of free memory") {
+        Heap h;
+        const auto initial = h.stats().freeSize;
+        CHECK(h.stats().minFreeSize == initial);
+        auto p = h->alloc(4000);
+        REQUIRE(p);
+        const auto minFree = h.stats().freeSize;
+        h->free(p);
+        auto s = h.stats();
+        CHECK(s.freeSize == initial);
+        CHECK(s.minFreeSize == minFree);
+    }
+
+    SECTION("supports multiple pools") {
+        Heap h(4096);
+        std::unique_ptr<char[]> mem(new char[8192]);
+        REQUIRE(h->addPool(mem.get(), 8192) == 0);
+        CHECK(h->check() == 0);
+        auto p1 = h->alloc(6000);
+        REQUIRE(p1);
+        CHECK((p1 >= mem.get() && p1 < mem.get() + 8192));
+        auto p2 = h->alloc(3000);
+        REQUIRE(p2);
+        CHECK(h.contains(p2, 3000));
+        h->free(p1);
+        h->free(p2);
+        auto s = h.stats();
+        CHECK(s.freeBlockCount == 2);
+        CHECK(s.freeSize == s.totalSize - 2 * Tlsf::BLOCK_OVERHEAD);
+        CHECK(h->check() == 0);
+    }
+
+    SECTION("supports blocks of the maximum size") {
+        // The pool memory is not accessed beyond the block headers
+        const size_t size = Tlsf::MAX_BLOCK_SIZE + Tlsf::POOL_OVERHEAD;
+        std::unique_ptr<char[]> mem(new char[size]);
+        Tlsf t;
+        REQUIRE(t.addPool(mem.get(), size) == 0);
+        CHECK(t.check() == 0);
+        CHECK(t.largestFreeBlock() == Tlsf::MAX_BLOCK_SIZE);
+        auto p = t.alloc(Tlsf::MAX_BLOCK_SIZE);
+        REQUIRE(p);
+        CHECK(Tlsf::blockSize(p) == Tlsf::MAX_BLOCK_SIZE);
+        CHECK(t.alloc(1) == nullptr);
+        t.free(p);
+        CHECK(t.check() == 0);
+        CHECK(t.largestFreeBlock() == Tlsf::MAX_BLOCK_SIZE);
+    }
+
+    SECTION("rejects pools that are too small") {
+        Tlsf t;
+        char buf[Tlsf::POOL_OVERHEAD];
+        CHECK(t.addPool(buf, sizeof(buf)) < 0);
+        CHECK(t.addPool(nullptr, 1024) < 0);
+        CHECK(t.alloc(1) == nullptr);
+    }
+
+    SECTION("stays consistent under a random workload") {
+        Heap h;
+        std::mt19937 gen(12345);
+        std::uniform_int_distribution<size_t> sizeDist(1, 2048);
+        std::uniform_int_distribution<int> opDist(0, 2);
+        struct Alloc {
+            uint8_t* ptr;
+            size_t size;
+            uint8_t fill;
+        };
+        std::vector<Alloc> allocs;
+        for (int i = 0; i < 20000; ++i) {
+            const int op = allocs.empty() ? 0 : opDist(gen);
+            if (op == 0) {
+                const auto size = sizeDist(gen);
+                auto p = (uint8_t*)h->alloc(size);
+                if (p) {
+                    const uint8_t fill = gen();
+                    std::memset(p, fill, size);
+                    allocs.push_back({ p, size, fill });
+                }
+            } else {
+                const auto index = gen() % allocs.size();
+                auto& a = allocs[index];
+                for (size_t j = 0; j < a.size; ++j) {
+                    REQUIRE(a.ptr[j] == a.fill);
+                }
+                if (op == 1) {
+                    h->free(a.ptr);
+                    allocs.erase(allocs.begin() + index);
+                } else {
+                    const auto size = sizeDist(gen);
+                    auto p = (uint8_t*)h->realloc(a.ptr, size);
+                    if (p) {
+                        for (size_t j = 0; j < std::min(size, a.size); ++j) {
+                            REQUIRE(p[j] == a.fill);
+                        }
+                        std::memset(p, a.fill, size);
+                        a.ptr = p;
+                        a.size = size;
+                    }
+                }
+            }
+            if (i % 100 == 0) {
+                REQUIRE(h->check() == 0);
+                REQUIRE(h.stats().usedBlockCount == allocs.size());
+            }
+        }
+        for (auto& a: allocs) {
+            h->free(a.ptr);
+        }
+        CHECK(h->check() == 0);
+        CHECK(h.stats().freeBlockCount == 1);
+    }
+}
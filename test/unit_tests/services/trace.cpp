@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "trace.h"
+#include "timer_hal.h"
+#include "system_error.h"
+
+#include <catch2/catch.hpp>
+
+#include <string>
+#include <vector>
+#include <cstring>
+
+namespace {
+
+system_tick_t g_micros = 0;
+
+struct Event {
+    uint32_t time;
+    uint32_t thread;
+    int type;
+    std::string name;
+};
+
+struct Chunk {
+    unsigned version;
+    uint32_t first;
+    uint32_t next;
+    std::vector<Event> events;
+};
+
+bool appendToString(void* data, const uint8_t* buf, size_t size) {
+    static_cast<std::string*>(data)->append((const char*)buf, size);
+    return true;
+}
+
+uint32_t readUint32(const std::string& s, size_t offs) {
+    const auto p = (const uint8_t*)s.data() + offs;
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+Chunk parseChunk(const std::string& s) {
+    REQUIRE(s.size() >= 12);
+    Chunk c;
+    c.version = (uint8_t)s[0];
+    const unsigned count = (uint8_t)s[2] | ((uint8_t)s[3] << 8);
+    c.first = readUint32(s, 4);
+    c.next = readUint32(s, 8);
+    size_t offs = 12;
+    for (unsigned i = 0; i < count; ++i) {
+        REQUIRE(s.size() >= offs + 10);
+        Event e;
+        e.time = readUint32(s, offs);
+        e.thread = readUint32(s, offs + 4);
+        e.type = (uint8_t)s[offs + 8];
+        const size_t nameSize = (uint8_t)s[offs + 9];
+        offs += 10;
+        REQUIRE(s.size() >= offs + nameSize);
+        e.name = s.substr(offs, nameSize);
+        offs += nameSize;
+        c.events.push_back(e);
+    }
+    CHECK(offs == s.size());
+    return c;
+}
+
+Chunk readChunk(uint32_t* pos, size_t maxSize = 4096) {
+    std::string s;
+    const int r = trace_format(pos, maxSize, appendToString, &s, nullptr);
+    REQUIRE(r >= 0);
+    auto c = parseChunk(s);
+    CHECK(c.events.size() == (size_t)r);
+    return c;
+}
+
+// Returns the index of the next event to be recorded
+uint32_t currentPos() {
+    uint32_t pos = 0;
+    while (!readChunk(&pos).events.empty()) {
+    }
+    return pos;
+}
+
+} // namespace
+
+system_tick_t HAL_Timer_Get_Micro_Seconds() {
+    return g_micros;
+}
+
+TEST_CASE("trace_event()") {
+    uint32_t pos = currentPos();
+
+    SECTION("records events of all types") {
+        g_micros = 100;
+        TRACE_BEGIN("a");
+        g_micros = 200;
+        TRACE_INSTANT("b");
+        g_micros = 300;
+        TRACE_END("a");
+        auto c = readChunk(&pos);
+        CHECK(c.version == TRACE_FORMAT_VERSION);
+        CHECK(c.next == c.first + 3);
+        CHECK(pos == c.next);
+        REQUIRE(c.events.size() == 3);
+        CHECK(c.events[0].time == 100);
+        CHECK(c.events[0].type == TRACE_EVENT_BEGIN);
+        CHECK(c.events[0].name == "a");
+        CHECK(c.events[1].time == 200);
+        CHECK(c.events[1].type == TRACE_EVENT_INSTANT);
+        CHECK(c.events[1].name == "b");
+        CHECK(c.events[2].time == 300);
+        CHECK(c.events[2].type == TRACE_EVENT_END);
+        CHECK(c.events[2].name == "a");
+    }
+
+    SECTION("TRACE_SCOPE() records a duration") {
+        {
+            g_micros = 1000;
+            TRACE_SCOPE("scope");
+            g_micros = 1500;
+        }
+        auto c = readChunk(&pos);
+        REQUIRE(c.events.size() == 2);
+        CHECK(c.events[0].type == TRACE_EVENT_BEGIN);
+        CHECK(c.events[0].time == 1000);
+        CHECK(c.events[1].type == TRACE_EVENT_END);
+        CHECK(c.events[1].time == 1500);
+        CHECK(c.events[1].name == "scope");
+    }
+}
+
+TEST_CASE("trace_format()") {
+    uint32_t pos = currentPos();
+
+    SECTION("returns no events if there are no new events") {
+        auto c = readChunk(&pos);
+        CHECK(c.events.empty());
+        CHECK(c.first == pos);
+        CHECK(c.next == pos);
+    }
+
+    SECTION("continues from the given position") {
+        TRACE_INSTANT("1");
+        TRACE_INSTANT("2");
+        auto c = readChunk(&pos);
+        CHECK(c.events.size() == 2);
+        TRACE_INSTANT("3");
+        c = readChunk(&pos);
+        REQUIRE(c.events.size() == 1);
+        CHECK(c.events[0].name == "3");
+    }
+
+    SECTION("limits the size of the output") {
+        for (int i = 0; i < 5; ++i) {
+            TRACE_INSTANT("event"); // 15 bytes per event
+        }
+        auto c = readChunk(&pos, 12 + 15 * 2 + 14);
+        CHECK(c.events.size() == 2);
+        c = readChunk(&pos);
+        CHECK(c.events.size() == 3);
+    }
+
+    SECTION("skips the events that have been overwritten") {
+        const uint32_t start = pos;
+        for (int i = 0; i < TRACE_BUFFER_SIZE + 10; ++i) {
+            TRACE_INSTANT("x");
+        }
+        auto c = readChunk(&pos);
+        CHECK(c.first == start + 10);
+        uint32_t n = c.events.size();
+        while (!(c = readChunk(&pos)).events.empty()) {
+            CHECK(c.first == start + 10 + n);
+            n += c.events.size();
+        }
+        CHECK(n == TRACE_BUFFER_SIZE);
+    }
+
+    SECTION("fails if the output size is too small") {
+        std::string s;
+        CHECK(trace_format(&pos, 11, appendToString, &s, nullptr) == SYSTEM_ERROR_INVALID_ARGUMENT);
+    }
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "file_util.h"
+#include "system_error.h"
+#include "check.h"
+
+#include <string>
+#include <vector>
+#include <cstring>
+
+// Simplified versions of the directory helpers that only use the LittleFS API and thus work with
+// the mock filesystem
+
+namespace particle {
+
+using fs::FsLock;
+
+int rmrf(const char* path) {
+    FsLock fs;
+    lfs_info info = {};
+    int r = lfs_stat(fs.instance(), path, &info);
+    if (r == LFS_ERR_NOENT) {
+        return 0;
+    }
+    CHECK_FS(r);
+    if (info.type == LFS_TYPE_DIR) {
+        std::vector<std::string> names;
+        lfs_dir_t dir = {};
+        CHECK_FS(lfs_dir_open(fs.instance(), &dir, path));
+        while ((r = lfs_dir_read(fs.instance(), &dir, &info)) == 1) {
+            if (strcmp(info.name, ".") != 0 && strcmp(info.name, "..") != 0) {
+                names.push_back(info.name);
+            }
+        }
+        lfs_dir_close(fs.instance(), &dir);
+        CHECK_FS(r);
+        for (const auto& name: names) {
+            CHECK(rmrf((std::string(path) + '/' + name).c_str()));
+        }
+    }
+    CHECK_FS(lfs_remove(fs.instance(), path));
+    return 0;
+}
+
+int mkdirp(const char* path) {
+    FsLock fs;
+    const std::string p(path);
+    size_t pos = (p.size() && p[0] == '/') ? 1 : 0;
+    for (;;) {
+        pos = p.find('/', pos);
+        const auto dir = p.substr(0, pos);
+        if (!dir.empty() && dir.back() != '/') {
+            int r = lfs_mkdir(fs.instance(), dir.c_str());
+            if (r < 0 && r != LFS_ERR_EXIST) {
+                CHECK_FS(r);
+            }
+        }
+        if (pos == std::string::npos) {
+            break;
+        }
+        ++pos;
+    }
+    return 0;
+}
+
+} // namespace particle
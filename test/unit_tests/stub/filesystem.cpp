@@ -16,6 +16,7 @@
  */
 
 #include "filesystem.h"
+#include "system_error.h"
 
 filesystem_t* filesystem_get_instance(filesystem_instance_t index, void* reserved) {
     static filesystem_t fs;
@@ -30,6 +31,29 @@ int filesystem_unlock(filesystem_t* fs) {
     return 0;
 }
 
+int filesystem_mount(filesystem_t* fs) {
+    return 0;
+}
+
+int filesystem_to_system_error(int error) {
+    switch (error) {
+    case LFS_ERR_OK: return SYSTEM_ERROR_NONE;
+    case LFS_ERR_IO: return SYSTEM_ERROR_FILESYSTEM_IO;
+    case LFS_ERR_CORRUPT: return SYSTEM_ERROR_FILESYSTEM_CORRUPT;
+    case LFS_ERR_NOENT: return SYSTEM_ERROR_FILESYSTEM_NOENT;
+    case LFS_ERR_EXIST: return SYSTEM_ERROR_FILESYSTEM_EXIST;
+    case LFS_ERR_NOTDIR: return SYSTEM_ERROR_FILESYSTEM_NOTDIR;
+    case LFS_ERR_ISDIR: return SYSTEM_ERROR_FILESYSTEM_ISDIR;
+    case LFS_ERR_NOTEMPTY: return SYSTEM_ERROR_FILESYSTEM_NOTEMPTY;
+    case LFS_ERR_BADF: return SYSTEM_ERROR_FILESYSTEM_BADF;
+    case LFS_ERR_FBIG: return SYSTEM_ERROR_FILESYSTEM_FBIG;
+    case LFS_ERR_INVAL: return SYSTEM_ERROR_FILESYSTEM_INVAL;
+    case LFS_ERR_NOSPC: return SYSTEM_ERROR_FILESYSTEM_NOSPC;
+    case LFS_ERR_NOMEM: return SYSTEM_ERROR_FILESYSTEM_NOMEM;
+    default: return SYSTEM_ERROR_FILESYSTEM;
+    }
+}
+
 int lfs_file_open(lfs_t* lfs, lfs_file_t* file, const char* path, int flags) {
     return 0;
 }
@@ -69,3 +93,27 @@ int lfs_file_sync(lfs_t* lfs, lfs_file_t* file) {
 int lfs_remove(lfs_t* lfs, const char* path) {
     return 0;
 }
+
+int lfs_rename(lfs_t* lfs, const char* oldpath, const char* newpath) {
+    return 0;
+}
+
+int lfs_stat(lfs_t* lfs, const char* path, struct lfs_info* info) {
+    return LFS_ERR_NOENT;
+}
+
+int lfs_mkdir(lfs_t* lfs, const char* path) {
+    return 0;
+}
+
+int lfs_dir_open(lfs_t* lfs, lfs_dir_t* dir, const char* path) {
+    return LFS_ERR_NOENT;
+}
+
+int lfs_dir_close(lfs_t* lfs, lfs_dir_t* dir) {
+    return 0;
+}
+
+int lfs_dir_read(lfs_t* lfs, lfs_dir_t* dir, struct lfs_info* info) {
+    return 0;
+}
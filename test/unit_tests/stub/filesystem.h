@@ -55,6 +55,15 @@ enum lfs_open_flags {
     LFS_O_APPEND = 0x0800
 };
 
+enum lfs_type {
+    LFS_TYPE_REG = 0x001,
+    LFS_TYPE_DIR = 0x002
+};
+
+#ifndef LFS_NAME_MAX
+#define LFS_NAME_MAX 255
+#endif
+
 enum lfs_whence_flags {
     LFS_SEEK_SET = 0,
     LFS_SEEK_CUR = 1,
@@ -70,6 +79,17 @@ typedef struct lfs_file {
     int fd;
 } lfs_file_t;
 
+typedef struct lfs_dir {
+    size_t pos;
+    int fd;
+} lfs_dir_t;
+
+struct lfs_info {
+    uint8_t type;
+    lfs_size_t size;
+    char name[LFS_NAME_MAX + 1];
+};
+
 typedef struct {
     lfs_t instance;
 } filesystem_t;
@@ -93,22 +113,39 @@ lfs_soff_t lfs_file_tell(lfs_t* lfs, lfs_file_t* file);
 int lfs_file_truncate(lfs_t* lfs, lfs_file_t* file, lfs_off_t size);
 int lfs_file_sync(lfs_t* lfs, lfs_file_t* file);
 int lfs_remove(lfs_t* lfs, const char* path);
+int lfs_rename(lfs_t* lfs, const char* oldpath, const char* newpath);
+int lfs_stat(lfs_t* lfs, const char* path, struct lfs_info* info);
+int lfs_mkdir(lfs_t* lfs, const char* path);
+int lfs_dir_open(lfs_t* lfs, lfs_dir_t* dir, const char* path);
+int lfs_dir_close(lfs_t* lfs, lfs_dir_t* dir);
+int lfs_dir_read(lfs_t* lfs, lfs_dir_t* dir, struct lfs_info* info);
 // TODO: Add stubs for remaining API functions
 
 filesystem_t* filesystem_get_instance(filesystem_instance_t index, void* reserved);
 int filesystem_lock(filesystem_t* fs);
 int filesystem_unlock(filesystem_t* fs);
+int filesystem_mount(filesystem_t* fs);
+int filesystem_to_system_error(int error);
 
 #ifdef __cplusplus
 } // extern "C"
 
+#define CHECK_FS(expr) \
+        ({ \
+            auto _r = expr; \
+            if (_r < 0) { \
+                return filesystem_to_system_error(_r); \
+            } \
+            _r; \
+        })
+
 namespace particle {
 
 namespace fs {
 
 class FsLock {
 public:
-    FsLock(filesystem_t* fs)
+    explicit FsLock(filesystem_t* fs = filesystem_get_instance(FILESYSTEM_INSTANCE_DEFAULT, nullptr))
             : fs_(fs) {
         lock();
     }
@@ -125,6 +162,10 @@ public:
         filesystem_unlock(fs_);
     }
 
+    lfs_t* instance() const {
+        return &fs_->instance;
+    }
+
 private:
     filesystem_t* fs_;
 };
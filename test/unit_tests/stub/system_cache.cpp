@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "system_cache.h"
+#include "system_error.h"
+
+#include <algorithm>
+#include <string>
+#include <map>
+#include <cstring>
+
+// In-memory replacement for the file-backed system cache
+namespace particle { namespace services {
+
+namespace settings {
+
+TlvFile::TlvFile(const char* path) {
+}
+
+TlvFile::~TlvFile() {
+}
+
+} // settings
+
+namespace {
+
+std::map<SystemCacheKey, std::string> g_values;
+
+} // namespace
+
+SystemCache::SystemCache() :
+        tlv_("") {
+}
+
+SystemCache& SystemCache::instance() {
+    static SystemCache cache;
+    return cache;
+}
+
+int SystemCache::get(SystemCacheKey key, void* value, size_t length) {
+    const auto it = g_values.find(key);
+    if (it == g_values.end()) {
+        return SYSTEM_ERROR_NOT_FOUND;
+    }
+    const size_t n = std::min(length, it->second.size());
+    memcpy(value, it->second.data(), n);
+    return n;
+}
+
+int SystemCache::set(SystemCacheKey key, const void* value, size_t length) {
+    g_values[key] = std::string((const char*)value, length);
+    return 0;
+}
+
+int SystemCache::del(SystemCacheKey key) {
+    g_values.erase(key);
+    return 0;
+}
+
+} } // particle::services
@@ -0,0 +1,411 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "asset_transfer.h"
+#include "system_error.h"
+
+#include "mock/filesystem.h"
+#include "util/random.h"
+
+#include <catch2/catch.hpp>
+#include <hippomocks.h>
+
+#include <string>
+#include <map>
+#include <functional>
+#include <memory>
+
+using namespace particle;
+
+namespace {
+
+const auto DATA_FILE = "/.transfer/data/asset";
+const auto STATE_FILE = "/.transfer/state/asset";
+
+const size_t CHUNK_SIZE = 1024;
+const size_t FILE_SIZE = CHUNK_SIZE * 10 + 100; // 11 chunks, the last one is shorter
+
+// Expected contents of the asset module checked by AssetReader
+struct {
+    Asset asset;
+    std::string data;
+    std::string path;
+} g_module;
+
+// Not a real SHA-256 but good enough to detect modified data
+std::string fakeHash(const std::string& data) {
+    const auto h = std::hash<std::string>()(data);
+    std::string s;
+    while (s.size() < Sha256::HASH_SIZE) {
+        s.append((const char*)&h, sizeof(h));
+    }
+    s.resize(Sha256::HASH_SIZE);
+    return s;
+}
+
+// Hippomocks identifies mocked free functions by a __COUNTER__ value, which restarts in every
+// translation unit. Use explicit indices that can't clash with the ones used by test::Filesystem
+#define ON_CALL_MD_FUNC(_mocks, _func, _index) \
+        (_mocks)->RegisterExpect_<1000 + (_index)>(&_func, HippoMocks::Any, #_func, __FILE__, __LINE__)
+
+// Implements the mbedTLS digest functions used by Sha256 in terms of fakeHash()
+class FakeSha256 {
+public:
+    explicit FakeSha256(MockRepository* mocks) {
+        ON_CALL_MD_FUNC(mocks, mbedtls_md_starts, 0).Do([this](mbedtls_md_context_t* ctx) {
+            data_[ctx].clear();
+            return 0;
+        });
+        ON_CALL_MD_FUNC(mocks, mbedtls_md_update, 1).Do([this](mbedtls_md_context_t* ctx, const unsigned char* data, size_t size) {
+            data_[ctx].append((const char*)data, size);
+            return 0;
+        });
+        ON_CALL_MD_FUNC(mocks, mbedtls_md_finish, 2).Do([this](mbedtls_md_context_t* ctx, unsigned char* out) {
+            const auto h = fakeHash(data_[ctx]);
+            memcpy(out, h.data(), h.size());
+            return 0;
+        });
+        ON_CALL_MD_FUNC(mocks, mbedtls_md_clone, 3).Do([this](mbedtls_md_context_t* dest, const mbedtls_md_context_t* src) {
+            data_[dest] = data_[src];
+            return 0;
+        });
+    }
+
+private:
+    std::map<const mbedtls_md_context_t*, std::string> data_;
+};
+
+std::string chunk(const std::string& data, size_t index) {
+    return data.substr(index * CHUNK_SIZE, CHUNK_SIZE);
+}
+
+int writeChunk(AssetTransfer* t, const std::string& data, size_t index) {
+    const auto d = chunk(data, index);
+    return t->write(index * CHUNK_SIZE, d.data(), d.size());
+}
+
+void writeChunks(AssetTransfer* t, const std::string& data, size_t first, size_t last) {
+    for (size_t i = first; i <= last; ++i) {
+        REQUIRE(writeChunk(t, data, i) == 0);
+    }
+}
+
+Asset makeAsset(const char* name) {
+    const auto hash = test::randString(AssetHash::SHA256_HASH_SIZE);
+    return Asset(name, AssetHash(hash.data(), hash.size()));
+}
+
+} // namespace
+
+// Reader that validates the data of the module against its expected contents
+namespace particle {
+
+AssetReader::AssetReader() :
+        stream_(nullptr),
+        valid_(false),
+        compressed_(false),
+        size_(0),
+        originalSize_(0),
+        dataOffset_(0),
+        dataSize_(0) {
+}
+
+int AssetReader::init(const char* filename) {
+    const auto fs = filesystem_get_instance(FILESYSTEM_INSTANCE_ASSET_STORAGE, nullptr);
+    lfs_file_t file = {};
+    CHECK_FS(lfs_file_open(&fs->instance, &file, filename, LFS_O_RDONLY));
+    size_ = lfs_file_size(&fs->instance, &file);
+    lfs_file_close(&fs->instance, &file);
+    asset_ = g_module.asset;
+    g_module.path = filename;
+    return 0;
+}
+
+int AssetReader::validate(bool full) {
+    valid_ = true;
+    if (full) {
+        const auto fs = filesystem_get_instance(FILESYSTEM_INSTANCE_ASSET_STORAGE, nullptr);
+        lfs_file_t file = {};
+        CHECK_FS(lfs_file_open(&fs->instance, &file, g_module.path.c_str(), LFS_O_RDONLY));
+        std::string data(size_, '\0');
+        lfs_file_read(&fs->instance, &file, &data.front(), data.size());
+        lfs_file_close(&fs->instance, &file);
+        valid_ = (data == g_module.data);
+    }
+    return 0;
+}
+
+bool AssetReader::isValid() const {
+    return valid_;
+}
+
+Asset AssetReader::asset() const {
+    return asset_;
+}
+
+size_t AssetReader::size() const {
+    return size_;
+}
+
+} // namespace particle
+
+TEST_CASE("AssetTransfer") {
+    MockRepository mocks;
+    test::Filesystem fs(&mocks);
+    FakeSha256 sha(&mocks);
+    const auto data = test::randString(FILE_SIZE);
+    const auto asset = makeAsset("asset");
+    g_module.asset = asset;
+    g_module.data = data;
+    std::unique_ptr<AssetTransfer> t(new AssetTransfer());
+    REQUIRE(t->begin(asset, data.size(), CHUNK_SIZE) == 0);
+    REQUIRE(t->chunkCount() == 11);
+
+    SECTION("stores the asset once all chunks are received") {
+        writeChunks(t.get(), data, 0, 10);
+        CHECK(t->receivedChunkCount() == 11);
+        CHECK(t->partialSize() == data.size());
+        CHECK(t->nextMissingChunk() == SYSTEM_ERROR_NOT_FOUND);
+        CHECK(t->finish(fakeHash(data).data()) == 0);
+        CHECK_FALSE(t->isActive());
+        CHECK(fs.readFile("asset") == data);
+        CHECK_FALSE(fs.hasFile(DATA_FILE));
+        CHECK_FALSE(fs.hasFile(STATE_FILE));
+    }
+
+    SECTION("verifies the CRC of the module if its hash is not provided") {
+        writeChunks(t.get(), data, 0, 10);
+        CHECK(t->finish() == 0);
+        CHECK(fs.readFile("asset") == data);
+    }
+
+    SECTION("accepts chunks in any order") {
+        writeChunks(t.get(), data, 2, 3);
+        CHECK(t->partialSize() == 0);
+        CHECK(t->nextMissingChunk() == 0);
+        writeChunks(t.get(), data, 0, 0);
+        CHECK(t->partialSize() == CHUNK_SIZE);
+        CHECK(t->nextMissingChunk() == 1);
+        CHECK(t->nextMissingChunk(2) == 4);
+        // Filling the gap extends the partial hash over the chunks that were received out of order
+        writeChunks(t.get(), data, 1, 1);
+        CHECK(t->partialSize() == 4 * CHUNK_SIZE);
+        writeChunks(t.get(), data, 10, 10);
+        CHECK(t->partialSize() == 4 * CHUNK_SIZE);
+        writeChunks(t.get(), data, 4, 9);
+        CHECK(t->partialSize() == data.size());
+        CHECK(t->finish(fakeHash(data).data()) == 0);
+        CHECK(fs.readFile("asset") == data);
+    }
+
+    SECTION("ignores duplicate chunks") {
+        writeChunks(t.get(), data, 0, 1);
+        const std::string garbage(CHUNK_SIZE, 'x');
+        CHECK(t->write(CHUNK_SIZE, garbage.data(), garbage.size()) == 0);
+        CHECK(t->receivedChunkCount() == 2);
+        writeChunks(t.get(), data, 2, 10);
+        CHECK(t->finish(fakeHash(data).data()) == 0);
+        CHECK(fs.readFile("asset") == data);
+    }
+
+    SECTION("write() rejects invalid chunks") {
+        const std::string d(CHUNK_SIZE, 'a');
+        CHECK(t->write(1, d.data(), d.size()) == SYSTEM_ERROR_INVALID_ARGUMENT); // Unaligned offset
+        CHECK(t->write(0, d.data(), d.size() - 1) == SYSTEM_ERROR_INVALID_ARGUMENT); // Short chunk
+        CHECK(t->write(10 * CHUNK_SIZE, d.data(), d.size()) == SYSTEM_ERROR_INVALID_ARGUMENT); // Last chunk is shorter
+        CHECK(t->write(11 * CHUNK_SIZE, d.data(), 100) == SYSTEM_ERROR_INVALID_ARGUMENT); // Past the end
+        CHECK(t->receivedChunkCount() == 0);
+        AssetTransfer t2;
+        CHECK(t2.write(0, d.data(), d.size()) == SYSTEM_ERROR_INVALID_STATE);
+    }
+
+    SECTION("resumes an interrupted transfer") {
+        writeChunks(t.get(), data, 0, 2);
+        writeChunks(t.get(), data, 5, 5);
+        t->cancel();
+        CHECK_FALSE(t->isActive());
+        CHECK(fs.hasFile(STATE_FILE));
+        t.reset(new AssetTransfer());
+        REQUIRE(t->begin(asset, data.size(), CHUNK_SIZE) == 0);
+        CHECK(t->receivedChunkCount() == 4);
+        CHECK(t->partialSize() == 3 * CHUNK_SIZE);
+        CHECK(t->hasChunk(5));
+        CHECK(t->nextMissingChunk() == 3);
+        writeChunks(t.get(), data, 3, 4);
+        CHECK(t->partialSize() == 6 * CHUNK_SIZE);
+        writeChunks(t.get(), data, 6, 10);
+        CHECK(t->finish(fakeHash(data).data()) == 0);
+        CHECK(fs.readFile("asset") == data);
+    }
+
+    SECTION("checkpoints the transfer state when destroyed") {
+        writeChunks(t.get(), data, 0, 3);
+        t.reset(new AssetTransfer());
+        REQUIRE(t->begin(asset, data.size(), CHUNK_SIZE) == 0);
+        CHECK(t->receivedChunkCount() == 4);
+        // The transfer can be interrupted several times
+        writeChunks(t.get(), data, 4, 7);
+        t.reset(new AssetTransfer());
+        REQUIRE(t->begin(asset, data.size(), CHUNK_SIZE) == 0);
+        CHECK(t->receivedChunkCount() == 8);
+        writeChunks(t.get(), data, 8, 10);
+        CHECK(t->finish(fakeHash(data).data()) == 0);
+    }
+
+    SECTION("loadState()") {
+        writeChunks(t.get(), data, 0, 3);
+        t->cancel();
+        t.reset(new AssetTransfer());
+
+        SECTION("starts over if the checkpointed data has been modified") {
+            auto d = fs.readFile(DATA_FILE);
+            d[CHUNK_SIZE + 10] ^= 0x01;
+            fs.writeFile(DATA_FILE, d);
+            REQUIRE(t->begin(asset, data.size(), CHUNK_SIZE) == 0);
+            CHECK(t->receivedChunkCount() == 0);
+            CHECK(t->partialSize() == 0);
+            CHECK(fs.readFile(DATA_FILE).empty());
+        }
+
+        SECTION("starts over if the checkpointed data is missing") {
+            fs.writeFile(DATA_FILE, data.substr(0, CHUNK_SIZE));
+            REQUIRE(t->begin(asset, data.size(), CHUNK_SIZE) == 0);
+            CHECK(t->receivedChunkCount() == 0);
+        }
+
+        SECTION("starts over if the state file is truncated") {
+            const auto s = fs.readFile(STATE_FILE);
+            fs.writeFile(STATE_FILE, s.substr(0, s.size() - 1));
+            REQUIRE(t->begin(asset, data.size(), CHUNK_SIZE) == 0);
+            CHECK(t->receivedChunkCount() == 0);
+        }
+
+        SECTION("starts over if the state file is corrupted") {
+            auto s = fs.readFile(STATE_FILE);
+            s[0] ^= 0x01;
+            fs.writeFile(STATE_FILE, s);
+            REQUIRE(t->begin(asset, data.size(), CHUNK_SIZE) == 0);
+            CHECK(t->receivedChunkCount() == 0);
+        }
+
+        SECTION("starts over if the chunk size has changed") {
+            REQUIRE(t->begin(asset, data.size(), CHUNK_SIZE * 2) == 0);
+            CHECK(t->receivedChunkCount() == 0);
+        }
+
+        SECTION("starts over if the asset has changed") {
+            const auto asset2 = makeAsset("asset");
+            REQUIRE(t->begin(asset2, data.size(), CHUNK_SIZE) == 0);
+            CHECK(t->receivedChunkCount() == 0);
+        }
+
+        SECTION("the transfer can be completed after starting over") {
+            fs.remove(STATE_FILE);
+            REQUIRE(t->begin(asset, data.size(), CHUNK_SIZE) == 0);
+            CHECK(t->receivedChunkCount() == 0);
+            writeChunks(t.get(), data, 0, 10);
+            CHECK(t->finish(fakeHash(data).data()) == 0);
+            CHECK(fs.readFile("asset") == data);
+        }
+    }
+
+    SECTION("finish()") {
+        SECTION("fails if some of the chunks are missing") {
+            writeChunks(t.get(), data, 0, 9);
+            CHECK(t->finish(fakeHash(data).data()) == SYSTEM_ERROR_NOT_ENOUGH_DATA);
+            CHECK(t->isActive());
+            writeChunks(t.get(), data, 10, 10);
+            CHECK(t->finish(fakeHash(data).data()) == 0);
+        }
+
+        SECTION("discards the data if the hash doesn't match") {
+            writeChunks(t.get(), data, 0, 10);
+            auto hash = fakeHash(data);
+            hash[0] ^= 0x01;
+            CHECK(t->finish(hash.data()) == SYSTEM_ERROR_BAD_DATA);
+            CHECK_FALSE(t->isActive());
+            CHECK_FALSE(fs.hasFile("asset"));
+            CHECK_FALSE(fs.hasFile(DATA_FILE));
+            CHECK_FALSE(fs.hasFile(STATE_FILE));
+        }
+
+        SECTION("discards the data if the CRC check fails") {
+            g_module.data[0] ^= 0x01;
+            writeChunks(t.get(), data, 0, 10);
+            CHECK(t->finish() == SYSTEM_ERROR_BAD_DATA);
+            CHECK_FALSE(t->isActive());
+            CHECK_FALSE(fs.hasFile("asset"));
+            CHECK_FALSE(fs.hasFile(DATA_FILE));
+        }
+
+        SECTION("discards the data if the module is a different asset") {
+            g_module.asset = makeAsset("other");
+            writeChunks(t.get(), data, 0, 10);
+            CHECK(t->finish(fakeHash(data).data()) == SYSTEM_ERROR_BAD_DATA);
+            CHECK_FALSE(fs.hasFile("asset"));
+            CHECK_FALSE(fs.hasFile(DATA_FILE));
+        }
+
+        SECTION("replaces an existing asset") {
+            fs.writeFile("asset", "old");
+            writeChunks(t.get(), data, 0, 10);
+            CHECK(t->finish(fakeHash(data).data()) == 0);
+            CHECK(fs.readFile("asset") == data);
+        }
+    }
+
+    SECTION("cancel(true) discards the transferred data") {
+        writeChunks(t.get(), data, 0, 3);
+        t->cancel(true /* discard */);
+        CHECK_FALSE(t->isActive());
+        CHECK_FALSE(fs.hasFile(DATA_FILE));
+        CHECK_FALSE(fs.hasFile(STATE_FILE));
+    }
+
+    SECTION("clearExcept() discards the data of other assets") {
+        writeChunks(t.get(), data, 0, 0);
+        t->cancel();
+        const auto asset2 = makeAsset("asset2");
+        AssetTransfer t2;
+        REQUIRE(t2.begin(asset2, data.size(), CHUNK_SIZE) == 0);
+        writeChunks(&t2, data, 0, 0);
+        t2.cancel();
+        REQUIRE(fs.hasFile("/.transfer/state/asset2"));
+        Vector<Asset> keep;
+        keep.append(asset2);
+        CHECK(AssetTransfer::clearExcept(keep) == 0);
+        CHECK_FALSE(fs.hasFile(DATA_FILE));
+        CHECK_FALSE(fs.hasFile(STATE_FILE));
+        CHECK(fs.hasFile("/.transfer/data/asset2"));
+        CHECK(fs.hasFile("/.transfer/state/asset2"));
+        CHECK(AssetTransfer::clearExcept(Vector<Asset>()) == 0);
+        CHECK_FALSE(fs.hasFile("/.transfer/data/asset2"));
+        CHECK_FALSE(fs.hasFile("/.transfer/state/asset2"));
+    }
+
+    t.reset();
+    CHECK_FALSE(fs.hasOpenFiles());
+}
+
+TEST_CASE("AssetTransfer::clearExcept()") {
+    MockRepository mocks;
+    test::Filesystem fs(&mocks);
+
+    SECTION("succeeds if there are no transfers") {
+        CHECK(AssetTransfer::clearExcept(Vector<Asset>()) == 0);
+    }
+}
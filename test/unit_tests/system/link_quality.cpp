@@ -0,0 +1,106 @@
+#include <catch2/catch.hpp>
+
+#include "system_link_quality.h"
+
+using namespace particle::system;
+
+TEST_CASE("LinkQuality") {
+    LinkQuality q;
+
+    SECTION("has no score until an RTT sample is added") {
+        CHECK_FALSE(q.hasRtt());
+        CHECK(q.score() == LinkQuality::INVALID_SCORE);
+        q.addLoss(10, 0);
+        CHECK(q.score() == LinkQuality::INVALID_SCORE);
+        q.addRtt(100);
+        CHECK(q.hasRtt());
+        CHECK(q.srtt() == 100);
+        CHECK(q.rttVar() == 50);
+        CHECK(q.score() == 300);
+    }
+
+    SECTION("smooths the RTT samples") {
+        q.addRtt(100);
+        for (int i = 0; i < 50; ++i) {
+            q.addRtt(200);
+        }
+        CHECK(q.srtt() > 190);
+        CHECK(q.srtt() <= 200);
+        CHECK(q.rttVar() < 20);
+        // A single spike doesn't move the estimate much
+        q.addRtt(2000);
+        CHECK(q.srtt() < 500);
+    }
+
+    SECTION("weights an average RTT by the number of samples") {
+        LinkQuality q2;
+        q.addRtt(100);
+        q2.addRtt(100);
+        q.addRtt(900, 4);
+        q2.addRtt(900);
+        CHECK(q.srtt() == 500);
+        CHECK(q2.srtt() == 200);
+    }
+
+    SECTION("never reports a zero RTT") {
+        q.addRtt(0);
+        CHECK(q.hasRtt());
+        CHECK(q.srtt() == 1);
+    }
+
+    SECTION("tracks the loss rate") {
+        q.addRtt(100);
+        const auto score = q.score();
+        q.addLoss(4, 2);
+        CHECK(q.loss() == LinkQuality::LOSS_SCALE / 4);
+        CHECK(q.score() > score);
+        for (int i = 0; i < 20; ++i) {
+            q.addLoss(4, 0);
+        }
+        CHECK(q.loss() == 0);
+        CHECK(q.score() == score);
+        q.addLoss(0, 0);
+        CHECK(q.loss() == 0);
+        q.addLoss(1, 5); // Can't lose more packets than were sent
+        CHECK(q.loss() == LinkQuality::LOSS_SCALE / 8);
+    }
+
+    SECTION("detects a lossy link after a few packets") {
+        q.addRtt(100);
+        q.addLoss(1, 1);
+        CHECK_FALSE(q.isDegraded());
+        q.addLoss(1, 1);
+        CHECK_FALSE(q.isDegraded());
+        q.addLoss(1, 1);
+        CHECK(q.isDegraded());
+        // Recovers with hysteresis
+        q.addLoss(1, 0);
+        CHECK(q.isDegraded());
+        for (int i = 0; i < 10; ++i) {
+            q.addLoss(2, 0);
+        }
+        CHECK_FALSE(q.isDegraded());
+    }
+
+    SECTION("detects a slow link") {
+        q.addRtt(LinkQuality::DEGRADED_RTT_MS * 2);
+        CHECK_FALSE(q.isDegraded());
+        q.addRtt(LinkQuality::DEGRADED_RTT_MS * 2, 2);
+        CHECK(q.isDegraded());
+        q.addRtt(LinkQuality::RECOVERED_RTT_MS * 2, 8);
+        CHECK(q.isDegraded());
+        q.addRtt(100, 8);
+        CHECK_FALSE(q.isDegraded());
+    }
+
+    SECTION("reset() forgets all samples") {
+        q.addRtt(LinkQuality::DEGRADED_RTT_MS, 3);
+        q.addLoss(3, 3);
+        REQUIRE(q.isDegraded());
+        q.reset();
+        CHECK_FALSE(q.hasRtt());
+        CHECK(q.loss() == 0);
+        CHECK_FALSE(q.isDegraded());
+        CHECK(q.score() == LinkQuality::INVALID_SCORE);
+    }
+}
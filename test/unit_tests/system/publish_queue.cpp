@@ -0,0 +1,361 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "publish_queue.h"
+#include "system_error.h"
+
+#include "mock/filesystem.h"
+
+#include <catch2/catch.hpp>
+#include <hippomocks.h>
+
+#include <string>
+#include <vector>
+#include <memory>
+
+using namespace particle;
+using particle::system::PublishQueue;
+
+namespace {
+
+const auto DIR = "/pubq";
+const auto HEAD_FILE = "/pubq/head";
+
+const size_t DATA_SIZE = 200;
+const size_t RECORD_SIZE = 2 /* Name */ + DATA_SIZE + 18 /* Header, trailer and terminating nulls */;
+
+class Sender {
+public:
+    explicit Sender(PublishQueue* queue) :
+            queue_(queue),
+            ack_(true) {
+    }
+
+    // Sends all queued events and returns their names
+    std::vector<std::string> drain() {
+        names_.clear();
+        for (int i = 0; i < 100; ++i) {
+            const int r = queue_->process(send, this);
+            REQUIRE(r >= 0);
+            if (!r && queue_->isEmpty()) {
+                break;
+            }
+        }
+        CHECK(queue_->isEmpty());
+        return names_;
+    }
+
+    // Sends a single batch of events
+    std::vector<std::string> sendBatch() {
+        names_.clear();
+        REQUIRE(queue_->process(send, this) >= 0);
+        return names_;
+    }
+
+    void ack(bool enabled) {
+        ack_ = enabled;
+    }
+
+    const std::vector<std::string>& data() const {
+        return data_;
+    }
+
+private:
+    std::vector<std::string> names_;
+    std::vector<std::string> data_;
+    PublishQueue* queue_;
+    bool ack_;
+
+    static int send(const PublishQueue::Event& event, uint32_t tag, void* arg) {
+        const auto self = (Sender*)arg;
+        self->names_.push_back(event.name);
+        self->data_.push_back(event.data ? event.data : "");
+        if (self->ack_) {
+            self->queue_->eventSent(tag, 0 /* error */);
+        }
+        return 0;
+    }
+};
+
+std::string eventName(int index) {
+    return "e" + std::to_string(index);
+}
+
+std::string eventData(int index) {
+    return std::string(DATA_SIZE, 'a' + index % 26);
+}
+
+std::vector<std::string> eventNames(int first, int last) {
+    std::vector<std::string> names;
+    for (int i = first; i <= last; ++i) {
+        names.push_back(eventName(i));
+    }
+    return names;
+}
+
+void pushEvents(PublishQueue* queue, int first, int last) {
+    for (int i = first; i <= last; ++i) {
+        REQUIRE(queue->push(eventName(i).c_str(), eventData(i).c_str(), 60, 0 /* flags */) == 0);
+    }
+}
+
+void configure(PublishQueue* queue, int policy = SPARK_PUBLISH_QUEUE_DROP_OLDEST, unsigned batchSize = 4) {
+    spark_publish_queue_config conf = {};
+    conf.size = sizeof(conf);
+    conf.eviction_policy = policy;
+    conf.batch_size = batchSize;
+    conf.max_size = 2048;
+    conf.segment_size = 1024; // 4 events per segment
+    conf.batch_interval = 0;
+    REQUIRE(queue->setConfig(conf) == 0);
+}
+
+spark_publish_queue_stats stats(PublishQueue* queue) {
+    spark_publish_queue_stats s = {};
+    s.size = sizeof(s);
+    REQUIRE(queue->getStats(&s) == 0);
+    return s;
+}
+
+} // namespace
+
+TEST_CASE("PublishQueue") {
+    MockRepository mocks;
+    test::Filesystem fs(&mocks);
+    std::unique_ptr<PublishQueue> queue(new PublishQueue(DIR));
+    configure(queue.get());
+
+    // Simulates a reset of the device
+    auto reload = [&queue]() {
+        queue.reset(new PublishQueue(DIR));
+        configure(queue.get());
+        REQUIRE(queue->prepare() == 0);
+    };
+
+    SECTION("sends the events in order") {
+        pushEvents(queue.get(), 0, 8);
+        auto s = stats(queue.get());
+        CHECK(s.event_count == 9);
+        CHECK(s.segment_count == 3);
+        CHECK(s.data_size == 9 * RECORD_SIZE);
+        Sender sender(queue.get());
+        CHECK(sender.drain() == eventNames(0, 8));
+        CHECK(sender.data().at(3) == eventData(3));
+        s = stats(queue.get());
+        CHECK(s.event_count == 0);
+        CHECK(s.sent_count == 9);
+        CHECK(s.segment_count == 0);
+    }
+
+    SECTION("resends the events that haven't been acknowledged") {
+        pushEvents(queue.get(), 0, 5);
+        Sender sender(queue.get());
+        sender.ack(false);
+        CHECK(sender.sendBatch() == eventNames(0, 3));
+        queue->cancelBatch();
+        sender.ack(true);
+        CHECK(sender.drain() == eventNames(0, 5));
+    }
+
+    SECTION("restores the queue state after a reset") {
+        pushEvents(queue.get(), 0, 5);
+        Sender sender(queue.get());
+        CHECK(sender.sendBatch() == eventNames(0, 3));
+        queue->cancelBatch(); // Commits the batch
+        reload();
+        CHECK(stats(queue.get()).event_count == 2);
+        pushEvents(queue.get(), 6, 6);
+        Sender sender2(queue.get());
+        CHECK(sender2.drain() == eventNames(4, 6));
+    }
+
+    SECTION("scanSegment()") {
+        SECTION("truncates a partially written record at the end of the tail segment") {
+            pushEvents(queue.get(), 0, 2);
+            queue.reset();
+            auto data = fs.readFile("/pubq/1");
+            REQUIRE(data.size() == 3 * RECORD_SIZE);
+            data.resize(data.size() - 5);
+            fs.writeFile("/pubq/1", data);
+            reload();
+            CHECK(stats(queue.get()).event_count == 2);
+            CHECK(fs.readFile("/pubq/1").size() == 2 * RECORD_SIZE);
+            // New records are appended after the last valid record
+            pushEvents(queue.get(), 3, 3);
+            CHECK(fs.readFile("/pubq/1").size() == 3 * RECORD_SIZE);
+            Sender sender(queue.get());
+            CHECK(sender.drain() == std::vector<std::string>({ "e0", "e1", "e3" }));
+        }
+
+        SECTION("truncates a record with an invalid checksum and everything that follows it") {
+            pushEvents(queue.get(), 0, 2);
+            queue.reset();
+            auto data = fs.readFile("/pubq/1");
+            data[RECORD_SIZE + 20] ^= 0x01; // Corrupt the data of the second record
+            fs.writeFile("/pubq/1", data);
+            reload();
+            CHECK(stats(queue.get()).event_count == 1);
+            CHECK(fs.readFile("/pubq/1").size() == RECORD_SIZE);
+            Sender sender(queue.get());
+            CHECK(sender.drain() == eventNames(0, 0));
+        }
+
+        SECTION("discards invalid records in a segment other than the tail without truncating it") {
+            pushEvents(queue.get(), 0, 5); // Segments 1 and 2
+            queue.reset();
+            auto data = fs.readFile("/pubq/1");
+            data[2 * RECORD_SIZE] = 0; // Corrupt the magic of the third record
+            fs.writeFile("/pubq/1", data);
+            reload();
+            CHECK(stats(queue.get()).event_count == 4);
+            CHECK(fs.readFile("/pubq/1").size() == 4 * RECORD_SIZE);
+            Sender sender(queue.get());
+            CHECK(sender.drain() == std::vector<std::string>({ "e0", "e1", "e4", "e5" }));
+        }
+
+        SECTION("ignores a tail segment consisting of garbage") {
+            pushEvents(queue.get(), 0, 1);
+            queue.reset();
+            fs.writeFile("/pubq/1", std::string(10, '\xff'));
+            reload();
+            CHECK(stats(queue.get()).event_count == 0);
+            CHECK(fs.readFile("/pubq/1").empty());
+        }
+    }
+
+    SECTION("load()") {
+        // Send and acknowledge the first 2 events
+        configure(queue.get(), SPARK_PUBLISH_QUEUE_DROP_OLDEST, 2 /* batchSize */);
+        pushEvents(queue.get(), 0, 2);
+        Sender sender(queue.get());
+        REQUIRE(sender.sendBatch() == eventNames(0, 1));
+        queue->cancelBatch();
+        REQUIRE(fs.hasFile(HEAD_FILE));
+        pushEvents(queue.get(), 3, 4);
+
+        SECTION("starts sending from the head position") {
+            reload();
+            CHECK(stats(queue.get()).event_count == 3);
+            Sender sender2(queue.get());
+            CHECK(sender2.drain() == eventNames(2, 4));
+        }
+
+        SECTION("sends all events if the head file has an invalid checksum") {
+            auto head = fs.readFile(HEAD_FILE);
+            head.back() ^= 0x01;
+            fs.writeFile(HEAD_FILE, head);
+            reload();
+            CHECK(stats(queue.get()).event_count == 5);
+            Sender sender2(queue.get());
+            CHECK(sender2.drain() == eventNames(0, 4));
+        }
+
+        SECTION("sends all events if the head file is truncated") {
+            const auto head = fs.readFile(HEAD_FILE);
+            fs.writeFile(HEAD_FILE, head.substr(0, head.size() - 1));
+            reload();
+            CHECK(stats(queue.get()).event_count == 5);
+            Sender sender2(queue.get());
+            CHECK(sender2.drain() == eventNames(0, 4));
+        }
+
+        SECTION("sends all events if the head file has an invalid magic number") {
+            auto head = fs.readFile(HEAD_FILE);
+            head[0] = 'X';
+            fs.writeFile(HEAD_FILE, head);
+            reload();
+            CHECK(stats(queue.get()).event_count == 5);
+        }
+    }
+
+    SECTION("load() removes the segments preceding the head segment") {
+        pushEvents(queue.get(), 0, 5); // Segments 1 and 2
+        const auto seg1 = fs.readFile("/pubq/1");
+        Sender sender(queue.get());
+        REQUIRE(sender.sendBatch() == eventNames(0, 3));
+        queue->cancelBatch();
+        REQUIRE_FALSE(fs.hasFile("/pubq/1"));
+        queue.reset();
+        // Restore segment 1 as if the device was reset before it could be removed
+        fs.writeFile("/pubq/1", seg1);
+        fs.writeFile("/pubq/other", "abc"); // Not a segment file
+        fs.createDir("/pubq/7"); // ditto
+        reload();
+        CHECK_FALSE(fs.hasFile("/pubq/1"));
+        CHECK(fs.hasFile("/pubq/other"));
+        CHECK(fs.hasDir("/pubq/7"));
+        const auto s = stats(queue.get());
+        CHECK(s.event_count == 2);
+        CHECK(s.segment_count == 1);
+        Sender sender2(queue.get());
+        CHECK(sender2.drain() == eventNames(4, 5));
+    }
+
+    SECTION("makeRoom()") {
+        SECTION("drops the oldest segment if the queue is full") {
+            pushEvents(queue.get(), 0, 8); // Segments 1, 2 and 3
+            CHECK(stats(queue.get()).dropped_count == 0);
+            pushEvents(queue.get(), 9, 9);
+            const auto s = stats(queue.get());
+            CHECK(s.dropped_count == 4);
+            CHECK(s.event_count == 6);
+            CHECK(s.segment_count == 2);
+            CHECK(s.data_size == 6 * RECORD_SIZE);
+            CHECK_FALSE(fs.hasFile("/pubq/1"));
+            Sender sender(queue.get());
+            CHECK(sender.drain() == eventNames(4, 9));
+        }
+
+        SECTION("invalidates the current batch when dropping the segment it was sent from") {
+            pushEvents(queue.get(), 0, 8);
+            Sender sender(queue.get());
+            CHECK(sender.sendBatch() == eventNames(0, 3));
+            pushEvents(queue.get(), 9, 9);
+            CHECK_FALSE(queue->isSending());
+            CHECK(sender.drain() == eventNames(4, 9));
+            CHECK(stats(queue.get()).sent_count == 6);
+        }
+
+        SECTION("rejects new events if the queue is full and the policy is to drop the newest events") {
+            configure(queue.get(), SPARK_PUBLISH_QUEUE_DROP_NEWEST);
+            pushEvents(queue.get(), 0, 8);
+            CHECK(queue->push("e9", eventData(9).c_str(), 60, 0) == SYSTEM_ERROR_LIMIT_EXCEEDED);
+            const auto s = stats(queue.get());
+            CHECK(s.dropped_count == 1);
+            CHECK(s.event_count == 9);
+            Sender sender(queue.get());
+            CHECK(sender.drain() == eventNames(0, 8));
+        }
+
+        SECTION("rejects events larger than the queue") {
+            CHECK(queue->push("e0", std::string(2048, 'a').c_str(), 60, 0) == SYSTEM_ERROR_TOO_LARGE);
+        }
+    }
+
+    SECTION("clear() removes all events") {
+        pushEvents(queue.get(), 0, 5);
+        REQUIRE(queue->clear() == 0);
+        CHECK_FALSE(fs.hasDir(DIR));
+        CHECK(stats(queue.get()).event_count == 0);
+        pushEvents(queue.get(), 6, 6);
+        Sender sender(queue.get());
+        CHECK(sender.drain() == eventNames(6, 6));
+    }
+
+    queue.reset();
+    CHECK_FALSE(fs.hasOpenFiles());
+}
@@ -0,0 +1,409 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "system_serial_flash.h"
+#include "system_update.h"
+#include "system_error.h"
+
+#include "util/random.h"
+
+#include <catch2/catch.hpp>
+#include <boost/crc.hpp>
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+
+using namespace particle;
+
+namespace {
+
+typedef SerialFlashReceiver Receiver;
+
+// In-memory OTA storage
+struct Update {
+    std::string data;
+    std::vector<uint32_t> chunks; // Addresses of the saved chunks in the order they were written
+    int prepareResult = 0;
+    int saveResult = 0;
+    int finishFlags = -1;
+    bool prepared = false;
+};
+
+Update g_update;
+
+// Stream that reads from a preloaded buffer and collects everything written to it
+class TestStream: public Stream {
+public:
+    explicit TestStream(std::string in = std::string()) :
+            in_(std::move(in)),
+            offs_(0) {
+    }
+
+    int available() override {
+        return in_.size() - offs_;
+    }
+
+    int read() override {
+        if (offs_ >= in_.size()) {
+            return -1;
+        }
+        return (uint8_t)in_[offs_++];
+    }
+
+    int peek() override {
+        if (offs_ >= in_.size()) {
+            return -1;
+        }
+        return (uint8_t)in_[offs_];
+    }
+
+    size_t readBytes(char* data, size_t size) override {
+        size = std::min(size, in_.size() - offs_);
+        memcpy(data, in_.data() + offs_, size);
+        offs_ += size;
+        return size;
+    }
+
+    size_t write(uint8_t c) override {
+        out_.push_back(c);
+        return 1;
+    }
+
+    size_t write(const uint8_t* data, size_t size) override {
+        out_.append((const char*)data, size);
+        return size;
+    }
+
+    void flush() override {
+    }
+
+    const std::string& output() const {
+        return out_;
+    }
+
+private:
+    std::string in_;
+    std::string out_;
+    size_t offs_;
+};
+
+struct Frame {
+    uint8_t type;
+    uint32_t seq;
+    std::string data;
+};
+
+uint32_t crc32(const std::string& data) {
+    boost::crc_32_type crc;
+    crc.process_bytes(data.data(), data.size());
+    return crc.checksum();
+}
+
+void appendUint16(std::string* s, uint16_t val) {
+    s->push_back(val & 0xff);
+    s->push_back(val >> 8);
+}
+
+void appendUint32(std::string* s, uint32_t val) {
+    appendUint16(s, val & 0xffff);
+    appendUint16(s, val >> 16);
+}
+
+uint32_t readUint32(const std::string& s, size_t offs) {
+    return (uint8_t)s[offs] | ((uint8_t)s[offs + 1] << 8) | ((uint8_t)s[offs + 2] << 16) | ((uint32_t)(uint8_t)s[offs + 3] << 24);
+}
+
+uint16_t readUint16(const std::string& s, size_t offs) {
+    return (uint8_t)s[offs] | ((uint8_t)s[offs + 1] << 8);
+}
+
+std::string frame(uint8_t type, uint32_t seq, const std::string& data) {
+    std::string f;
+    f.push_back(type);
+    f.push_back(0); // Reserved
+    appendUint16(&f, data.size());
+    appendUint32(&f, seq);
+    f.append(data);
+    appendUint32(&f, crc32(f));
+    return std::string(1, (char)Receiver::SYNC) + f;
+}
+
+std::string startFrame(uint32_t fileSize, uint16_t frameSize, uint16_t windowSize) {
+    std::string d;
+    appendUint32(&d, fileSize);
+    appendUint16(&d, frameSize);
+    appendUint16(&d, windowSize);
+    return frame(Receiver::START, 0, d);
+}
+
+std::string dataFrame(const std::string& file, uint32_t seq, size_t frameSize) {
+    return frame(Receiver::DATA, seq, file.substr(seq * frameSize, frameSize));
+}
+
+// Parses the frames sent by the device
+std::vector<Frame> parseFrames(const std::string& s) {
+    std::vector<Frame> frames;
+    size_t offs = 0;
+    while (offs < s.size()) {
+        REQUIRE((uint8_t)s[offs] == Receiver::SYNC);
+        REQUIRE(s.size() - offs >= 1 + Receiver::HEADER_SIZE + Receiver::TRAILER_SIZE);
+        const size_t size = readUint16(s, offs + 3);
+        const auto hdrAndData = s.substr(offs + 1, Receiver::HEADER_SIZE + size);
+        REQUIRE(readUint32(s, offs + 1 + Receiver::HEADER_SIZE + size) == crc32(hdrAndData));
+        Frame f = {};
+        f.type = s[offs + 1];
+        f.seq = readUint32(s, offs + 5);
+        f.data = hdrAndData.substr(Receiver::HEADER_SIZE);
+        frames.push_back(f);
+        offs += 1 + Receiver::HEADER_SIZE + size + Receiver::TRAILER_SIZE;
+    }
+    return frames;
+}
+
+std::vector<Frame> framesOfType(const std::vector<Frame>& frames, uint8_t type) {
+    std::vector<Frame> result;
+    std::copy_if(frames.begin(), frames.end(), std::back_inserter(result), [type](const Frame& f) {
+        return f.type == type;
+    });
+    return result;
+}
+
+} // namespace
+
+int Spark_Prepare_For_Firmware_Update(FileTransfer::Descriptor& file, uint32_t flags, void* reserved) {
+    if (g_update.prepareResult != 0) {
+        return g_update.prepareResult;
+    }
+    file.file_address = 0x1000;
+    g_update.data = std::string(file.file_length, '\xff');
+    g_update.prepared = true;
+    return 0;
+}
+
+int Spark_Save_Firmware_Chunk(FileTransfer::Descriptor& file, const uint8_t* chunk, void* reserved) {
+    if (g_update.saveResult != 0) {
+        return g_update.saveResult;
+    }
+    REQUIRE(g_update.prepared);
+    REQUIRE(file.chunk_address >= file.file_address);
+    const size_t offs = file.chunk_address - file.file_address;
+    REQUIRE(offs + file.chunk_size <= g_update.data.size());
+    memcpy(&g_update.data[offs], chunk, file.chunk_size);
+    g_update.chunks.push_back(file.chunk_address);
+    return 0;
+}
+
+int Spark_Finish_Firmware_Update(FileTransfer::Descriptor& file, uint32_t flags, void* reserved) {
+    g_update.finishFlags = flags;
+    return 0;
+}
+
+TEST_CASE("SerialFlashReceiver") {
+    g_update = Update();
+    FileTransfer::Descriptor tx = {};
+    const size_t frameSize = Receiver::MIN_FRAME_SIZE;
+    const auto file = test::randString(frameSize * 4 + 100); // 5 frames, the last one is shorter
+
+    SECTION("receives a file sent in order") {
+        std::string in = startFrame(file.size(), frameSize, 4);
+        for (uint32_t i = 0; i < 5; ++i) {
+            in += dataFrame(file, i, frameSize);
+        }
+        in += frame(Receiver::END, 0, "");
+        TestStream stream(in);
+        Receiver r(stream);
+        CHECK(r.receive(tx) == (int)file.size());
+        CHECK(r.updateStarted());
+        CHECK(g_update.data == file);
+        CHECK(g_update.chunks == std::vector<uint32_t>({ 0x1000, 0x1100, 0x1200, 0x1300, 0x1400 }));
+        const auto out = parseFrames(stream.output());
+        REQUIRE(out.size() >= 1);
+        CHECK(out[0].type == Receiver::READY);
+        REQUIRE(out[0].data.size() == 8);
+        CHECK(readUint32(out[0].data, 0) == file.size());
+        CHECK(readUint16(out[0].data, 4) == frameSize);
+        CHECK(readUint16(out[0].data, 6) == 4);
+    }
+
+    SECTION("skips data preceding the sync byte and frames with an invalid checksum") {
+        std::string in = "garbage" + startFrame(file.size(), frameSize, 4);
+        auto bad = dataFrame(file, 0, frameSize);
+        bad[20] ^= 0x01;
+        in += bad;
+        in += "\x01\x02\x03";
+        for (uint32_t i = 0; i < 5; ++i) {
+            in += dataFrame(file, i, frameSize);
+        }
+        in += frame(Receiver::END, 0, "");
+        TestStream stream(in);
+        Receiver r(stream);
+        CHECK(r.receive(tx) == (int)file.size());
+        CHECK(g_update.data == file);
+        CHECK(g_update.chunks.size() == 5);
+    }
+
+    SECTION("writes frames received out of order in sequence") {
+        std::string in = startFrame(file.size(), frameSize, 4);
+        in += dataFrame(file, 2, frameSize);
+        in += dataFrame(file, 1, frameSize);
+        in += dataFrame(file, 4, frameSize); // Outside of the window, dropped
+        in += dataFrame(file, 0, frameSize);
+        in += dataFrame(file, 3, frameSize);
+        in += dataFrame(file, 4, frameSize);
+        in += frame(Receiver::END, 0, "");
+        TestStream stream(in);
+        Receiver r(stream);
+        CHECK(r.receive(tx) == (int)file.size());
+        CHECK(g_update.data == file);
+        CHECK(g_update.chunks == std::vector<uint32_t>({ 0x1000, 0x1100, 0x1200, 0x1300, 0x1400 }));
+    }
+
+    SECTION("ignores duplicate frames") {
+        std::string in = startFrame(file.size(), frameSize, 4);
+        in += dataFrame(file, 0, frameSize);
+        in += dataFrame(file, 0, frameSize);
+        in += dataFrame(file, 2, frameSize);
+        in += dataFrame(file, 2, frameSize);
+        for (uint32_t i = 1; i < 5; ++i) {
+            in += dataFrame(file, i, frameSize);
+        }
+        in += frame(Receiver::END, 0, "");
+        TestStream stream(in);
+        Receiver r(stream);
+        CHECK(r.receive(tx) == (int)file.size());
+        CHECK(g_update.data == file);
+        CHECK(g_update.chunks.size() == 5);
+    }
+
+    SECTION("acknowledges the received frames if the file is incomplete") {
+        std::string in = startFrame(file.size(), frameSize, 4);
+        in += dataFrame(file, 0, frameSize);
+        in += dataFrame(file, 2, frameSize);
+        in += dataFrame(file, 3, frameSize);
+        in += frame(Receiver::END, 0, "");
+        in += dataFrame(file, 1, frameSize);
+        in += dataFrame(file, 4, frameSize);
+        in += frame(Receiver::END, 0, "");
+        TestStream stream(in);
+        Receiver r(stream);
+        CHECK(r.receive(tx) == (int)file.size());
+        CHECK(g_update.data == file);
+        const auto acks = framesOfType(parseFrames(stream.output()), Receiver::ACK);
+        REQUIRE(acks.size() == 1);
+        CHECK(acks[0].seq == 1); // Frame 1 is missing
+        REQUIRE(acks[0].data.size() == 4);
+        CHECK(readUint32(acks[0].data, 0) == 0x03); // Frames 2 and 3 have been received
+    }
+
+    SECTION("resends the READY frame if START is received again") {
+        std::string in = startFrame(file.size(), frameSize, 4);
+        in += startFrame(file.size(), frameSize, 4);
+        for (uint32_t i = 0; i < 5; ++i) {
+            in += dataFrame(file, i, frameSize);
+        }
+        in += frame(Receiver::END, 0, "");
+        TestStream stream(in);
+        Receiver r(stream);
+        CHECK(r.receive(tx) == (int)file.size());
+        const auto ready = framesOfType(parseFrames(stream.output()), Receiver::READY);
+        REQUIRE(ready.size() == 2);
+        CHECK(ready[0].data == ready[1].data);
+    }
+
+    SECTION("limits the frame and window size") {
+        SECTION("small frames") {
+            TestStream stream(startFrame(file.size(), 10, 1000) + frame(Receiver::ABORT, 0, ""));
+            Receiver r(stream);
+            CHECK(r.receive(tx) == SYSTEM_ERROR_ABORTED);
+            const auto out = parseFrames(stream.output());
+            REQUIRE(out.size() == 1);
+            CHECK(readUint16(out[0].data, 4) == Receiver::MIN_FRAME_SIZE);
+            CHECK(readUint16(out[0].data, 6) == Receiver::MAX_WINDOW_SIZE);
+        }
+        SECTION("large frames") {
+            TestStream stream(startFrame(100000, 10000, 0) + frame(Receiver::ABORT, 0, ""));
+            Receiver r(stream);
+            CHECK(r.receive(tx) == SYSTEM_ERROR_ABORTED);
+            const auto out = parseFrames(stream.output());
+            REQUIRE(out.size() == 1);
+            CHECK(readUint16(out[0].data, 4) == Receiver::MAX_FRAME_SIZE);
+            CHECK(readUint16(out[0].data, 6) == 1);
+        }
+        SECTION("total buffer size") {
+            TestStream stream(startFrame(100000, Receiver::MAX_FRAME_SIZE, Receiver::MAX_WINDOW_SIZE) + frame(Receiver::ABORT, 0, ""));
+            Receiver r(stream);
+            CHECK(r.receive(tx) == SYSTEM_ERROR_ABORTED);
+            const auto out = parseFrames(stream.output());
+            REQUIRE(out.size() == 1);
+            const unsigned slotSize = Receiver::HEADER_SIZE + Receiver::MAX_FRAME_SIZE + Receiver::TRAILER_SIZE;
+            const unsigned window = readUint16(out[0].data, 6);
+            CHECK(window >= 1);
+            CHECK((window + 1) * slotSize <= Receiver::MAX_BUFFER_SIZE);
+        }
+    }
+
+    SECTION("fails if the START frame is invalid") {
+        TestStream stream(startFrame(0, frameSize, 4));
+        Receiver r(stream);
+        CHECK(r.receive(tx) == SYSTEM_ERROR_INVALID_ARGUMENT);
+        CHECK_FALSE(r.updateStarted());
+        CHECK(stream.output().empty());
+    }
+
+    SECTION("fails if the update can't be prepared") {
+        g_update.prepareResult = 1;
+        TestStream stream(startFrame(file.size(), frameSize, 4));
+        Receiver r(stream);
+        CHECK(r.receive(tx) == SYSTEM_ERROR_OTA);
+        CHECK_FALSE(r.updateStarted());
+    }
+
+    SECTION("fails if a chunk can't be saved") {
+        g_update.saveResult = SYSTEM_ERROR_FLASH_IO;
+        TestStream stream(startFrame(file.size(), frameSize, 4) + dataFrame(file, 0, frameSize));
+        Receiver r(stream);
+        CHECK(r.receive(tx) == SYSTEM_ERROR_FLASH_IO);
+        CHECK(r.updateStarted());
+    }
+}
+
+TEST_CASE("Windowed_Serial_Flash_Update()") {
+    g_update = Update();
+    FileTransfer::Descriptor tx = {};
+    const size_t frameSize = Receiver::MIN_FRAME_SIZE;
+    const auto file = test::randString(frameSize * 2);
+
+    SECTION("cancels the update and reports the error if the host aborts the transfer") {
+        TestStream stream(startFrame(file.size(), frameSize, 4) + dataFrame(file, 0, frameSize) + frame(Receiver::ABORT, 0, ""));
+        CHECK_FALSE(Windowed_Serial_Flash_Update(&stream, tx, nullptr));
+        CHECK(g_update.finishFlags == 0);
+        const auto result = framesOfType(parseFrames(stream.output()), Receiver::RESULT);
+        REQUIRE(result.size() == 1);
+        CHECK((int)readUint32(result[0].data, 0) == SYSTEM_ERROR_ABORTED);
+    }
+
+    SECTION("doesn't finish the update if it hasn't been started") {
+        TestStream stream(startFrame(0, frameSize, 4));
+        CHECK_FALSE(Windowed_Serial_Flash_Update(&stream, tx, nullptr));
+        CHECK(g_update.finishFlags == -1);
+        const auto result = framesOfType(parseFrames(stream.output()), Receiver::RESULT);
+        REQUIRE(result.size() == 1);
+        CHECK((int)readUint32(result[0].data, 0) == SYSTEM_ERROR_INVALID_ARGUMENT);
+    }
+}
@@ -18,6 +18,11 @@
 #include "system_cloud_internal.h"
 #include "ota_flash_hal.h"
 #include "diagnostics.h"
+#include "system_cloud.h"
+#include "delay_hal.h"
+#include "core_hal.h"
+
+#include <boost/crc.hpp>
 
 namespace particle {
 
@@ -49,4 +54,17 @@ int diag_enum_sources(diag_enum_sources_callback callback, size_t* count, void*
 
 int diag_get_source(uint16_t id, const diag_source** src, void* reserved) {
     return 0;
-}
\ No newline at end of file
+}
+
+void HAL_Delay_Milliseconds(uint32_t millis) {
+}
+
+uint32_t HAL_Core_Compute_CRC32(const uint8_t* data, uint32_t size) {
+    boost::crc_32_type crc;
+    crc.process_bytes(data, size);
+    return crc.checksum();
+}
+
+bool spark_send_event(const char* name, const char* data, int ttl, uint32_t flags, void* reserved) {
+    return false;
+}
@@ -12,6 +12,7 @@
 
 #include <set>
 #include <list>
+#include <vector>
 
 namespace particle {
 
@@ -636,6 +637,46 @@ TEST_CASE("UsbControlRequestChannel") {
             CHECK(processNextTask());
             CHECK(channel.requestHandlerCalled());
         }
+        SECTION("reuses the request buffer of a completed firmware update request") {
+            std::string data = randomBytes(1024);
+            std::vector<const char*> bufs;
+            channel.requestHandler([=, &bufs](ctrl_request* req, ControlRequestChannel* ch) {
+                if (req->type == CTRL_REQUEST_FIRMWARE_UPDATE_DATA) {
+                    CHECK(std::string(req->request_data, req->request_size) == data);
+                    bufs.push_back(req->request_data);
+                }
+                ch->setResult(req, SYSTEM_ERROR_NONE);
+            });
+            for (int i = 0; i < 2; ++i) {
+                CHECK(channel.serviceRequest(ServiceRequest::INIT).type(CTRL_REQUEST_FIRMWARE_UPDATE_DATA).size(data.size()).send());
+                uint16_t id = channel.serviceReply().id();
+                CHECK(processNextTask());
+                CHECK(channel.heapAllocator().allocSize() == data.size());
+                CHECK(channel.serviceRequest(ServiceRequest::SEND).id(id).data(data).send());
+                CHECK(processNextTask());
+                CHECK(channel.requestHandlerCalled());
+            }
+            REQUIRE(bufs.size() == 2);
+            CHECK(bufs[1] == bufs[0]);
+            // The buffer is released once the update is finished
+            CHECK(channel.serviceRequest(ServiceRequest::INIT).type(CTRL_REQUEST_FINISH_FIRMWARE_UPDATE).send());
+            CHECK(processNextTask());
+            CHECK(channel.requestHandlerCalled());
+            CHECK(channel.heapAllocator().allocSize() == 0);
+        }
+        SECTION("does not keep the request buffer of other requests") {
+            std::string data = randomBytes(1024);
+            channel.requestHandler([=](ctrl_request* req, ControlRequestChannel* ch) {
+                ch->setResult(req, SYSTEM_ERROR_NONE);
+            });
+            CHECK(channel.serviceRequest(ServiceRequest::INIT).type(TEST_REQ).size(data.size()).send());
+            uint16_t id = channel.serviceReply().id();
+            CHECK(processNextTask());
+            CHECK(channel.serviceRequest(ServiceRequest::SEND).id(id).data(data).send());
+            CHECK(processNextTask());
+            CHECK(channel.requestHandlerCalled());
+            CHECK(channel.heapAllocator().allocSize() == 0);
+        }
         SECTION("fails when the request cannot be not found") {
             uint16_t id = 1234;
             std::string data = "test";
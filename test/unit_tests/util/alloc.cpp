@@ -77,8 +77,8 @@ void test::Allocator::free(void* ptr) {
         f.data = (std::string)f.buffer; // User data before free() has been called
         alloc_.erase(it);
         const bool ok = f.buffer.isPaddingValid();
-        free_.insert(std::make_pair(ptr, std::move(f)));
         allocSize_ -= f.buffer.size();
+        free_.insert(std::make_pair(ptr, std::move(f)));
         if (!ok) {
             throw std::runtime_error("Buffer overflow detected");
         }
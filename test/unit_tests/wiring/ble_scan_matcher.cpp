@@ -0,0 +1,208 @@
+#include "spark_wiring_ble_scan_matcher.h"
+
+#include "system_error.h"
+
+#include "util/catch.h"
+
+#include <string>
+#include <cstring>
+
+using namespace particle;
+
+namespace {
+
+const uint8_t ADDR1[] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06 };
+const uint8_t ADDR2[] = { 0x11, 0x12, 0x13, 0x14, 0x15, 0x16 };
+
+const uint8_t UUID128[] = { 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d,
+        0x1e, 0x1f };
+
+std::string adStruct(uint8_t type, const std::string& data) {
+    return std::string(1, (char)(data.size() + 1)) + (char)type + data;
+}
+
+std::string adStruct(uint8_t type, const uint8_t* data, size_t size) {
+    return adStruct(type, std::string((const char*)data, size));
+}
+
+struct Report {
+    std::string adv;
+    std::string sr;
+    const uint8_t* address = ADDR1;
+    uint8_t addressType = 0;
+    int8_t rssi = -50;
+
+    BleScanReport get() const {
+        BleScanReport r = {};
+        r.address = address;
+        r.addressType = addressType;
+        r.rssi = rssi;
+        r.advData = (const uint8_t*)adv.data();
+        r.advDataLen = adv.size();
+        r.srData = (const uint8_t*)sr.data();
+        r.srDataLen = sr.size();
+        return r;
+    }
+};
+
+} // namespace
+
+TEST_CASE("BleScanMatcher") {
+    BleScanMatcher m;
+    Report r;
+
+    SECTION("matches any report if no criteria are set") {
+        CHECK(m.match(r.get()));
+        r.adv = adStruct(0x09, "abc");
+        CHECK(m.match(r.get()));
+    }
+
+    SECTION("filters by RSSI") {
+        m.minRssi(-60).maxRssi(-40);
+        r.rssi = -50;
+        CHECK(m.match(r.get()));
+        r.rssi = -61;
+        CHECK(!m.match(r.get()));
+        r.rssi = -39;
+        CHECK(!m.match(r.get()));
+    }
+
+    SECTION("filters by address and address type") {
+        REQUIRE(m.addAddress(ADDR2, 0) == 0);
+        CHECK(!m.match(r.get()));
+        r.address = ADDR2;
+        CHECK(m.match(r.get()));
+        r.addressType = 1;
+        CHECK(!m.match(r.get()));
+    }
+
+    SECTION("filters by device name") {
+        REQUIRE(m.addDeviceName("foo", 3) == 0);
+        REQUIRE(m.addDeviceName("barbaz", 6) == 0);
+        CHECK(!m.match(r.get()));
+        r.adv = adStruct(0x01, "\x06") + adStruct(0x09, "barbaz");
+        CHECK(m.match(r.get()));
+        r.adv = adStruct(0x09, "bar");
+        CHECK(!m.match(r.get()));
+        // The name can be in the scan response
+        r.sr = adStruct(0x09, "foo");
+        CHECK(m.match(r.get()));
+        // The short name takes precedence over the complete name
+        r.adv = adStruct(0x09, "foo") + adStruct(0x08, "fo");
+        r.sr.clear();
+        CHECK(!m.match(r.get()));
+        r.adv = adStruct(0x09, "fo") + adStruct(0x08, "foo");
+        CHECK(m.match(r.get()));
+    }
+
+    SECTION("filters by service UUID") {
+        const uint8_t uuid16[] = { 0x0d, 0x18 };
+        REQUIRE(m.addServiceUuid(uuid16, sizeof(uuid16)) == 0);
+        REQUIRE(m.addServiceUuid(UUID128, sizeof(UUID128)) == 0);
+        CHECK(m.addServiceUuid(UUID128, 4) == SYSTEM_ERROR_INVALID_ARGUMENT);
+        CHECK(!m.match(r.get()));
+        r.adv = adStruct(0x03, std::string("\x0f\x18\x0a\x18", 4));
+        CHECK(!m.match(r.get()));
+        r.adv = adStruct(0x02, std::string("\x0f\x18\x0d\x18", 4));
+        CHECK(m.match(r.get()));
+        r.adv.clear();
+        r.sr = adStruct(0x07, UUID128, sizeof(UUID128));
+        CHECK(m.match(r.get()));
+        // A 16-bit UUID doesn't match a 128-bit UUID with the same value
+        uint8_t uuid[16] = {};
+        memcpy(uuid + 12, uuid16, 2);
+        r.sr = adStruct(0x07, uuid, sizeof(uuid));
+        CHECK(!m.match(r.get()));
+    }
+
+    SECTION("filters by appearance") {
+        REQUIRE(m.addAppearance(0x0340) == 0);
+        CHECK(!m.match(r.get()));
+        r.sr = adStruct(0x19, std::string("\x40\x03", 2));
+        CHECK(m.match(r.get()));
+        r.sr = adStruct(0x19, std::string("\x41\x03", 2));
+        CHECK(!m.match(r.get()));
+    }
+
+    SECTION("treats a missing appearance as unknown") {
+        REQUIRE(m.addAppearance(0) == 0);
+        CHECK(m.match(r.get()));
+        r.adv = adStruct(0x19, std::string("\x40\x03", 2));
+        r.sr = adStruct(0x19, std::string("\x41\x03", 2));
+        CHECK(!m.match(r.get()));
+    }
+
+    SECTION("filters by custom data") {
+        const uint8_t data[] = { 0x62, 0x06, 0xaa, 0xbb };
+        m.customData(data, sizeof(data));
+        CHECK(!m.match(r.get()));
+        r.adv = adStruct(0xff, data, sizeof(data));
+        CHECK(m.match(r.get()));
+        r.adv = adStruct(0xff, data, sizeof(data) - 1);
+        CHECK(!m.match(r.get()));
+        r.sr = adStruct(0xff, data, sizeof(data));
+        CHECK(m.match(r.get()));
+    }
+
+    SECTION("requires all criteria to be satisfied") {
+        const uint8_t uuid16[] = { 0x0d, 0x18 };
+        REQUIRE(m.addDeviceName("foo", 3) == 0);
+        REQUIRE(m.addServiceUuid(uuid16, sizeof(uuid16)) == 0);
+        r.adv = adStruct(0x09, "foo");
+        CHECK(!m.match(r.get()));
+        r.sr = adStruct(0x03, uuid16, sizeof(uuid16));
+        CHECK(m.match(r.get()));
+        m.clear();
+        CHECK(m.match(Report().get()));
+    }
+
+    SECTION("ignores malformed AD structures") {
+        REQUIRE(m.addDeviceName("foo", 3) == 0);
+        r.adv = adStruct(0x09, "foo");
+        r.adv[0] = 10; // Exceeds the size of the data
+        CHECK(!m.match(r.get()));
+        r.adv = std::string(1, '\0') + adStruct(0x09, "foo");
+        CHECK(m.match(r.get()));
+    }
+}
+
+TEST_CASE("BleAddressCache") {
+    BleAddressCache c;
+
+    SECTION("doesn't suppress anything if not initialized") {
+        CHECK(!c.checkAndAdd(ADDR1, 0));
+        CHECK(!c.checkAndAdd(ADDR1, 0));
+    }
+
+    SECTION("detects previously seen addresses") {
+        REQUIRE(c.init(16) == 0);
+        CHECK(c.capacity() == 16);
+        CHECK(!c.checkAndAdd(ADDR1, 0));
+        CHECK(c.checkAndAdd(ADDR1, 0));
+        CHECK(!c.checkAndAdd(ADDR1, 1));
+        CHECK(!c.checkAndAdd(ADDR2, 0));
+        CHECK(c.checkAndAdd(ADDR2, 0));
+        CHECK(c.size() == 3);
+        c.clear();
+        CHECK(c.size() == 0);
+        CHECK(!c.checkAndAdd(ADDR1, 0));
+    }
+
+    SECTION("stops adding addresses when full") {
+        REQUIRE(c.init(16) == 0);
+        uint8_t addr[6] = {};
+        for (int i = 0; i < 12; ++i) {
+            addr[0] = i;
+            CHECK(!c.checkAndAdd(addr, 0));
+        }
+        CHECK(c.size() == 12);
+        addr[0] = 100;
+        CHECK(!c.checkAndAdd(addr, 0));
+        CHECK(!c.checkAndAdd(addr, 0));
+        CHECK(c.size() == 12);
+        for (int i = 0; i < 12; ++i) {
+            addr[0] = i;
+            CHECK(c.checkAndAdd(addr, 0));
+        }
+    }
+}
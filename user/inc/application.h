@@ -76,6 +76,7 @@
 #include "spark_wiring_map.h"
 #include "spark_wiring_variant.h"
 #include "spark_wiring_async.h"
+#include "spark_wiring_thread_pool.h"
 #include "spark_wiring_error.h"
 #include "spark_wiring_led.h"
 #include "spark_wiring_diagnostics.h"
@@ -0,0 +1,383 @@
+/*
+ * Host benchmark for the BLE scan filter. Runs on the gcc virtual device and feeds synthetic
+ * advertising reports from a dense environment through the compiled scan filter, and through a
+ * reproduction of the per-report work done by the scan filter previously, which copied the report
+ * and the filter criteria, built temporary strings and lists and scanned the list of seen devices
+ * linearly. Reports the latency of filtering a report and the number of heap allocations per report.
+ *
+ * Build from the main directory and run the resulting executable:
+ *   make PLATFORM=gcc TEST=app/ble_scan_filter_bench
+ */
+
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <atomic>
+#include <new>
+#include <cstdlib>
+#include <cstring>
+
+#include "application.h"
+
+#include "spark_wiring_ble_scan_matcher.h"
+
+#include "check.h"
+
+#if PLATFORM_ID != PLATFORM_GCC
+#error "This benchmark can only be built for the gcc platform"
+#endif
+
+SYSTEM_MODE(MANUAL)
+
+namespace {
+
+using particle::BleScanMatcher;
+using particle::BleScanReport;
+using particle::BleAddressCache;
+
+const auto DEVICE_COUNT = 500;
+const auto REPORT_COUNT = 200000;
+
+// Every TARGET_RATIO-th device advertises the name and the service that the filter looks for
+const auto TARGET_RATIO = 10;
+
+const uint16_t TARGET_SERVICE = 0x181a;
+const uint16_t OTHER_SERVICE = 0x180f;
+const uint8_t TARGET_CUSTOM_DATA[] = { 0x62, 0x06, 0x01, 0x02 };
+
+const uint8_t AD_TYPE_FLAGS = 0x01;
+const uint8_t AD_TYPE_UUID16_COMPLETE = 0x03;
+const uint8_t AD_TYPE_COMPLETE_LOCAL_NAME = 0x09;
+const uint8_t AD_TYPE_MANUFACTURER_SPECIFIC_DATA = 0xff;
+
+const auto DESCR_COLUMN_WIDTH = 26;
+const auto VALUE_COLUMN_WIDTH = 9;
+
+const SerialLogHandler logHandler(LOG_LEVEL_ERROR, {
+    { "app", LOG_LEVEL_ALL }
+});
+
+std::atomic<unsigned> g_allocCount(0);
+
+struct Device {
+    uint8_t address[6];
+    std::string advData;
+    std::string srData;
+};
+
+struct OpStats {
+    std::vector<uint32_t> times; // Nanoseconds
+    uint64_t allocCount = 0;
+    unsigned matchCount = 0;
+};
+
+void appendAd(std::string* data, uint8_t type, const void* val, size_t size) {
+    data->push_back(size + 1);
+    data->push_back(type);
+    data->append((const char*)val, size);
+}
+
+std::vector<Device> makeDevices() {
+    std::mt19937 gen(1);
+    std::vector<Device> devices(DEVICE_COUNT);
+    for (size_t i = 0; i < devices.size(); ++i) {
+        auto& d = devices[i];
+        for (auto& b: d.address) {
+            b = gen();
+        }
+        const bool target = (i % TARGET_RATIO == 0);
+        const uint8_t flags = 0x06;
+        appendAd(&d.advData, AD_TYPE_FLAGS, &flags, sizeof(flags));
+        const uint16_t svc = target ? TARGET_SERVICE : OTHER_SERVICE;
+        const uint8_t uuids[] = { 0x0a, 0x18, (uint8_t)(svc & 0xff), (uint8_t)(svc >> 8) };
+        appendAd(&d.advData, AD_TYPE_UUID16_COMPLETE, uuids, sizeof(uuids));
+        uint8_t custom[sizeof(TARGET_CUSTOM_DATA)];
+        memcpy(custom, TARGET_CUSTOM_DATA, sizeof(custom));
+        if (!target) {
+            custom[sizeof(custom) - 1] = gen();
+        }
+        appendAd(&d.advData, AD_TYPE_MANUFACTURER_SPECIFIC_DATA, custom, sizeof(custom));
+        const auto name = String::format(target ? "sensor-%02u" : "device-%04u", i % 100);
+        appendAd(&d.srData, AD_TYPE_COMPLETE_LOCAL_NAME, name.c_str(), name.length());
+    }
+    return devices;
+}
+
+BleScanReport makeReport(const Device& d) {
+    BleScanReport r = {};
+    r.address = d.address;
+    r.rssi = -60;
+    r.advData = (const uint8_t*)d.advData.data();
+    r.advDataLen = d.advData.size();
+    r.srData = (const uint8_t*)d.srData.data();
+    r.srDataLen = d.srData.size();
+    return r;
+}
+
+// Reproduces the per-report work done by the scan filter before it was compiled
+class LegacyFilter {
+public:
+    explicit LegacyFilter(bool allowDuplicates) :
+            allowDuplicates_(allowDuplicates) {
+        for (int i = 0; i < 100; i += TARGET_RATIO) {
+            names_.append(String::format("sensor-%02u", i));
+        }
+        uuids_.append(TARGET_SERVICE);
+    }
+
+    bool process(const BleScanReport& r) {
+        if (!allowDuplicates_) {
+            uint8_t addr[6];
+            memcpy(addr, r.address, sizeof(addr));
+            for (const auto& a: cached_) {
+                if (!memcmp(a.data(), addr, sizeof(addr))) {
+                    return false;
+                }
+            }
+            cached_.append(particle::Vector<uint8_t>(addr, sizeof(addr)));
+        }
+        // The report was copied into a BleScanResult
+        const particle::Vector<uint8_t> adv(r.advData, r.advDataLen);
+        const particle::Vector<uint8_t> sr(r.srData, r.srDataLen);
+        // The filter criteria were copied by value
+        const auto names = names_;
+        const String advName = deviceName(adv);
+        const String srName = deviceName(sr);
+        if (advName.length() == 0 && srName.length() == 0) {
+            return false;
+        }
+        bool found = false;
+        for (const auto& name: names) {
+            if (name == advName || name == srName) {
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            return false;
+        }
+        const auto uuids = uuids_;
+        const auto advUuids = serviceUuids(adv);
+        const auto srUuids = serviceUuids(sr);
+        found = false;
+        for (auto uuid: uuids) {
+            if (advUuids.contains(uuid) || srUuids.contains(uuid)) {
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            return false;
+        }
+        size_t len = 0;
+        const auto custom = find(adv, AD_TYPE_MANUFACTURER_SPECIFIC_DATA, &len);
+        if (!custom || len != sizeof(TARGET_CUSTOM_DATA)) {
+            return false;
+        }
+        const auto buf = (uint8_t*)malloc(len);
+        if (!buf) {
+            return false;
+        }
+        memcpy(buf, custom, len);
+        found = !memcmp(buf, TARGET_CUSTOM_DATA, len);
+        free(buf);
+        return found;
+    }
+
+private:
+    particle::Vector<String> names_;
+    particle::Vector<uint16_t> uuids_;
+    particle::Vector<particle::Vector<uint8_t>> cached_;
+    bool allowDuplicates_;
+
+    static const uint8_t* find(const particle::Vector<uint8_t>& data, uint8_t type, size_t* len) {
+        for (int i = 0; i + 2 < data.size(); i += data[i] + 1) {
+            if (data[i + 1] == type && i + data[i] + 1 <= data.size()) {
+                *len = data[i] - 1;
+                return data.data() + i + 2;
+            }
+        }
+        return nullptr;
+    }
+
+    static String deviceName(const particle::Vector<uint8_t>& data) {
+        String name;
+        size_t len = 0;
+        const auto p = find(data, AD_TYPE_COMPLETE_LOCAL_NAME, &len);
+        for (size_t i = 0; p && i < len; ++i) {
+            name.concat((char)p[i]);
+        }
+        return name;
+    }
+
+    static particle::Vector<uint16_t> serviceUuids(const particle::Vector<uint8_t>& data) {
+        particle::Vector<uint16_t> uuids;
+        size_t len = 0;
+        const auto p = find(data, AD_TYPE_UUID16_COMPLETE, &len);
+        for (size_t i = 0; p && i + 1 < len; i += 2) {
+            uuids.append(p[i] | (p[i + 1] << 8));
+        }
+        return uuids;
+    }
+};
+
+class CompiledFilter {
+public:
+    explicit CompiledFilter(bool allowDuplicates) :
+            allowDuplicates_(allowDuplicates) {
+    }
+
+    int init() {
+        for (int i = 0; i < 100; i += TARGET_RATIO) {
+            const auto name = String::format("sensor-%02u", i);
+            CHECK(matcher_.addDeviceName(name.c_str(), name.length()));
+        }
+        const uint8_t uuid[] = { (uint8_t)(TARGET_SERVICE & 0xff), (uint8_t)(TARGET_SERVICE >> 8) };
+        CHECK(matcher_.addServiceUuid(uuid, sizeof(uuid)));
+        matcher_.customData(TARGET_CUSTOM_DATA, sizeof(TARGET_CUSTOM_DATA));
+        if (!allowDuplicates_) {
+            // Make sure all devices fit in the cache so that both filters suppress the same reports
+            CHECK(cache_.init(DEVICE_COUNT * 2));
+        }
+        return 0;
+    }
+
+    bool process(const BleScanReport& r) {
+        if (!allowDuplicates_ && cache_.checkAndAdd(r.address, r.addressType)) {
+            return false;
+        }
+        return matcher_.match(r);
+    }
+
+private:
+    BleScanMatcher matcher_;
+    BleAddressCache cache_;
+    bool allowDuplicates_;
+};
+
+template<typename FilterT>
+void runReports(FilterT& filter, const std::vector<Device>& devices, OpStats& stats) {
+    std::mt19937 gen(2);
+    for (int i = 0; i < REPORT_COUNT; ++i) {
+        const auto r = makeReport(devices[gen() % devices.size()]);
+        const unsigned allocs = g_allocCount.load(std::memory_order_relaxed);
+        const auto t1 = std::chrono::steady_clock::now();
+        const bool match = filter.process(r);
+        const auto t2 = std::chrono::steady_clock::now();
+        stats.allocCount += g_allocCount.load(std::memory_order_relaxed) - allocs;
+        stats.times.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count());
+        if (match) {
+            ++stats.matchCount;
+        }
+    }
+}
+
+uint32_t percentile(const std::vector<uint32_t>& sorted, unsigned p) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    // Nearest-rank method
+    size_t rank = std::max<size_t>((sorted.size() * p + 99) / 100, 1);
+    return sorted[rank - 1];
+}
+
+void printStatsHeader() {
+    const auto w = VALUE_COLUMN_WIDTH;
+    LOG_PRINTF(INFO, "%-*s%-*s%-*s%-*s%-*s%-*s%-*s\r\n", DESCR_COLUMN_WIDTH, "", w, "p50 ns", w, "p90 ns", w, "p99 ns",
+            w, "max ns", w, "allocs", w, "matched");
+}
+
+void printStatsRow(const char* desc, OpStats& stats) {
+    const auto w = VALUE_COLUMN_WIDTH;
+    auto& t = stats.times;
+    std::sort(t.begin(), t.end());
+    LOG_PRINTF(INFO, "%-*s%-*u%-*u%-*u%-*u%-*.2f%-*u\r\n", DESCR_COLUMN_WIDTH, desc, w, (unsigned)percentile(t, 50),
+            w, (unsigned)percentile(t, 90), w, (unsigned)percentile(t, 99), w, (unsigned)(t.empty() ? 0 : t.back()),
+            w, t.empty() ? 0.0 : (double)stats.allocCount / t.size(), w, stats.matchCount);
+}
+
+int testFilter(bool allowDuplicates) {
+    const auto devices = makeDevices();
+    OpStats legacyStats;
+    {
+        LegacyFilter filter(allowDuplicates);
+        runReports(filter, devices, legacyStats);
+    }
+    OpStats compiledStats;
+    {
+        CompiledFilter filter(allowDuplicates);
+        CHECK(filter.init());
+        runReports(filter, devices, compiledStats);
+    }
+    if (legacyStats.matchCount != compiledStats.matchCount) {
+        LOG(ERROR, "Filters disagree: %u vs %u matches", legacyStats.matchCount, compiledStats.matchCount);
+        return Error::INTERNAL;
+    }
+    LOG_PRINTF(INFO, "\r\n%d reports from %d devices, %s:\r\n", REPORT_COUNT, DEVICE_COUNT,
+            allowDuplicates ? "duplicates allowed" : "duplicates suppressed");
+    printStatsHeader();
+    printStatsRow("previous filter", legacyStats);
+    printStatsRow("compiled filter", compiledStats);
+    return 0;
+}
+
+int runTests() {
+    CHECK(testFilter(true /* allowDuplicates */));
+    CHECK(testFilter(false /* allowDuplicates */));
+    return 0;
+}
+
+} // namespace
+
+extern "C" {
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+void* __wrap_malloc(size_t size) {
+    g_allocCount.fetch_add(1, std::memory_order_relaxed);
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    g_allocCount.fetch_add(1, std::memory_order_relaxed);
+    return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    g_allocCount.fetch_add(1, std::memory_order_relaxed);
+    return __real_realloc(ptr, size);
+}
+
+} // extern "C"
+
+// Route C++ allocations through the wrapped malloc() so that they are counted too
+void* operator new(size_t size) {
+    void* p = std::malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t /* size */) noexcept {
+    std::free(ptr);
+}
+
+void setup() {
+    int r = runTests();
+    if (r < 0) {
+        LOG(ERROR, "runTests() failed: %d", r);
+    }
+    std::exit(r < 0 ? 1 : 0);
+}
+
+void loop() {
+}
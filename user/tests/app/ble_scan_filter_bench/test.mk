@@ -0,0 +1,6 @@
+ifneq ("$(PLATFORM)","gcc")
+$(error "This benchmark can only be built for the gcc platform")
+endif
+
+# Count heap allocations made while filtering the reports
+LDFLAGS += -Wl,--wrap=malloc -Wl,--wrap=calloc -Wl,--wrap=realloc
@@ -0,0 +1,296 @@
+/*
+ * Host benchmark for the ledger storage. Runs on the gcc virtual device over the emulated LittleFS
+ * backend and reports per-operation latency percentiles, block device operation counts and heap
+ * allocation counts.
+ *
+ * Build from the main directory and run the resulting executable:
+ *   make PLATFORM=gcc TEST=app/ledger_bench
+ *
+ * Unless --flash_file is specified, the emulated flash is kept in RAM so that the timings are not
+ * affected by the host filesystem.
+ */
+
+#define LOG_CHECKED_ERRORS 1 // Log errors caught by the CHECK() macro
+
+#include <algorithm>
+#include <vector>
+#include <atomic>
+#include <new>
+#include <cstdlib>
+#include <cstring>
+
+#include "application.h"
+
+#include "filesystem.h"
+
+#include "random.h"
+#include "scope_guard.h"
+#include "check.h"
+
+#if PLATFORM_ID != PLATFORM_GCC
+#error "This benchmark can only be built for the gcc platform"
+#endif
+
+SYSTEM_MODE(SEMI_AUTOMATIC)
+SYSTEM_THREAD(ENABLED)
+
+namespace {
+
+const auto LEDGER_NAME = "bench";
+
+const size_t SMALL_DATA_SIZE = 100;
+const size_t MEDIUM_DATA_SIZE = 1000;
+const size_t LARGE_DATA_SIZE = 10000;
+
+static_assert(SMALL_DATA_SIZE <= LARGE_DATA_SIZE && MEDIUM_DATA_SIZE <= LARGE_DATA_SIZE &&
+        LARGE_DATA_SIZE <= LEDGER_MAX_DATA_SIZE);
+
+const auto REPEAT_COUNT = 200;
+
+const auto DESCR_COLUMN_WIDTH = 22;
+const auto VALUE_COLUMN_WIDTH = 9;
+
+std::atomic<unsigned> g_allocCount(0);
+
+enum Op {
+    GET_INSTANCE,
+    OPEN,
+    READ_OR_WRITE,
+    CLOSE,
+    RELEASE,
+    OP_COUNT
+};
+
+struct OpStats {
+    std::vector<uint32_t> times; // Microseconds
+    uint64_t readCount = 0;
+    uint64_t progCount = 0;
+    uint64_t eraseCount = 0;
+    uint64_t allocCount = 0;
+};
+
+struct Stats {
+    OpStats ops[OP_COUNT];
+};
+
+const SerialLogHandler logHandler(LOG_LEVEL_ERROR, {
+    { "app", LOG_LEVEL_ALL }
+});
+
+char inBuffer[LARGE_DATA_SIZE];
+char outBuffer[LARGE_DATA_SIZE];
+
+filesystem_t* fsInstance() {
+    return filesystem_get_instance(FILESYSTEM_INSTANCE_DEFAULT, nullptr);
+}
+
+template<typename F>
+int measure(OpStats& stats, F fn) {
+    filesystem_stats_t fs1 = {};
+    CHECK(filesystem_get_stats(fsInstance(), &fs1));
+    unsigned allocs = g_allocCount.load(std::memory_order_relaxed);
+    auto t1 = micros();
+    int r = fn();
+    auto t2 = micros();
+    allocs = g_allocCount.load(std::memory_order_relaxed) - allocs;
+    filesystem_stats_t fs2 = {};
+    CHECK(filesystem_get_stats(fsInstance(), &fs2));
+    CHECK(r);
+    stats.times.push_back(t2 - t1);
+    stats.readCount += fs2.read_count - fs1.read_count;
+    stats.progCount += fs2.prog_count - fs1.prog_count;
+    stats.eraseCount += fs2.erase_count - fs1.erase_count;
+    stats.allocCount += allocs;
+    return r;
+}
+
+int readFromLedger(char* data, size_t size, Stats& stats) {
+    auto& ops = stats.ops;
+    ledger_instance* ledger = nullptr;
+    CHECK(measure(ops[GET_INSTANCE], [&]() {
+        return ledger_get_instance(&ledger, LEDGER_NAME, nullptr);
+    }));
+    NAMED_SCOPE_GUARD(releaseLedgerGuard, {
+        ledger_release(ledger, nullptr);
+    });
+    ledger_stream* stream = nullptr;
+    CHECK(measure(ops[OPEN], [&]() {
+        return ledger_open(&stream, ledger, LEDGER_STREAM_MODE_READ, nullptr);
+    }));
+    NAMED_SCOPE_GUARD(closeStreamGuard, {
+        ledger_close(stream, 0, nullptr);
+    });
+    int r = CHECK(measure(ops[READ_OR_WRITE], [&]() {
+        return ledger_read(stream, data, size, nullptr);
+    }));
+    if ((size_t)r != size) {
+        LOG(ERROR, "Unexpected size of ledger data");
+        return Error::BAD_DATA;
+    }
+    closeStreamGuard.dismiss();
+    CHECK(measure(ops[CLOSE], [&]() {
+        return ledger_close(stream, 0, nullptr);
+    }));
+    releaseLedgerGuard.dismiss();
+    CHECK(measure(ops[RELEASE], [&]() {
+        ledger_release(ledger, nullptr);
+        return 0;
+    }));
+    return 0;
+}
+
+int writeToLedger(const char* data, size_t size, Stats& stats) {
+    auto& ops = stats.ops;
+    ledger_instance* ledger = nullptr;
+    CHECK(measure(ops[GET_INSTANCE], [&]() {
+        return ledger_get_instance(&ledger, LEDGER_NAME, nullptr);
+    }));
+    NAMED_SCOPE_GUARD(releaseLedgerGuard, {
+        ledger_release(ledger, nullptr);
+    });
+    ledger_stream* stream = nullptr;
+    CHECK(measure(ops[OPEN], [&]() {
+        return ledger_open(&stream, ledger, LEDGER_STREAM_MODE_WRITE, nullptr);
+    }));
+    NAMED_SCOPE_GUARD(closeStreamGuard, {
+        ledger_close(stream, LEDGER_STREAM_CLOSE_DISCARD, nullptr);
+    });
+    int r = CHECK(measure(ops[READ_OR_WRITE], [&]() {
+        return ledger_write(stream, data, size, nullptr);
+    }));
+    if ((size_t)r != size) {
+        LOG(ERROR, "Unexpected number of bytes written");
+        return Error::IO;
+    }
+    closeStreamGuard.dismiss();
+    CHECK(measure(ops[CLOSE], [&]() {
+        return ledger_close(stream, 0, nullptr);
+    }));
+    releaseLedgerGuard.dismiss();
+    CHECK(measure(ops[RELEASE], [&]() {
+        ledger_release(ledger, nullptr);
+        return 0;
+    }));
+    return 0;
+}
+
+uint32_t percentile(const std::vector<uint32_t>& sorted, unsigned p) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    // Nearest-rank method
+    size_t rank = std::max<size_t>((sorted.size() * p + 99) / 100, 1);
+    return sorted[rank - 1];
+}
+
+void printStatsRow(const char* desc, OpStats& stats) {
+    const auto w = VALUE_COLUMN_WIDTH;
+    auto& t = stats.times;
+    std::sort(t.begin(), t.end());
+    double n = t.empty() ? 1 : t.size();
+    LOG_PRINTF(INFO, "%-*s%-*u%-*u%-*u%-*u%-*.1f%-*.1f%-*.1f%-*.1f\r\n", DESCR_COLUMN_WIDTH, desc,
+            w, (unsigned)percentile(t, 50), w, (unsigned)percentile(t, 90), w, (unsigned)percentile(t, 99),
+            w, (unsigned)(t.empty() ? 0 : t.back()),
+            w, stats.readCount / n, w, stats.progCount / n, w, stats.eraseCount / n, w, stats.allocCount / n);
+}
+
+void printStats(Stats& stats, bool reading) {
+    const auto w = VALUE_COLUMN_WIDTH;
+    LOG_PRINTF(INFO, "%-*s%-*s%-*s%-*s%-*s%-*s%-*s%-*s%-*s\r\n", DESCR_COLUMN_WIDTH, "", w, "p50 us", w, "p90 us",
+            w, "p99 us", w, "max us", w, "reads", w, "progs", w, "erases", w, "allocs");
+    printStatsRow("ledger_get_instance", stats.ops[GET_INSTANCE]);
+    printStatsRow("ledger_open", stats.ops[OPEN]);
+    printStatsRow(reading ? "ledger_read" : "ledger_write", stats.ops[READ_OR_WRITE]);
+    printStatsRow("ledger_close", stats.ops[CLOSE]);
+    printStatsRow("ledger_release", stats.ops[RELEASE]);
+}
+
+int testWriteAndRead(size_t size) {
+    if (size > LARGE_DATA_SIZE) {
+        return Error::INTERNAL;
+    }
+    CHECK(ledger_purge(LEDGER_NAME, nullptr));
+
+    Stats writeStats;
+    Stats readStats;
+    Random rand;
+
+    for (int i = 0; i < REPEAT_COUNT; ++i) {
+        rand.gen(outBuffer, size);
+        CHECK(writeToLedger(outBuffer, size, writeStats));
+        CHECK(readFromLedger(inBuffer, size, readStats));
+        if (std::memcmp(inBuffer, outBuffer, size) != 0) {
+            LOG(ERROR, "Unexpected ledger data");
+            return Error::BAD_DATA;
+        }
+    }
+
+    LOG_PRINTF(INFO, "\r\n%d writes of %d bytes (per-operation averages for counters):\r\n", REPEAT_COUNT, (int)size);
+    printStats(writeStats, false);
+    LOG_PRINTF(INFO, "\r\n%d reads of %d bytes (per-operation averages for counters):\r\n", REPEAT_COUNT, (int)size);
+    printStats(readStats, true /* reading */);
+    return 0;
+}
+
+int runTests() {
+    CHECK(ledger_purge_all(nullptr));
+    const size_t sizes[] = { SMALL_DATA_SIZE, MEDIUM_DATA_SIZE, LARGE_DATA_SIZE };
+    for (size_t size: sizes) {
+        CHECK(testWriteAndRead(size));
+    }
+    CHECK(ledger_purge_all(nullptr));
+    return 0;
+}
+
+} // namespace
+
+extern "C" {
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+void* __wrap_malloc(size_t size) {
+    g_allocCount.fetch_add(1, std::memory_order_relaxed);
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    g_allocCount.fetch_add(1, std::memory_order_relaxed);
+    return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    g_allocCount.fetch_add(1, std::memory_order_relaxed);
+    return __real_realloc(ptr, size);
+}
+
+} // extern "C"
+
+// Route C++ allocations through the wrapped malloc() so that they are counted too
+void* operator new(size_t size) {
+    void* p = std::malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t /* size */) noexcept {
+    std::free(ptr);
+}
+
+void setup() {
+    int r = runTests();
+    if (r < 0) {
+        LOG(ERROR, "runTests() failed: %d", r);
+    }
+    std::exit(r < 0 ? 1 : 0);
+}
+
+void loop() {
+}
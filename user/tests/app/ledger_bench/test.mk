@@ -0,0 +1,6 @@
+ifneq ("$(PLATFORM)","gcc")
+$(error "This benchmark can only be built for the gcc platform")
+endif
+
+# Count heap allocations made by the C code linked into the virtual device (LittleFS, etc.)
+LDFLAGS += -Wl,--wrap=malloc -Wl,--wrap=calloc -Wl,--wrap=realloc
@@ -0,0 +1,275 @@
+/*
+ * Host benchmark for the persistent publish queue. Runs on the gcc virtual device over the emulated
+ * LittleFS backend and reports the latency of appending events to the queue and the throughput of
+ * draining it with different batch sizes.
+ *
+ * Events are drained by a send function that acknowledges them immediately, so the drain figures
+ * reflect the cost of reading the queue and committing its state, not the network round trips.
+ *
+ * Build from the main directory and run the resulting executable:
+ *   make PLATFORM=gcc TEST=app/publish_queue_bench
+ *
+ * Unless --flash_file is specified, the emulated flash is kept in RAM so that the timings are not
+ * affected by the host filesystem.
+ */
+
+#define LOG_CHECKED_ERRORS 1 // Log errors caught by the CHECK() macro
+
+#include <algorithm>
+#include <vector>
+#include <atomic>
+#include <new>
+#include <cstdlib>
+#include <cstring>
+
+#include "application.h"
+
+#include "publish_queue.h"
+#include "filesystem.h"
+
+#include "random.h"
+#include "check.h"
+
+#if PLATFORM_ID != PLATFORM_GCC
+#error "This benchmark can only be built for the gcc platform"
+#endif
+
+SYSTEM_MODE(MANUAL)
+SYSTEM_THREAD(ENABLED)
+
+namespace {
+
+using particle::system::PublishQueue;
+
+const auto QUEUE_DIR = "/pubq_bench";
+const auto EVENT_NAME = "bench";
+
+const size_t SMALL_DATA_SIZE = 32;
+const size_t MEDIUM_DATA_SIZE = 256;
+const size_t LARGE_DATA_SIZE = 1024;
+
+const auto REPEAT_COUNT = 500;
+
+const size_t MAX_QUEUE_SIZE = 1024 * 1024;
+
+const unsigned BATCH_SIZES[] = { 1, 4, 16, 32 };
+
+const auto DESCR_COLUMN_WIDTH = 22;
+const auto VALUE_COLUMN_WIDTH = 9;
+
+std::atomic<unsigned> g_allocCount(0);
+
+struct OpStats {
+    std::vector<uint32_t> times; // Microseconds
+    uint64_t readCount = 0;
+    uint64_t progCount = 0;
+    uint64_t eraseCount = 0;
+    uint64_t allocCount = 0;
+};
+
+const SerialLogHandler logHandler(LOG_LEVEL_ERROR, {
+    { "app", LOG_LEVEL_ALL }
+});
+
+char eventData[LARGE_DATA_SIZE + 1];
+
+filesystem_t* fsInstance() {
+    return filesystem_get_instance(FILESYSTEM_INSTANCE_DEFAULT, nullptr);
+}
+
+template<typename F>
+int measure(OpStats& stats, F fn) {
+    filesystem_stats_t fs1 = {};
+    CHECK(filesystem_get_stats(fsInstance(), &fs1));
+    unsigned allocs = g_allocCount.load(std::memory_order_relaxed);
+    auto t1 = micros();
+    int r = fn();
+    auto t2 = micros();
+    allocs = g_allocCount.load(std::memory_order_relaxed) - allocs;
+    filesystem_stats_t fs2 = {};
+    CHECK(filesystem_get_stats(fsInstance(), &fs2));
+    CHECK(r);
+    stats.times.push_back(t2 - t1);
+    stats.readCount += fs2.read_count - fs1.read_count;
+    stats.progCount += fs2.prog_count - fs1.prog_count;
+    stats.eraseCount += fs2.erase_count - fs1.erase_count;
+    stats.allocCount += allocs;
+    return r;
+}
+
+uint32_t percentile(const std::vector<uint32_t>& sorted, unsigned p) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    // Nearest-rank method
+    size_t rank = std::max<size_t>((sorted.size() * p + 99) / 100, 1);
+    return sorted[rank - 1];
+}
+
+void printStatsHeader() {
+    const auto w = VALUE_COLUMN_WIDTH;
+    LOG_PRINTF(INFO, "%-*s%-*s%-*s%-*s%-*s%-*s%-*s%-*s%-*s\r\n", DESCR_COLUMN_WIDTH, "", w, "p50 us", w, "p90 us",
+            w, "p99 us", w, "max us", w, "reads", w, "progs", w, "erases", w, "allocs");
+}
+
+void printStatsRow(const char* desc, OpStats& stats) {
+    const auto w = VALUE_COLUMN_WIDTH;
+    auto& t = stats.times;
+    std::sort(t.begin(), t.end());
+    double n = t.empty() ? 1 : t.size();
+    LOG_PRINTF(INFO, "%-*s%-*u%-*u%-*u%-*u%-*.1f%-*.1f%-*.1f%-*.1f\r\n", DESCR_COLUMN_WIDTH, desc,
+            w, (unsigned)percentile(t, 50), w, (unsigned)percentile(t, 90), w, (unsigned)percentile(t, 99),
+            w, (unsigned)(t.empty() ? 0 : t.back()),
+            w, stats.readCount / n, w, stats.progCount / n, w, stats.eraseCount / n, w, stats.allocCount / n);
+}
+
+int acknowledgeEvent(const PublishQueue::Event& event, uint32_t tag, void* arg) {
+    static_cast<PublishQueue*>(arg)->eventSent(tag, 0 /* error */);
+    return 0;
+}
+
+spark_publish_queue_config queueConfig(unsigned batchSize) {
+    spark_publish_queue_config conf = {};
+    conf.size = sizeof(conf);
+    conf.eviction_policy = SPARK_PUBLISH_QUEUE_DROP_NEWEST;
+    conf.batch_size = batchSize;
+    conf.max_size = MAX_QUEUE_SIZE;
+    conf.segment_size = PublishQueue::DEFAULT_SEGMENT_SIZE;
+    conf.batch_interval = 0;
+    return conf;
+}
+
+int testPush(size_t size) {
+    PublishQueue queue(QUEUE_DIR);
+    CHECK(queue.clear());
+    CHECK(queue.setConfig(queueConfig(PublishQueue::DEFAULT_BATCH_SIZE)));
+    Random rand;
+    rand.genBase32(eventData, size);
+    eventData[size] = '\0';
+    OpStats stats;
+    for (int i = 0; i < REPEAT_COUNT; ++i) {
+        CHECK(measure(stats, [&]() {
+            return queue.push(EVENT_NAME, eventData, 60 /* ttl */, PUBLISH_EVENT_FLAG_PRIVATE);
+        }));
+    }
+    LOG_PRINTF(INFO, "\r\n%d events with %d bytes of data appended (per-operation averages for counters):\r\n",
+            REPEAT_COUNT, (int)size);
+    printStatsHeader();
+    printStatsRow("PublishQueue::push", stats);
+    CHECK(queue.clear());
+    return 0;
+}
+
+int testDrain(size_t size, unsigned batchSize) {
+    int eventCount = 0;
+    {
+        PublishQueue queue(QUEUE_DIR);
+        CHECK(queue.clear());
+        CHECK(queue.setConfig(queueConfig(batchSize)));
+        Random rand;
+        rand.genBase32(eventData, size);
+        eventData[size] = '\0';
+        for (int i = 0; i < REPEAT_COUNT; ++i) {
+            CHECK(queue.push(EVENT_NAME, eventData, 60 /* ttl */, PUBLISH_EVENT_FLAG_PRIVATE));
+        }
+    }
+    // Start with a fresh instance so that loading the queue state is measured too
+    PublishQueue queue(QUEUE_DIR);
+    CHECK(queue.setConfig(queueConfig(batchSize)));
+    OpStats loadStats;
+    spark_publish_queue_stats qs = {};
+    CHECK(measure(loadStats, [&]() {
+        return queue.getStats(&qs);
+    }));
+    OpStats batchStats;
+    const auto t1 = micros();
+    for (;;) {
+        const int n = CHECK(measure(batchStats, [&]() {
+            return queue.process(acknowledgeEvent, &queue);
+        }));
+        eventCount += n;
+        if (!n && !queue.isSending()) {
+            batchStats.times.pop_back(); // Last iteration only committed the state
+            break;
+        }
+    }
+    const auto t2 = micros();
+    if (eventCount != REPEAT_COUNT) {
+        LOG(ERROR, "Unexpected number of events: %d", eventCount);
+        return Error::BAD_DATA;
+    }
+    LOG_PRINTF(INFO, "\r\n%d events with %d bytes of data drained in batches of %u: %.0f events/s\r\n", eventCount,
+            (int)size, batchSize, eventCount * 1000000.0 / (t2 - t1));
+    printStatsHeader();
+    printStatsRow("load", loadStats);
+    printStatsRow("PublishQueue::process", batchStats);
+    return 0;
+}
+
+int runTests() {
+    const size_t sizes[] = { SMALL_DATA_SIZE, MEDIUM_DATA_SIZE, LARGE_DATA_SIZE };
+    for (size_t size: sizes) {
+        CHECK(testPush(size));
+    }
+    for (size_t size: sizes) {
+        for (unsigned batchSize: BATCH_SIZES) {
+            CHECK(testDrain(size, batchSize));
+        }
+    }
+    PublishQueue queue(QUEUE_DIR);
+    CHECK(queue.clear());
+    return 0;
+}
+
+} // namespace
+
+extern "C" {
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+void* __wrap_malloc(size_t size) {
+    g_allocCount.fetch_add(1, std::memory_order_relaxed);
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    g_allocCount.fetch_add(1, std::memory_order_relaxed);
+    return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    g_allocCount.fetch_add(1, std::memory_order_relaxed);
+    return __real_realloc(ptr, size);
+}
+
+} // extern "C"
+
+// Route C++ allocations through the wrapped malloc() so that they are counted too
+void* operator new(size_t size) {
+    void* p = std::malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t /* size */) noexcept {
+    std::free(ptr);
+}
+
+void setup() {
+    int r = runTests();
+    if (r < 0) {
+        LOG(ERROR, "runTests() failed: %d", r);
+    }
+    std::exit(r < 0 ? 1 : 0);
+}
+
+void loop() {
+}
@@ -0,0 +1,9 @@
+ifneq ("$(PLATFORM)","gcc")
+$(error "This benchmark can only be built for the gcc platform")
+endif
+
+# The benchmark uses the system's publish queue implementation directly
+INCLUDE_DIRS += $(PROJECT_ROOT)/system/src
+
+# Count heap allocations made by the C code linked into the virtual device (LittleFS, etc.)
+LDFLAGS += -Wl,--wrap=malloc -Wl,--wrap=calloc -Wl,--wrap=realloc
@@ -0,0 +1,3 @@
+ifneq ("$(PLATFORM)","gcc")
+$(error "This benchmark can only be built for the gcc platform")
+endif
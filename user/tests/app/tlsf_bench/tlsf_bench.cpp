@@ -0,0 +1,240 @@
+/*
+ * Host benchmark for the TLSF allocator used as the device heap. Runs on the gcc virtual device
+ * against a heap of the same size as the heap available on a typical device, and reports:
+ *
+ * - The latency of allocating and freeing blocks of random sizes.
+ * - The latency of growing blocks with realloc(), compared to a realloc() that always allocates a
+ *   new block and copies the data, as the heap did previously, and how many calls were satisfied in
+ *   place.
+ * - The state of the heap after a long random workload: the amount of free memory, the largest
+ *   free block and the resulting fragmentation.
+ *
+ * Build from the main directory and run the resulting executable:
+ *   make PLATFORM=gcc TEST=app/tlsf_bench
+ */
+
+#include <algorithm>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <memory>
+#include <cstdlib>
+#include <cstring>
+
+#include "application.h"
+
+#include "tlsf.h"
+
+#include "check.h"
+
+#if PLATFORM_ID != PLATFORM_GCC
+#error "This benchmark can only be built for the gcc platform"
+#endif
+
+SYSTEM_MODE(MANUAL)
+
+namespace {
+
+using particle::Tlsf;
+
+const size_t HEAP_SIZE = 128 * 1024;
+
+const size_t MIN_BLOCK_SIZE = 8;
+const size_t MAX_BLOCK_SIZE = 1024;
+
+const auto OP_COUNT = 200000;
+const auto MAX_LIVE_BLOCKS = 200;
+
+// Buffers are grown the way String and Vector grow them when data is appended
+const size_t GROW_STEP = 16;
+const size_t GROW_MAX_SIZE = 2048;
+const auto GROW_BUFFER_COUNT = 8;
+const auto GROW_REPEAT_COUNT = 200;
+
+const auto DESCR_COLUMN_WIDTH = 22;
+const auto VALUE_COLUMN_WIDTH = 9;
+
+const SerialLogHandler logHandler(LOG_LEVEL_ERROR, {
+    { "app", LOG_LEVEL_ALL }
+});
+
+struct OpStats {
+    std::vector<uint32_t> times; // Nanoseconds
+};
+
+class Heap {
+public:
+    Heap() :
+            mem_(new char[HEAP_SIZE]) {
+        tlsf_.addPool(mem_.get(), HEAP_SIZE);
+    }
+
+    Tlsf* operator->() {
+        return &tlsf_;
+    }
+
+private:
+    Tlsf tlsf_;
+    std::unique_ptr<char[]> mem_;
+};
+
+template<typename F>
+auto measure(OpStats& stats, F fn) {
+    const auto t1 = std::chrono::steady_clock::now();
+    auto r = fn();
+    const auto t2 = std::chrono::steady_clock::now();
+    stats.times.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(t2 - t1).count());
+    return r;
+}
+
+uint32_t percentile(const std::vector<uint32_t>& sorted, unsigned p) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    // Nearest-rank method
+    size_t rank = std::max<size_t>((sorted.size() * p + 99) / 100, 1);
+    return sorted[rank - 1];
+}
+
+void printStatsHeader() {
+    const auto w = VALUE_COLUMN_WIDTH;
+    LOG_PRINTF(INFO, "%-*s%-*s%-*s%-*s%-*s\r\n", DESCR_COLUMN_WIDTH, "", w, "p50 ns", w, "p90 ns", w, "p99 ns",
+            w, "max ns");
+}
+
+void printStatsRow(const char* desc, OpStats& stats) {
+    const auto w = VALUE_COLUMN_WIDTH;
+    auto& t = stats.times;
+    std::sort(t.begin(), t.end());
+    LOG_PRINTF(INFO, "%-*s%-*u%-*u%-*u%-*u\r\n", DESCR_COLUMN_WIDTH, desc, w, (unsigned)percentile(t, 50),
+            w, (unsigned)percentile(t, 90), w, (unsigned)percentile(t, 99), w, (unsigned)(t.empty() ? 0 : t.back()));
+}
+
+void printHeapStats(Heap& heap) {
+    Tlsf::Stats s = {};
+    heap->getStats(&s);
+    const unsigned frag = s.freeSize ? 100 - (uint64_t)s.largestFreeBlock * 100 / s.freeSize : 0;
+    LOG_PRINTF(INFO, "free: %u, min. free: %u, largest free block: %u, fragmentation: %u%%, free blocks: %u, used blocks: %u\r\n",
+            (unsigned)s.freeSize, (unsigned)s.minFreeSize, (unsigned)s.largestFreeBlock, frag,
+            (unsigned)s.freeBlockCount, (unsigned)s.usedBlockCount);
+}
+
+int testAllocFree() {
+    Heap heap;
+    std::mt19937 gen(1);
+    std::uniform_int_distribution<size_t> sizeDist(MIN_BLOCK_SIZE, MAX_BLOCK_SIZE);
+    std::vector<void*> blocks;
+    OpStats allocStats;
+    OpStats freeStats;
+    unsigned failed = 0;
+    for (int i = 0; i < OP_COUNT; ++i) {
+        if (blocks.size() < MAX_LIVE_BLOCKS && (blocks.empty() || gen() % 2)) {
+            const auto size = sizeDist(gen);
+            const auto p = measure(allocStats, [&]() {
+                return heap->alloc(size);
+            });
+            if (!p) {
+                ++failed;
+                continue;
+            }
+            blocks.push_back(p);
+        } else {
+            const auto index = gen() % blocks.size();
+            const auto p = blocks[index];
+            blocks[index] = blocks.back();
+            blocks.pop_back();
+            measure(freeStats, [&]() {
+                heap->free(p);
+                return 0;
+            });
+        }
+    }
+    LOG_PRINTF(INFO, "\r\n%d random operations with blocks of %u to %u bytes (%u allocations failed):\r\n", OP_COUNT,
+            (unsigned)MIN_BLOCK_SIZE, (unsigned)MAX_BLOCK_SIZE, failed);
+    printStatsHeader();
+    printStatsRow("Tlsf::alloc", allocStats);
+    printStatsRow("Tlsf::free", freeStats);
+    LOG_PRINTF(INFO, "Heap state after the workload:\r\n");
+    printHeapStats(heap);
+    CHECK(heap->check());
+    return 0;
+}
+
+// Previous behavior of realloc(): always allocate a new block and copy the data
+void* copyingRealloc(Heap& heap, void* ptr, size_t size) {
+    const auto p = heap->alloc(size);
+    if (p && ptr) {
+        std::memcpy(p, ptr, std::min(size, Tlsf::blockSize(ptr)));
+        heap->free(ptr);
+    }
+    return p;
+}
+
+template<typename F>
+int testGrow(const char* desc, F reallocFn) {
+    Heap heap;
+    OpStats stats;
+    unsigned inPlace = 0;
+    unsigned total = 0;
+    void* bufs[GROW_BUFFER_COUNT] = {};
+    size_t sizes[GROW_BUFFER_COUNT] = {};
+    std::mt19937 gen(2);
+    for (int i = 0; i < GROW_REPEAT_COUNT; ++i) {
+        // Grow several buffers in an interleaved fashion, as different subsystems would do
+        for (;;) {
+            const auto index = gen() % GROW_BUFFER_COUNT;
+            if (sizes[index] >= GROW_MAX_SIZE) {
+                heap->free(bufs[index]);
+                bufs[index] = nullptr;
+                sizes[index] = 0;
+                break;
+            }
+            const auto size = sizes[index] + GROW_STEP;
+            const auto p = measure(stats, [&]() {
+                return reallocFn(heap, bufs[index], size);
+            });
+            if (!p) {
+                LOG(ERROR, "Out of memory");
+                return Error::NO_MEMORY;
+            }
+            if (p == bufs[index]) {
+                ++inPlace;
+            }
+            ++total;
+            bufs[index] = p;
+            sizes[index] = size;
+        }
+    }
+    for (auto p: bufs) {
+        heap->free(p);
+    }
+    printStatsRow(desc, stats);
+    LOG_PRINTF(INFO, "%-*s%u of %u calls resized the block in place\r\n", DESCR_COLUMN_WIDTH, "", inPlace, total);
+    CHECK(heap->check());
+    return 0;
+}
+
+int runTests() {
+    CHECK(testAllocFree());
+    LOG_PRINTF(INFO, "\r\n%d buffers grown in steps of %u bytes up to %u bytes:\r\n", GROW_BUFFER_COUNT,
+            (unsigned)GROW_STEP, (unsigned)GROW_MAX_SIZE);
+    printStatsHeader();
+    CHECK(testGrow("Tlsf::realloc", [](Heap& heap, void* ptr, size_t size) {
+        return heap->realloc(ptr, size);
+    }));
+    CHECK(testGrow("alloc + copy + free", copyingRealloc));
+    return 0;
+}
+
+} // namespace
+
+void setup() {
+    int r = runTests();
+    if (r < 0) {
+        LOG(ERROR, "runTests() failed: %d", r);
+    }
+    std::exit(r < 0 ? 1 : 0);
+}
+
+void loop() {
+}
@@ -266,6 +266,60 @@ test(THREAD_09_dont_block_event_queue_option)
     assertEqual((int)test_val_fn1, 20);
 }
 
+test(THREAD_10_thread_pool_executes_tasks)
+{
+    s_ram_free_before = System.freeMemory();
+    {
+        ThreadPool pool(ThreadPoolConfig().workerCount(2).stackSize(2048));
+        assertTrue(pool.isValid());
+        Future<int> f1 = pool.execute([]() {
+            return 123;
+        });
+        std::atomic<int> count(0);
+        Future<void> f2 = pool.execute([&]() {
+            ++count;
+        });
+        assertTrue(f1.wait(1000));
+        assertTrue(f1.isSucceeded());
+        assertEqual(f1.result(), 123);
+        assertTrue(f2.wait(1000));
+        assertTrue(f2.isSucceeded());
+        assertEqual((int)count, 1);
+    }
+    delay(100);
+    // 1024 less to account for fragmentation and other allocations
+    assertMoreOrEqual(System.freeMemory(), s_ram_free_before - 1024);
+}
+
+test(THREAD_11_thread_pool_task_priorities_and_queue_limit)
+{
+    ThreadPool pool(ThreadPoolConfig().workerCount(1).queueSize(2).stackSize(2048));
+    assertTrue(pool.isValid());
+    // Keep the worker busy while the tasks are being queued
+    std::atomic<bool> unblock(false);
+    assertEqual(pool.post([&]() {
+        while (!unblock) {
+            delay(1);
+        }
+    }), 0);
+    delay(50);
+    char order[5] = {};
+    size_t n = 0;
+    assertEqual(pool.post([&]() { order[n++] = 'l'; }, ThreadPoolTaskPriority::LOW), 0);
+    assertEqual(pool.post([&]() { order[n++] = 'n'; }, ThreadPoolTaskPriority::NORMAL), 0);
+    assertEqual(pool.post([&]() { order[n++] = 'h'; }, ThreadPoolTaskPriority::HIGH), 0);
+    assertEqual(pool.post([&]() { order[n++] = 'H'; }, ThreadPoolTaskPriority::HIGH), 0);
+    assertEqual(pool.post([]() {}, ThreadPoolTaskPriority::HIGH), (int)Error::LIMIT_EXCEEDED);
+    auto f = pool.execute([]() {}, ThreadPoolTaskPriority::HIGH);
+    assertTrue(f.isFailed());
+    assertEqual((int)f.error().type(), (int)Error::LIMIT_EXCEEDED);
+    assertEqual((int)pool.pendingTaskCount(), 4);
+    unblock = true;
+    pool.shutdown(); // Waits for the pending tasks
+    assertEqual((int)pool.pendingTaskCount(), 0);
+    assertEqual(String(order), String("hHnl"));
+}
+
 // todo - test for SingleThreadedSection
 
 
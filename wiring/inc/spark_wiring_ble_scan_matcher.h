@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "spark_wiring_vector.h"
+
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * Default number of slots in the table used to suppress duplicate scan reports. Up to 3/4 of the
+ * slots can be occupied, after which the reports from previously unseen devices are no longer
+ * suppressed.
+ */
+#ifndef BLE_SCAN_DUPLICATE_CACHE_SIZE
+#define BLE_SCAN_DUPLICATE_CACHE_SIZE 256
+#endif
+
+namespace particle {
+
+/**
+ * Advertising report received during a scan.
+ *
+ * The address and the advertising data are referenced rather than copied.
+ */
+struct BleScanReport {
+    const uint8_t* address; ///< Device address (6 bytes, little-endian).
+    uint8_t addressType; ///< Address type as defined by the `ble_sig_addr_type_t` enum.
+    int8_t rssi; ///< RSSI.
+    const uint8_t* advData; ///< Advertising data.
+    size_t advDataLen; ///< Size of the advertising data.
+    const uint8_t* srData; ///< Scan response data.
+    size_t srDataLen; ///< Size of the scan response data.
+};
+
+/**
+ * Scan filter compiled into a form that can be matched against raw advertising reports.
+ *
+ * The criteria are added once before scanning. Matching a report parses its AD structures in place
+ * and doesn't allocate memory. As with `BleScanFilter`, a report matches if it satisfies all
+ * criteria that were set, and a criterion with multiple values is satisfied if any of the values
+ * match.
+ */
+class BleScanMatcher {
+public:
+    BleScanMatcher();
+
+    int addDeviceName(const char* name, size_t len);
+    // `uuid` is in the byte order used in the advertising data, `len` is either 2 or 16
+    int addServiceUuid(const uint8_t* uuid, size_t len);
+    int addAddress(const uint8_t* address, uint8_t type);
+    int addAppearance(uint16_t appearance);
+
+    BleScanMatcher& minRssi(int8_t rssi);
+    BleScanMatcher& maxRssi(int8_t rssi);
+
+    // The data is not copied and must remain valid while the matcher is in use
+    BleScanMatcher& customData(const uint8_t* data, size_t len);
+
+    bool match(const BleScanReport& report) const;
+
+    void clear();
+
+private:
+    struct Name {
+        uint16_t offset; // Offset in names_
+        uint16_t len;
+    };
+
+    struct Uuid128 {
+        uint8_t data[16];
+    };
+
+    struct Address {
+        uint8_t data[6];
+        uint8_t type;
+    };
+
+    struct AdFields;
+
+    Vector<char> names_;
+    Vector<Name> nameRefs_;
+    Vector<uint16_t> uuids16_;
+    Vector<Uuid128> uuids128_;
+    Vector<Address> addresses_;
+    Vector<uint16_t> appearances_;
+    const uint8_t* customData_;
+    size_t customDataLen_;
+    int minRssi_;
+    int maxRssi_;
+    bool parseData_; // Whether any of the criteria require parsing the advertising data
+
+    void parse(const uint8_t* data, size_t len, AdFields* fields) const;
+    bool matchName(const AdFields& adv, const AdFields& sr) const;
+    bool matchAppearance(const AdFields& adv, const AdFields& sr) const;
+    bool matchCustomData(const AdFields& adv, const AdFields& sr) const;
+    bool matchUuid16(const uint8_t* data, size_t len) const;
+    bool matchUuid128(const uint8_t* data, size_t len) const;
+};
+
+/**
+ * Fixed-size set of device addresses used to suppress duplicate scan reports.
+ */
+class BleAddressCache {
+public:
+    BleAddressCache();
+
+    // Allocates the table. Must be called before scanning
+    int init(size_t slotCount = BLE_SCAN_DUPLICATE_CACHE_SIZE);
+
+    // Returns true if the address has been seen before, otherwise adds it to the set. If the set
+    // is full or not initialized, returns false without adding the address
+    bool checkAndAdd(const uint8_t* address, uint8_t type);
+
+    void clear();
+
+    size_t size() const {
+        return size_;
+    }
+
+    size_t capacity() const {
+        return mask_ ? mask_ + 1 : 0;
+    }
+
+private:
+    std::unique_ptr<uint64_t[]> slots_; // 0 denotes an empty slot
+    size_t mask_;
+    size_t size_;
+    size_t maxSize_;
+    unsigned shift_;
+};
+
+} // namespace particle
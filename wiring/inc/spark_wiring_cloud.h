@@ -61,6 +61,7 @@ const PublishFlag PUBLIC(PUBLISH_EVENT_FLAG_PUBLIC);
 const PublishFlag PRIVATE(PUBLISH_EVENT_FLAG_PRIVATE);
 const PublishFlag NO_ACK(PUBLISH_EVENT_FLAG_NO_ACK);
 const PublishFlag WITH_ACK(PUBLISH_EVENT_FLAG_WITH_ACK);
+const PublishFlag PERSISTENT(PUBLISH_EVENT_FLAG_PERSISTENT);
 
 // Test if the paramater a regular C "string" literal
 template <typename T>
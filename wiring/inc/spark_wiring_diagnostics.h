@@ -22,12 +22,15 @@
 #include "spark_wiring_global.h"
 
 #include "diagnostics.h"
+#include "timer_hal.h"
 #include "system_error.h"
 #include "combine_hash.h"
 #include "underlying_type.h"
 #include "debug.h"
 
+#include <algorithm>
 #include <atomic>
+#include <climits>
 
 #define PARTICLE_RETAINED_INTEGER_DIAGNOSTIC_DATA(_var, _id, _name, _val, ...) \
         PARTICLE_RETAINED ::particle::RetainedIntegerDiagnosticDataStorage _storage##_id; \
@@ -111,6 +114,33 @@ protected:
     virtual int get(IntType& val) = 0;
 };
 
+// Base abstract class for a data source containing a histogram
+class AbstractHistogramDiagnosticData: public AbstractTypeDiagnosticData<diag_histogram_data> {
+public:
+    static int get(DiagnosticDataId id, diag_histogram_data& val);
+    static int get(const diag_source* src, diag_histogram_data& val);
+
+    // Returns the index of the bucket for a given sample value
+    static unsigned bucketIndex(uint32_t val, unsigned bucketCount);
+
+protected:
+    explicit AbstractHistogramDiagnosticData(DiagnosticDataId id, const char* name = nullptr);
+
+    virtual int get(diag_histogram_data& val) = 0;
+};
+
+// Base abstract class for a data source containing a windowed counter
+class AbstractCounterDiagnosticData: public AbstractTypeDiagnosticData<diag_counter_data> {
+public:
+    static int get(DiagnosticDataId id, diag_counter_data& val);
+    static int get(const diag_source* src, diag_counter_data& val);
+
+protected:
+    explicit AbstractCounterDiagnosticData(DiagnosticDataId id, const char* name = nullptr);
+
+    virtual int get(diag_counter_data& val) = 0;
+};
+
 template<typename ConcurrencyT = NoConcurrency>
 class IntegerDiagnosticData:
         public AbstractIntegerDiagnosticData,
@@ -327,6 +357,143 @@ private:
     }
 };
 
+// Histogram with logarithmic buckets. Samples can be recorded from any thread or an ISR without
+// locking. A snapshot taken while samples are being recorded may be slightly inconsistent, e.g. the
+// number of samples may not match the sum of the bucket counters
+template<unsigned BucketCountV = 16>
+class HistogramDiagnosticData: public AbstractHistogramDiagnosticData {
+public:
+    static_assert(BucketCountV >= 2 && BucketCountV <= DIAG_HISTOGRAM_MAX_BUCKET_COUNT, "Invalid number of buckets");
+
+    explicit HistogramDiagnosticData(DiagnosticDataId id, const char* name = nullptr) :
+            AbstractHistogramDiagnosticData(id, name) {
+        reset();
+    }
+
+    void record(uint32_t val) {
+        buckets_[bucketIndex(val, BucketCountV)].fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(val, std::memory_order_relaxed);
+        uint32_t v = min_.load(std::memory_order_relaxed);
+        while (val < v && !min_.compare_exchange_weak(v, val, std::memory_order_relaxed)) {
+        }
+        v = max_.load(std::memory_order_relaxed);
+        while (val > v && !max_.compare_exchange_weak(v, val, std::memory_order_relaxed)) {
+        }
+        count_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void reset() {
+        for (auto& b: buckets_) {
+            b.store(0, std::memory_order_relaxed);
+        }
+        count_.store(0, std::memory_order_relaxed);
+        sum_.store(0, std::memory_order_relaxed);
+        min_.store(UINT32_MAX, std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+    }
+
+    uint32_t count() const {
+        return count_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint32_t> buckets_[BucketCountV];
+    std::atomic<uint32_t> count_;
+    std::atomic<uint32_t> sum_;
+    std::atomic<uint32_t> min_;
+    std::atomic<uint32_t> max_;
+
+    virtual int get(diag_histogram_data& val) override { // AbstractHistogramDiagnosticData
+        val = {};
+        val.count = count_.load(std::memory_order_relaxed);
+        val.sum = sum_.load(std::memory_order_relaxed);
+        val.min = val.count ? min_.load(std::memory_order_relaxed) : 0;
+        val.max = max_.load(std::memory_order_relaxed);
+        val.bucket_count = BucketCountV;
+        for (unsigned i = 0; i < BucketCountV; ++i) {
+            val.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+        }
+        return SYSTEM_ERROR_NONE;
+    }
+};
+
+// Counts events within a sliding time window. The window is split into a number of slots and slides
+// in increments of one slot. Events can be counted from any thread or an ISR without locking. The
+// number of events counted per slot saturates at 65535
+template<unsigned SlotCountV = 6>
+class WindowedCounterDiagnosticData: public AbstractCounterDiagnosticData {
+public:
+    static_assert(SlotCountV >= 1 && SlotCountV < 0x10000, "Invalid number of slots");
+
+    WindowedCounterDiagnosticData(DiagnosticDataId id, const char* name, system_tick_t window) :
+            AbstractCounterDiagnosticData(id, name),
+            total_(0),
+            slotDuration_(std::max<system_tick_t>(window / SlotCountV, 1)) {
+        for (auto& s: slots_) {
+            s.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void add(uint32_t n = 1) {
+        add(n, HAL_Timer_Get_Milli_Seconds());
+    }
+
+    void add(uint32_t n, system_tick_t now) {
+        const uint32_t slot = now / slotDuration_;
+        const uint32_t epoch = slot & 0xffff;
+        auto& s = slots_[slot % SlotCountV];
+        uint32_t v = s.load(std::memory_order_relaxed);
+        uint32_t newVal = 0;
+        do {
+            // Each slot stores the 16 least significant bits of the slot number and the event count
+            const uint32_t count = ((v >> 16) == epoch) ? (v & 0xffff) : 0;
+            newVal = (epoch << 16) | std::min<uint32_t>(count + n, 0xffff);
+        } while (!s.compare_exchange_weak(v, newVal, std::memory_order_relaxed));
+        total_.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    WindowedCounterDiagnosticData& operator++() {
+        add(1);
+        return *this;
+    }
+
+    uint32_t windowCount() const {
+        return windowCount(HAL_Timer_Get_Milli_Seconds());
+    }
+
+    uint32_t windowCount(system_tick_t now) const {
+        const uint32_t epoch = (now / slotDuration_) & 0xffff;
+        uint32_t count = 0;
+        for (const auto& s: slots_) {
+            const uint32_t v = s.load(std::memory_order_relaxed);
+            if (((epoch - (v >> 16)) & 0xffff) < SlotCountV) {
+                count += v & 0xffff;
+            }
+        }
+        return count;
+    }
+
+    uint32_t total() const {
+        return total_.load(std::memory_order_relaxed);
+    }
+
+    system_tick_t window() const {
+        return slotDuration_ * SlotCountV;
+    }
+
+private:
+    std::atomic<uint32_t> slots_[SlotCountV];
+    std::atomic<uint32_t> total_;
+    system_tick_t slotDuration_;
+
+    virtual int get(diag_counter_data& val) override { // AbstractCounterDiagnosticData
+        val.total = total();
+        val.window_count = windowCount();
+        val.window = window();
+        return SYSTEM_ERROR_NONE;
+    }
+};
+
 template<typename StorageT, typename ConcurrencyT = NoConcurrency>
 class PersistentIntegerDiagnosticData:
         public AbstractIntegerDiagnosticData,
@@ -693,4 +860,35 @@ inline int AbstractUnsignedIntegerDiagnosticData::get(const diag_source* src, In
     return AbstractTypeDiagnosticData<IntType>::get(src, val);
 }
 
+inline AbstractHistogramDiagnosticData::AbstractHistogramDiagnosticData(DiagnosticDataId id, const char* name) :
+        AbstractTypeDiagnosticData<diag_histogram_data>(id, name, DIAG_TYPE_HISTOGRAM) {
+}
+
+inline int AbstractHistogramDiagnosticData::get(DiagnosticDataId id, diag_histogram_data& val) {
+    return AbstractTypeDiagnosticData<diag_histogram_data>::get(id, val);
+}
+
+inline int AbstractHistogramDiagnosticData::get(const diag_source* src, diag_histogram_data& val) {
+    SPARK_ASSERT(src->type == DIAG_TYPE_HISTOGRAM);
+    return AbstractTypeDiagnosticData<diag_histogram_data>::get(src, val);
+}
+
+inline unsigned AbstractHistogramDiagnosticData::bucketIndex(uint32_t val, unsigned bucketCount) {
+    const unsigned index = val ? (sizeof(unsigned) * CHAR_BIT - __builtin_clz(val)) : 0;
+    return std::min(index, bucketCount - 1);
+}
+
+inline AbstractCounterDiagnosticData::AbstractCounterDiagnosticData(DiagnosticDataId id, const char* name) :
+        AbstractTypeDiagnosticData<diag_counter_data>(id, name, DIAG_TYPE_COUNTER) {
+}
+
+inline int AbstractCounterDiagnosticData::get(DiagnosticDataId id, diag_counter_data& val) {
+    return AbstractTypeDiagnosticData<diag_counter_data>::get(id, val);
+}
+
+inline int AbstractCounterDiagnosticData::get(const diag_source* src, diag_counter_data& val) {
+    SPARK_ASSERT(src->type == DIAG_TYPE_COUNTER);
+    return AbstractTypeDiagnosticData<diag_counter_data>::get(src, val);
+}
+
 } // namespace particle
@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "hal_platform.h"
+
+#if PLATFORM_THREADING
+
+#include <functional>
+#include <type_traits>
+#include <atomic>
+#include <memory>
+
+#include "concurrent_hal.h"
+
+#include "spark_wiring_async.h"
+#include "spark_wiring_error.h"
+
+namespace particle {
+
+/**
+ * Task priority.
+ *
+ * Tasks of a higher priority are always dequeued before tasks of a lower priority. The priority
+ * doesn't affect the priority of the worker threads.
+ */
+enum class ThreadPoolTaskPriority {
+    LOW = 0,
+    NORMAL = 1,
+    HIGH = 2
+};
+
+/**
+ * Thread pool settings.
+ */
+class ThreadPoolConfig {
+public:
+    ThreadPoolConfig() :
+            name_("pool"),
+            workerCount_(1),
+            queueSize_(8),
+            stackSize_(OS_THREAD_STACK_SIZE_DEFAULT),
+            prio_(OS_THREAD_PRIORITY_DEFAULT) {
+    }
+
+    /**
+     * Set the name of the worker threads.
+     */
+    ThreadPoolConfig& name(const char* name) {
+        name_ = name;
+        return *this;
+    }
+
+    const char* name() const {
+        return name_;
+    }
+
+    /**
+     * Set the number of worker threads.
+     */
+    ThreadPoolConfig& workerCount(size_t count) {
+        workerCount_ = count;
+        return *this;
+    }
+
+    size_t workerCount() const {
+        return workerCount_;
+    }
+
+    /**
+     * Set the maximum number of pending tasks of each priority.
+     */
+    ThreadPoolConfig& queueSize(size_t size) {
+        queueSize_ = size;
+        return *this;
+    }
+
+    size_t queueSize() const {
+        return queueSize_;
+    }
+
+    /**
+     * Set the stack size of the worker threads.
+     */
+    ThreadPoolConfig& stackSize(size_t size) {
+        stackSize_ = size;
+        return *this;
+    }
+
+    size_t stackSize() const {
+        return stackSize_;
+    }
+
+    /**
+     * Set the priority of the worker threads.
+     */
+    ThreadPoolConfig& threadPriority(os_thread_prio_t prio) {
+        prio_ = prio;
+        return *this;
+    }
+
+    os_thread_prio_t threadPriority() const {
+        return prio_;
+    }
+
+private:
+    const char* name_;
+    size_t workerCount_;
+    size_t queueSize_;
+    size_t stackSize_;
+    os_thread_prio_t prio_;
+};
+
+/**
+ * A fixed number of worker threads executing tasks from a bounded queue.
+ *
+ * All tasks share the stacks of the worker threads, which is cheaper in terms of RAM than creating
+ * a dedicated thread for each job.
+ *
+ * Example usage:
+ * ```
+ * ThreadPool pool(ThreadPoolConfig().workerCount(2).stackSize(2048));
+ *
+ * Future<int> f = pool.execute([]() {
+ *     return compress(buf, size);
+ * });
+ * int n = f.result(); // Blocks until the task is completed
+ * ```
+ */
+class ThreadPool {
+public:
+    typedef std::function<void()> Task;
+
+    /**
+     * Construct an uninitialized pool.
+     */
+    ThreadPool();
+
+    /**
+     * Construct and initialize a pool.
+     *
+     * Use `isValid()` to check whether the pool was initialized successfully.
+     */
+    explicit ThreadPool(const ThreadPoolConfig& conf);
+
+    /**
+     * Destructor.
+     *
+     * Waits until all pending tasks are completed. No other methods of the pool may be called
+     * concurrently with the destructor.
+     */
+    ~ThreadPool();
+
+    /**
+     * Initialize the pool.
+     *
+     * @param conf Settings.
+     * @return 0 on success, otherwise an error code defined by `Error::Type`.
+     */
+    int init(const ThreadPoolConfig& conf);
+
+    /**
+     * Wait until all pending tasks are completed and stop the worker threads.
+     *
+     * Tasks cannot be submitted after this method is called. A task submitted concurrently with
+     * this method is either rejected or completed before the worker threads are stopped.
+     */
+    void shutdown();
+
+    /**
+     * Submit a task for execution.
+     *
+     * @param task Task.
+     * @param prio Task priority.
+     * @param timeout Maximum time in milliseconds to wait until there's room in the queue.
+     * @return 0 on success, otherwise an error code defined by `Error::Type`.
+     */
+    int post(Task task, ThreadPoolTaskPriority prio = ThreadPoolTaskPriority::NORMAL, system_tick_t timeout = 0) {
+        return post(std::move(task), Task(), prio, timeout);
+    }
+
+    /**
+     * Submit a task for execution and get a future for its result.
+     *
+     * The returned future is failed with `Error::LIMIT_EXCEEDED` if the queue is full.
+     *
+     * @param fn Function to execute. Must be callable without arguments.
+     * @param prio Task priority.
+     * @param timeout Maximum time in milliseconds to wait until there's room in the queue.
+     * @return Future.
+     */
+    template<typename FunctionT, typename ResultT = std::invoke_result_t<FunctionT>>
+    Future<ResultT> execute(FunctionT fn, ThreadPoolTaskPriority prio = ThreadPoolTaskPriority::NORMAL,
+            system_tick_t timeout = 0);
+
+    /**
+     * Get the number of tasks waiting in the queue.
+     */
+    size_t pendingTaskCount() const {
+        return pending_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Check whether the pool is initialized.
+     */
+    bool isValid() const {
+        return workerCount_ > 0;
+    }
+
+    // Instances of this class are not copyable nor movable
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+private:
+    static const size_t PRIORITY_COUNT = 3;
+
+    struct QueuedTask {
+        Task task;
+        Task cancel; // Called if the task is discarded without being run
+    };
+
+    std::unique_ptr<os_thread_t[]> workers_; // Worker threads
+    os_queue_t queues_[PRIORITY_COUNT]; // Task queues, one per priority
+    os_semaphore_t sem_; // Number of queued tasks plus pending stop requests
+    size_t workerCount_; // Number of worker threads
+    std::atomic<size_t> pending_; // Number of queued tasks
+    std::atomic<size_t> posting_; // Number of post() calls in progress
+    std::atomic<bool> stop_; // Whether the pool is shutting down
+
+    int post(Task task, Task cancel, ThreadPoolTaskPriority prio, system_tick_t timeout);
+    QueuedTask* takeTask();
+    void destroy();
+
+    static os_thread_return_t workerThread(void* data);
+};
+
+template<typename FunctionT, typename ResultT>
+inline Future<ResultT> ThreadPool::execute(FunctionT fn, ThreadPoolTaskPriority prio, system_tick_t timeout) {
+    Promise<ResultT> p;
+    auto f = p.future();
+    int r = post([p, fn = std::move(fn)]() mutable {
+        if (p.isDone()) {
+            return; // The future has been cancelled
+        }
+        if constexpr (std::is_void_v<ResultT>) {
+            fn();
+            p.setResult();
+        } else {
+            p.setResult(fn());
+        }
+    }, [p]() mutable {
+        if (!p.isDone()) {
+            p.setError(Error::CANCELLED);
+        }
+    }, prio, timeout);
+    if (r < 0) {
+        return Future<ResultT>((Error::Type)r);
+    }
+    return f;
+}
+
+} // namespace particle
+
+#endif // PLATFORM_THREADING
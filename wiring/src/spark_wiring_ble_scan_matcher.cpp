@@ -0,0 +1,398 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "spark_wiring_ble_scan_matcher.h"
+
+#include "system_error.h"
+
+#include <limits>
+#include <new>
+#include <cstring>
+
+namespace particle {
+
+namespace {
+
+// AD types as defined by the Bluetooth SIG. The BLE HAL headers are not available on all platforms
+const uint8_t AD_TYPE_UUID16_MORE_AVAILABLE = 0x02;
+const uint8_t AD_TYPE_UUID16_COMPLETE = 0x03;
+const uint8_t AD_TYPE_UUID128_MORE_AVAILABLE = 0x06;
+const uint8_t AD_TYPE_UUID128_COMPLETE = 0x07;
+const uint8_t AD_TYPE_SHORT_LOCAL_NAME = 0x08;
+const uint8_t AD_TYPE_COMPLETE_LOCAL_NAME = 0x09;
+const uint8_t AD_TYPE_APPEARANCE = 0x19;
+const uint8_t AD_TYPE_MANUFACTURER_SPECIFIC_DATA = 0xff;
+
+const size_t UUID16_LEN = 2;
+const size_t UUID128_LEN = 16;
+const size_t ADDRESS_LEN = 6;
+
+const uint16_t APPEARANCE_UNKNOWN = 0;
+
+const uint64_t SLOT_USED = (uint64_t)1 << 63;
+
+inline uint64_t addressKey(const uint8_t* addr, uint8_t type) {
+    uint64_t key = 0;
+    for (size_t i = 0; i < ADDRESS_LEN; ++i) {
+        key |= (uint64_t)addr[i] << (i * 8);
+    }
+    return key | ((uint64_t)type << 48) | SLOT_USED;
+}
+
+} // namespace
+
+// Fields of the advertising data that are looked up by the matcher. Only the first AD structure
+// of each type is taken into account, as done by BleAdvertisingData
+struct BleScanMatcher::AdFields {
+    const uint8_t* shortName;
+    size_t shortNameLen;
+    const uint8_t* completeName;
+    size_t completeNameLen;
+    const uint8_t* appearance;
+    const uint8_t* customData;
+    size_t customDataLen;
+    bool hasAppearance;
+    bool hasCustomData;
+    bool uuidMatched;
+};
+
+BleScanMatcher::BleScanMatcher() :
+        customData_(nullptr),
+        customDataLen_(0),
+        minRssi_(std::numeric_limits<int>::min()),
+        maxRssi_(std::numeric_limits<int>::max()),
+        parseData_(false) {
+}
+
+int BleScanMatcher::addDeviceName(const char* name, size_t len) {
+    const size_t offs = names_.size();
+    if (offs + len > std::numeric_limits<uint16_t>::max()) {
+        return SYSTEM_ERROR_TOO_LARGE;
+    }
+    if (!names_.append(name, len) || !nameRefs_.append(Name{ (uint16_t)offs, (uint16_t)len })) {
+        return SYSTEM_ERROR_NO_MEMORY;
+    }
+    parseData_ = true;
+    return 0;
+}
+
+int BleScanMatcher::addServiceUuid(const uint8_t* uuid, size_t len) {
+    if (len == UUID16_LEN) {
+        if (!uuids16_.append((uint16_t)uuid[0] | ((uint16_t)uuid[1] << 8))) {
+            return SYSTEM_ERROR_NO_MEMORY;
+        }
+    } else if (len == UUID128_LEN) {
+        Uuid128 u;
+        memcpy(u.data, uuid, UUID128_LEN);
+        if (!uuids128_.append(u)) {
+            return SYSTEM_ERROR_NO_MEMORY;
+        }
+    } else {
+        return SYSTEM_ERROR_INVALID_ARGUMENT;
+    }
+    parseData_ = true;
+    return 0;
+}
+
+int BleScanMatcher::addAddress(const uint8_t* address, uint8_t type) {
+    Address a;
+    memcpy(a.data, address, ADDRESS_LEN);
+    a.type = type;
+    if (!addresses_.append(a)) {
+        return SYSTEM_ERROR_NO_MEMORY;
+    }
+    return 0;
+}
+
+int BleScanMatcher::addAppearance(uint16_t appearance) {
+    if (!appearances_.append(appearance)) {
+        return SYSTEM_ERROR_NO_MEMORY;
+    }
+    parseData_ = true;
+    return 0;
+}
+
+BleScanMatcher& BleScanMatcher::minRssi(int8_t rssi) {
+    minRssi_ = rssi;
+    return *this;
+}
+
+BleScanMatcher& BleScanMatcher::maxRssi(int8_t rssi) {
+    maxRssi_ = rssi;
+    return *this;
+}
+
+BleScanMatcher& BleScanMatcher::customData(const uint8_t* data, size_t len) {
+    if (data && len > 0) {
+        customData_ = data;
+        customDataLen_ = len;
+        parseData_ = true;
+    } else {
+        customData_ = nullptr;
+        customDataLen_ = 0;
+    }
+    return *this;
+}
+
+bool BleScanMatcher::match(const BleScanReport& report) const {
+    if (report.rssi < minRssi_ || report.rssi > maxRssi_) {
+        return false;
+    }
+    if (!addresses_.isEmpty()) {
+        bool found = false;
+        for (const auto& a: addresses_) {
+            if (a.type == report.addressType && !memcmp(a.data, report.address, ADDRESS_LEN)) {
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            return false;
+        }
+    }
+    if (!parseData_) {
+        return true;
+    }
+    AdFields adv = {};
+    AdFields sr = {};
+    parse(report.advData, report.advDataLen, &adv);
+    parse(report.srData, report.srDataLen, &sr);
+    if (!nameRefs_.isEmpty() && !matchName(adv, sr)) {
+        return false;
+    }
+    if ((!uuids16_.isEmpty() || !uuids128_.isEmpty()) && !adv.uuidMatched && !sr.uuidMatched) {
+        return false;
+    }
+    if (!appearances_.isEmpty() && !matchAppearance(adv, sr)) {
+        return false;
+    }
+    if (customData_ && !matchCustomData(adv, sr)) {
+        return false;
+    }
+    return true;
+}
+
+void BleScanMatcher::clear() {
+    names_.clear();
+    nameRefs_.clear();
+    uuids16_.clear();
+    uuids128_.clear();
+    addresses_.clear();
+    appearances_.clear();
+    customData_ = nullptr;
+    customDataLen_ = 0;
+    minRssi_ = std::numeric_limits<int>::min();
+    maxRssi_ = std::numeric_limits<int>::max();
+    parseData_ = false;
+}
+
+void BleScanMatcher::parse(const uint8_t* data, size_t len, AdFields* fields) const {
+    if (!data) {
+        return;
+    }
+    size_t offs = 0;
+    while (offs + 3 <= len) {
+        // The length field doesn't include itself but includes the type field
+        const size_t adLen = data[offs];
+        if (offs + adLen + 1 > len) {
+            break; // Malformed data
+        }
+        if (adLen == 0) {
+            ++offs;
+            continue;
+        }
+        const uint8_t type = data[offs + 1];
+        const uint8_t* val = data + offs + 2;
+        const size_t valLen = adLen - 1;
+        offs += adLen + 1;
+        switch (type) {
+        case AD_TYPE_SHORT_LOCAL_NAME:
+            if (!fields->shortName) {
+                fields->shortName = val;
+                fields->shortNameLen = valLen;
+            }
+            break;
+        case AD_TYPE_COMPLETE_LOCAL_NAME:
+            if (!fields->completeName) {
+                fields->completeName = val;
+                fields->completeNameLen = valLen;
+            }
+            break;
+        case AD_TYPE_APPEARANCE:
+            if (!fields->hasAppearance) {
+                fields->appearance = (valLen >= 2) ? val : nullptr;
+                fields->hasAppearance = true;
+            }
+            break;
+        case AD_TYPE_MANUFACTURER_SPECIFIC_DATA:
+            if (!fields->hasCustomData) {
+                fields->customData = val;
+                fields->customDataLen = valLen;
+                fields->hasCustomData = true;
+            }
+            break;
+        case AD_TYPE_UUID16_MORE_AVAILABLE:
+        case AD_TYPE_UUID16_COMPLETE:
+            if (!fields->uuidMatched && matchUuid16(val, valLen)) {
+                fields->uuidMatched = true;
+            }
+            break;
+        case AD_TYPE_UUID128_MORE_AVAILABLE:
+        case AD_TYPE_UUID128_COMPLETE:
+            if (!fields->uuidMatched && matchUuid128(val, valLen)) {
+                fields->uuidMatched = true;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+bool BleScanMatcher::matchName(const AdFields& adv, const AdFields& sr) const {
+    // The short name takes precedence over the complete name if both are present
+    const auto nameOf = [](const AdFields& f, size_t* len) {
+        if (f.shortNameLen > 0) {
+            *len = f.shortNameLen;
+            return f.shortName;
+        }
+        *len = f.completeNameLen;
+        return f.completeName;
+    };
+    size_t advLen = 0;
+    const auto advName = nameOf(adv, &advLen);
+    size_t srLen = 0;
+    const auto srName = nameOf(sr, &srLen);
+    if (advLen == 0 && srLen == 0) {
+        return false;
+    }
+    for (const auto& ref: nameRefs_) {
+        const char* name = names_.data() + ref.offset;
+        if ((ref.len == srLen && (!srLen || !memcmp(name, srName, srLen))) ||
+                (ref.len == advLen && (!advLen || !memcmp(name, advName, advLen)))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool BleScanMatcher::matchAppearance(const AdFields& adv, const AdFields& sr) const {
+    const auto appearanceOf = [](const AdFields& f) {
+        return f.appearance ? (uint16_t)((uint16_t)f.appearance[0] | ((uint16_t)f.appearance[1] << 8)) :
+                APPEARANCE_UNKNOWN;
+    };
+    const auto advAppearance = appearanceOf(adv);
+    const auto srAppearance = appearanceOf(sr);
+    for (auto a: appearances_) {
+        if (a == advAppearance || a == srAppearance) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool BleScanMatcher::matchCustomData(const AdFields& adv, const AdFields& sr) const {
+    return (sr.customDataLen == customDataLen_ && !memcmp(sr.customData, customData_, customDataLen_)) ||
+            (adv.customDataLen == customDataLen_ && !memcmp(adv.customData, customData_, customDataLen_));
+}
+
+bool BleScanMatcher::matchUuid16(const uint8_t* data, size_t len) const {
+    for (size_t i = 0; i + UUID16_LEN <= len; i += UUID16_LEN) {
+        const uint16_t uuid = (uint16_t)data[i] | ((uint16_t)data[i + 1] << 8);
+        for (auto u: uuids16_) {
+            if (u == uuid) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool BleScanMatcher::matchUuid128(const uint8_t* data, size_t len) const {
+    for (size_t i = 0; i + UUID128_LEN <= len; i += UUID128_LEN) {
+        for (const auto& u: uuids128_) {
+            if (!memcmp(u.data, data + i, UUID128_LEN)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+BleAddressCache::BleAddressCache() :
+        mask_(0),
+        size_(0),
+        maxSize_(0),
+        shift_(0) {
+}
+
+int BleAddressCache::init(size_t slotCount) {
+    size_t n = 4;
+    unsigned bits = 2;
+    while (n < slotCount) {
+        n <<= 1;
+        ++bits;
+    }
+    if (n != capacity()) {
+        slots_.reset(new(std::nothrow) uint64_t[n]);
+        if (!slots_) {
+            mask_ = 0;
+            size_ = 0;
+            maxSize_ = 0;
+            return SYSTEM_ERROR_NO_MEMORY;
+        }
+        mask_ = n - 1;
+        maxSize_ = n / 4 * 3;
+        shift_ = 64 - bits;
+    }
+    clear();
+    return 0;
+}
+
+bool BleAddressCache::checkAndAdd(const uint8_t* address, uint8_t type) {
+    if (!slots_) {
+        return false;
+    }
+    const uint64_t key = addressKey(address, type);
+    // Fibonacci hashing followed by linear probing
+    size_t i = (size_t)((key * 0x9e3779b97f4a7c15ull) >> shift_);
+    for (;;) {
+        const uint64_t slot = slots_[i];
+        if (slot == key) {
+            return true;
+        }
+        if (!slot) {
+            break;
+        }
+        i = (i + 1) & mask_;
+    }
+    if (size_ >= maxSize_) {
+        return false;
+    }
+    slots_[i] = key;
+    ++size_;
+    return false;
+}
+
+void BleAddressCache::clear() {
+    if (slots_) {
+        memset(slots_.get(), 0, (mask_ + 1) * sizeof(uint64_t));
+    }
+    size_ = 0;
+}
+
+} // namespace particle
@@ -73,7 +73,8 @@ bool CloudClass::register_function(cloud_function_t fn, void* data, const char*
 }
 
 Future<bool> CloudClass::publish_event(const char *eventName, const char *eventData, int ttl, PublishFlags flags) {
-    if (!connected()) {
+    // Persistent events are queued by the system while the device is offline
+    if (!connected() && !(flags & PERSISTENT)) {
         return Future<bool>(Error::INVALID_STATE);
     }
     spark_send_event_data d = {};
@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2026 Particle Industries, Inc.  All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation, either
+ * version 3 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "spark_wiring_thread_pool.h"
+
+#if PLATFORM_THREADING
+
+#include "scope_guard.h"
+#include "delay_hal.h"
+
+namespace particle {
+
+ThreadPool::ThreadPool() :
+        queues_(),
+        sem_(nullptr),
+        workerCount_(0),
+        pending_(0),
+        posting_(0),
+        stop_(false) {
+}
+
+ThreadPool::ThreadPool(const ThreadPoolConfig& conf) :
+        ThreadPool() {
+    init(conf);
+}
+
+ThreadPool::~ThreadPool() {
+    shutdown();
+}
+
+int ThreadPool::init(const ThreadPoolConfig& conf) {
+    if (isValid()) {
+        return Error::INVALID_STATE;
+    }
+    if (!conf.workerCount() || !conf.queueSize()) {
+        return Error::INVALID_ARGUMENT;
+    }
+    stop_ = false;
+    NAMED_SCOPE_GUARD(destroyGuard, {
+        destroy();
+    });
+    workers_.reset(new(std::nothrow) os_thread_t[conf.workerCount()]);
+    if (!workers_) {
+        return Error::NO_MEMORY;
+    }
+    for (size_t i = 0; i < PRIORITY_COUNT; ++i) {
+        if (os_queue_create(&queues_[i], sizeof(QueuedTask*), conf.queueSize(), nullptr) != 0) {
+            queues_[i] = nullptr;
+            return Error::NO_MEMORY;
+        }
+    }
+    // Every queued task and every stop request wakes up one worker
+    const size_t maxCount = conf.queueSize() * PRIORITY_COUNT + conf.workerCount();
+    if (os_semaphore_create(&sem_, maxCount, 0) != 0) {
+        sem_ = nullptr;
+        return Error::NO_MEMORY;
+    }
+    for (size_t i = 0; i < conf.workerCount(); ++i) {
+        if (os_thread_create(&workers_[i], conf.name(), conf.threadPriority(), workerThread, this,
+                conf.stackSize()) != 0) {
+            // Stop the threads created so far
+            workerCount_ = i;
+            shutdown();
+            return Error::NO_MEMORY;
+        }
+    }
+    workerCount_ = conf.workerCount();
+    destroyGuard.dismiss();
+    return 0;
+}
+
+void ThreadPool::shutdown() {
+    if (!workers_ || stop_.exchange(true)) {
+        return;
+    }
+    // Wait until the post() calls that are in progress have queued their tasks. The workers keep
+    // running until they receive the stop requests, so a call that waits for room in a queue
+    // can complete too. All tasks queued before the stop requests are run by the workers
+    while (posting_.load() > 0) {
+        HAL_Delay_Milliseconds(1);
+    }
+    for (size_t i = 0; i < workerCount_; ++i) {
+        os_semaphore_give(sem_, false);
+    }
+    for (size_t i = 0; i < workerCount_; ++i) {
+        os_thread_join(workers_[i]);
+        os_thread_cleanup(workers_[i]);
+    }
+    destroy();
+}
+
+int ThreadPool::post(Task task, Task cancel, ThreadPoolTaskPriority prio, system_tick_t timeout) {
+    const auto index = (size_t)prio;
+    if (index >= PRIORITY_COUNT || !task) {
+        return Error::INVALID_ARGUMENT;
+    }
+    // shutdown() sets the stop flag before checking the number of post() calls in progress, and
+    // this method does the opposite, so the task is either rejected or queued before the workers
+    // are stopped
+    posting_.fetch_add(1);
+    SCOPE_GUARD({
+        posting_.fetch_sub(1);
+    });
+    if (!isValid() || stop_.load()) {
+        return Error::INVALID_STATE;
+    }
+    std::unique_ptr<QueuedTask> t(new(std::nothrow) QueuedTask{std::move(task), std::move(cancel)});
+    if (!t) {
+        return Error::NO_MEMORY;
+    }
+    auto ptr = t.get();
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    if (os_queue_put(queues_[index], &ptr, timeout, nullptr) != 0) {
+        pending_.fetch_sub(1, std::memory_order_relaxed);
+        return Error::LIMIT_EXCEEDED;
+    }
+    t.release();
+    os_semaphore_give(sem_, false);
+    return 0;
+}
+
+ThreadPool::QueuedTask* ThreadPool::takeTask() {
+    for (size_t i = PRIORITY_COUNT; i > 0; --i) {
+        QueuedTask* task = nullptr;
+        if (queues_[i - 1] && os_queue_take(queues_[i - 1], &task, 0, nullptr) == 0) {
+            pending_.fetch_sub(1, std::memory_order_relaxed);
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+void ThreadPool::destroy() {
+    // All queued tasks are normally run before the workers are stopped. Discard any remaining
+    // ones so that their futures don't stay pending forever
+    for (;;) {
+        std::unique_ptr<QueuedTask> task(takeTask());
+        if (!task) {
+            break;
+        }
+        if (task->cancel) {
+            task->cancel();
+        }
+    }
+    if (sem_) {
+        os_semaphore_destroy(sem_);
+        sem_ = nullptr;
+    }
+    for (size_t i = 0; i < PRIORITY_COUNT; ++i) {
+        if (queues_[i]) {
+            os_queue_destroy(queues_[i], nullptr);
+            queues_[i] = nullptr;
+        }
+    }
+    workers_.reset();
+    workerCount_ = 0;
+    pending_ = 0;
+}
+
+os_thread_return_t ThreadPool::workerThread(void* data) {
+    auto self = static_cast<ThreadPool*>(data);
+    for (;;) {
+        os_semaphore_take(self->sem_, CONCURRENT_WAIT_FOREVER, false);
+        // The semaphore is given once per queued task so the task is not necessarily the one that
+        // caused this thread to wake up, but the total number of wakeups always matches
+        std::unique_ptr<QueuedTask> task(self->takeTask());
+        if (task) {
+            task->task();
+        } else if (self->stop_.load(std::memory_order_relaxed)) {
+            break;
+        }
+    }
+    os_thread_exit(nullptr);
+}
+
+} // namespace particle
+
+#endif // PLATFORM_THREADING